@@ -35,6 +35,10 @@ class CheckCCompiles(object):
             self.extra_args = ['/arch:AVX', '/arch:AVX2', '/arch:AVX512']
         else:
             self.extra_args = []
+        # compiles and links only reflect the compiler, works also requires the
+        # current cpu to run the result
+        self.compiles = False
+        self.links = False
         self.works = False
 
     def try_run(self):
@@ -43,6 +43,10 @@
 #  define PYSIMD_OS_UNKNOWN
 #endif
 
+#if defined(PYSIMD_OS_LINUX)
+#  include <unistd.h>
+#endif
+
 //Mobile OS detection (android is shared with linux)
 #ifdef __ANDROID__
 #  define PYSIMD_OSM_ANDROID
@@ -51,9 +55,11 @@
 #if defined(PYSIMD_ARCH_X86_64)
 #  if defined(PYSIMD_OS_WINDOWS)
 #    define PYSIMD_X86_CPUID(info, x)    __cpuidex(info, x, 0)
+#    define PYSIMD_X86_CPUID_SUB(info, x, sub)    __cpuidex(info, x, sub)
 #  elif defined(PYSIMD_CC_GCC)
 #    include <cpuid.h>
 #    define PYSIMD_X86_CPUID(info, x) __cpuid_count(x, 0, (info)[0], (info)[1], (info)[2], (info)[3])
+#    define PYSIMD_X86_CPUID_SUB(info, x, sub) __cpuid_count(x, sub, (info)[0], (info)[1], (info)[2], (info)[3])
 #  endif
     // intrinsic headers
 #   if defined(PYSIMD_CC_GCC) || defined(PYSIMD_CC_CLANG)
@@ -63,6 +69,28 @@
 #   endif // !defined(PYSIMD_CC_GCC) || defined(PYSIMD_CC_CLANG)
 #endif
 
+// Per function instruction set targeting. This lets several ISA variants of the same
+// kernel be compiled into one binary, without passing -mavx2 and such to the whole module.
+// The variant that actually runs is picked at import time, see simd_dispatch.h
+#if defined(PYSIMD_CC_GCC) || defined(PYSIMD_CC_CLANG)
+#  define PYSIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+   // MSVC allows any intrinsic to be used regardless of /arch
+#  define PYSIMD_TARGET(isa)
+#endif
+
+#define PYSIMD_TARGET_SSE2 PYSIMD_TARGET("sse2")
+#define PYSIMD_TARGET_AVX2 PYSIMD_TARGET("avx,avx2")
+#define PYSIMD_TARGET_AVX512 PYSIMD_TARGET("avx,avx2,avx512f,avx512bw")
+#define PYSIMD_TARGET_FMA PYSIMD_TARGET("avx,avx2,fma")
+#define PYSIMD_TARGET_POPCNT PYSIMD_TARGET("popcnt")
+#define PYSIMD_TARGET_SSE42 PYSIMD_TARGET("sse4.2")
+
+// The 512 bit kernels need byte and word lanes, so both must be emittable
+#if defined(PYSIMD_X86_AVX512F) && defined(PYSIMD_X86_AVX512BW)
+#  define PYSIMD_X86_AVX512 1
+#endif
+
 // Exact width integer types
 #if defined(PYSIMD_OS_WINDOWS) && defined(_MSC_VER)
     typedef __int8 int8_t;
@@ -167,6 +195,7 @@ int pysimd_x86_features_init(struct pysimd_x86_features* feat)
     FORMAT_CPU_FEATURE(ssse3);
     feat->sse41 = __builtin_cpu_supports("sse4.1");
     feat->sse42 = __builtin_cpu_supports("sse4.2");
+    FORMAT_CPU_FEATURE(popcnt);
     FORMAT_CPU_FEATURE(sse4a);
     FORMAT_CPU_FEATURE(avx);
     FORMAT_CPU_FEATURE(avx2);
@@ -246,9 +275,62 @@ int pysimd_x86_features_init(struct pysimd_x86_features* feat)
 }
 #endif // PYSIMD_ARCH_X86_64
 
+// Used when the cache size cannot be detected
+#define PYSIMD_DEFAULT_CACHE_SIZE ((size_t)8 << 20)
+
+#if defined(PYSIMD_ARCH_X86_64) && defined(PYSIMD_X86_CPUID_SUB)
+/* Walks the deterministic cache parameters of cpuid, which Intel reports under leaf 4
+ * and AMD under leaf 0x8000001D, in the same layout, and returns the largest cache.
+ */
+static size_t pysimd_x86_cache_size_leaf(unsigned leaf)
+{
+    int infos[4];
+    unsigned sub = 0;
+    size_t largest = 0;
+    for (; sub < 16; ++sub) {
+        size_t ways, partitions, line_size, sets;
+        PYSIMD_X86_CPUID_SUB(infos, leaf, sub);
+        // A cache type of 0 ends the list
+        if ((infos[0] & 0x1f) == 0)
+            break;
+        ways = (((unsigned)infos[1] >> 22) & 0x3ff) + 1;
+        partitions = (((unsigned)infos[1] >> 12) & 0x3ff) + 1;
+        line_size = ((unsigned)infos[1] & 0xfff) + 1;
+        sets = (unsigned)infos[2] + 1;
+        if (ways * partitions * line_size * sets > largest)
+            largest = ways * partitions * line_size * sets;
+    }
+    return largest;
+}
+#endif
+
+// Returns the size in bytes of the last level cache
+static size_t pysimd_cache_size_detect(void)
+{
+    size_t found = 0;
+#if defined(PYSIMD_ARCH_X86_64) && defined(PYSIMD_X86_CPUID_SUB)
+    int infos[4];
+    PYSIMD_X86_CPUID(infos, 0);
+    if ((unsigned)infos[0] >= 4)
+        found = pysimd_x86_cache_size_leaf(4);
+    if (found == 0) {
+        PYSIMD_X86_CPUID(infos, 0x80000000);
+        if ((unsigned)infos[0] >= 0x8000001D)
+            found = pysimd_x86_cache_size_leaf(0x8000001D);
+    }
+#elif defined(PYSIMD_OS_LINUX) && defined(_SC_LEVEL3_CACHE_SIZE)
+    long level3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    long level2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    found = level3 > 0 ? (size_t)level3 : (level2 > 0 ? (size_t)level2 : 0);
+#endif
+    return found > 0 ? found : PYSIMD_DEFAULT_CACHE_SIZE;
+}
+
 struct pysimd_sys_info {
     enum pysimd_arch arch;
     enum pysimd_cc compiler;
+    // Last level cache, in bytes
+    size_t cache_size;
 #ifdef PYSIMD_ARCH_X86_64
     struct pysimd_x86_features features;
 #endif // PYSIMD_ARCH_X86_64
@@ -256,6 +338,8 @@ struct pysimd_sys_info {
 
 static void pysimd_sys_info_init(struct pysimd_sys_info* sinfo)
 {
+    // Features a branch below does not detect stay unsupported
+    memset(sinfo, 0, sizeof(struct pysimd_sys_info));
     #if defined(PYSIMD_ARCH_X86_64)
         sinfo->arch = PYSIMD_ARCH_TYPE_X86;
         (void)pysimd_x86_features_init(&(sinfo->features));
@@ -278,6 +362,7 @@ static void pysimd_sys_info_init(struct pysimd_sys_info* sinfo)
     #else
         sinfo->compiler = PYSIMD_CC_TYPE_UNKNOWN;
     #endif
+    sinfo->cache_size = pysimd_cache_size_detect();
 }
 
 #endif // CORE_SIMD_INFO_H
\ No newline at end of file
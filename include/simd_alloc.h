@@ -0,0 +1,184 @@
+#ifndef PYSIMD_ALLOC_H
+#define PYSIMD_ALLOC_H
+
+#include "core_simd_info.h"
+
+#if defined(PYSIMD_OS_WINDOWS)
+#  include <windows.h>
+#  include <malloc.h>
+#elif defined(PYSIMD_OS_LINUX) || defined(PYSIMD_OS_MAC)
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  define PYSIMD_ALLOC_HAS_MMAP
+#endif
+
+/* Allocator for vector data. Every block is aligned on a cache line, which is
+ * also the widest register any kernel uses, so aligned loads are always valid.
+ *
+ * Blocks up to PYSIMD_ALLOC_MAX_POOLED bytes are rounded up to a power of two size
+ * class, and freed blocks are kept on a free list per class, so short lived vectors
+ * do not go back to the system allocator. Larger blocks are mapped directly from the
+ * OS, which also hands them out already zeroed.
+ *
+ * The free lists are not locked, all calls must happen while holding the GIL.
+ */
+
+#define PYSIMD_ALLOC_ALIGN 64
+#define PYSIMD_ALLOC_MIN_SHIFT 6
+#define PYSIMD_ALLOC_MAX_SHIFT 20
+#define PYSIMD_ALLOC_MAX_POOLED ((size_t)1 << PYSIMD_ALLOC_MAX_SHIFT)
+#define PYSIMD_ALLOC_N_CLASSES (PYSIMD_ALLOC_MAX_SHIFT - PYSIMD_ALLOC_MIN_SHIFT + 1)
+// Upper bound on the bytes each size class may keep cached
+#define PYSIMD_ALLOC_CLASS_CACHE ((size_t)4 << 20)
+
+struct pysimd_alloc_block {
+	struct pysimd_alloc_block* next;
+};
+
+struct pysimd_alloc_pool {
+	struct pysimd_alloc_block* free_list[PYSIMD_ALLOC_N_CLASSES];
+	size_t n_cached[PYSIMD_ALLOC_N_CLASSES];
+};
+
+static struct pysimd_alloc_pool pysimd_alloc_global_pool;
+
+static size_t pysimd_alloc_class_of(size_t size)
+{
+	size_t cls = 0;
+	size_t class_size = (size_t)1 << PYSIMD_ALLOC_MIN_SHIFT;
+	while (class_size < size) {
+		class_size <<= 1;
+		++cls;
+	}
+	return cls;
+}
+
+#if defined(PYSIMD_ALLOC_HAS_MMAP)
+static size_t pysimd_alloc_page_size(void)
+{
+	static size_t page_size = 0;
+	if (page_size == 0) {
+		long found = sysconf(_SC_PAGESIZE);
+		page_size = found > 0 ? (size_t)found : 4096;
+	}
+	return page_size;
+}
+#endif
+
+/* Returns the number of bytes that will really be reserved for a request of size
+ * bytes. This is the value to pass back to pysimd_free.
+ */
+static size_t pysimd_alloc_capacity(size_t size)
+{
+	if (size <= PYSIMD_ALLOC_MAX_POOLED) {
+		return (size_t)1 << (pysimd_alloc_class_of(size) + PYSIMD_ALLOC_MIN_SHIFT);
+	}
+#if defined(PYSIMD_ALLOC_HAS_MMAP)
+	{
+		size_t page_size = pysimd_alloc_page_size();
+		return (size + page_size - 1) / page_size * page_size;
+	}
+#else
+	return (size + PYSIMD_ALLOC_ALIGN - 1) / PYSIMD_ALLOC_ALIGN * PYSIMD_ALLOC_ALIGN;
+#endif
+}
+
+static void* pysimd_alloc_aligned_sys(size_t capacity)
+{
+#if defined(PYSIMD_OS_WINDOWS)
+	return _aligned_malloc(capacity, PYSIMD_ALLOC_ALIGN);
+#else
+	void* ptr = NULL;
+	if (posix_memalign(&ptr, PYSIMD_ALLOC_ALIGN, capacity) != 0)
+		return NULL;
+	return ptr;
+#endif
+}
+
+static void pysimd_free_aligned_sys(void* ptr)
+{
+#if defined(PYSIMD_OS_WINDOWS)
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+/* Allocates at least size bytes, aligned on PYSIMD_ALLOC_ALIGN. When zeroed is 0 the
+ * contents are unspecified, which saves a pass over memory the caller will overwrite.
+ * The reserved size is written to capacity.
+ */
+static void* pysimd_alloc(size_t size, int zeroed, size_t* capacity)
+{
+	void* ptr = NULL;
+	*capacity = pysimd_alloc_capacity(size);
+	if (*capacity <= PYSIMD_ALLOC_MAX_POOLED) {
+		size_t cls = pysimd_alloc_class_of(*capacity);
+		struct pysimd_alloc_block* cached = pysimd_alloc_global_pool.free_list[cls];
+		if (cached != NULL) {
+			pysimd_alloc_global_pool.free_list[cls] = cached->next;
+			pysimd_alloc_global_pool.n_cached[cls] -= 1;
+			ptr = cached;
+		} else {
+			ptr = pysimd_alloc_aligned_sys(*capacity);
+		}
+		if (ptr != NULL && zeroed)
+			memset(ptr, 0, *capacity);
+		return ptr;
+	}
+#if defined(PYSIMD_ALLOC_HAS_MMAP)
+	ptr = mmap(NULL, *capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return ptr == MAP_FAILED ? NULL : ptr;
+#elif defined(PYSIMD_OS_WINDOWS)
+	return VirtualAlloc(NULL, *capacity, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+	ptr = pysimd_alloc_aligned_sys(*capacity);
+	if (ptr != NULL && zeroed)
+		memset(ptr, 0, *capacity);
+	return ptr;
+#endif
+}
+
+// Releases a block, capacity must be the value pysimd_alloc reported for it
+static void pysimd_free(void* ptr, size_t capacity)
+{
+	if (ptr == NULL)
+		return;
+	if (capacity <= PYSIMD_ALLOC_MAX_POOLED) {
+		size_t cls = pysimd_alloc_class_of(capacity);
+		if ((pysimd_alloc_global_pool.n_cached[cls] + 1) * capacity <= PYSIMD_ALLOC_CLASS_CACHE) {
+			struct pysimd_alloc_block* block = (struct pysimd_alloc_block*)ptr;
+			block->next = pysimd_alloc_global_pool.free_list[cls];
+			pysimd_alloc_global_pool.free_list[cls] = block;
+			pysimd_alloc_global_pool.n_cached[cls] += 1;
+		} else {
+			pysimd_free_aligned_sys(ptr);
+		}
+		return;
+	}
+#if defined(PYSIMD_ALLOC_HAS_MMAP)
+	munmap(ptr, capacity);
+#elif defined(PYSIMD_OS_WINDOWS)
+	VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+	pysimd_free_aligned_sys(ptr);
+#endif
+}
+
+// Returns every cached block to the system
+static void pysimd_alloc_trim(void)
+{
+	size_t cls = 0;
+	for (; cls < PYSIMD_ALLOC_N_CLASSES; ++cls) {
+		struct pysimd_alloc_block* block = pysimd_alloc_global_pool.free_list[cls];
+		while (block != NULL) {
+			struct pysimd_alloc_block* next = block->next;
+			pysimd_free_aligned_sys(block);
+			block = next;
+		}
+		pysimd_alloc_global_pool.free_list[cls] = NULL;
+		pysimd_alloc_global_pool.n_cached[cls] = 0;
+	}
+}
+
+#endif // PYSIMD_ALLOC_H
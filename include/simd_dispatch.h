@@ -0,0 +1,2322 @@
+#ifndef PYSIMD_DISPATCH_H
+#define PYSIMD_DISPATCH_H
+
+#include "core_simd_info.h"
+#include "simd_vec.h"
+#include "simd_vec_arith.h"
+#include "simd_vec_bits.h"
+#include "simd_vec_filter.h"
+#include "simd_vec_cmp.h"
+#include "simd_vec_find.h"
+#include "simd_vec_sort.h"
+#include "simd_vec_scan.h"
+#include "simd_vec_convert.h"
+#include "simd_vec_dot.h"
+#include "simd_mat.h"
+#include "simd_vec_gather.h"
+#include "simd_vec_hist.h"
+#include "simd_vec_hash.h"
+#include "simd_threads.h"
+
+/* Runtime kernel selection. Every kernel is compiled for each tier the compiler
+ * supports, and the best one the running CPU supports is bound into pysimd_dispatch
+ * once, when the module is imported.
+ */
+
+enum pysimd_dispatch_tier {
+	PYSIMD_TIER_SCALAR,
+	PYSIMD_TIER_SSE2,
+	PYSIMD_TIER_AVX2,
+	PYSIMD_TIER_AVX512
+};
+
+typedef void (*pysimd_vec_binop_t)(struct pysimd_vec_t*, const struct pysimd_vec_t*, const struct pysimd_vec_t*);
+typedef void (*pysimd_vec_unop_t)(struct pysimd_vec_t*, const struct pysimd_vec_t*);
+typedef void (*pysimd_vec_ternop_t)(struct pysimd_vec_t*, const struct pysimd_vec_t*,
+	                                const struct pysimd_vec_t*, const struct pysimd_vec_t*);
+typedef int (*pysimd_vec_fill_t)(struct pysimd_vec_t*, size_t, unsigned char);
+typedef int (*pysimd_vec_fill_float_t)(struct pysimd_vec_t*, double, unsigned char);
+typedef int (*pysimd_vec_copy_t)(struct pysimd_vec_t*, const struct pysimd_vec_t*, size_t, size_t);
+typedef void (*pysimd_vec_clear_data_t)(struct pysimd_vec_t*);
+typedef union pysimd_lane_value (*pysimd_vec_reduce_t)(const struct pysimd_vec_t*);
+// Kernels that count over the bytes two vectors have in common
+typedef uint64_t (*pysimd_vec_count_t)(const struct pysimd_vec_t*, const struct pysimd_vec_t*);
+typedef void (*pysimd_vec_cmp_t)(struct pysimd_vec_t*, const struct pysimd_vec_t*, const struct pysimd_vec_t*, int);
+typedef void (*pysimd_vec_pack_mask_t)(unsigned char*, const struct pysimd_vec_t*);
+// Searches for a value given as a broadcast block, see simd_vec_find.h
+typedef size_t (*pysimd_vec_search_t)(const struct pysimd_vec_t*, const unsigned char*);
+typedef size_t (*pysimd_vec_find_any_t)(const struct pysimd_vec_t*, const unsigned char*, size_t);
+// Writes running totals of lanes, carrying a total in and out, see simd_vec_scan.h
+typedef int (*pysimd_vec_scan_t)(struct pysimd_vec_t*, const struct pysimd_vec_t*, const struct pysimd_vec_t*,
+	                              int, union pysimd_lane_value*);
+// Sorts signed keys in place, moving 64 bit values along when given, see simd_vec_sort.h
+typedef int (*pysimd_vec_sort_t)(void*, int64_t*, size_t);
+// Sums products of the lanes of two vectors into three totals, see simd_vec_dot.h
+typedef void (*pysimd_vec_dist_t)(const struct pysimd_vec_t*, const struct pysimd_vec_t*, union pysimd_lane_value*);
+// Converts every lane of a vector to another lane type, see simd_vec_convert.h
+typedef void (*pysimd_vec_convert_t)(unsigned char*, const struct pysimd_vec_t*);
+typedef size_t (*pysimd_vec_filter_t)(unsigned char*, const struct pysimd_vec_t*, const struct pysimd_filter_range*);
+
+struct pysimd_dispatch_t {
+	enum pysimd_dispatch_tier tier;
+	pysimd_vec_binop_t add_i8;
+	pysimd_vec_binop_t add_i16;
+	pysimd_vec_binop_t add_i32;
+	pysimd_vec_binop_t add_i64;
+	pysimd_vec_binop_t add_f32;
+	pysimd_vec_binop_t add_f64;
+	pysimd_vec_binop_t sub_i8;
+	pysimd_vec_binop_t sub_i16;
+	pysimd_vec_binop_t sub_i32;
+	pysimd_vec_binop_t sub_i64;
+	pysimd_vec_binop_t sub_f32;
+	pysimd_vec_binop_t sub_f64;
+	pysimd_vec_binop_t mul_i16;
+	pysimd_vec_binop_t mul_i32;
+	pysimd_vec_binop_t mul_i64;
+	pysimd_vec_binop_t mulhi_i16;
+	pysimd_vec_binop_t mulhi_u16;
+	pysimd_vec_binop_t mulhi_i32;
+	pysimd_vec_binop_t mulhi_u32;
+	pysimd_vec_binop_t mulhi_i64;
+	pysimd_vec_binop_t mulhi_u64;
+	pysimd_vec_binop_t mul_f32;
+	pysimd_vec_binop_t mul_f64;
+	pysimd_vec_binop_t div_f32;
+	pysimd_vec_binop_t div_f64;
+	pysimd_vec_binop_t adds_i8;
+	pysimd_vec_binop_t adds_u8;
+	pysimd_vec_binop_t adds_i16;
+	pysimd_vec_binop_t adds_u16;
+	pysimd_vec_binop_t subs_i8;
+	pysimd_vec_binop_t subs_u8;
+	pysimd_vec_binop_t subs_i16;
+	pysimd_vec_binop_t subs_u16;
+	pysimd_vec_binop_t avg_u8;
+	pysimd_vec_binop_t avg_u16;
+	pysimd_vec_binop_t absdiff_i8;
+	pysimd_vec_binop_t absdiff_u8;
+	pysimd_vec_binop_t absdiff_i16;
+	pysimd_vec_binop_t absdiff_u16;
+	pysimd_vec_count_t sad_u8;
+	pysimd_vec_unop_t sqrt_f32;
+	pysimd_vec_unop_t sqrt_f64;
+	pysimd_vec_ternop_t fma_f32;
+	pysimd_vec_ternop_t fma_f64;
+	pysimd_vec_binop_t and_;
+	pysimd_vec_binop_t or_;
+	pysimd_vec_binop_t xor_;
+	pysimd_vec_binop_t andnot;
+	pysimd_vec_unop_t not_;
+	pysimd_vec_count_t popcount;
+	pysimd_vec_count_t and_popcount;
+	// Comparisons write lane masks, see PYSIMD_CMP_SWAP and PYSIMD_CMP_NEGATE for the others
+	pysimd_vec_cmp_t cmpeq_i8;
+	pysimd_vec_cmp_t cmpeq_i16;
+	pysimd_vec_cmp_t cmpeq_i32;
+	pysimd_vec_cmp_t cmpeq_i64;
+	pysimd_vec_cmp_t cmpeq_f32;
+	pysimd_vec_cmp_t cmpeq_f64;
+	pysimd_vec_cmp_t cmpgt_i8;
+	pysimd_vec_cmp_t cmpgt_i16;
+	pysimd_vec_cmp_t cmpgt_i32;
+	pysimd_vec_cmp_t cmpgt_i64;
+	pysimd_vec_cmp_t cmpgt_u8;
+	pysimd_vec_cmp_t cmpgt_u16;
+	pysimd_vec_cmp_t cmpgt_u32;
+	pysimd_vec_cmp_t cmpgt_u64;
+	pysimd_vec_cmp_t cmpgt_f32;
+	pysimd_vec_cmp_t cmpgt_f64;
+	pysimd_vec_cmp_t cmpge_f32;
+	pysimd_vec_cmp_t cmpge_f64;
+	pysimd_vec_pack_mask_t pack_mask_i8;
+	pysimd_vec_pack_mask_t pack_mask_i16;
+	pysimd_vec_pack_mask_t pack_mask_i32;
+	pysimd_vec_pack_mask_t pack_mask_i64;
+	pysimd_vec_ternop_t select;
+	// Integer searches serve signed and unsigned lanes alike
+	pysimd_vec_search_t find_i8;
+	pysimd_vec_search_t find_i16;
+	pysimd_vec_search_t find_i32;
+	pysimd_vec_search_t find_i64;
+	pysimd_vec_search_t find_f32;
+	pysimd_vec_search_t find_f64;
+	pysimd_vec_search_t rfind_i8;
+	pysimd_vec_search_t rfind_i16;
+	pysimd_vec_search_t rfind_i32;
+	pysimd_vec_search_t rfind_i64;
+	pysimd_vec_search_t rfind_f32;
+	pysimd_vec_search_t rfind_f64;
+	pysimd_vec_search_t count_i8;
+	pysimd_vec_search_t count_i16;
+	pysimd_vec_search_t count_i32;
+	pysimd_vec_search_t count_i64;
+	pysimd_vec_search_t count_f32;
+	pysimd_vec_search_t count_f64;
+	pysimd_vec_find_any_t find_any_i8;
+	pysimd_vec_find_any_t find_any_i16;
+	pysimd_vec_find_any_t find_any_i32;
+	pysimd_vec_find_any_t find_any_i64;
+	pysimd_vec_find_any_t find_any_f32;
+	pysimd_vec_find_any_t find_any_f64;
+	pysimd_vec_scan_t cumsum_i32;
+	pysimd_vec_scan_t cumsum_i64;
+	pysimd_vec_scan_t cumsum_f32;
+	pysimd_vec_scan_t cumsum_f64;
+	// The 32 bit sort takes no values
+	pysimd_vec_sort_t sort_i32;
+	pysimd_vec_sort_t sort_i64;
+	// Integer filters serve signed and unsigned lanes alike
+	pysimd_vec_filter_t filter_i8;
+	pysimd_vec_filter_t filter_i16;
+	pysimd_vec_filter_t filter_i32;
+	pysimd_vec_filter_t filter_i64;
+	pysimd_vec_filter_t filter_f32;
+	pysimd_vec_filter_t filter_f64;
+	pysimd_vec_fill_t fill;
+	pysimd_vec_fill_float_t fill_float;
+	pysimd_vec_copy_t copy;
+	pysimd_vec_clear_data_t clear_data;
+	// Reductions, indexed by pysimd_lane_index
+	pysimd_vec_reduce_t sum[PYSIMD_N_LANE_TYPES];
+	pysimd_vec_reduce_t min[PYSIMD_N_LANE_TYPES];
+	pysimd_vec_reduce_t max[PYSIMD_N_LANE_TYPES];
+	// Distances, indexed by pysimd_dist_metric
+	pysimd_vec_dist_t dist_f32[PYSIMD_N_DIST_METRICS];
+	pysimd_vec_dist_t dist_i8[PYSIMD_N_DIST_METRICS];
+	// Lane gathers and scatters at u32 positions, see simd_vec_gather.h
+	pysimd_vec_index_max_t index_max;
+	pysimd_vec_gather_t gather_32;
+	pysimd_vec_gather_t gather_64;
+	pysimd_vec_scatter_t scatter_32;
+	pysimd_vec_scatter_t scatter_64;
+	// Histogram bin numbers of float lanes, see simd_vec_hist.h
+	pysimd_vec_hist_index_t hist_index_f32;
+	pysimd_vec_hist_index_t hist_index_f64;
+	// Lane hashes and CRC32C, see simd_vec_hash.h
+	pysimd_vec_hash_t hash_32;
+	pysimd_vec_hash_t hash_64;
+	pysimd_vec_crc32c_t crc32c;
+	// Matrix kernels, see simd_mat.h
+	pysimd_mat_gemv_t gemv_f32;
+	pysimd_mat_gemv_t gemv_f64;
+	pysimd_mat_axpy_t axpy_f32;
+	pysimd_mat_axpy_t axpy_f64;
+	struct pysimd_gemm_kernel gemm_f32;
+	struct pysimd_gemm_kernel gemm_f64;
+	// Conversions from one lane type to another, NULL where only simd_convert_lanes does it
+	pysimd_vec_convert_t convert[PYSIMD_N_LANE_TYPES][PYSIMD_N_LANE_TYPES];
+};
+
+static struct pysimd_dispatch_t pysimd_dispatch;
+
+static const char* pysimd_dispatch_tier_stringify(enum pysimd_dispatch_tier tier)
+{
+	switch (tier) {
+		case PYSIMD_TIER_SSE2: return "sse2";
+		case PYSIMD_TIER_AVX2: return "avx2";
+		case PYSIMD_TIER_AVX512: return "avx512";
+		case PYSIMD_TIER_SCALAR:
+		default:
+		    return "scalar";
+	}
+}
+
+/* Determines the highest tier that both the build and the running CPU support.
+ * The environment variable PYSIMD_MAX_TIER can lower it, by naming a tier,
+ * which is useful to test or benchmark the narrower kernels on a wide machine.
+ */
+static enum pysimd_dispatch_tier pysimd_dispatch_detect(const struct pysimd_sys_info* sinfo)
+{
+	enum pysimd_dispatch_tier tier = PYSIMD_TIER_SCALAR;
+	const char* max_tier = getenv("PYSIMD_MAX_TIER");
+#if defined(PYSIMD_ARCH_X86_64)
+	const struct pysimd_x86_features* feat = &(sinfo->features);
+#  if defined(PYSIMD_X86_SSE2)
+	if (feat->sse2)
+		tier = PYSIMD_TIER_SSE2;
+#  endif
+#  if defined(PYSIMD_X86_AVX2)
+	if (feat->avx && feat->avx2)
+		tier = PYSIMD_TIER_AVX2;
+#  endif
+#  if defined(PYSIMD_X86_AVX512)
+	if (feat->avx512f && feat->avx512bw)
+		tier = PYSIMD_TIER_AVX512;
+#  endif
+#else
+	(void)sinfo;
+#endif
+	if (max_tier != NULL) {
+		enum pysimd_dispatch_tier cap = tier;
+		if (strcmp(max_tier, "scalar") == 0)
+			cap = PYSIMD_TIER_SCALAR;
+		else if (strcmp(max_tier, "sse2") == 0)
+			cap = PYSIMD_TIER_SSE2;
+		else if (strcmp(max_tier, "avx2") == 0)
+			cap = PYSIMD_TIER_AVX2;
+		if (cap < tier)
+			tier = cap;
+	}
+	return tier;
+}
+
+/* Binds the kernels for the detected tier. Each tier starts from the bindings of
+ * the tier below it, and only replaces the kernels it has its own variant of.
+ */
+static void pysimd_dispatch_init(const struct pysimd_sys_info* sinfo)
+{
+	struct pysimd_dispatch_t* disp = &pysimd_dispatch;
+	const char* stream_min = getenv("PYSIMD_STREAM_MIN");
+	disp->tier = pysimd_dispatch_detect(sinfo);
+	pysimd_filter_tables_init();
+	simd_crc32c_init();
+	pysimd_vec_stream_min = sinfo->cache_size;
+	// Lowered to test or benchmark the streaming stores without vectors past the cache
+	if (stream_min != NULL && strtoull(stream_min, NULL, 10) > 0)
+		pysimd_vec_stream_min = (size_t)strtoull(stream_min, NULL, 10);
+
+	disp->add_i8 = simd_vec_add_i8_scalar;
+	disp->add_i16 = simd_vec_add_i16_scalar;
+	disp->add_i32 = simd_vec_add_i32_scalar;
+	disp->add_i64 = simd_vec_add_i64_scalar;
+	disp->add_f32 = simd_vec_add_f32_scalar;
+	disp->add_f64 = simd_vec_add_f64_scalar;
+	disp->sub_i8 = simd_vec_sub_i8_scalar;
+	disp->sub_i16 = simd_vec_sub_i16_scalar;
+	disp->sub_i32 = simd_vec_sub_i32_scalar;
+	disp->sub_i64 = simd_vec_sub_i64_scalar;
+	disp->sub_f32 = simd_vec_sub_f32_scalar;
+	disp->sub_f64 = simd_vec_sub_f64_scalar;
+	disp->mul_i16 = simd_vec_mul_i16_scalar;
+	disp->mul_i32 = simd_vec_mul_i32_scalar;
+	disp->mul_i64 = simd_vec_mul_i64_scalar;
+	disp->mulhi_i16 = simd_vec_mulhi_i16_scalar;
+	disp->mulhi_u16 = simd_vec_mulhi_u16_scalar;
+	disp->mulhi_i32 = simd_vec_mulhi_i32_scalar;
+	disp->mulhi_u32 = simd_vec_mulhi_u32_scalar;
+	disp->mulhi_i64 = simd_vec_mulhi_i64_scalar;
+	disp->mulhi_u64 = simd_vec_mulhi_u64_scalar;
+	disp->mul_f32 = simd_vec_mul_f32_scalar;
+	disp->mul_f64 = simd_vec_mul_f64_scalar;
+	disp->div_f32 = simd_vec_div_f32_scalar;
+	disp->div_f64 = simd_vec_div_f64_scalar;
+	disp->adds_i8 = simd_vec_adds_i8_scalar;
+	disp->adds_u8 = simd_vec_adds_u8_scalar;
+	disp->adds_i16 = simd_vec_adds_i16_scalar;
+	disp->adds_u16 = simd_vec_adds_u16_scalar;
+	disp->subs_i8 = simd_vec_subs_i8_scalar;
+	disp->subs_u8 = simd_vec_subs_u8_scalar;
+	disp->subs_i16 = simd_vec_subs_i16_scalar;
+	disp->subs_u16 = simd_vec_subs_u16_scalar;
+	disp->avg_u8 = simd_vec_avg_u8_scalar;
+	disp->avg_u16 = simd_vec_avg_u16_scalar;
+	disp->absdiff_i8 = simd_vec_absdiff_i8_scalar;
+	disp->absdiff_u8 = simd_vec_absdiff_u8_scalar;
+	disp->absdiff_i16 = simd_vec_absdiff_i16_scalar;
+	disp->absdiff_u16 = simd_vec_absdiff_u16_scalar;
+	disp->sad_u8 = simd_vec_sad_u8_scalar;
+	disp->sqrt_f32 = simd_vec_sqrt_f32_scalar;
+	disp->sqrt_f64 = simd_vec_sqrt_f64_scalar;
+	disp->fma_f32 = simd_vec_fma_f32_scalar;
+	disp->fma_f64 = simd_vec_fma_f64_scalar;
+	disp->and_ = simd_vec_and_scalar;
+	disp->or_ = simd_vec_or_scalar;
+	disp->xor_ = simd_vec_xor_scalar;
+	disp->andnot = simd_vec_andnot_scalar;
+	disp->not_ = simd_vec_not_scalar;
+	disp->popcount = simd_vec_popcount_scalar;
+	disp->and_popcount = simd_vec_and_popcount_scalar;
+	disp->cmpeq_i8 = simd_vec_cmpeq_i8_scalar;
+	disp->cmpeq_i16 = simd_vec_cmpeq_i16_scalar;
+	disp->cmpeq_i32 = simd_vec_cmpeq_i32_scalar;
+	disp->cmpeq_i64 = simd_vec_cmpeq_i64_scalar;
+	disp->cmpeq_f32 = simd_vec_cmpeq_f32_scalar;
+	disp->cmpeq_f64 = simd_vec_cmpeq_f64_scalar;
+	disp->cmpgt_i8 = simd_vec_cmpgt_i8_scalar;
+	disp->cmpgt_i16 = simd_vec_cmpgt_i16_scalar;
+	disp->cmpgt_i32 = simd_vec_cmpgt_i32_scalar;
+	disp->cmpgt_i64 = simd_vec_cmpgt_i64_scalar;
+	disp->cmpgt_u8 = simd_vec_cmpgt_u8_scalar;
+	disp->cmpgt_u16 = simd_vec_cmpgt_u16_scalar;
+	disp->cmpgt_u32 = simd_vec_cmpgt_u32_scalar;
+	disp->cmpgt_u64 = simd_vec_cmpgt_u64_scalar;
+	disp->cmpgt_f32 = simd_vec_cmpgt_f32_scalar;
+	disp->cmpgt_f64 = simd_vec_cmpgt_f64_scalar;
+	disp->cmpge_f32 = simd_vec_cmpge_f32_scalar;
+	disp->cmpge_f64 = simd_vec_cmpge_f64_scalar;
+	disp->pack_mask_i8 = simd_vec_pack_mask_i8_scalar;
+	disp->pack_mask_i16 = simd_vec_pack_mask_i16_scalar;
+	disp->pack_mask_i32 = simd_vec_pack_mask_i32_scalar;
+	disp->pack_mask_i64 = simd_vec_pack_mask_i64_scalar;
+	disp->select = simd_vec_select_scalar;
+	disp->find_i8 = simd_vec_find_i8_scalar;
+	disp->find_i16 = simd_vec_find_i16_scalar;
+	disp->find_i32 = simd_vec_find_i32_scalar;
+	disp->find_i64 = simd_vec_find_i64_scalar;
+	disp->find_f32 = simd_vec_find_f32_scalar;
+	disp->find_f64 = simd_vec_find_f64_scalar;
+	disp->rfind_i8 = simd_vec_rfind_i8_scalar;
+	disp->rfind_i16 = simd_vec_rfind_i16_scalar;
+	disp->rfind_i32 = simd_vec_rfind_i32_scalar;
+	disp->rfind_i64 = simd_vec_rfind_i64_scalar;
+	disp->rfind_f32 = simd_vec_rfind_f32_scalar;
+	disp->rfind_f64 = simd_vec_rfind_f64_scalar;
+	disp->count_i8 = simd_vec_count_i8_scalar;
+	disp->count_i16 = simd_vec_count_i16_scalar;
+	disp->count_i32 = simd_vec_count_i32_scalar;
+	disp->count_i64 = simd_vec_count_i64_scalar;
+	disp->count_f32 = simd_vec_count_f32_scalar;
+	disp->count_f64 = simd_vec_count_f64_scalar;
+	disp->find_any_i8 = simd_vec_find_any_i8_scalar;
+	disp->find_any_i16 = simd_vec_find_any_i16_scalar;
+	disp->find_any_i32 = simd_vec_find_any_i32_scalar;
+	disp->find_any_i64 = simd_vec_find_any_i64_scalar;
+	disp->find_any_f32 = simd_vec_find_any_f32_scalar;
+	disp->find_any_f64 = simd_vec_find_any_f64_scalar;
+	disp->index_max = simd_vec_index_max_scalar;
+	disp->gather_32 = simd_vec_gather_32_scalar;
+	disp->gather_64 = simd_vec_gather_64_scalar;
+	disp->scatter_32 = simd_vec_scatter_32_scalar;
+	disp->scatter_64 = simd_vec_scatter_64_scalar;
+	disp->hist_index_f32 = simd_vec_hist_index_f32_scalar;
+	disp->hist_index_f64 = simd_vec_hist_index_f64_scalar;
+	disp->hash_32 = simd_vec_hash_32_scalar;
+	disp->hash_64 = simd_vec_hash_64_scalar;
+	disp->crc32c = simd_vec_crc32c_scalar;
+	disp->dist_f32[PYSIMD_DIST_DOT] = simd_vec_dot_f32_scalar;
+	disp->dist_f32[PYSIMD_DIST_L2] = simd_vec_l2_f32_scalar;
+	disp->dist_f32[PYSIMD_DIST_COSINE] = simd_vec_cosine_f32_scalar;
+	disp->dist_i8[PYSIMD_DIST_DOT] = simd_vec_dot_i8_scalar;
+	disp->dist_i8[PYSIMD_DIST_L2] = simd_vec_l2_i8_scalar;
+	disp->dist_i8[PYSIMD_DIST_COSINE] = simd_vec_cosine_i8_scalar;
+	disp->gemv_f32 = simd_mat_gemv_f32_scalar;
+	disp->gemv_f64 = simd_mat_gemv_f64_scalar;
+	disp->axpy_f32 = simd_mat_axpy_f32_scalar;
+	disp->axpy_f64 = simd_mat_axpy_f64_scalar;
+	disp->gemm_f32.tile = simd_mat_tile_f32_scalar;
+	disp->gemm_f32.nr = 4;
+	disp->gemm_f64.tile = simd_mat_tile_f64_scalar;
+	disp->gemm_f64.nr = 4;
+	memset(disp->convert, 0, sizeof(disp->convert));
+	disp->cumsum_i32 = simd_vec_cumsum_i32_scalar;
+	disp->cumsum_i64 = simd_vec_cumsum_i64_scalar;
+	disp->cumsum_f32 = simd_vec_cumsum_f32_scalar;
+	disp->cumsum_f64 = simd_vec_cumsum_f64_scalar;
+	disp->sort_i32 = simd_sort_i32_scalar;
+	disp->sort_i64 = simd_sort_i64_scalar;
+	disp->filter_i8 = simd_vec_filter_i8_scalar;
+	disp->filter_i16 = simd_vec_filter_i16_scalar;
+	disp->filter_i32 = simd_vec_filter_i32_scalar;
+	disp->filter_i64 = simd_vec_filter_i64_scalar;
+	disp->filter_f32 = simd_vec_filter_f32_scalar;
+	disp->filter_f64 = simd_vec_filter_f64_scalar;
+	disp->fill = pysimd_vec_fill_scalar;
+	disp->fill_float = pysimd_vec_fill_float_scalar;
+	disp->copy = pysimd_vec_copy_scalar;
+	disp->clear_data = pysimd_vec_clear_data;
+	disp->sum[0] = simd_vec_sum_i8_scalar;
+	disp->sum[1] = simd_vec_sum_u8_scalar;
+	disp->sum[2] = simd_vec_sum_i16_scalar;
+	disp->sum[3] = simd_vec_sum_u16_scalar;
+	disp->sum[4] = simd_vec_sum_i32_scalar;
+	disp->sum[5] = simd_vec_sum_u32_scalar;
+	disp->sum[6] = simd_vec_sum_i64_scalar;
+	disp->sum[7] = simd_vec_sum_i64_scalar;
+	disp->sum[8] = simd_vec_sum_f32_scalar;
+	disp->sum[9] = simd_vec_sum_f64_scalar;
+	disp->min[0] = simd_vec_min_i8_scalar;
+	disp->min[1] = simd_vec_min_u8_scalar;
+	disp->min[2] = simd_vec_min_i16_scalar;
+	disp->min[3] = simd_vec_min_u16_scalar;
+	disp->min[4] = simd_vec_min_i32_scalar;
+	disp->min[5] = simd_vec_min_u32_scalar;
+	disp->min[6] = simd_vec_min_i64_scalar;
+	disp->min[7] = simd_vec_min_u64_scalar;
+	disp->min[8] = simd_vec_min_f32_scalar;
+	disp->min[9] = simd_vec_min_f64_scalar;
+	disp->max[0] = simd_vec_max_i8_scalar;
+	disp->max[1] = simd_vec_max_u8_scalar;
+	disp->max[2] = simd_vec_max_i16_scalar;
+	disp->max[3] = simd_vec_max_u16_scalar;
+	disp->max[4] = simd_vec_max_i32_scalar;
+	disp->max[5] = simd_vec_max_u32_scalar;
+	disp->max[6] = simd_vec_max_i64_scalar;
+	disp->max[7] = simd_vec_max_u64_scalar;
+	disp->max[8] = simd_vec_max_f32_scalar;
+	disp->max[9] = simd_vec_max_f64_scalar;
+
+#if defined(PYSIMD_X86_SSE2)
+	if (disp->tier >= PYSIMD_TIER_SSE2) {
+		disp->add_i8 = simd_vec_add_i8_sse2;
+		disp->add_i16 = simd_vec_add_i16_sse2;
+		disp->add_i32 = simd_vec_add_i32_sse2;
+		disp->add_i64 = simd_vec_add_i64_sse2;
+		disp->add_f32 = simd_vec_add_f32_sse2;
+		disp->add_f64 = simd_vec_add_f64_sse2;
+		disp->sub_i8 = simd_vec_sub_i8_sse2;
+		disp->sub_i16 = simd_vec_sub_i16_sse2;
+		disp->sub_i32 = simd_vec_sub_i32_sse2;
+		disp->sub_i64 = simd_vec_sub_i64_sse2;
+		disp->sub_f32 = simd_vec_sub_f32_sse2;
+		disp->sub_f64 = simd_vec_sub_f64_sse2;
+		disp->mul_i16 = simd_vec_mul_i16_sse2;
+		disp->mul_i32 = simd_vec_mul_i32_sse2;
+		disp->mul_i64 = simd_vec_mul_i64_sse2;
+		disp->mulhi_i16 = simd_vec_mulhi_i16_sse2;
+		disp->mulhi_u16 = simd_vec_mulhi_u16_sse2;
+		disp->mulhi_i32 = simd_vec_mulhi_i32_sse2;
+		disp->mulhi_u32 = simd_vec_mulhi_u32_sse2;
+		disp->mul_f32 = simd_vec_mul_f32_sse2;
+		disp->mul_f64 = simd_vec_mul_f64_sse2;
+		disp->div_f32 = simd_vec_div_f32_sse2;
+		disp->div_f64 = simd_vec_div_f64_sse2;
+		disp->adds_i8 = simd_vec_adds_i8_sse2;
+		disp->adds_u8 = simd_vec_adds_u8_sse2;
+		disp->adds_i16 = simd_vec_adds_i16_sse2;
+		disp->adds_u16 = simd_vec_adds_u16_sse2;
+		disp->subs_i8 = simd_vec_subs_i8_sse2;
+		disp->subs_u8 = simd_vec_subs_u8_sse2;
+		disp->subs_i16 = simd_vec_subs_i16_sse2;
+		disp->subs_u16 = simd_vec_subs_u16_sse2;
+		disp->avg_u8 = simd_vec_avg_u8_sse2;
+		disp->avg_u16 = simd_vec_avg_u16_sse2;
+		disp->absdiff_i8 = simd_vec_absdiff_i8_sse2;
+		disp->absdiff_u8 = simd_vec_absdiff_u8_sse2;
+		disp->absdiff_i16 = simd_vec_absdiff_i16_sse2;
+		disp->absdiff_u16 = simd_vec_absdiff_u16_sse2;
+		disp->sad_u8 = simd_vec_sad_u8_sse2;
+		disp->sqrt_f32 = simd_vec_sqrt_f32_sse2;
+		disp->sqrt_f64 = simd_vec_sqrt_f64_sse2;
+		disp->fma_f32 = simd_vec_fma_f32_sse2;
+		disp->fma_f64 = simd_vec_fma_f64_sse2;
+		disp->and_ = simd_vec_and_sse2;
+		disp->or_ = simd_vec_or_sse2;
+		disp->xor_ = simd_vec_xor_sse2;
+		disp->andnot = simd_vec_andnot_sse2;
+		disp->not_ = simd_vec_not_sse2;
+		disp->popcount = simd_vec_popcount_sse2;
+		disp->and_popcount = simd_vec_and_popcount_sse2;
+		disp->cmpeq_i8 = simd_vec_cmpeq_i8_sse2;
+		disp->cmpeq_i16 = simd_vec_cmpeq_i16_sse2;
+		disp->cmpeq_i32 = simd_vec_cmpeq_i32_sse2;
+		disp->cmpeq_i64 = simd_vec_cmpeq_i64_sse2;
+		disp->cmpeq_f32 = simd_vec_cmpeq_f32_sse2;
+		disp->cmpeq_f64 = simd_vec_cmpeq_f64_sse2;
+		disp->cmpgt_i8 = simd_vec_cmpgt_i8_sse2;
+		disp->cmpgt_i16 = simd_vec_cmpgt_i16_sse2;
+		disp->cmpgt_i32 = simd_vec_cmpgt_i32_sse2;
+		disp->cmpgt_i64 = simd_vec_cmpgt_i64_sse2;
+		disp->cmpgt_u8 = simd_vec_cmpgt_u8_sse2;
+		disp->cmpgt_u16 = simd_vec_cmpgt_u16_sse2;
+		disp->cmpgt_u32 = simd_vec_cmpgt_u32_sse2;
+		disp->cmpgt_u64 = simd_vec_cmpgt_u64_sse2;
+		disp->cmpgt_f32 = simd_vec_cmpgt_f32_sse2;
+		disp->cmpgt_f64 = simd_vec_cmpgt_f64_sse2;
+		disp->cmpge_f32 = simd_vec_cmpge_f32_sse2;
+		disp->cmpge_f64 = simd_vec_cmpge_f64_sse2;
+		disp->pack_mask_i8 = simd_vec_pack_mask_i8_sse2;
+		disp->pack_mask_i16 = simd_vec_pack_mask_i16_sse2;
+		disp->pack_mask_i32 = simd_vec_pack_mask_i32_sse2;
+		disp->pack_mask_i64 = simd_vec_pack_mask_i64_sse2;
+		disp->select = simd_vec_select_sse2;
+		disp->find_i8 = simd_vec_find_i8_sse2;
+		disp->find_i16 = simd_vec_find_i16_sse2;
+		disp->find_i32 = simd_vec_find_i32_sse2;
+		disp->find_i64 = simd_vec_find_i64_sse2;
+		disp->find_f32 = simd_vec_find_f32_sse2;
+		disp->find_f64 = simd_vec_find_f64_sse2;
+		disp->rfind_i8 = simd_vec_rfind_i8_sse2;
+		disp->rfind_i16 = simd_vec_rfind_i16_sse2;
+		disp->rfind_i32 = simd_vec_rfind_i32_sse2;
+		disp->rfind_i64 = simd_vec_rfind_i64_sse2;
+		disp->rfind_f32 = simd_vec_rfind_f32_sse2;
+		disp->rfind_f64 = simd_vec_rfind_f64_sse2;
+		disp->count_i8 = simd_vec_count_i8_sse2;
+		disp->count_i16 = simd_vec_count_i16_sse2;
+		disp->count_i32 = simd_vec_count_i32_sse2;
+		disp->count_i64 = simd_vec_count_i64_sse2;
+		disp->count_f32 = simd_vec_count_f32_sse2;
+		disp->count_f64 = simd_vec_count_f64_sse2;
+		disp->find_any_i8 = simd_vec_find_any_i8_sse2;
+		disp->find_any_i16 = simd_vec_find_any_i16_sse2;
+		disp->find_any_i32 = simd_vec_find_any_i32_sse2;
+		disp->find_any_i64 = simd_vec_find_any_i64_sse2;
+		disp->find_any_f32 = simd_vec_find_any_f32_sse2;
+		disp->find_any_f64 = simd_vec_find_any_f64_sse2;
+		disp->index_max = simd_vec_index_max_sse2;
+		disp->hist_index_f32 = simd_vec_hist_index_f32_sse2;
+		disp->hist_index_f64 = simd_vec_hist_index_f64_sse2;
+		disp->hash_32 = simd_vec_hash_32_sse2;
+		disp->hash_64 = simd_vec_hash_64_sse2;
+		disp->dist_f32[PYSIMD_DIST_DOT] = simd_vec_dot_f32_sse2;
+		disp->dist_f32[PYSIMD_DIST_L2] = simd_vec_l2_f32_sse2;
+		disp->dist_f32[PYSIMD_DIST_COSINE] = simd_vec_cosine_f32_sse2;
+		disp->dist_i8[PYSIMD_DIST_DOT] = simd_vec_dot_i8_sse2;
+		disp->dist_i8[PYSIMD_DIST_L2] = simd_vec_l2_i8_sse2;
+		disp->dist_i8[PYSIMD_DIST_COSINE] = simd_vec_cosine_i8_sse2;
+		disp->gemv_f32 = simd_mat_gemv_f32_sse2;
+		disp->gemv_f64 = simd_mat_gemv_f64_sse2;
+		disp->axpy_f32 = simd_mat_axpy_f32_sse2;
+		disp->axpy_f64 = simd_mat_axpy_f64_sse2;
+		disp->gemm_f32.tile = simd_mat_tile_f32_sse2;
+		disp->gemm_f32.nr = 8;
+		disp->gemm_f64.tile = simd_mat_tile_f64_sse2;
+		disp->gemm_f64.nr = 4;
+		disp->convert[PYSIMD_LANE_I8][PYSIMD_LANE_I16] = simd_convert_i8_i16_sse2;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_I16] = simd_convert_u8_i16_sse2;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_U16] = simd_convert_u8_u16_sse2;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_I32] = simd_convert_i16_i32_sse2;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_I32] = simd_convert_u16_i32_sse2;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_U32] = simd_convert_u16_u32_sse2;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_I64] = simd_convert_i32_i64_sse2;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_I64] = simd_convert_u32_i64_sse2;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_U64] = simd_convert_u32_u64_sse2;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_I8] = simd_convert_i16_i8_sse2;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_U8] = simd_convert_i16_u8_sse2;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_I16] = simd_convert_i32_i16_sse2;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_F32] = simd_convert_u8_f32_sse2;
+		disp->convert[PYSIMD_LANE_I8][PYSIMD_LANE_F32] = simd_convert_i8_f32_sse2;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_F32] = simd_convert_u16_f32_sse2;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_F32] = simd_convert_i16_f32_sse2;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_F32] = simd_convert_i32_f32_sse2;
+		disp->convert[PYSIMD_LANE_F32][PYSIMD_LANE_I32] = simd_convert_f32_i32_sse2;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_F64] = simd_convert_i32_f64_sse2;
+		disp->convert[PYSIMD_LANE_F32][PYSIMD_LANE_F64] = simd_convert_f32_f64_sse2;
+		disp->convert[PYSIMD_LANE_F64][PYSIMD_LANE_F32] = simd_convert_f64_f32_sse2;
+		disp->cumsum_i32 = simd_vec_cumsum_i32_sse2;
+		disp->cumsum_i64 = simd_vec_cumsum_i64_sse2;
+		disp->cumsum_f32 = simd_vec_cumsum_f32_sse2;
+		disp->cumsum_f64 = simd_vec_cumsum_f64_sse2;
+		disp->filter_i8 = simd_vec_filter_i8_sse2;
+		disp->filter_i16 = simd_vec_filter_i16_sse2;
+		disp->filter_i32 = simd_vec_filter_i32_sse2;
+		disp->filter_i64 = simd_vec_filter_i64_sse2;
+		disp->filter_f32 = simd_vec_filter_f32_sse2;
+		disp->filter_f64 = simd_vec_filter_f64_sse2;
+#  if defined(PYSIMD_X86_POPCNT)
+		if (sinfo->features.popcnt) {
+			disp->popcount = simd_vec_popcount_popcnt;
+			disp->and_popcount = simd_vec_and_popcount_popcnt;
+		}
+#  endif
+#  if defined(PYSIMD_X86_SSE42)
+		if (sinfo->features.sse42) {
+			disp->crc32c = simd_vec_crc32c_sse42;
+		}
+#  endif
+		disp->fill = pysimd_vec_fill_sse2;
+		disp->fill_float = pysimd_vec_fill_float_sse2;
+		disp->copy = pysimd_vec_copy_sse2;
+		disp->clear_data = pysimd_vec_clear_data_sse2;
+		disp->sum[0] = simd_vec_sum_i8_sse2;
+		disp->sum[1] = simd_vec_sum_u8_sse2;
+		disp->sum[2] = simd_vec_sum_i16_sse2;
+		disp->sum[3] = simd_vec_sum_u16_sse2;
+		disp->sum[4] = simd_vec_sum_i32_sse2;
+		disp->sum[5] = simd_vec_sum_u32_sse2;
+		disp->sum[6] = simd_vec_sum_i64_sse2;
+		disp->sum[7] = simd_vec_sum_i64_sse2;
+		disp->sum[8] = simd_vec_sum_f32_sse2;
+		disp->sum[9] = simd_vec_sum_f64_sse2;
+		disp->min[1] = simd_vec_min_u8_sse2;
+		disp->min[2] = simd_vec_min_i16_sse2;
+		disp->min[8] = simd_vec_min_f32_sse2;
+		disp->min[9] = simd_vec_min_f64_sse2;
+		disp->max[1] = simd_vec_max_u8_sse2;
+		disp->max[2] = simd_vec_max_i16_sse2;
+		disp->max[8] = simd_vec_max_f32_sse2;
+		disp->max[9] = simd_vec_max_f64_sse2;
+	}
+#endif // PYSIMD_X86_SSE2
+
+#if defined(PYSIMD_X86_AVX2)
+	if (disp->tier >= PYSIMD_TIER_AVX2) {
+		disp->add_i8 = simd_vec_add_i8_avx2;
+		disp->add_i16 = simd_vec_add_i16_avx2;
+		disp->add_i32 = simd_vec_add_i32_avx2;
+		disp->add_i64 = simd_vec_add_i64_avx2;
+		disp->add_f32 = simd_vec_add_f32_avx2;
+		disp->add_f64 = simd_vec_add_f64_avx2;
+		disp->sub_i8 = simd_vec_sub_i8_avx2;
+		disp->sub_i16 = simd_vec_sub_i16_avx2;
+		disp->sub_i32 = simd_vec_sub_i32_avx2;
+		disp->sub_i64 = simd_vec_sub_i64_avx2;
+		disp->sub_f32 = simd_vec_sub_f32_avx2;
+		disp->sub_f64 = simd_vec_sub_f64_avx2;
+		disp->mul_i16 = simd_vec_mul_i16_avx2;
+		disp->mul_i32 = simd_vec_mul_i32_avx2;
+		disp->mul_i64 = simd_vec_mul_i64_avx2;
+		disp->mulhi_i16 = simd_vec_mulhi_i16_avx2;
+		disp->mulhi_u16 = simd_vec_mulhi_u16_avx2;
+		disp->mulhi_i32 = simd_vec_mulhi_i32_avx2;
+		disp->mulhi_u32 = simd_vec_mulhi_u32_avx2;
+		disp->mul_f32 = simd_vec_mul_f32_avx2;
+		disp->mul_f64 = simd_vec_mul_f64_avx2;
+		disp->div_f32 = simd_vec_div_f32_avx2;
+		disp->div_f64 = simd_vec_div_f64_avx2;
+		disp->adds_i8 = simd_vec_adds_i8_avx2;
+		disp->adds_u8 = simd_vec_adds_u8_avx2;
+		disp->adds_i16 = simd_vec_adds_i16_avx2;
+		disp->adds_u16 = simd_vec_adds_u16_avx2;
+		disp->subs_i8 = simd_vec_subs_i8_avx2;
+		disp->subs_u8 = simd_vec_subs_u8_avx2;
+		disp->subs_i16 = simd_vec_subs_i16_avx2;
+		disp->subs_u16 = simd_vec_subs_u16_avx2;
+		disp->avg_u8 = simd_vec_avg_u8_avx2;
+		disp->avg_u16 = simd_vec_avg_u16_avx2;
+		disp->absdiff_i8 = simd_vec_absdiff_i8_avx2;
+		disp->absdiff_u8 = simd_vec_absdiff_u8_avx2;
+		disp->absdiff_i16 = simd_vec_absdiff_i16_avx2;
+		disp->absdiff_u16 = simd_vec_absdiff_u16_avx2;
+		disp->sad_u8 = simd_vec_sad_u8_avx2;
+		disp->sqrt_f32 = simd_vec_sqrt_f32_avx2;
+		disp->sqrt_f64 = simd_vec_sqrt_f64_avx2;
+		disp->fma_f32 = simd_vec_fma_f32_avx2;
+		disp->fma_f64 = simd_vec_fma_f64_avx2;
+#  if defined(PYSIMD_X86_FMA)
+		if (sinfo->features.fma) {
+			disp->fma_f32 = simd_vec_fma_f32_fma;
+			disp->fma_f64 = simd_vec_fma_f64_fma;
+		}
+#  endif
+		disp->and_ = simd_vec_and_avx2;
+		disp->or_ = simd_vec_or_avx2;
+		disp->xor_ = simd_vec_xor_avx2;
+		disp->andnot = simd_vec_andnot_avx2;
+		disp->not_ = simd_vec_not_avx2;
+		disp->popcount = simd_vec_popcount_avx2;
+		disp->and_popcount = simd_vec_and_popcount_avx2;
+		disp->cmpeq_i8 = simd_vec_cmpeq_i8_avx2;
+		disp->cmpeq_i16 = simd_vec_cmpeq_i16_avx2;
+		disp->cmpeq_i32 = simd_vec_cmpeq_i32_avx2;
+		disp->cmpeq_i64 = simd_vec_cmpeq_i64_avx2;
+		disp->cmpeq_f32 = simd_vec_cmpeq_f32_avx2;
+		disp->cmpeq_f64 = simd_vec_cmpeq_f64_avx2;
+		disp->cmpgt_i8 = simd_vec_cmpgt_i8_avx2;
+		disp->cmpgt_i16 = simd_vec_cmpgt_i16_avx2;
+		disp->cmpgt_i32 = simd_vec_cmpgt_i32_avx2;
+		disp->cmpgt_i64 = simd_vec_cmpgt_i64_avx2;
+		disp->cmpgt_u8 = simd_vec_cmpgt_u8_avx2;
+		disp->cmpgt_u16 = simd_vec_cmpgt_u16_avx2;
+		disp->cmpgt_u32 = simd_vec_cmpgt_u32_avx2;
+		disp->cmpgt_u64 = simd_vec_cmpgt_u64_avx2;
+		disp->cmpgt_f32 = simd_vec_cmpgt_f32_avx2;
+		disp->cmpgt_f64 = simd_vec_cmpgt_f64_avx2;
+		disp->cmpge_f32 = simd_vec_cmpge_f32_avx2;
+		disp->cmpge_f64 = simd_vec_cmpge_f64_avx2;
+		disp->select = simd_vec_select_avx2;
+		disp->find_i8 = simd_vec_find_i8_avx2;
+		disp->find_i16 = simd_vec_find_i16_avx2;
+		disp->find_i32 = simd_vec_find_i32_avx2;
+		disp->find_i64 = simd_vec_find_i64_avx2;
+		disp->find_f32 = simd_vec_find_f32_avx2;
+		disp->find_f64 = simd_vec_find_f64_avx2;
+		disp->rfind_i8 = simd_vec_rfind_i8_avx2;
+		disp->rfind_i16 = simd_vec_rfind_i16_avx2;
+		disp->rfind_i32 = simd_vec_rfind_i32_avx2;
+		disp->rfind_i64 = simd_vec_rfind_i64_avx2;
+		disp->rfind_f32 = simd_vec_rfind_f32_avx2;
+		disp->rfind_f64 = simd_vec_rfind_f64_avx2;
+		disp->count_i8 = simd_vec_count_i8_avx2;
+		disp->count_i16 = simd_vec_count_i16_avx2;
+		disp->count_i32 = simd_vec_count_i32_avx2;
+		disp->count_i64 = simd_vec_count_i64_avx2;
+		disp->count_f32 = simd_vec_count_f32_avx2;
+		disp->count_f64 = simd_vec_count_f64_avx2;
+		disp->find_any_i8 = simd_vec_find_any_i8_avx2;
+		disp->find_any_i16 = simd_vec_find_any_i16_avx2;
+		disp->find_any_i32 = simd_vec_find_any_i32_avx2;
+		disp->find_any_i64 = simd_vec_find_any_i64_avx2;
+		disp->find_any_f32 = simd_vec_find_any_f32_avx2;
+		disp->find_any_f64 = simd_vec_find_any_f64_avx2;
+		disp->index_max = simd_vec_index_max_avx2;
+		disp->hist_index_f32 = simd_vec_hist_index_f32_avx2;
+		disp->hist_index_f64 = simd_vec_hist_index_f64_avx2;
+		disp->hash_32 = simd_vec_hash_32_avx2;
+		disp->hash_64 = simd_vec_hash_64_avx2;
+		disp->gather_32 = simd_vec_gather_32_avx2;
+		disp->gather_64 = simd_vec_gather_64_avx2;
+		disp->dist_f32[PYSIMD_DIST_DOT] = simd_vec_dot_f32_avx2;
+		disp->dist_f32[PYSIMD_DIST_L2] = simd_vec_l2_f32_avx2;
+		disp->dist_f32[PYSIMD_DIST_COSINE] = simd_vec_cosine_f32_avx2;
+		disp->dist_i8[PYSIMD_DIST_DOT] = simd_vec_dot_i8_avx2;
+		disp->dist_i8[PYSIMD_DIST_L2] = simd_vec_l2_i8_avx2;
+		disp->dist_i8[PYSIMD_DIST_COSINE] = simd_vec_cosine_i8_avx2;
+		disp->gemv_f32 = simd_mat_gemv_f32_avx2;
+		disp->gemv_f64 = simd_mat_gemv_f64_avx2;
+		disp->axpy_f32 = simd_mat_axpy_f32_avx2;
+		disp->axpy_f64 = simd_mat_axpy_f64_avx2;
+		disp->gemm_f32.tile = simd_mat_tile_f32_avx2;
+		disp->gemm_f32.nr = 16;
+		disp->gemm_f64.tile = simd_mat_tile_f64_avx2;
+		disp->gemm_f64.nr = 8;
+#  if defined(PYSIMD_X86_FMA)
+		if (sinfo->features.fma) {
+			disp->dist_f32[PYSIMD_DIST_DOT] = simd_vec_dot_f32_fma;
+			disp->dist_f32[PYSIMD_DIST_L2] = simd_vec_l2_f32_fma;
+			disp->dist_f32[PYSIMD_DIST_COSINE] = simd_vec_cosine_f32_fma;
+			disp->gemv_f32 = simd_mat_gemv_f32_fma;
+			disp->gemv_f64 = simd_mat_gemv_f64_fma;
+			disp->axpy_f32 = simd_mat_axpy_f32_fma;
+			disp->axpy_f64 = simd_mat_axpy_f64_fma;
+			disp->gemm_f32.tile = simd_mat_tile_f32_fma;
+			disp->gemm_f64.tile = simd_mat_tile_f64_fma;
+		}
+#  endif
+		disp->convert[PYSIMD_LANE_I8][PYSIMD_LANE_I16] = simd_convert_i8_i16_avx2;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_I16] = simd_convert_u8_i16_avx2;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_U16] = simd_convert_u8_u16_avx2;
+		disp->convert[PYSIMD_LANE_I8][PYSIMD_LANE_I32] = simd_convert_i8_i32_avx2;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_I32] = simd_convert_u8_i32_avx2;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_U32] = simd_convert_u8_u32_avx2;
+		disp->convert[PYSIMD_LANE_I8][PYSIMD_LANE_I64] = simd_convert_i8_i64_avx2;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_I64] = simd_convert_u8_i64_avx2;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_U64] = simd_convert_u8_u64_avx2;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_I32] = simd_convert_i16_i32_avx2;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_I32] = simd_convert_u16_i32_avx2;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_U32] = simd_convert_u16_u32_avx2;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_I64] = simd_convert_i16_i64_avx2;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_I64] = simd_convert_u16_i64_avx2;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_U64] = simd_convert_u16_u64_avx2;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_I64] = simd_convert_i32_i64_avx2;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_I64] = simd_convert_u32_i64_avx2;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_U64] = simd_convert_u32_u64_avx2;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_I8] = simd_convert_i16_i8_avx2;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_U8] = simd_convert_i16_u8_avx2;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_I16] = simd_convert_i32_i16_avx2;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_U16] = simd_convert_i32_u16_avx2;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_F32] = simd_convert_u8_f32_avx2;
+		disp->convert[PYSIMD_LANE_I8][PYSIMD_LANE_F32] = simd_convert_i8_f32_avx2;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_F32] = simd_convert_u16_f32_avx2;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_F32] = simd_convert_i16_f32_avx2;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_F32] = simd_convert_i32_f32_avx2;
+		disp->convert[PYSIMD_LANE_F32][PYSIMD_LANE_I32] = simd_convert_f32_i32_avx2;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_F64] = simd_convert_i32_f64_avx2;
+		disp->convert[PYSIMD_LANE_F32][PYSIMD_LANE_F64] = simd_convert_f32_f64_avx2;
+		disp->convert[PYSIMD_LANE_F64][PYSIMD_LANE_F32] = simd_convert_f64_f32_avx2;
+		disp->convert[PYSIMD_LANE_I64][PYSIMD_LANE_F64] = simd_convert_i64_f64_avx2;
+		disp->convert[PYSIMD_LANE_F64][PYSIMD_LANE_I64] = simd_convert_f64_i64_avx2;
+		disp->cumsum_i32 = simd_vec_cumsum_i32_avx2;
+		disp->cumsum_i64 = simd_vec_cumsum_i64_avx2;
+		disp->cumsum_f32 = simd_vec_cumsum_f32_avx2;
+		disp->cumsum_f64 = simd_vec_cumsum_f64_avx2;
+		disp->sort_i32 = simd_sort_i32_avx2;
+		disp->sort_i64 = simd_sort_i64_avx2;
+		disp->filter_i8 = simd_vec_filter_i8_avx2;
+		disp->filter_i16 = simd_vec_filter_i16_avx2;
+		disp->filter_i32 = simd_vec_filter_i32_avx2;
+		disp->filter_i64 = simd_vec_filter_i64_avx2;
+		disp->filter_f32 = simd_vec_filter_f32_avx2;
+		disp->filter_f64 = simd_vec_filter_f64_avx2;
+		disp->fill = pysimd_vec_fill_avx2;
+		disp->fill_float = pysimd_vec_fill_float_avx2;
+		disp->copy = pysimd_vec_copy_avx2;
+		disp->clear_data = pysimd_vec_clear_data_avx2;
+		disp->sum[0] = simd_vec_sum_i8_avx2;
+		disp->sum[1] = simd_vec_sum_u8_avx2;
+		disp->sum[2] = simd_vec_sum_i16_avx2;
+		disp->sum[3] = simd_vec_sum_u16_avx2;
+		disp->sum[4] = simd_vec_sum_i32_avx2;
+		disp->sum[5] = simd_vec_sum_u32_avx2;
+		disp->sum[6] = simd_vec_sum_i64_avx2;
+		disp->sum[7] = simd_vec_sum_i64_avx2;
+		disp->sum[8] = simd_vec_sum_f32_avx2;
+		disp->sum[9] = simd_vec_sum_f64_avx2;
+		disp->min[0] = simd_vec_min_i8_avx2;
+		disp->min[1] = simd_vec_min_u8_avx2;
+		disp->min[2] = simd_vec_min_i16_avx2;
+		disp->min[3] = simd_vec_min_u16_avx2;
+		disp->min[4] = simd_vec_min_i32_avx2;
+		disp->min[5] = simd_vec_min_u32_avx2;
+		disp->min[6] = simd_vec_min_i64_avx2;
+		disp->min[7] = simd_vec_min_u64_avx2;
+		disp->min[8] = simd_vec_min_f32_avx2;
+		disp->min[9] = simd_vec_min_f64_avx2;
+		disp->max[0] = simd_vec_max_i8_avx2;
+		disp->max[1] = simd_vec_max_u8_avx2;
+		disp->max[2] = simd_vec_max_i16_avx2;
+		disp->max[3] = simd_vec_max_u16_avx2;
+		disp->max[4] = simd_vec_max_i32_avx2;
+		disp->max[5] = simd_vec_max_u32_avx2;
+		disp->max[6] = simd_vec_max_i64_avx2;
+		disp->max[7] = simd_vec_max_u64_avx2;
+		disp->max[8] = simd_vec_max_f32_avx2;
+		disp->max[9] = simd_vec_max_f64_avx2;
+	}
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+	if (disp->tier >= PYSIMD_TIER_AVX512) {
+		disp->add_i8 = simd_vec_add_i8_avx512;
+		disp->add_i16 = simd_vec_add_i16_avx512;
+		disp->add_i32 = simd_vec_add_i32_avx512;
+		disp->add_i64 = simd_vec_add_i64_avx512;
+		disp->add_f32 = simd_vec_add_f32_avx512;
+		disp->add_f64 = simd_vec_add_f64_avx512;
+		disp->sub_i8 = simd_vec_sub_i8_avx512;
+		disp->sub_i16 = simd_vec_sub_i16_avx512;
+		disp->sub_i32 = simd_vec_sub_i32_avx512;
+		disp->sub_i64 = simd_vec_sub_i64_avx512;
+		disp->sub_f32 = simd_vec_sub_f32_avx512;
+		disp->sub_f64 = simd_vec_sub_f64_avx512;
+		disp->mul_i16 = simd_vec_mul_i16_avx512;
+		disp->mul_i32 = simd_vec_mul_i32_avx512;
+		disp->mul_i64 = simd_vec_mul_i64_avx512;
+		disp->mulhi_i16 = simd_vec_mulhi_i16_avx512;
+		disp->mulhi_u16 = simd_vec_mulhi_u16_avx512;
+		disp->mulhi_i32 = simd_vec_mulhi_i32_avx512;
+		disp->mulhi_u32 = simd_vec_mulhi_u32_avx512;
+		disp->mul_f32 = simd_vec_mul_f32_avx512;
+		disp->mul_f64 = simd_vec_mul_f64_avx512;
+		disp->div_f32 = simd_vec_div_f32_avx512;
+		disp->div_f64 = simd_vec_div_f64_avx512;
+		disp->adds_i8 = simd_vec_adds_i8_avx512;
+		disp->adds_u8 = simd_vec_adds_u8_avx512;
+		disp->adds_i16 = simd_vec_adds_i16_avx512;
+		disp->adds_u16 = simd_vec_adds_u16_avx512;
+		disp->subs_i8 = simd_vec_subs_i8_avx512;
+		disp->subs_u8 = simd_vec_subs_u8_avx512;
+		disp->subs_i16 = simd_vec_subs_i16_avx512;
+		disp->subs_u16 = simd_vec_subs_u16_avx512;
+		disp->avg_u8 = simd_vec_avg_u8_avx512;
+		disp->avg_u16 = simd_vec_avg_u16_avx512;
+		disp->absdiff_i8 = simd_vec_absdiff_i8_avx512;
+		disp->absdiff_u8 = simd_vec_absdiff_u8_avx512;
+		disp->absdiff_i16 = simd_vec_absdiff_i16_avx512;
+		disp->absdiff_u16 = simd_vec_absdiff_u16_avx512;
+		disp->sad_u8 = simd_vec_sad_u8_avx512;
+		disp->sqrt_f32 = simd_vec_sqrt_f32_avx512;
+		disp->sqrt_f64 = simd_vec_sqrt_f64_avx512;
+#  if defined(PYSIMD_X86_FMA)
+		disp->fma_f32 = simd_vec_fma_f32_avx512;
+		disp->fma_f64 = simd_vec_fma_f64_avx512;
+#  endif
+		disp->and_ = simd_vec_and_avx512;
+		disp->or_ = simd_vec_or_avx512;
+		disp->xor_ = simd_vec_xor_avx512;
+		disp->andnot = simd_vec_andnot_avx512;
+		disp->not_ = simd_vec_not_avx512;
+		disp->popcount = simd_vec_popcount_avx512;
+		disp->and_popcount = simd_vec_and_popcount_avx512;
+		disp->cmpeq_i8 = simd_vec_cmpeq_i8_avx512;
+		disp->cmpeq_i16 = simd_vec_cmpeq_i16_avx512;
+		disp->cmpeq_i32 = simd_vec_cmpeq_i32_avx512;
+		disp->cmpeq_i64 = simd_vec_cmpeq_i64_avx512;
+		disp->cmpeq_f32 = simd_vec_cmpeq_f32_avx512;
+		disp->cmpeq_f64 = simd_vec_cmpeq_f64_avx512;
+		disp->cmpgt_i8 = simd_vec_cmpgt_i8_avx512;
+		disp->cmpgt_i16 = simd_vec_cmpgt_i16_avx512;
+		disp->cmpgt_i32 = simd_vec_cmpgt_i32_avx512;
+		disp->cmpgt_i64 = simd_vec_cmpgt_i64_avx512;
+		disp->cmpgt_u8 = simd_vec_cmpgt_u8_avx512;
+		disp->cmpgt_u16 = simd_vec_cmpgt_u16_avx512;
+		disp->cmpgt_u32 = simd_vec_cmpgt_u32_avx512;
+		disp->cmpgt_u64 = simd_vec_cmpgt_u64_avx512;
+		disp->cmpgt_f32 = simd_vec_cmpgt_f32_avx512;
+		disp->cmpgt_f64 = simd_vec_cmpgt_f64_avx512;
+		disp->cmpge_f32 = simd_vec_cmpge_f32_avx512;
+		disp->cmpge_f64 = simd_vec_cmpge_f64_avx512;
+		disp->select = simd_vec_select_avx512;
+		disp->find_i8 = simd_vec_find_i8_avx512;
+		disp->find_i16 = simd_vec_find_i16_avx512;
+		disp->find_i32 = simd_vec_find_i32_avx512;
+		disp->find_i64 = simd_vec_find_i64_avx512;
+		disp->find_f32 = simd_vec_find_f32_avx512;
+		disp->find_f64 = simd_vec_find_f64_avx512;
+		disp->rfind_i8 = simd_vec_rfind_i8_avx512;
+		disp->rfind_i16 = simd_vec_rfind_i16_avx512;
+		disp->rfind_i32 = simd_vec_rfind_i32_avx512;
+		disp->rfind_i64 = simd_vec_rfind_i64_avx512;
+		disp->rfind_f32 = simd_vec_rfind_f32_avx512;
+		disp->rfind_f64 = simd_vec_rfind_f64_avx512;
+		disp->count_i8 = simd_vec_count_i8_avx512;
+		disp->count_i16 = simd_vec_count_i16_avx512;
+		disp->count_i32 = simd_vec_count_i32_avx512;
+		disp->count_i64 = simd_vec_count_i64_avx512;
+		disp->count_f32 = simd_vec_count_f32_avx512;
+		disp->count_f64 = simd_vec_count_f64_avx512;
+		disp->find_any_i8 = simd_vec_find_any_i8_avx512;
+		disp->find_any_i16 = simd_vec_find_any_i16_avx512;
+		disp->find_any_i32 = simd_vec_find_any_i32_avx512;
+		disp->find_any_i64 = simd_vec_find_any_i64_avx512;
+		disp->find_any_f32 = simd_vec_find_any_f32_avx512;
+		disp->find_any_f64 = simd_vec_find_any_f64_avx512;
+		disp->index_max = simd_vec_index_max_avx512;
+		disp->hist_index_f32 = simd_vec_hist_index_f32_avx512;
+		disp->hist_index_f64 = simd_vec_hist_index_f64_avx512;
+		disp->hash_32 = simd_vec_hash_32_avx512;
+		disp->hash_64 = simd_vec_hash_64_avx512;
+		disp->gather_32 = simd_vec_gather_32_avx512;
+		disp->gather_64 = simd_vec_gather_64_avx512;
+		disp->scatter_32 = simd_vec_scatter_32_avx512;
+		disp->scatter_64 = simd_vec_scatter_64_avx512;
+		disp->dist_f32[PYSIMD_DIST_DOT] = simd_vec_dot_f32_avx512;
+		disp->dist_f32[PYSIMD_DIST_L2] = simd_vec_l2_f32_avx512;
+		disp->dist_f32[PYSIMD_DIST_COSINE] = simd_vec_cosine_f32_avx512;
+		disp->dist_i8[PYSIMD_DIST_DOT] = simd_vec_dot_i8_avx512;
+		disp->dist_i8[PYSIMD_DIST_L2] = simd_vec_l2_i8_avx512;
+		disp->dist_i8[PYSIMD_DIST_COSINE] = simd_vec_cosine_i8_avx512;
+		disp->gemv_f32 = simd_mat_gemv_f32_avx512;
+		disp->gemv_f64 = simd_mat_gemv_f64_avx512;
+		disp->axpy_f32 = simd_mat_axpy_f32_avx512;
+		disp->axpy_f64 = simd_mat_axpy_f64_avx512;
+		disp->gemm_f32.tile = simd_mat_tile_f32_avx512;
+		disp->gemm_f32.nr = 32;
+		disp->gemm_f64.tile = simd_mat_tile_f64_avx512;
+		disp->gemm_f64.nr = 16;
+		disp->convert[PYSIMD_LANE_I8][PYSIMD_LANE_I16] = simd_convert_i8_i16_avx512;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_I16] = simd_convert_u8_i16_avx512;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_U16] = simd_convert_u8_u16_avx512;
+		disp->convert[PYSIMD_LANE_I8][PYSIMD_LANE_I32] = simd_convert_i8_i32_avx512;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_I32] = simd_convert_u8_i32_avx512;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_U32] = simd_convert_u8_u32_avx512;
+		disp->convert[PYSIMD_LANE_I8][PYSIMD_LANE_I64] = simd_convert_i8_i64_avx512;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_I64] = simd_convert_u8_i64_avx512;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_U64] = simd_convert_u8_u64_avx512;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_I32] = simd_convert_i16_i32_avx512;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_I32] = simd_convert_u16_i32_avx512;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_U32] = simd_convert_u16_u32_avx512;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_I64] = simd_convert_i16_i64_avx512;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_I64] = simd_convert_u16_i64_avx512;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_U64] = simd_convert_u16_u64_avx512;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_I64] = simd_convert_i32_i64_avx512;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_I64] = simd_convert_u32_i64_avx512;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_U64] = simd_convert_u32_u64_avx512;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_I8] = simd_convert_i16_i8_avx512;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_U8] = simd_convert_i16_u8_avx512;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_I8] = simd_convert_u16_i8_avx512;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_U8] = simd_convert_u16_u8_avx512;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_I8] = simd_convert_i32_i8_avx512;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_U8] = simd_convert_i32_u8_avx512;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_I8] = simd_convert_u32_i8_avx512;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_U8] = simd_convert_u32_u8_avx512;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_I16] = simd_convert_i32_i16_avx512;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_U16] = simd_convert_i32_u16_avx512;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_I16] = simd_convert_u32_i16_avx512;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_U16] = simd_convert_u32_u16_avx512;
+		disp->convert[PYSIMD_LANE_I64][PYSIMD_LANE_I8] = simd_convert_i64_i8_avx512;
+		disp->convert[PYSIMD_LANE_I64][PYSIMD_LANE_U8] = simd_convert_i64_u8_avx512;
+		disp->convert[PYSIMD_LANE_U64][PYSIMD_LANE_I8] = simd_convert_u64_i8_avx512;
+		disp->convert[PYSIMD_LANE_U64][PYSIMD_LANE_U8] = simd_convert_u64_u8_avx512;
+		disp->convert[PYSIMD_LANE_I64][PYSIMD_LANE_I16] = simd_convert_i64_i16_avx512;
+		disp->convert[PYSIMD_LANE_I64][PYSIMD_LANE_U16] = simd_convert_i64_u16_avx512;
+		disp->convert[PYSIMD_LANE_U64][PYSIMD_LANE_I16] = simd_convert_u64_i16_avx512;
+		disp->convert[PYSIMD_LANE_U64][PYSIMD_LANE_U16] = simd_convert_u64_u16_avx512;
+		disp->convert[PYSIMD_LANE_I64][PYSIMD_LANE_I32] = simd_convert_i64_i32_avx512;
+		disp->convert[PYSIMD_LANE_I64][PYSIMD_LANE_U32] = simd_convert_i64_u32_avx512;
+		disp->convert[PYSIMD_LANE_U64][PYSIMD_LANE_I32] = simd_convert_u64_i32_avx512;
+		disp->convert[PYSIMD_LANE_U64][PYSIMD_LANE_U32] = simd_convert_u64_u32_avx512;
+		disp->convert[PYSIMD_LANE_U8][PYSIMD_LANE_F32] = simd_convert_u8_f32_avx512;
+		disp->convert[PYSIMD_LANE_I8][PYSIMD_LANE_F32] = simd_convert_i8_f32_avx512;
+		disp->convert[PYSIMD_LANE_U16][PYSIMD_LANE_F32] = simd_convert_u16_f32_avx512;
+		disp->convert[PYSIMD_LANE_I16][PYSIMD_LANE_F32] = simd_convert_i16_f32_avx512;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_F32] = simd_convert_i32_f32_avx512;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_F32] = simd_convert_u32_f32_avx512;
+		disp->convert[PYSIMD_LANE_F32][PYSIMD_LANE_I32] = simd_convert_f32_i32_avx512;
+		disp->convert[PYSIMD_LANE_I32][PYSIMD_LANE_F64] = simd_convert_i32_f64_avx512;
+		disp->convert[PYSIMD_LANE_U32][PYSIMD_LANE_F64] = simd_convert_u32_f64_avx512;
+		disp->convert[PYSIMD_LANE_F32][PYSIMD_LANE_F64] = simd_convert_f32_f64_avx512;
+		disp->convert[PYSIMD_LANE_F64][PYSIMD_LANE_F32] = simd_convert_f64_f32_avx512;
+		disp->cumsum_i32 = simd_vec_cumsum_i32_avx512;
+		disp->cumsum_i64 = simd_vec_cumsum_i64_avx512;
+		disp->cumsum_f32 = simd_vec_cumsum_f32_avx512;
+		disp->cumsum_f64 = simd_vec_cumsum_f64_avx512;
+		disp->sort_i32 = simd_sort_i32_avx512;
+		disp->sort_i64 = simd_sort_i64_avx512;
+		disp->filter_i32 = simd_vec_filter_i32_avx512;
+		disp->filter_i64 = simd_vec_filter_i64_avx512;
+		disp->filter_f32 = simd_vec_filter_f32_avx512;
+		disp->filter_f64 = simd_vec_filter_f64_avx512;
+		disp->fill = pysimd_vec_fill_avx512;
+		disp->fill_float = pysimd_vec_fill_float_avx512;
+		disp->copy = pysimd_vec_copy_avx512;
+		disp->clear_data = pysimd_vec_clear_data_avx512;
+		disp->sum[0] = simd_vec_sum_i8_avx512;
+		disp->sum[1] = simd_vec_sum_u8_avx512;
+		disp->sum[2] = simd_vec_sum_i16_avx512;
+		disp->sum[3] = simd_vec_sum_u16_avx512;
+		disp->sum[4] = simd_vec_sum_i32_avx512;
+		disp->sum[5] = simd_vec_sum_u32_avx512;
+		disp->sum[6] = simd_vec_sum_i64_avx512;
+		disp->sum[7] = simd_vec_sum_i64_avx512;
+		disp->sum[8] = simd_vec_sum_f32_avx512;
+		disp->sum[9] = simd_vec_sum_f64_avx512;
+		disp->min[0] = simd_vec_min_i8_avx512;
+		disp->min[1] = simd_vec_min_u8_avx512;
+		disp->min[2] = simd_vec_min_i16_avx512;
+		disp->min[3] = simd_vec_min_u16_avx512;
+		disp->min[4] = simd_vec_min_i32_avx512;
+		disp->min[5] = simd_vec_min_u32_avx512;
+		disp->min[6] = simd_vec_min_i64_avx512;
+		disp->min[7] = simd_vec_min_u64_avx512;
+		disp->min[8] = simd_vec_min_f32_avx512;
+		disp->min[9] = simd_vec_min_f64_avx512;
+		disp->max[0] = simd_vec_max_i8_avx512;
+		disp->max[1] = simd_vec_max_u8_avx512;
+		disp->max[2] = simd_vec_max_i16_avx512;
+		disp->max[3] = simd_vec_max_u16_avx512;
+		disp->max[4] = simd_vec_max_i32_avx512;
+		disp->max[5] = simd_vec_max_u32_avx512;
+		disp->max[6] = simd_vec_max_i64_avx512;
+		disp->max[7] = simd_vec_max_u64_avx512;
+		disp->max[8] = simd_vec_max_f32_avx512;
+		disp->max[9] = simd_vec_max_f64_avx512;
+	}
+#endif // PYSIMD_X86_AVX512
+}
+
+struct pysimd_binop_task {
+	pysimd_vec_binop_t op;
+	struct pysimd_vec_t* dst;
+	const struct pysimd_vec_t* v1;
+	const struct pysimd_vec_t* v2;
+};
+
+static void pysimd_binop_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_binop_task* task = (struct pysimd_binop_task*)ctx;
+	struct pysimd_vec_t dstpart = {end - start, task->dst->data + start, 0};
+	struct pysimd_vec_t v1part = {end - start, task->v1->data + start, 0};
+	struct pysimd_vec_t v2part = {end - start, task->v2->data + start, 0};
+	task->op(&dstpart, &v1part, &v2part);
+}
+
+/* Runs a binary kernel over the overlap of two vectors, splitting it across the
+ * thread pool when it is large enough to be worth it.
+ */
+static void pysimd_binop_run(pysimd_vec_binop_t op, struct pysimd_vec_t* dst,
+	                         const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2)
+{
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
+	struct pysimd_binop_task task;
+	if (oper_region < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2) {
+		op(dst, v1, v2);
+		return;
+	}
+	task.op = op;
+	task.dst = dst;
+	task.v1 = v1;
+	task.v2 = v2;
+	pysimd_pool_parallel_for(oper_region, PYSIMD_PARALLEL_CHUNK, pysimd_binop_task_run, &task);
+}
+
+struct pysimd_unop_task {
+	pysimd_vec_unop_t op;
+	struct pysimd_vec_t* dst;
+	const struct pysimd_vec_t* src;
+};
+
+static void pysimd_unop_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_unop_task* task = (struct pysimd_unop_task*)ctx;
+	struct pysimd_vec_t dstpart = {end - start, task->dst->data + start, 0};
+	struct pysimd_vec_t srcpart = {end - start, task->src->data + start, 0};
+	task->op(&dstpart, &srcpart);
+}
+
+// Runs a unary kernel over a vector, like pysimd_binop_run
+static void pysimd_unop_run(pysimd_vec_unop_t op, struct pysimd_vec_t* dst, const struct pysimd_vec_t* src)
+{
+	struct pysimd_unop_task task;
+	if (src->size < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2) {
+		op(dst, src);
+		return;
+	}
+	task.op = op;
+	task.dst = dst;
+	task.src = src;
+	pysimd_pool_parallel_for(src->size, PYSIMD_PARALLEL_CHUNK, pysimd_unop_task_run, &task);
+}
+
+struct pysimd_ternop_task {
+	pysimd_vec_ternop_t op;
+	struct pysimd_vec_t* dst;
+	const struct pysimd_vec_t* v1;
+	const struct pysimd_vec_t* v2;
+	const struct pysimd_vec_t* v3;
+};
+
+static void pysimd_ternop_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_ternop_task* task = (struct pysimd_ternop_task*)ctx;
+	struct pysimd_vec_t dstpart = {end - start, task->dst->data + start, 0};
+	struct pysimd_vec_t v1part = {end - start, task->v1->data + start, 0};
+	struct pysimd_vec_t v2part = {end - start, task->v2->data + start, 0};
+	struct pysimd_vec_t v3part = {end - start, task->v3->data + start, 0};
+	task->op(&dstpart, &v1part, &v2part, &v3part);
+}
+
+// Runs a ternary kernel over the overlap of three vectors, like pysimd_binop_run
+static void pysimd_ternop_run(pysimd_vec_ternop_t op, struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1,
+	                          const struct pysimd_vec_t* v2, const struct pysimd_vec_t* v3)
+{
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2) < v3->size ? PYSIMD_MIN_VEC_SIZE(v1, v2) : v3->size;
+	struct pysimd_ternop_task task;
+	if (oper_region < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2) {
+		op(dst, v1, v2, v3);
+		return;
+	}
+	task.op = op;
+	task.dst = dst;
+	task.v1 = v1;
+	task.v2 = v2;
+	task.v3 = v3;
+	pysimd_pool_parallel_for(oper_region, PYSIMD_PARALLEL_CHUNK, pysimd_ternop_task_run, &task);
+}
+
+enum pysimd_reduce_op {
+	PYSIMD_REDUCE_SUM,
+	PYSIMD_REDUCE_MIN,
+	PYSIMD_REDUCE_MAX
+};
+
+// Combines the results of a reduction over two parts of a vector
+static union pysimd_lane_value pysimd_reduce_combine(enum pysimd_reduce_op op, struct pysimd_lane_t lane,
+	                                                 union pysimd_lane_value a, union pysimd_lane_value b)
+{
+	union pysimd_lane_value result;
+	int b_wins = 0;
+	if (op == PYSIMD_REDUCE_SUM) {
+		if (lane.kind == PYSIMD_LANE_FLOAT)
+			result.f = a.f + b.f;
+		else
+			result.u = a.u + b.u;
+		return result;
+	}
+	switch (lane.kind) {
+		case PYSIMD_LANE_INT:
+			b_wins = op == PYSIMD_REDUCE_MIN ? b.i < a.i : b.i > a.i;
+			break;
+		case PYSIMD_LANE_UINT:
+			b_wins = op == PYSIMD_REDUCE_MIN ? b.u < a.u : b.u > a.u;
+			break;
+		case PYSIMD_LANE_FLOAT:
+			b_wins = op == PYSIMD_REDUCE_MIN ? b.f < a.f : b.f > a.f;
+			break;
+	}
+	return b_wins ? b : a;
+}
+
+struct pysimd_reduce_task {
+	pysimd_vec_reduce_t kernel;
+	const struct pysimd_vec_t* vec;
+	union pysimd_lane_value* partials;
+};
+
+static void pysimd_reduce_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_reduce_task* task = (struct pysimd_reduce_task*)ctx;
+	struct pysimd_vec_t part = {end - start, task->vec->data + start, 0};
+	task->partials[start / PYSIMD_PARALLEL_CHUNK] = task->kernel(&part);
+}
+
+/* Runs a reduction kernel over a vector. Large vectors are reduced a chunk at a time
+ * over the thread pool, and the partial results combined in order, so the result does
+ * not depend on how the chunks were scheduled.
+ */
+static union pysimd_lane_value pysimd_reduce_run(pysimd_vec_reduce_t kernel, enum pysimd_reduce_op op,
+	                                             struct pysimd_lane_t lane, const struct pysimd_vec_t* vec)
+{
+	struct pysimd_reduce_task task;
+	union pysimd_lane_value result;
+	size_t n_chunks = 0;
+	size_t i = 1;
+	if (vec->size < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2)
+		return kernel(vec);
+	n_chunks = (vec->size + PYSIMD_PARALLEL_CHUNK - 1) / PYSIMD_PARALLEL_CHUNK;
+	task.partials = malloc(n_chunks * sizeof(union pysimd_lane_value));
+	if (task.partials == NULL)
+		return kernel(vec);
+	task.kernel = kernel;
+	task.vec = vec;
+	pysimd_pool_parallel_for(vec->size, PYSIMD_PARALLEL_CHUNK, pysimd_reduce_task_run, &task);
+	result = task.partials[0];
+	for (; i < n_chunks; ++i)
+		result = pysimd_reduce_combine(op, lane, result, task.partials[i]);
+	free(task.partials);
+	return result;
+}
+
+struct pysimd_count_task {
+	pysimd_vec_count_t kernel;
+	const struct pysimd_vec_t* v1;
+	const struct pysimd_vec_t* v2;
+	uint64_t* partials;
+};
+
+static void pysimd_count_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_count_task* task = (struct pysimd_count_task*)ctx;
+	struct pysimd_vec_t v1 = {end - start, task->v1->data + start, 0};
+	struct pysimd_vec_t v2 = {end - start, task->v2->data + start, 0};
+	task->partials[start / PYSIMD_PARALLEL_CHUNK] = task->kernel(&v1, &v2);
+}
+
+// Runs a counting kernel over the common region of two vectors, over the thread pool if large enough
+static uint64_t pysimd_count_run(pysimd_vec_count_t kernel, const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2)
+{
+	struct pysimd_count_task task;
+	const size_t region = PYSIMD_MIN_VEC_SIZE(v1, v2);
+	uint64_t total = 0;
+	size_t n_chunks = 0;
+	size_t i = 0;
+	if (region < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2)
+		return kernel(v1, v2);
+	n_chunks = (region + PYSIMD_PARALLEL_CHUNK - 1) / PYSIMD_PARALLEL_CHUNK;
+	task.partials = malloc(n_chunks * sizeof(uint64_t));
+	if (task.partials == NULL)
+		return kernel(v1, v2);
+	task.kernel = kernel;
+	task.v1 = v1;
+	task.v2 = v2;
+	pysimd_pool_parallel_for(region, PYSIMD_PARALLEL_CHUNK, pysimd_count_task_run, &task);
+	for (; i < n_chunks; ++i)
+		total += task.partials[i];
+	free(task.partials);
+	return total;
+}
+
+struct pysimd_search_task {
+	pysimd_vec_search_t kernel;
+	const struct pysimd_vec_t* vec;
+	const unsigned char* value;
+	size_t* partials;
+};
+
+static void pysimd_search_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_search_task* task = (struct pysimd_search_task*)ctx;
+	struct pysimd_vec_t part = {end - start, task->vec->data + start, 0};
+	task->partials[start / PYSIMD_PARALLEL_CHUNK] = task->kernel(&part, task->value);
+}
+
+/* Runs a count search kernel over a vector, over the thread pool if large enough. The
+ * find kernels stop at the first match, and are always run on a single thread.
+ */
+static size_t pysimd_search_count_run(pysimd_vec_search_t kernel, const struct pysimd_vec_t* vec, const unsigned char* value)
+{
+	struct pysimd_search_task task;
+	size_t total = 0;
+	size_t n_chunks = 0;
+	size_t i = 0;
+	if (vec->size < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2)
+		return kernel(vec, value);
+	n_chunks = (vec->size + PYSIMD_PARALLEL_CHUNK - 1) / PYSIMD_PARALLEL_CHUNK;
+	task.partials = malloc(n_chunks * sizeof(size_t));
+	if (task.partials == NULL)
+		return kernel(vec, value);
+	task.kernel = kernel;
+	task.vec = vec;
+	task.value = value;
+	pysimd_pool_parallel_for(vec->size, PYSIMD_PARALLEL_CHUNK, pysimd_search_task_run, &task);
+	for (; i < n_chunks; ++i)
+		total += task.partials[i];
+	free(task.partials);
+	return total;
+}
+
+/* Finds the first lane equal to any of n_values broadcast blocks, PYSIMD_FIND_ANY_MAX
+ * of them at a time. Each group only searches the lanes before the best match so far.
+ */
+static size_t pysimd_find_any_run(pysimd_vec_find_any_t kernel, size_t width, const struct pysimd_vec_t* vec,
+	                              const unsigned char* values, size_t n_values)
+{
+	struct pysimd_vec_t part = *vec;
+	size_t best = vec->size / width;
+	size_t k = 0;
+	for (; k < n_values && part.size > 0; k += PYSIMD_FIND_ANY_MAX) {
+		const size_t group = n_values - k < PYSIMD_FIND_ANY_MAX ? n_values - k : PYSIMD_FIND_ANY_MAX;
+		const size_t found = kernel(&part, values + k * PYSIMD_CMP_BROADCAST_SIZE, group);
+		if (found < best) {
+			best = found;
+			part.size = found * width;
+		}
+	}
+	return best;
+}
+
+struct pysimd_cmp_task {
+	pysimd_vec_cmp_t cmp;
+	pysimd_vec_pack_mask_t pack;
+	size_t width;
+	int flags;
+	unsigned char* dst;
+	const struct pysimd_vec_t* v1;
+	const struct pysimd_vec_t* v2;
+};
+
+// The part of v2 lined up with the bytes [start, end) of v1, all of it when broadcast
+static struct pysimd_vec_t pysimd_cmp_operand(const struct pysimd_vec_t* v2, int flags, size_t start, size_t end)
+{
+	struct pysimd_vec_t part = {end - start, v2->data + start, 0};
+	if (flags & PYSIMD_CMP_BROADCAST)
+		part = *v2;
+	return part;
+}
+
+static void pysimd_cmp_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_cmp_task* task = (struct pysimd_cmp_task*)ctx;
+	struct pysimd_vec_t dstpart = {end - start, task->dst + start, 0};
+	struct pysimd_vec_t v1part = {end - start, task->v1->data + start, 0};
+	struct pysimd_vec_t v2part = pysimd_cmp_operand(task->v2, task->flags, start, end);
+	task->cmp(&dstpart, &v1part, &v2part, task->flags);
+}
+
+/* Compares the bytes [start, end) of the operands a block at a time into a scratch
+ * lane mask that stays in L1, and packs each block into its place in bits. start must
+ * be on a multiple of 8 lanes.
+ */
+static void pysimd_cmp_pack_range(const struct pysimd_cmp_task* task, size_t start, size_t end)
+{
+	unsigned char scratch_raw[PYSIMD_CMP_BLOCK + PYSIMD_ALLOC_ALIGN];
+	unsigned char* scratch = (unsigned char*)(((uintptr_t)scratch_raw + PYSIMD_ALLOC_ALIGN - 1) &
+	                                          ~(uintptr_t)(PYSIMD_ALLOC_ALIGN - 1));
+	size_t block = start;
+	for (; block < end; block += PYSIMD_CMP_BLOCK) {
+		const size_t block_end = end - block < PYSIMD_CMP_BLOCK ? end : block + PYSIMD_CMP_BLOCK;
+		struct pysimd_vec_t mask = {block_end - block, scratch, 0};
+		struct pysimd_vec_t v1part = {block_end - block, task->v1->data + block, 0};
+		struct pysimd_vec_t v2part = pysimd_cmp_operand(task->v2, task->flags, block, block_end);
+		task->cmp(&mask, &v1part, &v2part, task->flags);
+		task->pack(task->dst + block / task->width / 8, &mask);
+	}
+}
+
+static void pysimd_cmp_pack_task_run(void* ctx, size_t start, size_t end)
+{
+	pysimd_cmp_pack_range((struct pysimd_cmp_task*)ctx, start, end);
+}
+
+/* Runs a comparison over region bytes of v1, into a lane mask in dst, or when pack is
+ * given, into one bit per lane of width bytes. Large regions are split over the pool.
+ */
+static void pysimd_cmp_run(pysimd_vec_cmp_t cmp, pysimd_vec_pack_mask_t pack, size_t width, int flags,
+	                       unsigned char* dst, const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2, size_t region)
+{
+	struct pysimd_cmp_task task;
+	task.cmp = cmp;
+	task.pack = pack;
+	task.width = width;
+	task.flags = flags;
+	task.dst = dst;
+	task.v1 = v1;
+	task.v2 = v2;
+	if (region < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2) {
+		if (pack != NULL)
+			pysimd_cmp_pack_range(&task, 0, region);
+		else
+			pysimd_cmp_task_run(&task, 0, region);
+		return;
+	}
+	pysimd_pool_parallel_for(region, PYSIMD_PARALLEL_CHUNK, pack != NULL ? pysimd_cmp_pack_task_run : pysimd_cmp_task_run, &task);
+}
+
+struct pysimd_filter_task {
+	pysimd_vec_filter_t kernel;
+	unsigned char* dst;
+	const struct pysimd_vec_t* src;
+	const struct pysimd_filter_range* range;
+	size_t* counts;
+};
+
+static void pysimd_filter_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_filter_task* task = (struct pysimd_filter_task*)ctx;
+	struct pysimd_vec_t part = {end - start, task->src->data + start, 0};
+	task->counts[start / PYSIMD_PARALLEL_CHUNK] = task->kernel(task->dst + start, &part, task->range);
+}
+
+/* Runs a filter kernel of lanes width bytes wide, returning the number of lanes kept.
+ * Large vectors are filtered a chunk at a time over the thread pool, each chunk packed
+ * in place within its own part of dst, then the chunks are moved together in order.
+ */
+static size_t pysimd_filter_run(pysimd_vec_filter_t kernel, size_t width, unsigned char* dst,
+	                            const struct pysimd_vec_t* src, const struct pysimd_filter_range* range)
+{
+	struct pysimd_filter_task task;
+	size_t kept = 0;
+	size_t n_chunks = 0;
+	size_t i = 0;
+	if (src->size < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2)
+		return kernel(dst, src, range);
+	n_chunks = (src->size + PYSIMD_PARALLEL_CHUNK - 1) / PYSIMD_PARALLEL_CHUNK;
+	task.counts = malloc(n_chunks * sizeof(size_t));
+	if (task.counts == NULL)
+		return kernel(dst, src, range);
+	task.kernel = kernel;
+	task.dst = dst;
+	task.src = src;
+	task.range = range;
+	pysimd_pool_parallel_for(src->size, PYSIMD_PARALLEL_CHUNK, pysimd_filter_task_run, &task);
+	for (; i < n_chunks; ++i) {
+		memmove(dst + kept * width, dst + i * PYSIMD_PARALLEL_CHUNK, task.counts[i] * width);
+		kept += task.counts[i];
+	}
+	free(task.counts);
+	return kept;
+}
+
+struct pysimd_scan_task {
+	pysimd_vec_scan_t kernel;
+	pysimd_vec_reduce_t sum;
+	struct pysimd_vec_t* dst;
+	const struct pysimd_vec_t* src;
+	const struct pysimd_vec_t* flags;
+	int exclusive;
+	// Totals of each chunk on the first pass, then the totals carried into each chunk
+	union pysimd_lane_value* carries;
+	int* flagged;
+	int second_pass;
+};
+
+/* Finds the total of the last segment of a part of a segmented scan, and whether it
+ * has any flag, by scanning it a block at a time into scratch that stays in L1, as dst
+ * may be src or the flags, which the second pass still reads.
+ */
+static int pysimd_scan_segment_total(pysimd_vec_scan_t kernel, const struct pysimd_vec_t* src,
+	                                 const struct pysimd_vec_t* flags, union pysimd_lane_value* carry)
+{
+	unsigned char scratch_raw[PYSIMD_CMP_BLOCK + PYSIMD_ALLOC_ALIGN];
+	unsigned char* scratch = (unsigned char*)(((uintptr_t)scratch_raw + PYSIMD_ALLOC_ALIGN - 1) &
+	                                          ~(uintptr_t)(PYSIMD_ALLOC_ALIGN - 1));
+	size_t block = 0;
+	int flagged = 0;
+	for (; block < src->size; block += PYSIMD_CMP_BLOCK) {
+		const size_t block_size = src->size - block < PYSIMD_CMP_BLOCK ? src->size - block : PYSIMD_CMP_BLOCK;
+		struct pysimd_vec_t dstpart = {block_size, scratch, 0};
+		struct pysimd_vec_t srcpart = {block_size, src->data + block, 0};
+		struct pysimd_vec_t flagspart = {block_size, flags->data + block, 0};
+		flagged |= kernel(&dstpart, &srcpart, &flagspart, 0, carry);
+	}
+	return flagged;
+}
+
+static void pysimd_scan_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_scan_task* task = (struct pysimd_scan_task*)ctx;
+	const size_t chunk = start / PYSIMD_PARALLEL_CHUNK;
+	struct pysimd_vec_t dstpart = {end - start, task->dst->data + start, 0};
+	struct pysimd_vec_t srcpart = {end - start, task->src->data + start, 0};
+	struct pysimd_vec_t flagspart = {end - start, task->flags != NULL ? task->flags->data + start : NULL, 0};
+	if (task->second_pass) {
+		if (chunk > 0 || task->flags != NULL)
+			task->kernel(&dstpart, &srcpart, task->flags != NULL ? &flagspart : NULL, task->exclusive, &task->carries[chunk]);
+	} else if (task->flags != NULL) {
+		task->carries[chunk].u = 0;
+		task->flagged[chunk] = pysimd_scan_segment_total(task->kernel, &srcpart, &flagspart, &task->carries[chunk]);
+	} else if (chunk > 0) {
+		task->carries[chunk] = task->sum(&srcpart);
+		task->flagged[chunk] = 0;
+	} else {
+		// Nothing is carried into the first chunk, it is scanned on the first pass
+		task->carries[chunk].u = 0;
+		task->flagged[chunk] = task->kernel(&dstpart, &srcpart, NULL, task->exclusive, &task->carries[chunk]);
+	}
+}
+
+/* Scans the lanes of src into dst, starting from a total of 0, as lanes of a width of
+ * 4 or 8 bytes, and of the kind given by lane. Large vectors are scanned in two passes
+ * over the thread pool. The first finds the total of each chunk with the sum kernels,
+ * or for a segmented scan, the total of its last segment. The second scans each chunk
+ * with the totals of the chunks before it carried in. The first chunk of a plain scan
+ * starts from 0 and reads only its own part of src, so it is scanned on the first pass.
+ */
+static void pysimd_scan_run(pysimd_vec_scan_t kernel, struct pysimd_lane_t lane, struct pysimd_vec_t* dst,
+	                        const struct pysimd_vec_t* src, const struct pysimd_vec_t* flags, int exclusive)
+{
+	struct pysimd_scan_task task;
+	union pysimd_lane_value carry;
+	union pysimd_lane_value total;
+	size_t n_chunks = 0;
+	size_t i = 0;
+	carry.u = 0;
+	if (src->size < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2) {
+		kernel(dst, src, flags, exclusive, &carry);
+		return;
+	}
+	n_chunks = (src->size + PYSIMD_PARALLEL_CHUNK - 1) / PYSIMD_PARALLEL_CHUNK;
+	task.carries = malloc(n_chunks * sizeof(union pysimd_lane_value));
+	task.flagged = malloc(n_chunks * sizeof(int));
+	if (task.carries == NULL || task.flagged == NULL) {
+		free(task.carries);
+		free(task.flagged);
+		kernel(dst, src, flags, exclusive, &carry);
+		return;
+	}
+	task.kernel = kernel;
+	task.sum = pysimd_dispatch.sum[pysimd_lane_index(lane)];
+	task.dst = dst;
+	task.src = src;
+	task.flags = flags;
+	task.exclusive = exclusive;
+	task.second_pass = 0;
+	pysimd_pool_parallel_for(src->size, PYSIMD_PARALLEL_CHUNK, pysimd_scan_task_run, &task);
+	for (; i < n_chunks; ++i) {
+		total = task.carries[i];
+		task.carries[i] = carry;
+		if (task.flagged[i])
+			carry = total;
+		else if (lane.kind == PYSIMD_LANE_FLOAT)
+			carry.f += total.f;
+		else
+			carry.u += total.u;
+	}
+	task.second_pass = 1;
+	pysimd_pool_parallel_for(src->size, PYSIMD_PARALLEL_CHUNK, pysimd_scan_task_run, &task);
+	free(task.carries);
+	free(task.flagged);
+}
+
+/* Sorts n lanes of data in place, as lanes of a kind and a width of 4 or 8 bytes.
+ * Returns 0, or -1 when out of memory, in which case data is left in an unspecified
+ * order, but keeps the same lanes.
+ */
+static int pysimd_sort_run(void* data, size_t n, enum pysimd_lane_kind kind, size_t width)
+{
+	int status = 0;
+	if (width == 4) {
+		simd_sort_encode_32((uint32_t*)data, n, kind, 0);
+		status = pysimd_dispatch.sort_i32(data, NULL, n);
+		simd_sort_encode_32((uint32_t*)data, n, kind, 1);
+	} else {
+		simd_sort_encode_64((uint64_t*)data, n, kind, 0);
+		status = pysimd_dispatch.sort_i64(data, NULL, n);
+		simd_sort_encode_64((uint64_t*)data, n, kind, 1);
+	}
+	return status;
+}
+
+/* Writes into order the positions of n lanes of data in sorted order, equal lanes in
+ * the order they appear. 4 byte keys are sorted along with their position in the low
+ * half of 8 byte keys, which breaks ties. 8 byte keys carry their position as a value,
+ * and the positions within each run of equal keys are sorted afterwards. n must not be
+ * above UINT32_MAX for 4 byte lanes. Returns 0, or -1 when out of memory.
+ */
+static int pysimd_argsort_run(int64_t* order, const void* data, size_t n, enum pysimd_lane_kind kind, size_t width)
+{
+	size_t i = 0;
+	size_t start = 0;
+	if (width == 4) {
+		uint32_t* keys = (uint32_t*)malloc((n > 0 ? n : 1) * sizeof(uint32_t));
+		if (keys == NULL)
+			return -1;
+		memcpy(keys, data, n * sizeof(uint32_t));
+		simd_sort_encode_32(keys, n, kind, 0);
+		for (; i < n; ++i)
+			order[i] = (int64_t)(((uint64_t)keys[i] << 32) | (uint64_t)i);
+		free(keys);
+		if (pysimd_dispatch.sort_i64(order, NULL, n) < 0)
+			return -1;
+		for (i = 0; i < n; ++i)
+			order[i] = (int64_t)((uint64_t)order[i] & 0xffffffffu);
+		return 0;
+	}
+	{
+		int64_t* keys = (int64_t*)malloc((n > 0 ? n : 1) * sizeof(int64_t));
+		if (keys == NULL)
+			return -1;
+		memcpy(keys, data, n * sizeof(int64_t));
+		simd_sort_encode_64((uint64_t*)keys, n, kind, 0);
+		for (; i < n; ++i)
+			order[i] = (int64_t)i;
+		if (pysimd_dispatch.sort_i64(keys, order, n) < 0) {
+			free(keys);
+			return -1;
+		}
+		for (i = 1; i <= n; ++i) {
+			if (i == n || keys[i] != keys[start]) {
+				if (i - start > 1 && pysimd_dispatch.sort_i64(order + start, NULL, i - start) < 0) {
+					free(keys);
+					return -1;
+				}
+				start = i;
+			}
+		}
+		free(keys);
+	}
+	return 0;
+}
+
+// Moves the lanes of src of width bytes to dst in the given order
+static void pysimd_gather_lanes(unsigned char* dst, const unsigned char* src, const int64_t* order, size_t n, size_t width)
+{
+	size_t i = 0;
+	switch (width) {
+		case 1:
+			for (; i < n; ++i)
+				dst[i] = src[order[i]];
+			break;
+		case 2:
+			for (; i < n; ++i)
+				((uint16_t*)dst)[i] = ((const uint16_t*)src)[order[i]];
+			break;
+		case 4:
+			for (; i < n; ++i)
+				((uint32_t*)dst)[i] = ((const uint32_t*)src)[order[i]];
+			break;
+		default:
+			for (; i < n; ++i)
+				((uint64_t*)dst)[i] = ((const uint64_t*)src)[order[i]];
+			break;
+	}
+}
+
+/* Sorts n lanes of keys in place as pysimd_sort_run does, and the first n lanes of
+ * values of value_width bytes along with them, keeping equal keys in their order. The
+ * keys are moved rather than decoded back, so NaNs keep their bits. Returns 0, or -1
+ * when out of memory, in which case neither is changed.
+ */
+static int pysimd_sort_values_run(unsigned char* keys, size_t n, enum pysimd_lane_kind kind, size_t width,
+	                              unsigned char* values, size_t value_width)
+{
+	int64_t* order = (int64_t*)malloc((n > 0 ? n : 1) * sizeof(int64_t));
+	unsigned char* copy = (unsigned char*)malloc((n > 0 ? n : 1) * 8);
+	if (order == NULL || copy == NULL || pysimd_argsort_run(order, keys, n, kind, width) < 0) {
+		free(order);
+		free(copy);
+		return -1;
+	}
+	memcpy(copy, keys, n * width);
+	pysimd_gather_lanes(keys, copy, order, n, width);
+	memcpy(copy, values, n * value_width);
+	pysimd_gather_lanes(values, copy, order, n, value_width);
+	free(order);
+	free(copy);
+	return 0;
+}
+
+struct pysimd_convert_task {
+	pysimd_vec_convert_t kernel;
+	struct pysimd_lane_t from;
+	struct pysimd_lane_t to;
+	unsigned char* dst;
+	const struct pysimd_vec_t* src;
+};
+
+static void pysimd_convert_range(const struct pysimd_convert_task* task, size_t start, size_t end)
+{
+	struct pysimd_vec_t part = {end - start, task->src->data + start, 0};
+	unsigned char* dst = task->dst + start / task->from.width * task->to.width;
+	if (task->kernel != NULL)
+		task->kernel(dst, &part);
+	else
+		simd_convert_lanes(dst, task->to, part.data, task->from, part.size / task->from.width);
+}
+
+static void pysimd_convert_task_run(void* ctx, size_t start, size_t end)
+{
+	pysimd_convert_range((const struct pysimd_convert_task*)ctx, start, end);
+}
+
+/* Converts every lane of src from one lane type to another into dst, which holds as
+ * many lanes of the new type. Large vectors are converted a chunk at a time over the
+ * thread pool, the chunks being whole lanes of every width.
+ */
+static void pysimd_convert_run(struct pysimd_lane_t from, struct pysimd_lane_t to, unsigned char* dst,
+	                           const struct pysimd_vec_t* src)
+{
+	struct pysimd_convert_task task;
+	task.kernel = pysimd_dispatch.convert[pysimd_lane_index(from)][pysimd_lane_index(to)];
+	task.from = from;
+	task.to = to;
+	task.dst = dst;
+	task.src = src;
+	if (src->size < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2)
+		pysimd_convert_range(&task, 0, src->size);
+	else
+		pysimd_pool_parallel_for(src->size, PYSIMD_PARALLEL_CHUNK, pysimd_convert_task_run, &task);
+}
+
+struct pysimd_dist_task {
+	pysimd_vec_dist_t kernel;
+	const struct pysimd_vec_t* a;
+	const struct pysimd_vec_t* b;
+	union pysimd_lane_value* partials;
+};
+
+static void pysimd_dist_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_dist_task* task = (struct pysimd_dist_task*)ctx;
+	struct pysimd_vec_t a_part = {end - start, task->a->data + start, 0};
+	struct pysimd_vec_t b_part = {end - start, task->b->data + start, 0};
+	task->kernel(&a_part, &b_part, task->partials + start / PYSIMD_PARALLEL_CHUNK * 3);
+}
+
+/* Runs a distance kernel over the first size bytes of a and b into three totals, in .f
+ * for floats and .i otherwise. Large vectors are summed a chunk at a time over the
+ * thread pool, and the chunk totals added in order.
+ */
+static void pysimd_dist_run(pysimd_vec_dist_t kernel, int is_float, const struct pysimd_vec_t* a,
+	                        const struct pysimd_vec_t* b, size_t size, union pysimd_lane_value* sums)
+{
+	const struct pysimd_vec_t a_region = {size, a->data, 0};
+	const struct pysimd_vec_t b_region = {size, b->data, 0};
+	struct pysimd_dist_task task;
+	size_t n_chunks = 0;
+	size_t i = 0;
+	size_t k = 0;
+	if (size < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2) {
+		kernel(&a_region, &b_region, sums);
+		return;
+	}
+	n_chunks = (size + PYSIMD_PARALLEL_CHUNK - 1) / PYSIMD_PARALLEL_CHUNK;
+	task.partials = (union pysimd_lane_value*)malloc(n_chunks * 3 * sizeof(union pysimd_lane_value));
+	if (task.partials == NULL) {
+		kernel(&a_region, &b_region, sums);
+		return;
+	}
+	task.kernel = kernel;
+	task.a = &a_region;
+	task.b = &b_region;
+	pysimd_pool_parallel_for(size, PYSIMD_PARALLEL_CHUNK, pysimd_dist_task_run, &task);
+	for (k = 0; k < 3; ++k) {
+		sums[k] = task.partials[k];
+		for (i = 1; i < n_chunks; ++i) {
+			if (is_float)
+				sums[k].f += task.partials[i * 3 + k].f;
+			else
+				sums[k].i += task.partials[i * 3 + k].i;
+		}
+	}
+	free(task.partials);
+}
+
+// The cosine of the angle between two vectors from their cosine totals, NaN when either is 0
+static double pysimd_dist_cosine(double dot, double a_squares, double b_squares)
+{
+	const double norms = sqrt(a_squares) * sqrt(b_squares);
+	return norms == 0.0 ? NAN : dot / norms;
+}
+
+// A row of a nearest neighbour search, lower scores being nearer
+struct pysimd_knn_hit {
+	double score;
+	size_t row;
+};
+
+// Whether hit a is nearer than hit b, NaN being furthest and ties going to the lower row
+static int pysimd_knn_nearer(const struct pysimd_knn_hit* a, const struct pysimd_knn_hit* b)
+{
+	if (a->score != a->score || b->score != b->score) {
+		if (a->score == a->score)
+			return 1;
+		if (b->score == b->score)
+			return 0;
+	} else if (a->score != b->score) {
+		return a->score < b->score;
+	}
+	return a->row < b->row;
+}
+
+/* Offers a hit to a heap of at most k hits, furthest at the top, which keeps the k
+ * nearest hits offered. count is the number of hits in the heap.
+ */
+static void pysimd_knn_offer(struct pysimd_knn_hit* heap, size_t* count, size_t k, struct pysimd_knn_hit hit)
+{
+	size_t pos = 0;
+	if (*count < k) {
+		pos = (*count)++;
+		while (pos > 0 && pysimd_knn_nearer(&heap[(pos - 1) / 2], &hit)) {
+			heap[pos] = heap[(pos - 1) / 2];
+			pos = (pos - 1) / 2;
+		}
+		heap[pos] = hit;
+		return;
+	}
+	if (!pysimd_knn_nearer(&hit, &heap[0]))
+		return;
+	for (;;) {
+		size_t child = pos * 2 + 1;
+		if (child >= k)
+			break;
+		if (child + 1 < k && pysimd_knn_nearer(&heap[child], &heap[child + 1]))
+			++child;
+		if (!pysimd_knn_nearer(&hit, &heap[child]))
+			break;
+		heap[pos] = heap[child];
+		pos = child;
+	}
+	heap[pos] = hit;
+}
+
+static int pysimd_knn_compare(const void* a, const void* b)
+{
+	const struct pysimd_knn_hit* hit_a = (const struct pysimd_knn_hit*)a;
+	const struct pysimd_knn_hit* hit_b = (const struct pysimd_knn_hit*)b;
+	return pysimd_knn_nearer(hit_a, hit_b) ? -1 : (pysimd_knn_nearer(hit_b, hit_a) ? 1 : 0);
+}
+
+struct pysimd_knn_task {
+	pysimd_vec_dist_t kernel;
+	enum pysimd_dist_metric metric;
+	int is_float;
+	const struct pysimd_vec_t* query;
+	const unsigned char* rows;
+	size_t row_bytes;
+	size_t k;
+	size_t rows_per_chunk;
+	struct pysimd_knn_hit* heaps;
+	size_t* counts;
+};
+
+static void pysimd_knn_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_knn_task* task = (struct pysimd_knn_task*)ctx;
+	const size_t chunk = start / task->rows_per_chunk;
+	struct pysimd_knn_hit* heap = task->heaps + chunk * task->k;
+	struct pysimd_knn_hit hit;
+	union pysimd_lane_value sums[3];
+	size_t row = start;
+	task->counts[chunk] = 0;
+	for (; row < end; ++row) {
+		const struct pysimd_vec_t part = {task->row_bytes, (unsigned char*)task->rows + row * task->row_bytes, 0};
+		task->kernel(task->query, &part, sums);
+		if (!task->is_float) {
+			sums[0].f = (double)sums[0].i;
+			sums[1].f = (double)sums[1].i;
+			sums[2].f = (double)sums[2].i;
+		}
+		switch (task->metric) {
+			case PYSIMD_DIST_DOT: hit.score = -sums[0].f; break;
+			case PYSIMD_DIST_L2: hit.score = sums[0].f; break;
+			case PYSIMD_DIST_COSINE: hit.score = -pysimd_dist_cosine(sums[0].f, sums[1].f, sums[2].f); break;
+		}
+		hit.row = row;
+		pysimd_knn_offer(heap, &task->counts[chunk], task->k, hit);
+	}
+}
+
+/* Finds the k rows of n_rows rows of row_bytes each that are nearest to query, the
+ * query being row_bytes as well. Nearest is the least l2 distance, or the greatest dot
+ * product or cosine. Writes the rows nearest first into found, and returns how many
+ * there are, or -1 when out of memory. Large searches are split into runs of rows over
+ * the thread pool, each keeping its own k nearest, and those are merged after.
+ */
+static ptrdiff_t pysimd_knn_run(pysimd_vec_dist_t kernel, enum pysimd_dist_metric metric, int is_float,
+	                            const struct pysimd_vec_t* query, const unsigned char* rows, size_t row_bytes,
+	                            size_t n_rows, size_t k, size_t* found)
+{
+	struct pysimd_knn_task task;
+	size_t n_chunks = 1;
+	size_t n_found = 0;
+	size_t i = 0;
+	k = k < n_rows ? k : n_rows;
+	if (k == 0)
+		return 0;
+	task.kernel = kernel;
+	task.metric = metric;
+	task.is_float = is_float;
+	task.query = query;
+	task.rows = rows;
+	task.row_bytes = row_bytes;
+	task.k = k;
+	task.rows_per_chunk = n_rows;
+	if (n_rows * row_bytes >= PYSIMD_PARALLEL_MIN && pysimd_pool_get_threads() >= 2) {
+		task.rows_per_chunk = PYSIMD_PARALLEL_CHUNK / row_bytes > 0 ? PYSIMD_PARALLEL_CHUNK / row_bytes : 1;
+		n_chunks = (n_rows + task.rows_per_chunk - 1) / task.rows_per_chunk;
+	}
+	task.heaps = (struct pysimd_knn_hit*)malloc(n_chunks * k * sizeof(struct pysimd_knn_hit));
+	task.counts = (size_t*)malloc(n_chunks * sizeof(size_t));
+	if (task.heaps == NULL || task.counts == NULL) {
+		free(task.heaps);
+		free(task.counts);
+		return -1;
+	}
+	if (n_chunks == 1)
+		pysimd_knn_task_run(&task, 0, n_rows);
+	else
+		pysimd_pool_parallel_for(n_rows, task.rows_per_chunk, pysimd_knn_task_run, &task);
+	// Every later heap is offered to the first one
+	n_found = task.counts[0];
+	for (i = 1; i < n_chunks; ++i) {
+		size_t j = 0;
+		for (; j < task.counts[i]; ++j)
+			pysimd_knn_offer(task.heaps, &n_found, k, task.heaps[i * k + j]);
+	}
+	qsort(task.heaps, n_found, sizeof(struct pysimd_knn_hit), pysimd_knn_compare);
+	for (i = 0; i < n_found; ++i)
+		found[i] = task.heaps[i].row;
+	free(task.heaps);
+	free(task.counts);
+	return (ptrdiff_t)n_found;
+}
+
+struct pysimd_gemv_task {
+	pysimd_mat_gemv_t gemv;
+	const struct pysimd_mat_t* a;
+	const unsigned char* x;
+	unsigned char* y;
+	size_t width;
+};
+
+static void pysimd_gemv_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_gemv_task* task = (struct pysimd_gemv_task*)ctx;
+	task->gemv(task->a->data + start * task->a->row_stride, task->a->row_stride, end - start, task->x, task->a->cols,
+	           task->y + start * task->width);
+}
+
+/* Sets y to the product of the matrix a and the vector x, for lanes width bytes wide.
+ * Rows whose lanes are next to each other are dot products with x, split over the
+ * thread pool by runs of rows for large matrices. Columns whose lanes are next to each
+ * other, as in a transposed matrix, are scaled by x and summed. Other strides go lane
+ * by lane.
+ */
+static void pysimd_gemv_run(size_t width, const struct pysimd_mat_t* a, const unsigned char* x, unsigned char* y)
+{
+	const pysimd_mat_gemv_t gemv = width == 4 ? pysimd_dispatch.gemv_f32 : pysimd_dispatch.gemv_f64;
+	const pysimd_mat_axpy_t axpy = width == 4 ? pysimd_dispatch.axpy_f32 : pysimd_dispatch.axpy_f64;
+	struct pysimd_gemv_task task;
+	size_t i = 0;
+	size_t j = 0;
+	if (a->col_stride == width) {
+		size_t rows_per_chunk = 0;
+		if (a->rows * a->row_stride < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2) {
+			gemv(a->data, a->row_stride, a->rows, x, a->cols, y);
+			return;
+		}
+		rows_per_chunk = (PYSIMD_PARALLEL_CHUNK / a->row_stride) & ~(size_t)3;
+		task.gemv = gemv;
+		task.a = a;
+		task.x = x;
+		task.y = y;
+		task.width = width;
+		pysimd_pool_parallel_for(a->rows, rows_per_chunk > 4 ? rows_per_chunk : 4, pysimd_gemv_task_run, &task);
+	} else if (a->row_stride == width) {
+		memset(y, 0, a->rows * width);
+		for (; j < a->cols; ++j)
+			axpy(y, a->data + j * a->col_stride, a->rows, width == 4 ? (double)((const float*)x)[j] : ((const double*)x)[j]);
+	} else {
+		for (; i < a->rows; ++i) {
+			double total = 0.0;
+			for (j = 0; j < a->cols; ++j)
+				total += simd_mat_get(a, width, i, j) * (width == 4 ? (double)((const float*)x)[j] : ((const double*)x)[j]);
+			if (width == 4)
+				((float*)y)[i] = (float)total;
+			else
+				((double*)y)[i] = total;
+		}
+	}
+}
+
+struct pysimd_gemm_task {
+	struct pysimd_gemm_kernel kernel;
+	size_t width;
+	struct pysimd_mat_t* c;
+	const struct pysimd_mat_t* a;
+	const unsigned char* pack;
+	size_t p0;
+	size_t kc;
+	size_t j0;
+	size_t nc;
+};
+
+/* Adds the product of rows [start, end) of a block of A and the packed block of B to C,
+ * a tile at a time. Tiles past the last row or column of C go through a scratch tile.
+ */
+static void pysimd_gemm_rows(const struct pysimd_gemm_task* task, size_t start, size_t end)
+{
+	const size_t width = task->width;
+	const size_t nr = task->kernel.nr;
+	const struct pysimd_mat_t* a = task->a;
+	struct pysimd_mat_t* c = task->c;
+	unsigned char tile[PYSIMD_GEMM_MR * PYSIMD_GEMM_NR_MAX * 8];
+	const unsigned char* a_rows[PYSIMD_GEMM_MR];
+	size_t i = start;
+	for (; i < end; i += PYSIMD_GEMM_MR) {
+		const size_t n_rows = end - i < PYSIMD_GEMM_MR ? end - i : PYSIMD_GEMM_MR;
+		size_t r = 0;
+		size_t s = 0;
+		for (; r < PYSIMD_GEMM_MR; ++r)
+			a_rows[r] = a->data + (i + (r < n_rows ? r : 0)) * a->row_stride + task->p0 * a->col_stride;
+		for (; s < task->nc; s += nr) {
+			const size_t n_cols = task->nc - s < nr ? task->nc - s : nr;
+			const unsigned char* strip = task->pack + s * task->kc * width;
+			unsigned char* c_tile = c->data + i * c->row_stride + (task->j0 + s) * width;
+			size_t j = 0;
+			if (n_rows == PYSIMD_GEMM_MR && n_cols == nr) {
+				task->kernel.tile(task->kc, a_rows, a->col_stride, strip, c_tile, c->row_stride);
+				continue;
+			}
+			memset(tile, 0, PYSIMD_GEMM_MR * nr * width);
+			task->kernel.tile(task->kc, a_rows, a->col_stride, strip, tile, nr * width);
+			for (r = 0; r < n_rows; ++r) {
+				for (j = 0; j < n_cols; ++j) {
+					if (width == 4)
+						((float*)(c_tile + r * c->row_stride))[j] += ((const float*)tile)[r * nr + j];
+					else
+						((double*)(c_tile + r * c->row_stride))[j] += ((const double*)tile)[r * nr + j];
+				}
+			}
+		}
+	}
+}
+
+static void pysimd_gemm_task_run(void* ctx, size_t start, size_t end)
+{
+	pysimd_gemm_rows((const struct pysimd_gemm_task*)ctx, start, end);
+}
+
+/* Sets c, whose lanes are next to each other in each row, to the product of a and b,
+ * for lanes width bytes wide. B is packed a block at a time, and the rows of C are
+ * split over the thread pool when there is enough work. Returns 0, or -1 when out of
+ * memory, in which case c is left unspecified.
+ */
+static int pysimd_gemm_run(size_t width, struct pysimd_mat_t* c, const struct pysimd_mat_t* a, const struct pysimd_mat_t* b)
+{
+	struct pysimd_gemm_task task;
+	unsigned char* pack = NULL;
+	size_t i = 0;
+	task.kernel = width == 4 ? pysimd_dispatch.gemm_f32 : pysimd_dispatch.gemm_f64;
+	pack = (unsigned char*)malloc(PYSIMD_GEMM_KC * PYSIMD_GEMM_NC * width);
+	if (pack == NULL)
+		return -1;
+	for (; i < c->rows; ++i)
+		memset(c->data + i * c->row_stride, 0, c->cols * width);
+	task.width = width;
+	task.c = c;
+	task.a = a;
+	task.pack = pack;
+	for (task.j0 = 0; task.j0 < b->cols; task.j0 += PYSIMD_GEMM_NC) {
+		task.nc = b->cols - task.j0 < PYSIMD_GEMM_NC ? b->cols - task.j0 : PYSIMD_GEMM_NC;
+		for (task.p0 = 0; task.p0 < a->cols; task.p0 += PYSIMD_GEMM_KC) {
+			task.kc = a->cols - task.p0 < PYSIMD_GEMM_KC ? a->cols - task.p0 : PYSIMD_GEMM_KC;
+			simd_mat_pack(pack, b, width, task.p0, task.kc, task.j0, task.nc, task.kernel.nr);
+			if (a->rows > PYSIMD_GEMM_MC && a->rows * task.nc * task.kc >= PYSIMD_GEMM_PARALLEL_MIN &&
+			    pysimd_pool_get_threads() >= 2)
+				pysimd_pool_parallel_for(a->rows, PYSIMD_GEMM_MC, pysimd_gemm_task_run, &task);
+			else
+				pysimd_gemm_rows(&task, 0, a->rows);
+		}
+	}
+	free(pack);
+	return 0;
+}
+
+struct pysimd_gather_task {
+	pysimd_vec_gather_t kernel;
+	size_t width;
+	unsigned char* dst;
+	const unsigned char* src;
+	const uint32_t* index;
+};
+
+static void pysimd_gather_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_gather_task* task = (struct pysimd_gather_task*)ctx;
+	task->kernel(task->dst + start * task->width, task->src, task->index + start, end - start);
+}
+
+/* Gathers n lanes width bytes wide from src into dst, at positions no greater than
+ * index_max. Large gathers are split over the thread pool, each thread writing its own
+ * run of dst.
+ */
+static void pysimd_gather_run(size_t width, unsigned char* dst, const unsigned char* src, const uint32_t* index, size_t n,
+	                          uint32_t index_max)
+{
+	struct pysimd_gather_task task;
+	if (index_max > PYSIMD_GATHER_INDEX_MAX)
+		task.kernel = width == 4 ? simd_vec_gather_32_scalar : simd_vec_gather_64_scalar;
+	else
+		task.kernel = width == 4 ? pysimd_dispatch.gather_32 : pysimd_dispatch.gather_64;
+	task.width = width;
+	task.dst = dst;
+	task.src = src;
+	task.index = index;
+	if (n * width < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2)
+		task.kernel(dst, src, index, n);
+	else
+		pysimd_pool_parallel_for(n, PYSIMD_PARALLEL_CHUNK / width, pysimd_gather_task_run, &task);
+}
+
+/* Scatters n lanes width bytes wide from values into dst, at positions no greater than
+ * index_max. Scatters stay on one thread, so that the last of several lanes written to
+ * the same position is the one kept.
+ */
+static void pysimd_scatter_run(size_t width, unsigned char* dst, const uint32_t* index, const unsigned char* values, size_t n,
+	                           uint32_t index_max)
+{
+	pysimd_vec_scatter_t kernel = width == 4 ? pysimd_dispatch.scatter_32 : pysimd_dispatch.scatter_64;
+	if (index_max > PYSIMD_GATHER_INDEX_MAX)
+		kernel = width == 4 ? simd_vec_scatter_32_scalar : simd_vec_scatter_64_scalar;
+	kernel(dst, index, values, n);
+}
+
+// Histograms with at most this many bins are split over the thread pool, each chunk counting into its own
+#define PYSIMD_HIST_PARALLEL_BINS 4096
+
+struct pysimd_hist_task {
+	pysimd_vec_hist_index_t index;
+	size_t width;
+	const unsigned char* data;
+	const struct pysimd_hist_range* range;
+	uint64_t* partials;
+};
+
+static void pysimd_hist_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_hist_task* task = (struct pysimd_hist_task*)ctx;
+	const size_t stride = (size_t)task->range->nbins + 1;
+	uint64_t* ways = (uint64_t*)malloc(PYSIMD_HIST_WAYS * stride * sizeof(uint64_t));
+	// Without room for the extra histograms, the chunk is counted into one, only slower
+	simd_hist_lanes(task->index, task->width, task->data + start * task->width, end - start, task->range,
+	                task->partials + start / (PYSIMD_PARALLEL_CHUNK / task->width) * stride, ways);
+	free(ways);
+}
+
+/* Counts the n lanes of data, of the given type, into range->nbins + 1 counts, the last
+ * of lanes outside of the range. Float bin numbers are computed by the dispatched
+ * kernels, integer ones lane by lane. Without memory for the chunk counts, or the extra
+ * histograms, it falls back to one thread counting into counts alone.
+ */
+static void pysimd_hist_run(struct pysimd_lane_t lane, uint64_t* counts, const unsigned char* data, size_t n,
+	                        const struct pysimd_hist_range* range)
+{
+	static const pysimd_vec_hist_index_t int_kernels[8] = {
+		simd_vec_hist_index_i8_scalar, simd_vec_hist_index_u8_scalar, simd_vec_hist_index_i16_scalar,
+		simd_vec_hist_index_u16_scalar, simd_vec_hist_index_i32_scalar, simd_vec_hist_index_u32_scalar,
+		simd_vec_hist_index_i64_scalar, simd_vec_hist_index_u64_scalar
+	};
+	const size_t stride = (size_t)range->nbins + 1;
+	const size_t lanes_per_chunk = PYSIMD_PARALLEL_CHUNK / lane.width;
+	struct pysimd_hist_task task;
+	uint64_t* ways = NULL;
+	size_t n_chunks = 0;
+	size_t i = 0;
+	size_t k = 0;
+	if (lane.kind == PYSIMD_LANE_FLOAT)
+		task.index = lane.width == 4 ? pysimd_dispatch.hist_index_f32 : pysimd_dispatch.hist_index_f64;
+	else
+		task.index = int_kernels[pysimd_lane_index(lane)];
+	memset(counts, 0, stride * sizeof(uint64_t));
+	task.partials = NULL;
+	if (n * lane.width >= PYSIMD_PARALLEL_MIN && range->nbins <= PYSIMD_HIST_PARALLEL_BINS && pysimd_pool_get_threads() >= 2) {
+		n_chunks = (n + lanes_per_chunk - 1) / lanes_per_chunk;
+		task.partials = (uint64_t*)calloc(n_chunks * stride, sizeof(uint64_t));
+	}
+	if (task.partials == NULL) {
+		ways = (uint64_t*)malloc(PYSIMD_HIST_WAYS * stride * sizeof(uint64_t));
+		simd_hist_lanes(task.index, lane.width, data, n, range, counts, ways);
+		free(ways);
+		return;
+	}
+	task.width = lane.width;
+	task.data = data;
+	task.range = range;
+	pysimd_pool_parallel_for(n, lanes_per_chunk, pysimd_hist_task_run, &task);
+	for (; i < n_chunks; ++i)
+		for (k = 0; k < stride; ++k)
+			counts[k] += task.partials[i * stride + k];
+	free(task.partials);
+}
+
+struct pysimd_bincount_task {
+	const unsigned char* data;
+	uint64_t* partials;
+};
+
+static void pysimd_bincount_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_bincount_task* task = (struct pysimd_bincount_task*)ctx;
+	simd_vec_bincount_u8(task->partials + start / PYSIMD_PARALLEL_CHUNK * 256, task->data + start, end - start);
+}
+
+/* Counts every value of the n bytes of data into 256 counts. Large vectors are counted
+ * a chunk at a time over the thread pool, falling back to one thread without memory
+ * for the chunk counts.
+ */
+static void pysimd_bincount_run(uint64_t* counts, const unsigned char* data, size_t n)
+{
+	struct pysimd_bincount_task task;
+	size_t n_chunks = 0;
+	size_t i = 0;
+	size_t k = 0;
+	memset(counts, 0, 256 * sizeof(uint64_t));
+	if (n < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2) {
+		simd_vec_bincount_u8(counts, data, n);
+		return;
+	}
+	n_chunks = (n + PYSIMD_PARALLEL_CHUNK - 1) / PYSIMD_PARALLEL_CHUNK;
+	task.partials = (uint64_t*)calloc(n_chunks * 256, sizeof(uint64_t));
+	if (task.partials == NULL) {
+		simd_vec_bincount_u8(counts, data, n);
+		return;
+	}
+	task.data = data;
+	pysimd_pool_parallel_for(n, PYSIMD_PARALLEL_CHUNK, pysimd_bincount_task_run, &task);
+	for (; i < n_chunks; ++i)
+		for (k = 0; k < 256; ++k)
+			counts[k] += task.partials[i * 256 + k];
+	free(task.partials);
+}
+
+struct pysimd_hash_task {
+	pysimd_vec_hash_t kernel;
+	size_t width;
+	unsigned char* dst;
+	const unsigned char* src;
+	uint64_t key;
+};
+
+static void pysimd_hash_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_hash_task* task = (struct pysimd_hash_task*)ctx;
+	task->kernel(task->dst + start * task->width, task->src + start * task->width, end - start, task->key);
+}
+
+// Hashes n lanes width bytes wide from src into dst, over the thread pool for large vectors
+static void pysimd_hash_run(size_t width, unsigned char* dst, const unsigned char* src, size_t n, uint64_t seed)
+{
+	struct pysimd_hash_task task;
+	task.kernel = width == 4 ? pysimd_dispatch.hash_32 : pysimd_dispatch.hash_64;
+	task.width = width;
+	task.dst = dst;
+	task.src = src;
+	task.key = simd_hash_key(seed);
+	if (n * width < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2)
+		task.kernel(dst, src, n, task.key);
+	else
+		pysimd_pool_parallel_for(n, PYSIMD_PARALLEL_CHUNK / width, pysimd_hash_task_run, &task);
+}
+
+struct pysimd_crc32c_task {
+	const unsigned char* data;
+	uint32_t* states;
+};
+
+static void pysimd_crc32c_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_crc32c_task* task = (struct pysimd_crc32c_task*)ctx;
+	task->states[start / PYSIMD_PARALLEL_CHUNK] = pysimd_dispatch.crc32c(0, task->data + start, end - start);
+}
+
+/* Returns the CRC32C of n bytes of data, continuing from the checksum crc, 0 to start a
+ * new one. Large vectors are checksummed a chunk at a time over the thread pool, each
+ * chunk from a zero state, and the chunk states combined in order.
+ */
+static uint32_t pysimd_crc32c_run(uint32_t crc, const unsigned char* data, size_t n)
+{
+	struct pysimd_crc32c_task task;
+	uint32_t state = ~crc;
+	uint32_t skip = 0;
+	size_t n_chunks = 0;
+	size_t i = 0;
+	if (n < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2)
+		return ~pysimd_dispatch.crc32c(state, data, n);
+	n_chunks = (n + PYSIMD_PARALLEL_CHUNK - 1) / PYSIMD_PARALLEL_CHUNK;
+	task.states = (uint32_t*)malloc(n_chunks * sizeof(uint32_t));
+	if (task.states == NULL)
+		return ~pysimd_dispatch.crc32c(state, data, n);
+	task.data = data;
+	pysimd_pool_parallel_for(n, PYSIMD_PARALLEL_CHUNK, pysimd_crc32c_task_run, &task);
+	skip = simd_crc32c_shift(PYSIMD_PARALLEL_CHUNK);
+	for (; i + 1 < n_chunks; ++i)
+		state = simd_crc32c_multiply(skip, state) ^ task.states[i];
+	state = simd_crc32c_multiply(simd_crc32c_shift(n - i * PYSIMD_PARALLEL_CHUNK), state) ^ task.states[i];
+	free(task.states);
+	return ~state;
+}
+
+#endif // PYSIMD_DISPATCH_H
@@ -0,0 +1,80 @@
+#ifndef PYSIMD_EXPR_H
+#define PYSIMD_EXPR_H
+
+#include "simd_dispatch.h"
+
+/* Fused evaluation of a chain of binary operations, ((base op0 x0) op1 x1) ...
+ * Instead of one pass over memory per operation, the chain runs a block at a time,
+ * the running result of a block is kept in a scratch buffer that stays in the L1
+ * cache, and only the last operation writes to the destination.
+ */
+
+// Bytes processed per block, small enough for the scratch buffer and two operands to share L1
+#define PYSIMD_EXPR_BLOCK ((size_t)1 << 12)
+
+struct pysimd_expr_step {
+	pysimd_vec_binop_t op;
+	const struct pysimd_vec_t* operand;
+};
+
+struct pysimd_expr_t {
+	const struct pysimd_vec_t* base;
+	const struct pysimd_expr_step* steps;
+	size_t n_steps;
+};
+
+/* Evaluates the bytes [start, end) of an expression into dst. The destination may
+ * be any of the operands, as each block of it is only written once every operation
+ * has read that block.
+ */
+static void pysimd_expr_run_range(struct pysimd_vec_t* dst, const struct pysimd_expr_t* expr,
+	                              size_t start, size_t end)
+{
+	unsigned char scratch_raw[PYSIMD_EXPR_BLOCK + PYSIMD_ALLOC_ALIGN];
+	unsigned char* scratch = (unsigned char*)(((uintptr_t)scratch_raw + PYSIMD_ALLOC_ALIGN - 1) &
+	                                          ~(uintptr_t)(PYSIMD_ALLOC_ALIGN - 1));
+	size_t block = start;
+	for (; block < end; block += PYSIMD_EXPR_BLOCK) {
+		const size_t block_size = end - block < PYSIMD_EXPR_BLOCK ? end - block : PYSIMD_EXPR_BLOCK;
+		struct pysimd_vec_t acc = {block_size, scratch, 0};
+		struct pysimd_vec_t out = {block_size, dst->data + block, 0};
+		struct pysimd_vec_t base = {block_size, expr->base->data + block, 0};
+		const struct pysimd_vec_t* lhs = &base;
+		size_t i = 0;
+		if (expr->n_steps == 0) {
+			memmove(out.data, base.data, block_size);
+			continue;
+		}
+		for (; i < expr->n_steps; ++i) {
+			struct pysimd_vec_t operand = {block_size, expr->steps[i].operand->data + block, 0};
+			expr->steps[i].op(i + 1 == expr->n_steps ? &out : &acc, lhs, &operand);
+			lhs = &acc;
+		}
+	}
+}
+
+struct pysimd_expr_task {
+	struct pysimd_vec_t* dst;
+	const struct pysimd_expr_t* expr;
+};
+
+static void pysimd_expr_task_run(void* ctx, size_t start, size_t end)
+{
+	struct pysimd_expr_task* task = (struct pysimd_expr_task*)ctx;
+	pysimd_expr_run_range(task->dst, task->expr, start, end);
+}
+
+// Evaluates the first region bytes of an expression into dst, over the thread pool if large enough
+static void pysimd_expr_run(struct pysimd_vec_t* dst, const struct pysimd_expr_t* expr, size_t region)
+{
+	struct pysimd_expr_task task;
+	if (region < PYSIMD_PARALLEL_MIN || pysimd_pool_get_threads() < 2) {
+		pysimd_expr_run_range(dst, expr, 0, region);
+		return;
+	}
+	task.dst = dst;
+	task.expr = expr;
+	pysimd_pool_parallel_for(region, PYSIMD_PARALLEL_CHUNK, pysimd_expr_task_run, &task);
+}
+
+#endif // PYSIMD_EXPR_H
@@ -0,0 +1,289 @@
+#ifndef SIMD_MAT_H
+#define SIMD_MAT_H
+
+#include "simd_vec_type.h"
+#include "vec_macros.h"
+#include "simd_vec_arith.h"
+
+/* A matrix of f32 or f64 lanes over a range of bytes. Element (i, j) is at
+ * data + i * row_stride + j * col_stride, so rows, columns and transposes of a matrix
+ * are matrices over the same bytes. Matrices made from scratch have a column stride
+ * of one lane, and a row stride padded to PYSIMD_MAT_ROW_ALIGN bytes, so every row
+ * starts on a cache line.
+ */
+struct pysimd_mat_t {
+	unsigned char* data;
+	size_t rows;
+	size_t cols;
+	size_t row_stride;
+	size_t col_stride;
+};
+
+#define PYSIMD_MAT_ROW_ALIGN 64
+
+/* Matrix products are computed by tiles of PYSIMD_GEMM_MR rows of C, and nr columns,
+ * two registers wide, which the tile kernel keeps in registers over the whole of a
+ * block of PYSIMD_GEMM_KC columns of A. Each block of B is first packed, nr columns
+ * at a time, so the kernel reads it in order, PYSIMD_GEMM_NC columns at a time.
+ */
+#define PYSIMD_GEMM_MR 4
+#define PYSIMD_GEMM_NR_MAX 32
+#define PYSIMD_GEMM_KC 256
+#define PYSIMD_GEMM_NC 512
+// Rows of C per piece of work over the thread pool, once there are this many multiply-adds
+#define PYSIMD_GEMM_MC 64
+#define PYSIMD_GEMM_PARALLEL_MIN ((size_t)1 << 22)
+
+// Sets y[i] to the dot product of row i of a, whose lanes are next to each other, and x
+typedef void (*pysimd_mat_gemv_t)(const unsigned char*, size_t, size_t, const unsigned char*, size_t, unsigned char*);
+// Adds s times the first n lanes of x to those of y
+typedef void (*pysimd_mat_axpy_t)(unsigned char*, const unsigned char*, size_t, double);
+/* Adds the product of PYSIMD_GEMM_MR rows of A, k lanes each, given by pointer and
+ * lane stride, and k rows of packed B to a tile of C, given by pointer and row stride.
+ */
+typedef void (*pysimd_mat_tile_t)(size_t, const unsigned char* const*, size_t, const unsigned char*, unsigned char*, size_t);
+
+struct pysimd_gemm_kernel {
+	pysimd_mat_tile_t tile;
+	// Columns of a tile
+	size_t nr;
+};
+
+#define SIMD_MAT_SCALAR(suffix, ctype) \
+static void simd_mat_gemv_##suffix##_scalar(const unsigned char* a, size_t row_stride, size_t rows, \
+	                                         const unsigned char* x, size_t cols, unsigned char* y) { \
+	const ctype* xs = (const ctype*)x; \
+	size_t i = 0; \
+	for (; i < rows; ++i) { \
+		const ctype* row = (const ctype*)(a + i * row_stride); \
+		ctype total = 0; \
+		size_t j = 0; \
+		for (; j < cols; ++j) \
+			total += row[j] * xs[j]; \
+		((ctype*)y)[i] = total; \
+	} \
+} \
+static void simd_mat_axpy_##suffix##_scalar(unsigned char* y, const unsigned char* x, size_t n, double s) { \
+	const ctype scale = (ctype)s; \
+	size_t i = 0; \
+	for (; i < n; ++i) \
+		((ctype*)y)[i] += scale * ((const ctype*)x)[i]; \
+} \
+static void simd_mat_tile_##suffix##_scalar(size_t k, const unsigned char* const* a_rows, size_t a_stride, \
+	                                         const unsigned char* b_pack, unsigned char* c, size_t c_stride) { \
+	ctype acc[PYSIMD_GEMM_MR][4] = {{0}}; \
+	size_t p = 0; \
+	size_t r = 0; \
+	size_t j = 0; \
+	for (; p < k; ++p) { \
+		const ctype* b = (const ctype*)b_pack + p * 4; \
+		for (r = 0; r < PYSIMD_GEMM_MR; ++r) { \
+			const ctype a = *(const ctype*)(a_rows[r] + p * a_stride); \
+			for (j = 0; j < 4; ++j) \
+				acc[r][j] += a * b[j]; \
+		} \
+	} \
+	for (r = 0; r < PYSIMD_GEMM_MR; ++r) \
+		for (j = 0; j < 4; ++j) \
+			((ctype*)(c + r * c_stride))[j] += acc[r][j]; \
+}
+
+SIMD_MAT_SCALAR(f32, float)
+SIMD_MAT_SCALAR(f64, double)
+
+#undef SIMD_MAT_SCALAR
+
+/* The vector kernels of a tier for one lane type, given its a * b + c. gemv takes four
+ * rows at a time, sharing each load of x between them. The rows past the last are read
+ * again from the first of the four, and their results dropped.
+ */
+#define SIMD_MAT_VECTOR(suffix, target, lanes, vtype, ctype, load, store, setzero, set1, add, muladd) \
+static target void simd_mat_gemv_##suffix(const unsigned char* a, size_t row_stride, size_t rows, \
+	                                       const unsigned char* x, size_t cols, unsigned char* y) { \
+	const ctype* xs = (const ctype*)x; \
+	ctype parts[lanes]; \
+	size_t i = 0; \
+	for (; i < rows; i += 4) { \
+		const size_t n_rows = rows - i < 4 ? rows - i : 4; \
+		const ctype* row[4]; \
+		vtype acc[4]; \
+		size_t r = 0; \
+		size_t j = 0; \
+		for (; r < 4; ++r) { \
+			row[r] = (const ctype*)(a + (i + (r < n_rows ? r : 0)) * row_stride); \
+			acc[r] = setzero(); \
+		} \
+		for (; j + (lanes) <= cols; j += (lanes)) { \
+			const vtype xv = load(xs + j); \
+			acc[0] = muladd(load(row[0] + j), xv, acc[0]); \
+			acc[1] = muladd(load(row[1] + j), xv, acc[1]); \
+			acc[2] = muladd(load(row[2] + j), xv, acc[2]); \
+			acc[3] = muladd(load(row[3] + j), xv, acc[3]); \
+		} \
+		for (r = 0; r < n_rows; ++r) { \
+			ctype total = 0; \
+			size_t k = 0; \
+			store(parts, acc[r]); \
+			for (; k < (lanes); ++k) \
+				total += parts[k]; \
+			for (k = j; k < cols; ++k) \
+				total += row[r][k] * xs[k]; \
+			((ctype*)y)[i + r] = total; \
+		} \
+	} \
+} \
+static target void simd_mat_axpy_##suffix(unsigned char* y, const unsigned char* x, size_t n, double s) { \
+	const vtype scale = set1((ctype)s); \
+	ctype* ys = (ctype*)y; \
+	const ctype* xs = (const ctype*)x; \
+	size_t i = 0; \
+	for (; i + (lanes) <= n; i += (lanes)) \
+		store(ys + i, muladd(load(xs + i), scale, load(ys + i))); \
+	for (; i < n; ++i) \
+		ys[i] += (ctype)s * xs[i]; \
+} \
+static target void simd_mat_tile_##suffix(size_t k, const unsigned char* const* a_rows, size_t a_stride, \
+	                                       const unsigned char* b_pack, unsigned char* c, size_t c_stride) { \
+	const ctype* b = (const ctype*)b_pack; \
+	vtype c00 = setzero(), c01 = setzero(), c10 = setzero(), c11 = setzero(); \
+	vtype c20 = setzero(), c21 = setzero(), c30 = setzero(), c31 = setzero(); \
+	size_t p = 0; \
+	for (; p < k; ++p, b += 2 * (lanes)) { \
+		const vtype b0 = load(b); \
+		const vtype b1 = load(b + (lanes)); \
+		vtype av = set1(*(const ctype*)(a_rows[0] + p * a_stride)); \
+		c00 = muladd(av, b0, c00); \
+		c01 = muladd(av, b1, c01); \
+		av = set1(*(const ctype*)(a_rows[1] + p * a_stride)); \
+		c10 = muladd(av, b0, c10); \
+		c11 = muladd(av, b1, c11); \
+		av = set1(*(const ctype*)(a_rows[2] + p * a_stride)); \
+		c20 = muladd(av, b0, c20); \
+		c21 = muladd(av, b1, c21); \
+		av = set1(*(const ctype*)(a_rows[3] + p * a_stride)); \
+		c30 = muladd(av, b0, c30); \
+		c31 = muladd(av, b1, c31); \
+	} \
+	SIMD_MAT_TILE_STORE(c, load, store, add, lanes, ctype, c00, c01); \
+	SIMD_MAT_TILE_STORE(c + c_stride, load, store, add, lanes, ctype, c10, c11); \
+	SIMD_MAT_TILE_STORE(c + 2 * c_stride, load, store, add, lanes, ctype, c20, c21); \
+	SIMD_MAT_TILE_STORE(c + 3 * c_stride, load, store, add, lanes, ctype, c30, c31); \
+}
+
+#define SIMD_MAT_TILE_STORE(row, load, store, add, lanes, ctype, lo, hi) do { \
+	ctype* dst_row = (ctype*)(row); \
+	store(dst_row, add(load(dst_row), lo)); \
+	store(dst_row + (lanes), add(load(dst_row + (lanes)), hi)); \
+} while (0)
+
+#if defined(PYSIMD_X86_SSE2)
+
+SIMD_MAT_VECTOR(f32_sse2, PYSIMD_TARGET_SSE2, 4, __m128, float, _mm_loadu_ps, _mm_storeu_ps, _mm_setzero_ps, _mm_set1_ps, _mm_add_ps,
+	            simd_muladd_ps_sse2)
+SIMD_MAT_VECTOR(f64_sse2, PYSIMD_TARGET_SSE2, 2, __m128d, double, _mm_loadu_pd, _mm_storeu_pd, _mm_setzero_pd, _mm_set1_pd, _mm_add_pd,
+	            simd_muladd_pd_sse2)
+
+#endif // PYSIMD_X86_SSE2
+
+#if defined(PYSIMD_X86_AVX2)
+
+SIMD_MAT_VECTOR(f32_avx2, PYSIMD_TARGET_AVX2, 8, __m256, float, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_setzero_ps, _mm256_set1_ps,
+	            _mm256_add_ps, simd_muladd_ps_avx2)
+SIMD_MAT_VECTOR(f64_avx2, PYSIMD_TARGET_AVX2, 4, __m256d, double, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_setzero_pd, _mm256_set1_pd,
+	            _mm256_add_pd, simd_muladd_pd_avx2)
+
+#if defined(PYSIMD_X86_FMA)
+
+// Bound in place of the kernels above when the cpu reports FMA as well
+SIMD_MAT_VECTOR(f32_fma, PYSIMD_TARGET_FMA, 8, __m256, float, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_setzero_ps, _mm256_set1_ps,
+	            _mm256_add_ps, _mm256_fmadd_ps)
+SIMD_MAT_VECTOR(f64_fma, PYSIMD_TARGET_FMA, 4, __m256d, double, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_setzero_pd, _mm256_set1_pd,
+	            _mm256_add_pd, _mm256_fmadd_pd)
+
+#endif // PYSIMD_X86_FMA
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+SIMD_MAT_VECTOR(f32_avx512, PYSIMD_TARGET_AVX512, 16, __m512, float, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_setzero_ps, _mm512_set1_ps,
+	            _mm512_add_ps, _mm512_fmadd_ps)
+SIMD_MAT_VECTOR(f64_avx512, PYSIMD_TARGET_AVX512, 8, __m512d, double, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_setzero_pd, _mm512_set1_pd,
+	            _mm512_add_pd, _mm512_fmadd_pd)
+
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_MAT_VECTOR
+#undef SIMD_MAT_TILE_STORE
+
+// Reads element (i, j) of a matrix of lanes width bytes wide as a double
+static double simd_mat_get(const struct pysimd_mat_t* mat, size_t width, size_t i, size_t j)
+{
+	const unsigned char* at = mat->data + i * mat->row_stride + j * mat->col_stride;
+	return width == 4 ? (double)*(const float*)at : *(const double*)at;
+}
+
+static void simd_mat_set(struct pysimd_mat_t* mat, size_t width, size_t i, size_t j, double value)
+{
+	unsigned char* at = mat->data + i * mat->row_stride + j * mat->col_stride;
+	if (width == 4)
+		*(float*)at = (float)value;
+	else
+		*(double*)at = value;
+}
+
+/* Copies src into dst of the same shape, whatever their strides. Copies go by square
+ * blocks, so that copying a transposed matrix reads and writes a few cache lines at a
+ * time on both sides.
+ */
+static void simd_mat_copy(struct pysimd_mat_t* dst, const struct pysimd_mat_t* src, size_t width)
+{
+	const size_t block = 32;
+	size_t i0 = 0;
+	size_t j0 = 0;
+	for (; i0 < src->rows; i0 += block) {
+		const size_t i1 = src->rows - i0 < block ? src->rows : i0 + block;
+		for (j0 = 0; j0 < src->cols; j0 += block) {
+			const size_t j1 = src->cols - j0 < block ? src->cols : j0 + block;
+			size_t i = i0;
+			for (; i < i1; ++i) {
+				unsigned char* to = dst->data + i * dst->row_stride;
+				const unsigned char* from = src->data + i * src->row_stride;
+				size_t j = j0;
+				if (src->col_stride == width && dst->col_stride == width) {
+					memcpy(to + j0 * width, from + j0 * width, (j1 - j0) * width);
+					continue;
+				}
+				for (; j < j1; ++j)
+					memcpy(to + j * dst->col_stride, from + j * src->col_stride, width);
+			}
+		}
+	}
+}
+
+/* Packs rows [p0, p0 + kc) and columns [j0, j0 + nc) of b for the tile kernel, nr
+ * columns at a time, each run of nr lanes of a row after the last, zero past the end.
+ */
+static void simd_mat_pack(unsigned char* pack, const struct pysimd_mat_t* b, size_t width, size_t p0, size_t kc,
+	                      size_t j0, size_t nc, size_t nr)
+{
+	size_t s = 0;
+	for (; s < nc; s += nr) {
+		const size_t n_cols = nc - s < nr ? nc - s : nr;
+		size_t p = 0;
+		for (; p < kc; ++p) {
+			const unsigned char* from = b->data + (p0 + p) * b->row_stride + (j0 + s) * b->col_stride;
+			size_t j = 0;
+			if (b->col_stride == width) {
+				memcpy(pack, from, n_cols * width);
+			} else {
+				for (; j < n_cols; ++j)
+					memcpy(pack + j * width, from + j * b->col_stride, width);
+			}
+			memset(pack + n_cols * width, 0, (nr - n_cols) * width);
+			pack += nr * width;
+		}
+	}
+}
+
+#endif // SIMD_MAT_H
@@ -0,0 +1,256 @@
+#ifndef PYSIMD_THREADS_H
+#define PYSIMD_THREADS_H
+
+#include "core_simd_info.h"
+
+#if defined(PYSIMD_OS_WINDOWS)
+#  include <windows.h>
+#else
+#  include <pthread.h>
+#  include <unistd.h>
+#endif
+
+/* A small pool of worker threads, used to split operations on large vectors.
+ * A job is a range of bytes cut into chunks, that the workers and the calling
+ * thread claim one at a time until none are left. Only one job runs at a time,
+ * callers from several threads queue on the submit lock.
+ */
+
+// Operations on at least this many bytes run without holding the GIL
+#define PYSIMD_NOGIL_MIN ((size_t)1 << 16)
+// Operations on at least this many bytes are split across the pool
+#define PYSIMD_PARALLEL_MIN ((size_t)1 << 22)
+// Bytes claimed by a thread at a time, small enough to stay in the L2 cache
+#define PYSIMD_PARALLEL_CHUNK ((size_t)1 << 18)
+
+#if defined(PYSIMD_OS_WINDOWS)
+   typedef SRWLOCK pysimd_mutex_t;
+   typedef CONDITION_VARIABLE pysimd_cond_t;
+   typedef HANDLE pysimd_thread_t;
+#  define PYSIMD_MUTEX_INIT(m) InitializeSRWLock(m)
+#  define PYSIMD_MUTEX_LOCK(m) AcquireSRWLockExclusive(m)
+#  define PYSIMD_MUTEX_UNLOCK(m) ReleaseSRWLockExclusive(m)
+#  define PYSIMD_COND_INIT(c) InitializeConditionVariable(c)
+#  define PYSIMD_COND_WAIT(c, m) SleepConditionVariableSRW(c, m, INFINITE, 0)
+#  define PYSIMD_COND_BROADCAST(c) WakeAllConditionVariable(c)
+#  define PYSIMD_COND_SIGNAL(c) WakeConditionVariable(c)
+#  define PYSIMD_ATOMIC_FETCH_ADD(ptr, val) (size_t)InterlockedExchangeAdd64((volatile LONG64*)(ptr), (LONG64)(val))
+#else
+   typedef pthread_mutex_t pysimd_mutex_t;
+   typedef pthread_cond_t pysimd_cond_t;
+   typedef pthread_t pysimd_thread_t;
+#  define PYSIMD_MUTEX_INIT(m) pthread_mutex_init(m, NULL)
+#  define PYSIMD_MUTEX_LOCK(m) pthread_mutex_lock(m)
+#  define PYSIMD_MUTEX_UNLOCK(m) pthread_mutex_unlock(m)
+#  define PYSIMD_COND_INIT(c) pthread_cond_init(c, NULL)
+#  define PYSIMD_COND_WAIT(c, m) pthread_cond_wait(c, m)
+#  define PYSIMD_COND_BROADCAST(c) pthread_cond_broadcast(c)
+#  define PYSIMD_COND_SIGNAL(c) pthread_cond_signal(c)
+#  define PYSIMD_ATOMIC_FETCH_ADD(ptr, val) __atomic_fetch_add(ptr, val, __ATOMIC_RELAXED)
+#endif
+
+typedef void (*pysimd_task_fn)(void* ctx, size_t start, size_t end);
+
+struct pysimd_pool_job {
+	pysimd_task_fn fn;
+	void* ctx;
+	size_t total;
+	size_t chunk;
+	size_t next;
+};
+
+struct pysimd_pool_t {
+	pysimd_mutex_t submit;
+	pysimd_mutex_t lock;
+	pysimd_cond_t work_ready;
+	pysimd_cond_t work_done;
+	pysimd_thread_t* threads;
+	// Worker threads, the calling thread is not counted
+	size_t n_workers;
+	// Total threads a job is split across, 0 until first configured
+	size_t n_threads;
+	size_t busy;
+	unsigned long generation;
+	// Generation at the time the current workers were started
+	unsigned long spawn_generation;
+	int shutdown;
+	struct pysimd_pool_job job;
+};
+
+static struct pysimd_pool_t pysimd_pool;
+
+static size_t pysimd_cpu_count(void)
+{
+#if defined(PYSIMD_OS_WINDOWS)
+	SYSTEM_INFO sysinfo;
+	GetSystemInfo(&sysinfo);
+	return sysinfo.dwNumberOfProcessors > 0 ? (size_t)sysinfo.dwNumberOfProcessors : 1;
+#else
+	long found = sysconf(_SC_NPROCESSORS_ONLN);
+	return found > 0 ? (size_t)found : 1;
+#endif
+}
+
+static void pysimd_pool_run_chunks(struct pysimd_pool_job* job)
+{
+	size_t start = PYSIMD_ATOMIC_FETCH_ADD(&(job->next), job->chunk);
+	while (start < job->total) {
+		size_t end = start + job->chunk < job->total ? start + job->chunk : job->total;
+		job->fn(job->ctx, start, end);
+		start = PYSIMD_ATOMIC_FETCH_ADD(&(job->next), job->chunk);
+	}
+}
+
+#if defined(PYSIMD_OS_WINDOWS)
+static DWORD WINAPI pysimd_pool_worker(LPVOID arg)
+#else
+static void* pysimd_pool_worker(void* arg)
+#endif
+{
+	struct pysimd_pool_t* pool = (struct pysimd_pool_t*)arg;
+	unsigned long seen = 0;
+	PYSIMD_MUTEX_LOCK(&(pool->lock));
+	seen = pool->spawn_generation;
+	for (;;) {
+		while (!pool->shutdown && pool->generation == seen) {
+			PYSIMD_COND_WAIT(&(pool->work_ready), &(pool->lock));
+		}
+		if (pool->shutdown)
+			break;
+		seen = pool->generation;
+		PYSIMD_MUTEX_UNLOCK(&(pool->lock));
+		pysimd_pool_run_chunks(&(pool->job));
+		PYSIMD_MUTEX_LOCK(&(pool->lock));
+		pool->busy -= 1;
+		if (pool->busy == 0)
+			PYSIMD_COND_SIGNAL(&(pool->work_done));
+	}
+	PYSIMD_MUTEX_UNLOCK(&(pool->lock));
+	return 0;
+}
+
+static void pysimd_pool_stop_workers(struct pysimd_pool_t* pool)
+{
+	size_t i = 0;
+	PYSIMD_MUTEX_LOCK(&(pool->lock));
+	pool->shutdown = 1;
+	PYSIMD_COND_BROADCAST(&(pool->work_ready));
+	PYSIMD_MUTEX_UNLOCK(&(pool->lock));
+	for (; i < pool->n_workers; ++i) {
+#if defined(PYSIMD_OS_WINDOWS)
+		WaitForSingleObject(pool->threads[i], INFINITE);
+		CloseHandle(pool->threads[i]);
+#else
+		pthread_join(pool->threads[i], NULL);
+#endif
+	}
+	free(pool->threads);
+	pool->threads = NULL;
+	pool->n_workers = 0;
+	pool->shutdown = 0;
+}
+
+// Must be called with the submit lock held
+static void pysimd_pool_start_workers(struct pysimd_pool_t* pool, size_t n_threads)
+{
+	size_t i = 0;
+	pool->n_threads = n_threads;
+	pool->spawn_generation = pool->generation;
+	if (n_threads < 2)
+		return;
+	pool->threads = calloc(n_threads - 1, sizeof(pysimd_thread_t));
+	if (pool->threads == NULL)
+		return;
+	for (; i < n_threads - 1; ++i) {
+#if defined(PYSIMD_OS_WINDOWS)
+		pool->threads[i] = CreateThread(NULL, 0, pysimd_pool_worker, pool, 0, NULL);
+		if (pool->threads[i] == NULL)
+			break;
+#else
+		if (pthread_create(&(pool->threads[i]), NULL, pysimd_pool_worker, pool) != 0)
+			break;
+#endif
+		pool->n_workers += 1;
+	}
+}
+
+#if !defined(PYSIMD_OS_WINDOWS)
+// Threads do not survive fork, the child starts over with an unstarted pool
+static void pysimd_pool_atfork_child(void)
+{
+	PYSIMD_MUTEX_INIT(&(pysimd_pool.submit));
+	PYSIMD_MUTEX_INIT(&(pysimd_pool.lock));
+	PYSIMD_COND_INIT(&(pysimd_pool.work_ready));
+	PYSIMD_COND_INIT(&(pysimd_pool.work_done));
+	pysimd_pool.threads = NULL;
+	pysimd_pool.n_workers = 0;
+	pysimd_pool.n_threads = 0;
+	pysimd_pool.busy = 0;
+	pysimd_pool.shutdown = 0;
+}
+#endif
+
+static void pysimd_pool_init(void)
+{
+	PYSIMD_MUTEX_INIT(&(pysimd_pool.submit));
+	PYSIMD_MUTEX_INIT(&(pysimd_pool.lock));
+	PYSIMD_COND_INIT(&(pysimd_pool.work_ready));
+	PYSIMD_COND_INIT(&(pysimd_pool.work_done));
+#if !defined(PYSIMD_OS_WINDOWS)
+	pthread_atfork(NULL, NULL, pysimd_pool_atfork_child);
+#endif
+}
+
+/* Sets the number of threads jobs are split across, including the calling thread.
+ * 0 selects the number of online cpus. Workers are started lazily, by the first job.
+ */
+static void pysimd_pool_set_threads(size_t n_threads)
+{
+	PYSIMD_MUTEX_LOCK(&(pysimd_pool.submit));
+	pysimd_pool_stop_workers(&pysimd_pool);
+	pysimd_pool.n_threads = n_threads;
+	PYSIMD_MUTEX_UNLOCK(&(pysimd_pool.submit));
+}
+
+static size_t pysimd_pool_get_threads(void)
+{
+	return pysimd_pool.n_threads == 0 ? pysimd_cpu_count() : pysimd_pool.n_threads;
+}
+
+/* Calls fn over [0, total) in pieces of chunk bytes, spread over the pool. Returns
+ * once every piece is done. chunk must keep pieces on whatever boundary fn requires.
+ */
+static void pysimd_pool_parallel_for(size_t total, size_t chunk, pysimd_task_fn fn, void* ctx)
+{
+	struct pysimd_pool_t* pool = &pysimd_pool;
+	PYSIMD_MUTEX_LOCK(&(pool->submit));
+	if (pool->threads == NULL) {
+		pysimd_pool_start_workers(pool, pysimd_pool_get_threads());
+	}
+	if (pool->n_workers == 0) {
+		PYSIMD_MUTEX_UNLOCK(&(pool->submit));
+		fn(ctx, 0, total);
+		return;
+	}
+	PYSIMD_MUTEX_LOCK(&(pool->lock));
+	pool->job.fn = fn;
+	pool->job.ctx = ctx;
+	pool->job.total = total;
+	pool->job.chunk = chunk;
+	pool->job.next = 0;
+	pool->busy = pool->n_workers;
+	pool->generation += 1;
+	PYSIMD_COND_BROADCAST(&(pool->work_ready));
+	PYSIMD_MUTEX_UNLOCK(&(pool->lock));
+
+	pysimd_pool_run_chunks(&(pool->job));
+
+	PYSIMD_MUTEX_LOCK(&(pool->lock));
+	while (pool->busy > 0) {
+		PYSIMD_COND_WAIT(&(pool->work_done), &(pool->lock));
+	}
+	PYSIMD_MUTEX_UNLOCK(&(pool->lock));
+	PYSIMD_MUTEX_UNLOCK(&(pool->submit));
+}
+
+#endif // PYSIMD_THREADS_H
@@ -2,43 +2,75 @@
 #define SIMD_VEC_H
 
 #include "simd_vec_type.h"
+#include "simd_alloc.h"
 
 static inline void pysimd_vec_clear(struct pysimd_vec_t* vec) {
 	vec->size = 0;
 	vec->data = NULL;
+	vec->capacity = 0;
 }
 
+/* Vectors of at least this many bytes are written with non-temporal stores, which
+ * go straight to memory instead of evicting the rest of the cache for data that
+ * would not fit in it anyway. Set to the last level cache size on import, unless
+ * the environment variable PYSIMD_STREAM_MIN gives it in bytes.
+ */
+static size_t pysimd_vec_stream_min = PYSIMD_DEFAULT_CACHE_SIZE;
+// How far ahead of the reader streaming copies prefetch
+#define PYSIMD_VEC_PREFETCH_AHEAD 512
+
 static inline void pysimd_vec_clear_data(struct pysimd_vec_t* vec) {
-	unsigned char* cleaner = vec->data;
-	const unsigned char* end = cleaner + vec->size;
-	while (cleaner != end) {
-		*cleaner++ = 0;
-	}
+	memset(vec->data, 0, vec->size);
 }
 
 static void pysimd_vec_init(struct pysimd_vec_t* buf, size_t capacity)
 {
 	buf->size = capacity;
-	buf->data = calloc(1, capacity);
+	buf->data = pysimd_alloc(capacity, 1, &(buf->capacity));
+}
+
+/* Same as pysimd_vec_init, but leaves the contents unspecified, for callers
+ * that overwrite the whole vector right away.
+ */
+static void pysimd_vec_init_raw(struct pysimd_vec_t* buf, size_t capacity)
+{
+	buf->size = capacity;
+	buf->data = pysimd_alloc(capacity, 0, &(buf->capacity));
 }
 
 static int pysimd_vec_resize(struct pysimd_vec_t* buf, size_t new_size) {
 	if (new_size == 0)
 		return 0;
 	size_t old_size = buf->size;
-	buf->size = new_size;
-	buf->data = realloc(buf->data, new_size);
-	while (old_size < new_size) {
+	// Reuse the current block while it is large enough and not mostly unused
+	if (new_size <= buf->capacity && new_size > buf->capacity / 2) {
+		if (new_size > old_size)
+			memset(buf->data + old_size, 0, new_size - old_size);
+		buf->size = new_size;
+		return 1;
+	}
+	size_t new_capacity = 0;
+	uint8_t* new_data = pysimd_alloc(new_size, 0, &new_capacity);
+	if (new_data == NULL)
+		return 0;
+	if (new_size > old_size) {
+		memcpy(new_data, buf->data, old_size);
 		// Must make sure upstream is zeroed
-		buf->data[old_size++] = 0;
+		memset(new_data + old_size, 0, new_size - old_size);
+	} else {
+		memcpy(new_data, buf->data, new_size);
 	}
+	pysimd_free(buf->data, buf->capacity);
+	buf->data = new_data;
+	buf->size = new_size;
+	buf->capacity = new_capacity;
 	return 1;
 }
 
 static void pysimd_vec_deinit(struct pysimd_vec_t* buf)
 {
-	buf->size = 0;
-	free(buf->data);
+	pysimd_free(buf->data, buf->capacity);
+	pysimd_vec_clear(buf);
 }
 
 static char* pysimd_vec_repr(const struct pysimd_vec_t* buf)
@@ -57,59 +89,37 @@ static char* pysimd_vec_repr(const struct pysimd_vec_t* buf)
 	return repr_str;
 }
 
-static int pysimd_vec_copy(struct pysimd_vec_t* dst, 
-	                        const struct pysimd_vec_t* src,
-	                        size_t start,
-	                        size_t end)
+static int pysimd_vec_copy_prepare(struct pysimd_vec_t* dst, size_t start, size_t end)
 {
 	size_t diff = end - start;
 	if (diff % 16 != 0)
 		return 0;
-	pysimd_vec_init(dst, diff);
+	pysimd_vec_init_raw(dst, diff);
+	return dst->data != NULL;
+}
+
+static int pysimd_vec_copy_scalar(struct pysimd_vec_t* dst,
+	                               const struct pysimd_vec_t* src,
+	                               size_t start,
+	                               size_t end)
+{
+	if (!pysimd_vec_copy_prepare(dst, start, end))
+		return 0;
 	const unsigned char* reader = src->data + start;
 	const unsigned char* read_end = src->data + end;
 	unsigned char* writer = dst->data;
 	while (reader < read_end) {
-#if defined(PYSIMD_X86_SSE2)
-		_mm_store_si128((__m128i*)writer, _mm_load_si128((__m128i const*)reader));
-		reader += 16;
-		writer += 16;
-#else
 		*(long long*)writer = *(long long*)reader;
 		writer += sizeof(long long);
 		reader += sizeof(long long);
-#endif
 	}
 	return 1;
 }
 
-static int pysimd_vec_fill(struct pysimd_vec_t* buf, size_t val, unsigned char sizer)
+static int pysimd_vec_fill_scalar(struct pysimd_vec_t* buf, size_t val, unsigned char sizer)
 {
 	unsigned char* data_ptr = buf->data;
 	const unsigned char* data_end = buf->data + buf->size;
-#if defined(PYSIMD_X86_SSE2)
-	__m128i filler;
-	switch (sizer) {
-		case 1:
-		    filler = _mm_set1_epi8((char)val);
-		    break;
-		case 2:
-		    filler = _mm_set1_epi16((short)val);
-		    break;
-		case 4:
-		    filler = _mm_set1_epi32((int)val);
-		    break;
-		case 8:
-		    filler = _mm_set1_epi64x(val);
-		    break;
-		default:
-		    return 0;
-	}
-	while (data_ptr < data_end) {
-		_mm_store_si128((__m128i*)data_ptr, filler);
-		data_ptr += 16;
-	}
-#else
 	char filler[16] = {0};
 	switch (sizer) {
 		case 1:
@@ -139,37 +149,12 @@ static int pysimd_vec_fill(struct pysimd_vec_t* buf, size_t val, unsigned char s
 		*(long long*)data_ptr = *(long long*)filler;
 		data_ptr += 8;
 	}
-#endif
 	return 1;
 }
 
-static int pysimd_vec_fill_float(struct pysimd_vec_t* buf, double val, unsigned char sizer) {
+static int pysimd_vec_fill_float_scalar(struct pysimd_vec_t* buf, double val, unsigned char sizer) {
 	unsigned char* data_ptr = buf->data;
 	const unsigned char* data_end = buf->data + buf->size;
-#if defined(PYSIMD_X86_SSE2)
-	switch (sizer) {
-		case 4:
-		    {
-		    	__m128 filler = _mm_set1_ps((float)val);
-				while (data_ptr < data_end) {
-					_mm_store_ps((float*)data_ptr, filler);
-					data_ptr += 16;
-				}
-		    }
-		    break;
-		case 8:
-		    {
-		    	__m128d filler = _mm_set1_pd(val);
-				while (data_ptr < data_end) {
-					_mm_store_pd((double*)data_ptr, filler);
-					data_ptr += 16;
-				}
-		    }
-		    break;
-		default:
-		    return 0;
-	}
-#else
 	switch (sizer) {
 		case 4:
 		    {
@@ -196,8 +181,330 @@ static int pysimd_vec_fill_float(struct pysimd_vec_t* buf, double val, unsigned
 		default:
 		    return 0;
 	}
-#endif
 	return 1;
 }
 
-#endif // SIMD_DATA_OBJECT_H
\ No newline at end of file
+#if defined(PYSIMD_X86_SSE2)
+
+/* Streams a copy of [reader, read_end) to writer, which must be 16 byte aligned.
+ * The source is prefetched with a non-temporal hint, so it does not evict the cache either.
+ */
+static PYSIMD_TARGET_SSE2 void pysimd_vec_stream_copy_sse2(unsigned char* writer,
+	                                                        const unsigned char* reader,
+	                                                        const unsigned char* read_end)
+{
+	while (reader + 64 <= read_end) {
+		_mm_prefetch((const char*)reader + PYSIMD_VEC_PREFETCH_AHEAD, _MM_HINT_NTA);
+		__m128i part0 = _mm_loadu_si128((__m128i const*)reader);
+		__m128i part1 = _mm_loadu_si128((__m128i const*)(reader + 16));
+		__m128i part2 = _mm_loadu_si128((__m128i const*)(reader + 32));
+		__m128i part3 = _mm_loadu_si128((__m128i const*)(reader + 48));
+		_mm_stream_si128((__m128i*)writer, part0);
+		_mm_stream_si128((__m128i*)(writer + 16), part1);
+		_mm_stream_si128((__m128i*)(writer + 32), part2);
+		_mm_stream_si128((__m128i*)(writer + 48), part3);
+		reader += 64;
+		writer += 64;
+	}
+	while (reader < read_end) {
+		_mm_stream_si128((__m128i*)writer, _mm_loadu_si128((__m128i const*)reader));
+		reader += 16;
+		writer += 16;
+	}
+	_mm_sfence();
+}
+
+static PYSIMD_TARGET_SSE2 int pysimd_vec_copy_sse2(struct pysimd_vec_t* dst,
+	                                                const struct pysimd_vec_t* src,
+	                                                size_t start,
+	                                                size_t end)
+{
+	if (!pysimd_vec_copy_prepare(dst, start, end))
+		return 0;
+	const unsigned char* reader = src->data + start;
+	const unsigned char* read_end = src->data + end;
+	unsigned char* writer = dst->data;
+	if (end - start >= pysimd_vec_stream_min) {
+		pysimd_vec_stream_copy_sse2(writer, reader, read_end);
+		return 1;
+	}
+	while (reader < read_end) {
+		_mm_storeu_si128((__m128i*)writer, _mm_loadu_si128((__m128i const*)reader));
+		reader += 16;
+		writer += 16;
+	}
+	return 1;
+}
+
+static PYSIMD_TARGET_SSE2 void pysimd_vec_fill_m128(struct pysimd_vec_t* buf, __m128i filler)
+{
+	unsigned char* data_ptr = buf->data;
+	const unsigned char* data_end = buf->data + buf->size;
+	if (buf->size >= pysimd_vec_stream_min) {
+		while (data_ptr < data_end) {
+			_mm_stream_si128((__m128i*)data_ptr, filler);
+			data_ptr += 16;
+		}
+		_mm_sfence();
+		return;
+	}
+	while (data_ptr < data_end) {
+		_mm_store_si128((__m128i*)data_ptr, filler);
+		data_ptr += 16;
+	}
+}
+
+static PYSIMD_TARGET_SSE2 int pysimd_vec_fill_sse2(struct pysimd_vec_t* buf, size_t val, unsigned char sizer)
+{
+	switch (sizer) {
+		case 1:
+		    pysimd_vec_fill_m128(buf, _mm_set1_epi8((char)val));
+		    break;
+		case 2:
+		    pysimd_vec_fill_m128(buf, _mm_set1_epi16((short)val));
+		    break;
+		case 4:
+		    pysimd_vec_fill_m128(buf, _mm_set1_epi32((int)val));
+		    break;
+		case 8:
+		    pysimd_vec_fill_m128(buf, _mm_set1_epi64x(val));
+		    break;
+		default:
+		    return 0;
+	}
+	return 1;
+}
+
+static PYSIMD_TARGET_SSE2 int pysimd_vec_fill_float_sse2(struct pysimd_vec_t* buf, double val, unsigned char sizer) {
+	switch (sizer) {
+		case 4:
+		    pysimd_vec_fill_m128(buf, _mm_castps_si128(_mm_set1_ps((float)val)));
+		    break;
+		case 8:
+		    pysimd_vec_fill_m128(buf, _mm_castpd_si128(_mm_set1_pd(val)));
+		    break;
+		default:
+		    return 0;
+	}
+	return 1;
+}
+
+static PYSIMD_TARGET_SSE2 void pysimd_vec_clear_data_sse2(struct pysimd_vec_t* buf)
+{
+	pysimd_vec_fill_m128(buf, _mm_setzero_si128());
+}
+
+#endif // PYSIMD_X86_SSE2
+
+/* The wider variants below step over the vector in full registers, then finish
+ * the remainder in 16 byte steps, as vector sizes are only guaranteed to be
+ * a multiple of 16. Streaming stores need a destination aligned to the full
+ * register, so those first step up to that boundary in 16 byte stores.
+ */
+
+#if defined(PYSIMD_X86_AVX2)
+
+static PYSIMD_TARGET_AVX2 int pysimd_vec_copy_avx2(struct pysimd_vec_t* dst,
+	                                                const struct pysimd_vec_t* src,
+	                                                size_t start,
+	                                                size_t end)
+{
+	if (!pysimd_vec_copy_prepare(dst, start, end))
+		return 0;
+	const unsigned char* reader = src->data + start;
+	const unsigned char* read_end = src->data + end;
+	unsigned char* writer = dst->data;
+	if (end - start >= pysimd_vec_stream_min) {
+		// Owned vector memory is always aligned on 64 bytes
+		while (reader + 64 <= read_end) {
+			_mm_prefetch((const char*)reader + PYSIMD_VEC_PREFETCH_AHEAD, _MM_HINT_NTA);
+			__m256i part0 = _mm256_loadu_si256((__m256i const*)reader);
+			__m256i part1 = _mm256_loadu_si256((__m256i const*)(reader + 32));
+			_mm256_stream_si256((__m256i*)writer, part0);
+			_mm256_stream_si256((__m256i*)(writer + 32), part1);
+			reader += 64;
+			writer += 64;
+		}
+		_mm_sfence();
+	}
+	while (reader + 32 <= read_end) {
+		_mm256_storeu_si256((__m256i*)writer, _mm256_loadu_si256((__m256i const*)reader));
+		reader += 32;
+		writer += 32;
+	}
+	if (reader < read_end) {
+		_mm_storeu_si128((__m128i*)writer, _mm_loadu_si128((__m128i const*)reader));
+	}
+	return 1;
+}
+
+static PYSIMD_TARGET_AVX2 void pysimd_vec_fill_m256(struct pysimd_vec_t* buf, __m256i filler)
+{
+	unsigned char* data_ptr = buf->data;
+	const unsigned char* data_end = buf->data + buf->size;
+	if (buf->size >= pysimd_vec_stream_min) {
+		if (((size_t)data_ptr & 31) != 0) {
+			_mm_store_si128((__m128i*)data_ptr, _mm256_castsi256_si128(filler));
+			data_ptr += 16;
+		}
+		while (data_ptr + 32 <= data_end) {
+			_mm256_stream_si256((__m256i*)data_ptr, filler);
+			data_ptr += 32;
+		}
+		_mm_sfence();
+	}
+	while (data_ptr + 32 <= data_end) {
+		_mm256_storeu_si256((__m256i*)data_ptr, filler);
+		data_ptr += 32;
+	}
+	if (data_ptr < data_end) {
+		_mm_storeu_si128((__m128i*)data_ptr, _mm256_castsi256_si128(filler));
+	}
+}
+
+static PYSIMD_TARGET_AVX2 int pysimd_vec_fill_avx2(struct pysimd_vec_t* buf, size_t val, unsigned char sizer)
+{
+	switch (sizer) {
+		case 1:
+		    pysimd_vec_fill_m256(buf, _mm256_set1_epi8((char)val));
+		    break;
+		case 2:
+		    pysimd_vec_fill_m256(buf, _mm256_set1_epi16((short)val));
+		    break;
+		case 4:
+		    pysimd_vec_fill_m256(buf, _mm256_set1_epi32((int)val));
+		    break;
+		case 8:
+		    pysimd_vec_fill_m256(buf, _mm256_set1_epi64x(val));
+		    break;
+		default:
+		    return 0;
+	}
+	return 1;
+}
+
+static PYSIMD_TARGET_AVX2 int pysimd_vec_fill_float_avx2(struct pysimd_vec_t* buf, double val, unsigned char sizer) {
+	switch (sizer) {
+		case 4:
+		    pysimd_vec_fill_m256(buf, _mm256_castps_si256(_mm256_set1_ps((float)val)));
+		    break;
+		case 8:
+		    pysimd_vec_fill_m256(buf, _mm256_castpd_si256(_mm256_set1_pd(val)));
+		    break;
+		default:
+		    return 0;
+	}
+	return 1;
+}
+
+static PYSIMD_TARGET_AVX2 void pysimd_vec_clear_data_avx2(struct pysimd_vec_t* buf)
+{
+	pysimd_vec_fill_m256(buf, _mm256_setzero_si256());
+}
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+static PYSIMD_TARGET_AVX512 int pysimd_vec_copy_avx512(struct pysimd_vec_t* dst,
+	                                                    const struct pysimd_vec_t* src,
+	                                                    size_t start,
+	                                                    size_t end)
+{
+	if (!pysimd_vec_copy_prepare(dst, start, end))
+		return 0;
+	const unsigned char* reader = src->data + start;
+	const unsigned char* read_end = src->data + end;
+	unsigned char* writer = dst->data;
+	if (end - start >= pysimd_vec_stream_min) {
+		// Owned vector memory is always aligned on 64 bytes
+		while (reader + 64 <= read_end) {
+			_mm_prefetch((const char*)reader + PYSIMD_VEC_PREFETCH_AHEAD, _MM_HINT_NTA);
+			_mm512_stream_si512((void*)writer, _mm512_loadu_si512((void const*)reader));
+			reader += 64;
+			writer += 64;
+		}
+		_mm_sfence();
+	}
+	while (reader + 64 <= read_end) {
+		_mm512_storeu_si512((void*)writer, _mm512_loadu_si512((void const*)reader));
+		reader += 64;
+		writer += 64;
+	}
+	while (reader < read_end) {
+		_mm_storeu_si128((__m128i*)writer, _mm_loadu_si128((__m128i const*)reader));
+		reader += 16;
+		writer += 16;
+	}
+	return 1;
+}
+
+static PYSIMD_TARGET_AVX512 void pysimd_vec_fill_m512(struct pysimd_vec_t* buf, __m512i filler)
+{
+	unsigned char* data_ptr = buf->data;
+	const unsigned char* data_end = buf->data + buf->size;
+	const __m128i tail_filler = _mm512_castsi512_si128(filler);
+	if (buf->size >= pysimd_vec_stream_min) {
+		while (((size_t)data_ptr & 63) != 0 && data_ptr < data_end) {
+			_mm_store_si128((__m128i*)data_ptr, tail_filler);
+			data_ptr += 16;
+		}
+		while (data_ptr + 64 <= data_end) {
+			_mm512_stream_si512((void*)data_ptr, filler);
+			data_ptr += 64;
+		}
+		_mm_sfence();
+	}
+	while (data_ptr + 64 <= data_end) {
+		_mm512_storeu_si512((void*)data_ptr, filler);
+		data_ptr += 64;
+	}
+	while (data_ptr < data_end) {
+		_mm_storeu_si128((__m128i*)data_ptr, tail_filler);
+		data_ptr += 16;
+	}
+}
+
+static PYSIMD_TARGET_AVX512 int pysimd_vec_fill_avx512(struct pysimd_vec_t* buf, size_t val, unsigned char sizer)
+{
+	switch (sizer) {
+		case 1:
+		    pysimd_vec_fill_m512(buf, _mm512_set1_epi8((char)val));
+		    break;
+		case 2:
+		    pysimd_vec_fill_m512(buf, _mm512_set1_epi16((short)val));
+		    break;
+		case 4:
+		    pysimd_vec_fill_m512(buf, _mm512_set1_epi32((int)val));
+		    break;
+		case 8:
+		    pysimd_vec_fill_m512(buf, _mm512_set1_epi64((long long)val));
+		    break;
+		default:
+		    return 0;
+	}
+	return 1;
+}
+
+static PYSIMD_TARGET_AVX512 int pysimd_vec_fill_float_avx512(struct pysimd_vec_t* buf, double val, unsigned char sizer) {
+	switch (sizer) {
+		case 4:
+		    pysimd_vec_fill_m512(buf, _mm512_castps_si512(_mm512_set1_ps((float)val)));
+		    break;
+		case 8:
+		    pysimd_vec_fill_m512(buf, _mm512_castpd_si512(_mm512_set1_pd(val)));
+		    break;
+		default:
+		    return 0;
+	}
+	return 1;
+}
+
+static PYSIMD_TARGET_AVX512 void pysimd_vec_clear_data_avx512(struct pysimd_vec_t* buf)
+{
+	pysimd_vec_fill_m512(buf, _mm512_setzero_si512());
+}
+
+#endif // PYSIMD_X86_AVX512
+
+#endif // SIMD_DATA_OBJECT_H
@@ -3,209 +3,1061 @@
 
 #include "simd_vec_type.h"
 #include "vec_macros.h"
+#include <math.h>
 
-static void simd_vec_add_i8(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
-	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
-	size_t i = 0;
-	while (i < oper_region) {
-#if defined(PYSIMD_X86_SSE2)
-	__m128i v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128i v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128i added = _mm_add_epi8 (v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	v1->data[i] = v1->data[i] + v2->data[i];
-	++i;
-#endif
-	}
+/* Each arithmetic kernel is generated once per instruction set tier, with the
+ * suffix of the tier in its name, like simd_vec_add_i8_sse2. The entry point used
+ * by the module is chosen at import time, see simd_dispatch.h
+ */
+
+/* Binary kernels are three operand, dst = v1 op v2, over the bytes v1 and v2 have in
+ * common. dst must be at least that large, and may be v1 itself to work in place.
+ */
+
+// Integer lanes are processed as unsigned so overflow wraps instead of being undefined
+#define SIMD_VEC_BINOP_SCALAR(name, ctype, op) \
+static void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2); \
+	size_t i = 0; \
+	while (i < oper_region) { \
+		*(ctype*)(dst->data + i) = (*(ctype*)(v1->data + i)) op (*(ctype*)(v2->data + i)); \
+		i += sizeof(ctype); \
+	} \
 }
 
-static void simd_vec_add_i16(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
-	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
-	size_t i = 0;
-	while (i < oper_region) {
-#if defined(PYSIMD_X86_SSE2)
-	__m128i v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128i v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128i added = _mm_add_epi16(v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	*(short*)(v1->data + i) = (*(short*)(v1->data + i)) + (*(short*)(v2->data + i));
-	i += 2;
-#endif
-	}
+SIMD_VEC_BINOP_SCALAR(simd_vec_add_i8_scalar, uint8_t, +)
+SIMD_VEC_BINOP_SCALAR(simd_vec_add_i16_scalar, uint16_t, +)
+SIMD_VEC_BINOP_SCALAR(simd_vec_add_i32_scalar, uint32_t, +)
+SIMD_VEC_BINOP_SCALAR(simd_vec_add_i64_scalar, uint64_t, +)
+SIMD_VEC_BINOP_SCALAR(simd_vec_add_f32_scalar, float, +)
+SIMD_VEC_BINOP_SCALAR(simd_vec_add_f64_scalar, double, +)
+SIMD_VEC_BINOP_SCALAR(simd_vec_sub_i8_scalar, uint8_t, -)
+SIMD_VEC_BINOP_SCALAR(simd_vec_sub_i16_scalar, uint16_t, -)
+SIMD_VEC_BINOP_SCALAR(simd_vec_sub_i32_scalar, uint32_t, -)
+SIMD_VEC_BINOP_SCALAR(simd_vec_sub_i64_scalar, uint64_t, -)
+SIMD_VEC_BINOP_SCALAR(simd_vec_sub_f32_scalar, float, -)
+SIMD_VEC_BINOP_SCALAR(simd_vec_sub_f64_scalar, double, -)
+
+/* Integer products keep either the low half of the double width product, which is the
+ * same for signed and unsigned lanes, or the high half, which is not. The helpers widen
+ * before multiplying, as narrow unsigned types promote to int and could overflow it.
+ */
+static uint16_t simd_mul_u16(uint16_t a, uint16_t b) { return (uint16_t)((uint32_t)a * b); }
+static uint32_t simd_mul_u32(uint32_t a, uint32_t b) { return (uint32_t)((uint64_t)a * b); }
+static uint64_t simd_mul_u64(uint64_t a, uint64_t b) { return a * b; }
+static int16_t simd_mulhi_i16(int16_t a, int16_t b) { return (int16_t)(((int32_t)a * b) >> 16); }
+static uint16_t simd_mulhi_u16(uint16_t a, uint16_t b) { return (uint16_t)(((uint32_t)a * b) >> 16); }
+static int32_t simd_mulhi_i32(int32_t a, int32_t b) { return (int32_t)(((int64_t)a * b) >> 32); }
+static uint32_t simd_mulhi_u32(uint32_t a, uint32_t b) { return (uint32_t)(((uint64_t)a * b) >> 32); }
+
+static uint64_t simd_mulhi_u64(uint64_t a, uint64_t b)
+{
+	const uint64_t a_lo = a & 0xffffffffU;
+	const uint64_t a_hi = a >> 32;
+	const uint64_t b_lo = b & 0xffffffffU;
+	const uint64_t b_hi = b >> 32;
+	const uint64_t hi_lo = a_hi * b_lo;
+	const uint64_t cross = ((a_lo * b_lo) >> 32) + (hi_lo & 0xffffffffU) + a_lo * b_hi;
+	return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
 }
 
-static void simd_vec_add_i32(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
-	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
-	size_t i = 0;
-	while (i < oper_region) {
-#if defined(PYSIMD_X86_SSE2)
-	__m128i v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128i v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128i added = _mm_add_epi32(v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	*(int*)(v1->data + i) = (*(int*)(v1->data + i)) + (*(int*)(v2->data + i));
-	i += 4;
-#endif
-	}
+// The signed high half is the unsigned one, less each operand where the other is negative
+static int64_t simd_mulhi_i64(int64_t a, int64_t b)
+{
+	uint64_t high = simd_mulhi_u64((uint64_t)a, (uint64_t)b);
+	if (a < 0)
+		high -= (uint64_t)b;
+	if (b < 0)
+		high -= (uint64_t)a;
+	return (int64_t)high;
 }
 
-static void simd_vec_add_i64(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
-	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
-	size_t i = 0;
-	while (i < oper_region) {
-#if defined(PYSIMD_X86_SSE2)
-	__m128i v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128i v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128i added = _mm_add_epi64(v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	*(long long*)(v1->data + i) = (*(long long*)(v1->data + i)) + (*(long long*)(v2->data + i));
-	i += 8;
-#endif
-	}
+#define SIMD_VEC_BINOP_SCALAR_FN(name, ctype, fn) \
+static void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2); \
+	size_t i = 0; \
+	while (i < oper_region) { \
+		*(ctype*)(dst->data + i) = fn(*(ctype*)(v1->data + i), *(ctype*)(v2->data + i)); \
+		i += sizeof(ctype); \
+	} \
 }
 
-static void simd_vec_add_f32(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_mul_i16_scalar, uint16_t, simd_mul_u16)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_mul_i32_scalar, uint32_t, simd_mul_u32)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_mul_i64_scalar, uint64_t, simd_mul_u64)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_mulhi_i16_scalar, int16_t, simd_mulhi_i16)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_mulhi_u16_scalar, uint16_t, simd_mulhi_u16)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_mulhi_i32_scalar, int32_t, simd_mulhi_i32)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_mulhi_u32_scalar, uint32_t, simd_mulhi_u32)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_mulhi_i64_scalar, int64_t, simd_mulhi_i64)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_mulhi_u64_scalar, uint64_t, simd_mulhi_u64)
+
+/* Saturating arithmetic clamps results to the range of the lane type instead of
+ * wrapping, which is what pixel and sample data needs.
+ */
+static int8_t simd_adds_i8(int8_t a, int8_t b) { int sum = a + b; return (int8_t)(sum > INT8_MAX ? INT8_MAX : sum < INT8_MIN ? INT8_MIN : sum); }
+static int8_t simd_subs_i8(int8_t a, int8_t b) { int diff = a - b; return (int8_t)(diff > INT8_MAX ? INT8_MAX : diff < INT8_MIN ? INT8_MIN : diff); }
+static uint8_t simd_adds_u8(uint8_t a, uint8_t b) { int sum = a + b; return (uint8_t)(sum > UINT8_MAX ? UINT8_MAX : sum); }
+static uint8_t simd_subs_u8(uint8_t a, uint8_t b) { return (uint8_t)(a > b ? a - b : 0); }
+static int16_t simd_adds_i16(int16_t a, int16_t b) { int32_t sum = (int32_t)a + b; return (int16_t)(sum > INT16_MAX ? INT16_MAX : sum < INT16_MIN ? INT16_MIN : sum); }
+static int16_t simd_subs_i16(int16_t a, int16_t b) { int32_t diff = (int32_t)a - b; return (int16_t)(diff > INT16_MAX ? INT16_MAX : diff < INT16_MIN ? INT16_MIN : diff); }
+static uint16_t simd_adds_u16(uint16_t a, uint16_t b) { uint32_t sum = (uint32_t)a + b; return (uint16_t)(sum > UINT16_MAX ? UINT16_MAX : sum); }
+static uint16_t simd_subs_u16(uint16_t a, uint16_t b) { return (uint16_t)(a > b ? a - b : 0); }
+// Averages round up, like pavgb and pavgw
+static uint8_t simd_avg_u8(uint8_t a, uint8_t b) { return (uint8_t)(((unsigned)a + b + 1) >> 1); }
+static uint16_t simd_avg_u16(uint16_t a, uint16_t b) { return (uint16_t)(((uint32_t)a + b + 1) >> 1); }
+// Absolute differences are unsigned, as that of two signed lanes can exceed the signed range
+static uint8_t simd_absdiff_u8(uint8_t a, uint8_t b) { return (uint8_t)(a > b ? a - b : b - a); }
+static uint16_t simd_absdiff_u16(uint16_t a, uint16_t b) { return (uint16_t)(a > b ? a - b : b - a); }
+static int8_t simd_absdiff_i8(int8_t a, int8_t b) { return (int8_t)(uint8_t)(a > b ? a - b : b - a); }
+static int16_t simd_absdiff_i16(int16_t a, int16_t b) { return (int16_t)(uint16_t)(a > b ? a - b : b - a); }
+
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_adds_i8_scalar, int8_t, simd_adds_i8)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_adds_u8_scalar, uint8_t, simd_adds_u8)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_adds_i16_scalar, int16_t, simd_adds_i16)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_adds_u16_scalar, uint16_t, simd_adds_u16)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_subs_i8_scalar, int8_t, simd_subs_i8)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_subs_u8_scalar, uint8_t, simd_subs_u8)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_subs_i16_scalar, int16_t, simd_subs_i16)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_subs_u16_scalar, uint16_t, simd_subs_u16)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_avg_u8_scalar, uint8_t, simd_avg_u8)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_avg_u16_scalar, uint16_t, simd_avg_u16)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_absdiff_i8_scalar, int8_t, simd_absdiff_i8)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_absdiff_u8_scalar, uint8_t, simd_absdiff_u8)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_absdiff_i16_scalar, int16_t, simd_absdiff_i16)
+SIMD_VEC_BINOP_SCALAR_FN(simd_vec_absdiff_u16_scalar, uint16_t, simd_absdiff_u16)
+
+#undef SIMD_VEC_BINOP_SCALAR_FN
+
+// Sum of the absolute differences of the bytes two vectors have in common
+static uint64_t simd_vec_sad_u8_scalar(const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2)
+{
 	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
+	uint64_t total = 0;
 	size_t i = 0;
-	while (i < oper_region) {
-#if defined(PYSIMD_X86_SSE2)
-	__m128 v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128 v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128 added = _mm_add_ps(v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	*(float*)(v1->data + i) = (*(float*)(v1->data + i)) + (*(float*)(v2->data + i));
-	i += 4;
-#endif
-	}
+	for (; i < oper_region; ++i)
+		total += simd_absdiff_u8(v1->data[i], v2->data[i]);
+	return total;
 }
 
-static void simd_vec_add_f64(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
-	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
-	size_t i = 0;
-	while (i < oper_region) {
-#if defined(PYSIMD_X86_SSE2)
-	__m128d v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128d v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128d added = _mm_add_pd(v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	*(double*)(v1->data + i) = (*(double*)(v1->data + i)) + (*(double*)(v2->data + i));
-	i += 8;
-#endif
-	}
+SIMD_VEC_BINOP_SCALAR(simd_vec_mul_f32_scalar, float, *)
+SIMD_VEC_BINOP_SCALAR(simd_vec_mul_f64_scalar, double, *)
+SIMD_VEC_BINOP_SCALAR(simd_vec_div_f32_scalar, float, /)
+SIMD_VEC_BINOP_SCALAR(simd_vec_div_f64_scalar, double, /)
+
+/* Unary kernels, dst = op src, over the bytes of src. dst must be at least as large,
+ * and may be src itself.
+ */
+#define SIMD_VEC_UNOP_SCALAR(name, ctype, fn) \
+static void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* src) { \
+	size_t i = 0; \
+	while (i < src->size) { \
+		*(ctype*)(dst->data + i) = fn(*(const ctype*)(src->data + i)); \
+		i += sizeof(ctype); \
+	} \
 }
 
-static void simd_vec_sub_i8(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
-	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
-	size_t i = 0;
-	while (i < oper_region) {
-#if defined(PYSIMD_X86_SSE2)
-	__m128i v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128i v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128i added = _mm_sub_epi8 (v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	v1->data[i] = v1->data[i] - v2->data[i];
-	++i;
-#endif
-	}
+SIMD_VEC_UNOP_SCALAR(simd_vec_sqrt_f32_scalar, float, sqrtf)
+SIMD_VEC_UNOP_SCALAR(simd_vec_sqrt_f64_scalar, double, sqrt)
+
+#undef SIMD_VEC_UNOP_SCALAR
+
+/* Ternary kernels, dst = v1 * v2 + v3, over the bytes all three have in common.
+ * Without a fused instruction the product is rounded before the addition.
+ */
+#define SIMD_VEC_FMA_SCALAR(name, ctype) \
+static void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1, \
+	             const struct pysimd_vec_t* v2, const struct pysimd_vec_t* v3) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2) < v3->size ? PYSIMD_MIN_VEC_SIZE(v1, v2) : v3->size; \
+	size_t i = 0; \
+	while (i < oper_region) { \
+		*(ctype*)(dst->data + i) = (*(ctype*)(v1->data + i)) * (*(ctype*)(v2->data + i)) + (*(ctype*)(v3->data + i)); \
+		i += sizeof(ctype); \
+	} \
 }
 
-static void simd_vec_sub_i16(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
-	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
-	size_t i = 0;
-	while (i < oper_region) {
+SIMD_VEC_FMA_SCALAR(simd_vec_fma_f32_scalar, float)
+SIMD_VEC_FMA_SCALAR(simd_vec_fma_f64_scalar, double)
+
+#undef SIMD_VEC_FMA_SCALAR
+
+#undef SIMD_VEC_BINOP_SCALAR
+
 #if defined(PYSIMD_X86_SSE2)
-	__m128i v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128i v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128i added = _mm_sub_epi16(v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	*(short*)(v1->data + i) = (*(short*)(v1->data + i)) - (*(short*)(v2->data + i));
-	i += 2;
-#endif
-	}
+
+#define SIMD_VEC_BINOP_SSE2(name, vtype, ptype, load, store, op) \
+static PYSIMD_TARGET_SSE2 void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2); \
+	size_t i = 0; \
+	while (i < oper_region) { \
+		vtype v1seg = load((ptype const*)(v1->data + i)); \
+		vtype v2seg = load((ptype const*)(v2->data + i)); \
+		store((ptype*)(dst->data + i), op(v1seg, v2seg)); \
+		i += 16; \
+	} \
 }
 
-static void simd_vec_sub_i32(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
-	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
-	size_t i = 0;
-	while (i < oper_region) {
-#if defined(PYSIMD_X86_SSE2)
-	__m128i v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128i v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128i added = _mm_sub_epi32(v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	*(int*)(v1->data + i) = (*(int*)(v1->data + i)) - (*(int*)(v2->data + i));
-	i += 4;
-#endif
-	}
+SIMD_VEC_BINOP_SSE2(simd_vec_add_i8_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_add_epi8)
+SIMD_VEC_BINOP_SSE2(simd_vec_add_i16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_add_epi16)
+SIMD_VEC_BINOP_SSE2(simd_vec_add_i32_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_add_epi32)
+SIMD_VEC_BINOP_SSE2(simd_vec_add_i64_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_add_epi64)
+SIMD_VEC_BINOP_SSE2(simd_vec_add_f32_sse2, __m128, float, _mm_load_ps, _mm_store_ps, _mm_add_ps)
+SIMD_VEC_BINOP_SSE2(simd_vec_add_f64_sse2, __m128d, double, _mm_load_pd, _mm_store_pd, _mm_add_pd)
+SIMD_VEC_BINOP_SSE2(simd_vec_sub_i8_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_sub_epi8)
+SIMD_VEC_BINOP_SSE2(simd_vec_sub_i16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_sub_epi16)
+SIMD_VEC_BINOP_SSE2(simd_vec_sub_i32_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_sub_epi32)
+SIMD_VEC_BINOP_SSE2(simd_vec_sub_i64_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_sub_epi64)
+SIMD_VEC_BINOP_SSE2(simd_vec_sub_f32_sse2, __m128, float, _mm_load_ps, _mm_store_ps, _mm_sub_ps)
+SIMD_VEC_BINOP_SSE2(simd_vec_sub_f64_sse2, __m128d, double, _mm_load_pd, _mm_store_pd, _mm_sub_pd)
+
+// SSE2 has no 32 bit low multiply, the even and odd lanes are multiplied into 64 bit products, then interleaved
+static PYSIMD_TARGET_SSE2 __m128i simd_mullo_epi32_sse2(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
 }
 
-static void simd_vec_sub_i64(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
-	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
-	size_t i = 0;
-	while (i < oper_region) {
-#if defined(PYSIMD_X86_SSE2)
-	__m128i v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128i v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128i added = _mm_sub_epi64(v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	*(long long*)(v1->data + i) = (*(long long*)(v1->data + i)) - (*(long long*)(v2->data + i));
-	i += 8;
-#endif
-	}
+static PYSIMD_TARGET_SSE2 __m128i simd_mulhi_epu32_sse2(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
 }
 
-static void simd_vec_sub_f32(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
-	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
-	size_t i = 0;
-	while (i < oper_region) {
-#if defined(PYSIMD_X86_SSE2)
-	__m128 v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128 v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128 added = _mm_sub_ps(v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	*(float*)(v1->data + i) = (*(float*)(v1->data + i)) - (*(float*)(v2->data + i));
-	i += 4;
+// Nor a signed 32 bit multiply, the unsigned high half is corrected as in simd_mulhi_i64
+static PYSIMD_TARGET_SSE2 __m128i simd_mulhi_epi32_sse2(__m128i a, __m128i b)
+{
+	__m128i high = simd_mulhi_epu32_sse2(a, b);
+	high = _mm_sub_epi32(high, _mm_and_si128(_mm_srai_epi32(a, 31), b));
+	return _mm_sub_epi32(high, _mm_and_si128(_mm_srai_epi32(b, 31), a));
+}
+
+// The low half of a 64 bit product only needs the low by low product and the two cross products
+static PYSIMD_TARGET_SSE2 __m128i simd_mullo_epi64_sse2(__m128i a, __m128i b)
+{
+	__m128i cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), b), _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+	return _mm_add_epi64(_mm_mul_epu32(a, b), _mm_slli_epi64(cross, 32));
+}
+
+SIMD_VEC_BINOP_SSE2(simd_vec_mul_i16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_mullo_epi16)
+SIMD_VEC_BINOP_SSE2(simd_vec_mul_i32_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, simd_mullo_epi32_sse2)
+SIMD_VEC_BINOP_SSE2(simd_vec_mul_i64_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, simd_mullo_epi64_sse2)
+SIMD_VEC_BINOP_SSE2(simd_vec_mulhi_i16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_mulhi_epi16)
+SIMD_VEC_BINOP_SSE2(simd_vec_mulhi_u16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_mulhi_epu16)
+SIMD_VEC_BINOP_SSE2(simd_vec_mulhi_i32_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, simd_mulhi_epi32_sse2)
+SIMD_VEC_BINOP_SSE2(simd_vec_mulhi_u32_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, simd_mulhi_epu32_sse2)
+SIMD_VEC_BINOP_SSE2(simd_vec_mul_f32_sse2, __m128, float, _mm_load_ps, _mm_store_ps, _mm_mul_ps)
+SIMD_VEC_BINOP_SSE2(simd_vec_mul_f64_sse2, __m128d, double, _mm_load_pd, _mm_store_pd, _mm_mul_pd)
+SIMD_VEC_BINOP_SSE2(simd_vec_div_f32_sse2, __m128, float, _mm_load_ps, _mm_store_ps, _mm_div_ps)
+SIMD_VEC_BINOP_SSE2(simd_vec_div_f64_sse2, __m128d, double, _mm_load_pd, _mm_store_pd, _mm_div_pd)
+
+/* Absolute differences of unsigned lanes are the saturating differences both ways
+ * combined, one of which is 0. Signed lanes are moved to the unsigned range first,
+ * by flipping the sign bit, which leaves their differences unchanged.
+ */
+static PYSIMD_TARGET_SSE2 __m128i simd_absdiff_epu8_sse2(__m128i a, __m128i b) { return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a)); }
+static PYSIMD_TARGET_SSE2 __m128i simd_absdiff_epu16_sse2(__m128i a, __m128i b) { return _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a)); }
+static PYSIMD_TARGET_SSE2 __m128i simd_absdiff_epi8_sse2(__m128i a, __m128i b)
+{
+	const __m128i flip = _mm_set1_epi8((char)0x80);
+	return simd_absdiff_epu8_sse2(_mm_xor_si128(a, flip), _mm_xor_si128(b, flip));
+}
+static PYSIMD_TARGET_SSE2 __m128i simd_absdiff_epi16_sse2(__m128i a, __m128i b)
+{
+	const __m128i flip = _mm_set1_epi16((short)0x8000);
+	return simd_absdiff_epu16_sse2(_mm_xor_si128(a, flip), _mm_xor_si128(b, flip));
+}
+
+SIMD_VEC_BINOP_SSE2(simd_vec_adds_i8_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_adds_epi8)
+SIMD_VEC_BINOP_SSE2(simd_vec_adds_u8_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_adds_epu8)
+SIMD_VEC_BINOP_SSE2(simd_vec_adds_i16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_adds_epi16)
+SIMD_VEC_BINOP_SSE2(simd_vec_adds_u16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_adds_epu16)
+SIMD_VEC_BINOP_SSE2(simd_vec_subs_i8_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_subs_epi8)
+SIMD_VEC_BINOP_SSE2(simd_vec_subs_u8_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_subs_epu8)
+SIMD_VEC_BINOP_SSE2(simd_vec_subs_i16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_subs_epi16)
+SIMD_VEC_BINOP_SSE2(simd_vec_subs_u16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_subs_epu16)
+SIMD_VEC_BINOP_SSE2(simd_vec_avg_u8_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_avg_epu8)
+SIMD_VEC_BINOP_SSE2(simd_vec_avg_u16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, _mm_avg_epu16)
+SIMD_VEC_BINOP_SSE2(simd_vec_absdiff_i8_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, simd_absdiff_epi8_sse2)
+SIMD_VEC_BINOP_SSE2(simd_vec_absdiff_u8_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, simd_absdiff_epu8_sse2)
+SIMD_VEC_BINOP_SSE2(simd_vec_absdiff_i16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, simd_absdiff_epi16_sse2)
+SIMD_VEC_BINOP_SSE2(simd_vec_absdiff_u16_sse2, __m128i, __m128i, _mm_load_si128, _mm_store_si128, simd_absdiff_epu16_sse2)
+
+#undef SIMD_VEC_BINOP_SSE2
+
+/* psadbw sums the absolute differences of eight bytes into a 64 bit lane, two
+ * accumulators are kept to overlap the latency.
+ */
+#define SIMD_VEC_SAD(name, target, width, vtype, ptype, load, storeu, zero, sad, add64) \
+static target uint64_t name(const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2); \
+	const unsigned char* v1data = v1->data; \
+	const unsigned char* v2data = v2->data; \
+	vtype acc0 = zero(); \
+	vtype acc1 = zero(); \
+	uint64_t lanes[(width) / 8]; \
+	uint64_t total = 0; \
+	size_t i = 0; \
+	size_t j = 0; \
+	while (i + 2 * (width) <= oper_region) { \
+		acc0 = add64(acc0, sad(load((ptype const*)(v1data + i)), load((ptype const*)(v2data + i)))); \
+		acc1 = add64(acc1, sad(load((ptype const*)(v1data + i + (width))), load((ptype const*)(v2data + i + (width))))); \
+		i += 2 * (width); \
+	} \
+	while (i + (width) <= oper_region) { \
+		acc0 = add64(acc0, sad(load((ptype const*)(v1data + i)), load((ptype const*)(v2data + i)))); \
+		i += (width); \
+	} \
+	storeu((ptype*)lanes, add64(acc0, acc1)); \
+	for (j = 0; j < (width) / 8; ++j) \
+		total += lanes[j]; \
+	for (; i < oper_region; ++i) \
+		total += simd_absdiff_u8(v1data[i], v2data[i]); \
+	return total; \
+}
+
+SIMD_VEC_SAD(simd_vec_sad_u8_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_setzero_si128, _mm_sad_epu8, _mm_add_epi64)
+
+#define SIMD_VEC_UNOP_SSE2(name, vtype, ptype, load, store, op) \
+static PYSIMD_TARGET_SSE2 void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* src) { \
+	size_t i = 0; \
+	while (i < src->size) { \
+		store((ptype*)(dst->data + i), op(load((ptype const*)(src->data + i)))); \
+		i += 16; \
+	} \
+}
+
+SIMD_VEC_UNOP_SSE2(simd_vec_sqrt_f32_sse2, __m128, float, _mm_load_ps, _mm_store_ps, _mm_sqrt_ps)
+SIMD_VEC_UNOP_SSE2(simd_vec_sqrt_f64_sse2, __m128d, double, _mm_load_pd, _mm_store_pd, _mm_sqrt_pd)
+
+#undef SIMD_VEC_UNOP_SSE2
+
+static PYSIMD_TARGET_SSE2 __m128 simd_muladd_ps_sse2(__m128 a, __m128 b, __m128 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+static PYSIMD_TARGET_SSE2 __m128d simd_muladd_pd_sse2(__m128d a, __m128d b, __m128d c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+
+#define SIMD_VEC_TERNOP_SSE2(name, vtype, ptype, load, store, op) \
+static PYSIMD_TARGET_SSE2 void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1, \
+	                                const struct pysimd_vec_t* v2, const struct pysimd_vec_t* v3) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2) < v3->size ? PYSIMD_MIN_VEC_SIZE(v1, v2) : v3->size; \
+	size_t i = 0; \
+	while (i < oper_region) { \
+		vtype v1seg = load((ptype const*)(v1->data + i)); \
+		vtype v2seg = load((ptype const*)(v2->data + i)); \
+		vtype v3seg = load((ptype const*)(v3->data + i)); \
+		store((ptype*)(dst->data + i), op(v1seg, v2seg, v3seg)); \
+		i += 16; \
+	} \
+}
+
+SIMD_VEC_TERNOP_SSE2(simd_vec_fma_f32_sse2, __m128, float, _mm_load_ps, _mm_store_ps, simd_muladd_ps_sse2)
+SIMD_VEC_TERNOP_SSE2(simd_vec_fma_f64_sse2, __m128d, double, _mm_load_pd, _mm_store_pd, simd_muladd_pd_sse2)
+
+#undef SIMD_VEC_TERNOP_SSE2
+
+/* The wide kernels keep four registers of each operand in flight per iteration,
+ * then step one register at a time. Whatever is left is less than a register wide,
+ * but a multiple of 16 bytes, and is handed to the sse2 kernel.
+ */
+#define SIMD_VEC_BINOP_WIDE(name, target, width, vtype, ptype, load, store, op, tail) \
+static target void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2); \
+	unsigned char* dstdata = dst->data; \
+	const unsigned char* v1data = v1->data; \
+	const unsigned char* v2data = v2->data; \
+	size_t i = 0; \
+	while (i + 4 * (width) <= oper_region) { \
+		vtype v1seg0 = load((ptype const*)(v1data + i)); \
+		vtype v1seg1 = load((ptype const*)(v1data + i + (width))); \
+		vtype v1seg2 = load((ptype const*)(v1data + i + 2 * (width))); \
+		vtype v1seg3 = load((ptype const*)(v1data + i + 3 * (width))); \
+		vtype v2seg0 = load((ptype const*)(v2data + i)); \
+		vtype v2seg1 = load((ptype const*)(v2data + i + (width))); \
+		vtype v2seg2 = load((ptype const*)(v2data + i + 2 * (width))); \
+		vtype v2seg3 = load((ptype const*)(v2data + i + 3 * (width))); \
+		store((ptype*)(dstdata + i), op(v1seg0, v2seg0)); \
+		store((ptype*)(dstdata + i + (width)), op(v1seg1, v2seg1)); \
+		store((ptype*)(dstdata + i + 2 * (width)), op(v1seg2, v2seg2)); \
+		store((ptype*)(dstdata + i + 3 * (width)), op(v1seg3, v2seg3)); \
+		i += 4 * (width); \
+	} \
+	while (i + (width) <= oper_region) { \
+		vtype v1seg = load((ptype const*)(v1data + i)); \
+		vtype v2seg = load((ptype const*)(v2data + i)); \
+		store((ptype*)(dstdata + i), op(v1seg, v2seg)); \
+		i += (width); \
+	} \
+	if (i < oper_region) { \
+		struct pysimd_vec_t dstrest = {oper_region - i, dst->data + i}; \
+		struct pysimd_vec_t v1rest = {oper_region - i, v1->data + i}; \
+		struct pysimd_vec_t v2rest = {oper_region - i, v2->data + i}; \
+		tail(&dstrest, &v1rest, &v2rest); \
+	} \
+}
+
+#define SIMD_VEC_UNOP_WIDE(name, target, width, vtype, ptype, load, store, op, tail) \
+static target void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* src) { \
+	unsigned char* dstdata = dst->data; \
+	const unsigned char* srcdata = src->data; \
+	size_t i = 0; \
+	while (i + 4 * (width) <= src->size) { \
+		vtype seg0 = load((ptype const*)(srcdata + i)); \
+		vtype seg1 = load((ptype const*)(srcdata + i + (width))); \
+		vtype seg2 = load((ptype const*)(srcdata + i + 2 * (width))); \
+		vtype seg3 = load((ptype const*)(srcdata + i + 3 * (width))); \
+		store((ptype*)(dstdata + i), op(seg0)); \
+		store((ptype*)(dstdata + i + (width)), op(seg1)); \
+		store((ptype*)(dstdata + i + 2 * (width)), op(seg2)); \
+		store((ptype*)(dstdata + i + 3 * (width)), op(seg3)); \
+		i += 4 * (width); \
+	} \
+	while (i + (width) <= src->size) { \
+		store((ptype*)(dstdata + i), op(load((ptype const*)(srcdata + i)))); \
+		i += (width); \
+	} \
+	if (i < src->size) { \
+		struct pysimd_vec_t dstrest = {src->size - i, dst->data + i}; \
+		struct pysimd_vec_t srcrest = {src->size - i, src->data + i}; \
+		tail(&dstrest, &srcrest); \
+	} \
+}
+
+#define SIMD_VEC_TERNOP_WIDE(name, target, width, vtype, ptype, load, store, op, tail) \
+static target void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1, \
+	                    const struct pysimd_vec_t* v2, const struct pysimd_vec_t* v3) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2) < v3->size ? PYSIMD_MIN_VEC_SIZE(v1, v2) : v3->size; \
+	unsigned char* dstdata = dst->data; \
+	const unsigned char* v1data = v1->data; \
+	const unsigned char* v2data = v2->data; \
+	const unsigned char* v3data = v3->data; \
+	size_t i = 0; \
+	while (i + 2 * (width) <= oper_region) { \
+		vtype v1seg0 = load((ptype const*)(v1data + i)); \
+		vtype v1seg1 = load((ptype const*)(v1data + i + (width))); \
+		vtype v2seg0 = load((ptype const*)(v2data + i)); \
+		vtype v2seg1 = load((ptype const*)(v2data + i + (width))); \
+		vtype v3seg0 = load((ptype const*)(v3data + i)); \
+		vtype v3seg1 = load((ptype const*)(v3data + i + (width))); \
+		store((ptype*)(dstdata + i), op(v1seg0, v2seg0, v3seg0)); \
+		store((ptype*)(dstdata + i + (width)), op(v1seg1, v2seg1, v3seg1)); \
+		i += 2 * (width); \
+	} \
+	while (i + (width) <= oper_region) { \
+		store((ptype*)(dstdata + i), op(load((ptype const*)(v1data + i)), load((ptype const*)(v2data + i)), \
+		                                load((ptype const*)(v3data + i)))); \
+		i += (width); \
+	} \
+	if (i < oper_region) { \
+		struct pysimd_vec_t dstrest = {oper_region - i, dst->data + i}; \
+		struct pysimd_vec_t v1rest = {oper_region - i, v1->data + i}; \
+		struct pysimd_vec_t v2rest = {oper_region - i, v2->data + i}; \
+		struct pysimd_vec_t v3rest = {oper_region - i, v3->data + i}; \
+		tail(&dstrest, &v1rest, &v2rest, &v3rest); \
+	} \
+}
+
+#if defined(PYSIMD_X86_AVX2)
+
+SIMD_VEC_BINOP_WIDE(simd_vec_add_i8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_add_epi8, simd_vec_add_i8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_add_i16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_add_epi16, simd_vec_add_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_add_i32_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_add_epi32, simd_vec_add_i32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_add_i64_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_add_epi64, simd_vec_add_i64_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_add_f32_avx2, PYSIMD_TARGET_AVX2, 32, __m256, float, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps, simd_vec_add_f32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_add_f64_avx2, PYSIMD_TARGET_AVX2, 32, __m256d, double, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, simd_vec_add_f64_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_i8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_sub_epi8, simd_vec_sub_i8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_i16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_sub_epi16, simd_vec_sub_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_i32_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_sub_epi32, simd_vec_sub_i32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_i64_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_sub_epi64, simd_vec_sub_i64_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_f32_avx2, PYSIMD_TARGET_AVX2, 32, __m256, float, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_sub_ps, simd_vec_sub_f32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_f64_avx2, PYSIMD_TARGET_AVX2, 32, __m256d, double, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_sub_pd, simd_vec_sub_f64_sse2)
+
+// The high halves of the even lane products are shifted down, the odd lane products already have theirs in place
+static PYSIMD_TARGET_AVX2 __m256i simd_mulhi_epu32_avx2(__m256i a, __m256i b)
+{
+	__m256i even = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
+	__m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+	return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_mulhi_epi32_avx2(__m256i a, __m256i b)
+{
+	__m256i even = _mm256_srli_epi64(_mm256_mul_epi32(a, b), 32);
+	__m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+	return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_mullo_epi64_avx2(__m256i a, __m256i b)
+{
+	__m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+	return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+}
+
+static PYSIMD_TARGET_AVX2 __m256 simd_muladd_ps_avx2(__m256 a, __m256 b, __m256 c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+static PYSIMD_TARGET_AVX2 __m256d simd_muladd_pd_avx2(__m256d a, __m256d b, __m256d c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+
+SIMD_VEC_BINOP_WIDE(simd_vec_mul_i16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_mullo_epi16, simd_vec_mul_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mul_i32_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_mullo_epi32, simd_vec_mul_i32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mul_i64_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, simd_mullo_epi64_avx2, simd_vec_mul_i64_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mulhi_i16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_mulhi_epi16, simd_vec_mulhi_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mulhi_u16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_mulhi_epu16, simd_vec_mulhi_u16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mulhi_i32_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, simd_mulhi_epi32_avx2, simd_vec_mulhi_i32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mulhi_u32_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, simd_mulhi_epu32_avx2, simd_vec_mulhi_u32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mul_f32_avx2, PYSIMD_TARGET_AVX2, 32, __m256, float, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_mul_ps, simd_vec_mul_f32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mul_f64_avx2, PYSIMD_TARGET_AVX2, 32, __m256d, double, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_mul_pd, simd_vec_mul_f64_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_div_f32_avx2, PYSIMD_TARGET_AVX2, 32, __m256, float, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_div_ps, simd_vec_div_f32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_div_f64_avx2, PYSIMD_TARGET_AVX2, 32, __m256d, double, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_div_pd, simd_vec_div_f64_sse2)
+
+static PYSIMD_TARGET_AVX2 __m256i simd_absdiff_epu8_avx2(__m256i a, __m256i b) { return _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_absdiff_epu16_avx2(__m256i a, __m256i b) { return _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_absdiff_epi8_avx2(__m256i a, __m256i b) { return _mm256_sub_epi8(_mm256_max_epi8(a, b), _mm256_min_epi8(a, b)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_absdiff_epi16_avx2(__m256i a, __m256i b) { return _mm256_sub_epi16(_mm256_max_epi16(a, b), _mm256_min_epi16(a, b)); }
+
+SIMD_VEC_BINOP_WIDE(simd_vec_adds_i8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_adds_epi8, simd_vec_adds_i8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_adds_u8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_adds_epu8, simd_vec_adds_u8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_adds_i16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_adds_epi16, simd_vec_adds_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_adds_u16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_adds_epu16, simd_vec_adds_u16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_subs_i8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_subs_epi8, simd_vec_subs_i8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_subs_u8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_subs_epu8, simd_vec_subs_u8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_subs_i16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_subs_epi16, simd_vec_subs_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_subs_u16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_subs_epu16, simd_vec_subs_u16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_avg_u8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_avg_epu8, simd_vec_avg_u8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_avg_u16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_avg_epu16, simd_vec_avg_u16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_absdiff_i8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, simd_absdiff_epi8_avx2, simd_vec_absdiff_i8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_absdiff_u8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, simd_absdiff_epu8_avx2, simd_vec_absdiff_u8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_absdiff_i16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, simd_absdiff_epi16_avx2, simd_vec_absdiff_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_absdiff_u16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, simd_absdiff_epu16_avx2, simd_vec_absdiff_u16_sse2)
+SIMD_VEC_SAD(simd_vec_sad_u8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_setzero_si256, _mm256_sad_epu8, _mm256_add_epi64)
+SIMD_VEC_UNOP_WIDE(simd_vec_sqrt_f32_avx2, PYSIMD_TARGET_AVX2, 32, __m256, float, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_sqrt_ps, simd_vec_sqrt_f32_sse2)
+SIMD_VEC_UNOP_WIDE(simd_vec_sqrt_f64_avx2, PYSIMD_TARGET_AVX2, 32, __m256d, double, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_sqrt_pd, simd_vec_sqrt_f64_sse2)
+SIMD_VEC_TERNOP_WIDE(simd_vec_fma_f32_avx2, PYSIMD_TARGET_AVX2, 32, __m256, float, _mm256_loadu_ps, _mm256_storeu_ps, simd_muladd_ps_avx2, simd_vec_fma_f32_sse2)
+SIMD_VEC_TERNOP_WIDE(simd_vec_fma_f64_avx2, PYSIMD_TARGET_AVX2, 32, __m256d, double, _mm256_loadu_pd, _mm256_storeu_pd, simd_muladd_pd_avx2, simd_vec_fma_f64_sse2)
+
+#if defined(PYSIMD_X86_FMA)
+
+/* FMA is a separate cpuid bit from AVX2, these are only bound when the cpu reports both.
+ * The tails are fused as well, by 16 byte variants, so every lane is rounded once.
+ */
+SIMD_VEC_TERNOP_WIDE(simd_vec_fma_f32_fma128, PYSIMD_TARGET_FMA, 16, __m128, float, _mm_loadu_ps, _mm_storeu_ps, _mm_fmadd_ps, simd_vec_fma_f32_sse2)
+SIMD_VEC_TERNOP_WIDE(simd_vec_fma_f64_fma128, PYSIMD_TARGET_FMA, 16, __m128d, double, _mm_loadu_pd, _mm_storeu_pd, _mm_fmadd_pd, simd_vec_fma_f64_sse2)
+SIMD_VEC_TERNOP_WIDE(simd_vec_fma_f32_fma, PYSIMD_TARGET_FMA, 32, __m256, float, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_fmadd_ps, simd_vec_fma_f32_fma128)
+SIMD_VEC_TERNOP_WIDE(simd_vec_fma_f64_fma, PYSIMD_TARGET_FMA, 32, __m256d, double, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_fmadd_pd, simd_vec_fma_f64_fma128)
+
+#endif // PYSIMD_X86_FMA
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+SIMD_VEC_BINOP_WIDE(simd_vec_add_i8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_add_epi8, simd_vec_add_i8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_add_i16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_add_epi16, simd_vec_add_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_add_i32_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_add_epi32, simd_vec_add_i32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_add_i64_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_add_epi64, simd_vec_add_i64_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_add_f32_avx512, PYSIMD_TARGET_AVX512, 64, __m512, void, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_add_ps, simd_vec_add_f32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_add_f64_avx512, PYSIMD_TARGET_AVX512, 64, __m512d, void, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_add_pd, simd_vec_add_f64_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_i8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_sub_epi8, simd_vec_sub_i8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_i16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_sub_epi16, simd_vec_sub_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_i32_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_sub_epi32, simd_vec_sub_i32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_i64_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_sub_epi64, simd_vec_sub_i64_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_f32_avx512, PYSIMD_TARGET_AVX512, 64, __m512, void, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_sub_ps, simd_vec_sub_f32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_sub_f64_avx512, PYSIMD_TARGET_AVX512, 64, __m512d, void, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_sub_pd, simd_vec_sub_f64_sse2)
+
+static PYSIMD_TARGET_AVX512 __m512i simd_mulhi_epu32_avx512(__m512i a, __m512i b)
+{
+	__m512i even = _mm512_srli_epi64(_mm512_mul_epu32(a, b), 32);
+	__m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+	return _mm512_mask_blend_epi32(0xAAAA, even, odd);
+}
+
+static PYSIMD_TARGET_AVX512 __m512i simd_mulhi_epi32_avx512(__m512i a, __m512i b)
+{
+	__m512i even = _mm512_srli_epi64(_mm512_mul_epi32(a, b), 32);
+	__m512i odd = _mm512_mul_epi32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+	return _mm512_mask_blend_epi32(0xAAAA, even, odd);
+}
+
+// vpmullq is AVX-512DQ, which the 512 bit tier does not require
+static PYSIMD_TARGET_AVX512 __m512i simd_mullo_epi64_avx512(__m512i a, __m512i b)
+{
+	__m512i cross = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(a, 32), b), _mm512_mul_epu32(a, _mm512_srli_epi64(b, 32)));
+	return _mm512_add_epi64(_mm512_mul_epu32(a, b), _mm512_slli_epi64(cross, 32));
+}
+
+SIMD_VEC_BINOP_WIDE(simd_vec_mul_i16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_mullo_epi16, simd_vec_mul_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mul_i32_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_mullo_epi32, simd_vec_mul_i32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mul_i64_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, simd_mullo_epi64_avx512, simd_vec_mul_i64_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mulhi_i16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_mulhi_epi16, simd_vec_mulhi_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mulhi_u16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_mulhi_epu16, simd_vec_mulhi_u16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mulhi_i32_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, simd_mulhi_epi32_avx512, simd_vec_mulhi_i32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mulhi_u32_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, simd_mulhi_epu32_avx512, simd_vec_mulhi_u32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mul_f32_avx512, PYSIMD_TARGET_AVX512, 64, __m512, void, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_mul_ps, simd_vec_mul_f32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_mul_f64_avx512, PYSIMD_TARGET_AVX512, 64, __m512d, void, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_mul_pd, simd_vec_mul_f64_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_div_f32_avx512, PYSIMD_TARGET_AVX512, 64, __m512, void, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_div_ps, simd_vec_div_f32_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_div_f64_avx512, PYSIMD_TARGET_AVX512, 64, __m512d, void, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_div_pd, simd_vec_div_f64_sse2)
+
+static PYSIMD_TARGET_AVX512 __m512i simd_absdiff_epu8_avx512(__m512i a, __m512i b) { return _mm512_or_si512(_mm512_subs_epu8(a, b), _mm512_subs_epu8(b, a)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_absdiff_epu16_avx512(__m512i a, __m512i b) { return _mm512_or_si512(_mm512_subs_epu16(a, b), _mm512_subs_epu16(b, a)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_absdiff_epi8_avx512(__m512i a, __m512i b) { return _mm512_sub_epi8(_mm512_max_epi8(a, b), _mm512_min_epi8(a, b)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_absdiff_epi16_avx512(__m512i a, __m512i b) { return _mm512_sub_epi16(_mm512_max_epi16(a, b), _mm512_min_epi16(a, b)); }
+
+SIMD_VEC_BINOP_WIDE(simd_vec_adds_i8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_adds_epi8, simd_vec_adds_i8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_adds_u8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_adds_epu8, simd_vec_adds_u8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_adds_i16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_adds_epi16, simd_vec_adds_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_adds_u16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_adds_epu16, simd_vec_adds_u16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_subs_i8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_subs_epi8, simd_vec_subs_i8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_subs_u8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_subs_epu8, simd_vec_subs_u8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_subs_i16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_subs_epi16, simd_vec_subs_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_subs_u16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_subs_epu16, simd_vec_subs_u16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_avg_u8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_avg_epu8, simd_vec_avg_u8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_avg_u16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_avg_epu16, simd_vec_avg_u16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_absdiff_i8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, simd_absdiff_epi8_avx512, simd_vec_absdiff_i8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_absdiff_u8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, simd_absdiff_epu8_avx512, simd_vec_absdiff_u8_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_absdiff_i16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, simd_absdiff_epi16_avx512, simd_vec_absdiff_i16_sse2)
+SIMD_VEC_BINOP_WIDE(simd_vec_absdiff_u16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, simd_absdiff_epu16_avx512, simd_vec_absdiff_u16_sse2)
+SIMD_VEC_SAD(simd_vec_sad_u8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_setzero_si512, _mm512_sad_epu8, _mm512_add_epi64)
+SIMD_VEC_UNOP_WIDE(simd_vec_sqrt_f32_avx512, PYSIMD_TARGET_AVX512, 64, __m512, void, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_sqrt_ps, simd_vec_sqrt_f32_sse2)
+SIMD_VEC_UNOP_WIDE(simd_vec_sqrt_f64_avx512, PYSIMD_TARGET_AVX512, 64, __m512d, void, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_sqrt_pd, simd_vec_sqrt_f64_sse2)
+#if defined(PYSIMD_X86_FMA)
+// Every cpu with AVX-512F also has FMA
+SIMD_VEC_TERNOP_WIDE(simd_vec_fma_f32_avx512, PYSIMD_TARGET_AVX512, 64, __m512, void, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_fmadd_ps, simd_vec_fma_f32_fma128)
+SIMD_VEC_TERNOP_WIDE(simd_vec_fma_f64_avx512, PYSIMD_TARGET_AVX512, 64, __m512d, void, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_fmadd_pd, simd_vec_fma_f64_fma128)
 #endif
-	}
+
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_VEC_BINOP_WIDE
+#undef SIMD_VEC_UNOP_WIDE
+#undef SIMD_VEC_TERNOP_WIDE
+#undef SIMD_VEC_SAD
+
+#endif // PYSIMD_X86_SSE2
+
+/* Reductions fold every lane of a vector into one value, returned widened to 64 bits.
+ * Integer sums are exact up to 64 bits, as narrow lanes are summed in wider
+ * accumulators, and 64 bit lanes wrap. Float sums are accumulated in doubles, with
+ * Kahan compensation for f64. Min and max start from the identity of the operation,
+ * so NaN lanes, which never compare, are skipped.
+ */
+
+#define SIMD_VEC_SUM_SCALAR(name, ctype, acctype, field) \
+static union pysimd_lane_value name(const struct pysimd_vec_t* vec) { \
+	const ctype* reader = (const ctype*)(vec->data); \
+	const size_t n_lanes = vec->size / sizeof(ctype); \
+	acctype acc = 0; \
+	size_t i = 0; \
+	union pysimd_lane_value result; \
+	for (; i < n_lanes; ++i) \
+		acc += reader[i]; \
+	result.field = acc; \
+	return result; \
 }
 
-static void simd_vec_sub_f64(struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) {
-	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
+SIMD_VEC_SUM_SCALAR(simd_vec_sum_i8_scalar, int8_t, int64_t, i)
+SIMD_VEC_SUM_SCALAR(simd_vec_sum_u8_scalar, uint8_t, uint64_t, u)
+SIMD_VEC_SUM_SCALAR(simd_vec_sum_i16_scalar, int16_t, int64_t, i)
+SIMD_VEC_SUM_SCALAR(simd_vec_sum_u16_scalar, uint16_t, uint64_t, u)
+SIMD_VEC_SUM_SCALAR(simd_vec_sum_i32_scalar, int32_t, int64_t, i)
+SIMD_VEC_SUM_SCALAR(simd_vec_sum_u32_scalar, uint32_t, uint64_t, u)
+SIMD_VEC_SUM_SCALAR(simd_vec_sum_i64_scalar, uint64_t, uint64_t, u)
+SIMD_VEC_SUM_SCALAR(simd_vec_sum_f32_scalar, float, double, f)
+
+#undef SIMD_VEC_SUM_SCALAR
+
+// Adds value to a Kahan sum, the compensation carries the low order bits each addition loses
+static void simd_kahan_add(double* sum, double* compensation, double value)
+{
+	const double corrected = value - *compensation;
+	const double next = *sum + corrected;
+	*compensation = (next - *sum) - corrected;
+	*sum = next;
+}
+
+static union pysimd_lane_value simd_vec_sum_f64_scalar(const struct pysimd_vec_t* vec)
+{
+	const double* reader = (const double*)(vec->data);
+	const size_t n_lanes = vec->size / sizeof(double);
+	double sum = 0.0;
+	double compensation = 0.0;
 	size_t i = 0;
-	while (i < oper_region) {
+	union pysimd_lane_value result;
+	for (; i < n_lanes; ++i)
+		simd_kahan_add(&sum, &compensation, reader[i]);
+	result.f = sum;
+	return result;
+}
+
+#define SIMD_VEC_MINMAX_SCALAR(name, ctype, field, init, cmp) \
+static union pysimd_lane_value name(const struct pysimd_vec_t* vec) { \
+	const ctype* reader = (const ctype*)(vec->data); \
+	const size_t n_lanes = vec->size / sizeof(ctype); \
+	ctype best = init; \
+	size_t i = 0; \
+	union pysimd_lane_value result; \
+	for (; i < n_lanes; ++i) { \
+		if (reader[i] cmp best) \
+			best = reader[i]; \
+	} \
+	result.field = best; \
+	return result; \
+}
+
+SIMD_VEC_MINMAX_SCALAR(simd_vec_min_i8_scalar, int8_t, i, INT8_MAX, <)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_min_u8_scalar, uint8_t, u, UINT8_MAX, <)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_min_i16_scalar, int16_t, i, INT16_MAX, <)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_min_u16_scalar, uint16_t, u, UINT16_MAX, <)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_min_i32_scalar, int32_t, i, INT32_MAX, <)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_min_u32_scalar, uint32_t, u, UINT32_MAX, <)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_min_i64_scalar, int64_t, i, INT64_MAX, <)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_min_u64_scalar, uint64_t, u, UINT64_MAX, <)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_min_f32_scalar, float, f, (float)HUGE_VAL, <)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_min_f64_scalar, double, f, HUGE_VAL, <)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_max_i8_scalar, int8_t, i, INT8_MIN, >)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_max_u8_scalar, uint8_t, u, 0, >)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_max_i16_scalar, int16_t, i, INT16_MIN, >)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_max_u16_scalar, uint16_t, u, 0, >)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_max_i32_scalar, int32_t, i, INT32_MIN, >)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_max_u32_scalar, uint32_t, u, 0, >)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_max_i64_scalar, int64_t, i, INT64_MIN, >)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_max_u64_scalar, uint64_t, u, 0, >)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_max_f32_scalar, float, f, -(float)HUGE_VAL, >)
+SIMD_VEC_MINMAX_SCALAR(simd_vec_max_f64_scalar, double, f, -HUGE_VAL, >)
+
+#undef SIMD_VEC_MINMAX_SCALAR
+
 #if defined(PYSIMD_X86_SSE2)
-	__m128d v1seg = _mm_load_si128((__m128i const*)(v1->data + i));
-	__m128d v2seg = _mm_load_si128((__m128i const*)(v2->data + i));
-	__m128d added = _mm_sub_pd(v1seg, v2seg);
-	_mm_storeu_si128 ((__m128i*)(v1->data + i), added);
-	i += 16;
-#else
-	*(double*)(v1->data + i) = (*(double*)(v1->data + i)) - (*(double*)(v2->data + i));
-	i += 8;
-#endif
-	}
+
+/* Byte sums go through psadbw against zero, which adds eight bytes into a 64 bit lane.
+ * Signed bytes are biased to unsigned by flipping the sign bit, and the bias is taken
+ * back out of the total, which may wrap through zero on the way.
+ */
+#define SIMD_VEC_SUM_BYTES(name, target, width, vtype, ptype, load, storeu, zero, set1, xorv, sad, add64, bias) \
+static target union pysimd_lane_value name(const struct pysimd_vec_t* vec) { \
+	const unsigned char* data = vec->data; \
+	const size_t size = vec->size; \
+	const vtype flip = set1((char)(bias)); \
+	vtype acc0 = zero(); \
+	vtype acc1 = zero(); \
+	uint64_t lanes[(width) / 8]; \
+	uint64_t total = 0; \
+	size_t i = 0; \
+	size_t j = 0; \
+	union pysimd_lane_value result; \
+	while (i + 2 * (width) <= size) { \
+		acc0 = add64(acc0, sad(xorv(load((ptype const*)(data + i)), flip), zero())); \
+		acc1 = add64(acc1, sad(xorv(load((ptype const*)(data + i + (width))), flip), zero())); \
+		i += 2 * (width); \
+	} \
+	while (i + (width) <= size) { \
+		acc0 = add64(acc0, sad(xorv(load((ptype const*)(data + i)), flip), zero())); \
+		i += (width); \
+	} \
+	storeu((ptype*)lanes, add64(acc0, acc1)); \
+	for (j = 0; j < (width) / 8; ++j) \
+		total += lanes[j]; \
+	for (; i < size; ++i) \
+		total += (uint8_t)(data[i] ^ (bias)); \
+	result.u = total - (uint64_t)(bias) * size; \
+	return result; \
+}
+
+/* Word sums multiply add against ones, which adds pairs of words into 32 bit lanes.
+ * Those are folded into a 64 bit total often enough that they cannot overflow. Unsigned
+ * words are biased to signed by flipping the sign bit.
+ */
+#define SIMD_VEC_SUM_WORDS(name, target, width, vtype, ptype, load, storeu, zero, set1, xorv, madd, add32, bias) \
+static target union pysimd_lane_value name(const struct pysimd_vec_t* vec) { \
+	const unsigned char* data = vec->data; \
+	const size_t size = vec->size; \
+	const vtype flip = set1((short)(bias)); \
+	const vtype ones = set1(1); \
+	int32_t lanes[(width) / 4]; \
+	int64_t total = 0; \
+	size_t i = 0; \
+	size_t j = 0; \
+	union pysimd_lane_value result; \
+	while (i + (width) <= size) { \
+		vtype acc = zero(); \
+		size_t block_end = size - i > ((size_t)(width) << 14) ? i + ((size_t)(width) << 14) : size; \
+		while (i + (width) <= block_end) { \
+			acc = add32(acc, madd(xorv(load((ptype const*)(data + i)), flip), ones)); \
+			i += (width); \
+		} \
+		storeu((ptype*)lanes, acc); \
+		for (j = 0; j < (width) / 4; ++j) \
+			total += lanes[j]; \
+	} \
+	for (; i < size; i += 2) \
+		total += (int16_t)(*(const uint16_t*)(data + i) ^ (bias)); \
+	result.u = (uint64_t)total + (uint64_t)(bias) * (size / 2); \
+	return result; \
+}
+
+/* Sums that widen each register into two halves of 64 bit lanes before adding them.
+ * acctype is the 64 bit type of the accumulator lanes, and ctype the lane type, for
+ * the scalar tail.
+ */
+#define SIMD_VEC_SUM_WIDEN(name, target, width, vtype, wtype, ptype, wptype, load, storeu, zero, widen_lo, widen_hi, add, ctype, acctype, field) \
+static target union pysimd_lane_value name(const struct pysimd_vec_t* vec) { \
+	const unsigned char* data = vec->data; \
+	const size_t size = vec->size; \
+	wtype acc0 = zero(); \
+	wtype acc1 = zero(); \
+	wtype acc2 = zero(); \
+	wtype acc3 = zero(); \
+	acctype lanes[(width) / 8]; \
+	acctype total = 0; \
+	size_t i = 0; \
+	size_t j = 0; \
+	union pysimd_lane_value result; \
+	while (i + 2 * (width) <= size) { \
+		vtype seg0 = load((ptype const*)(data + i)); \
+		vtype seg1 = load((ptype const*)(data + i + (width))); \
+		acc0 = add(acc0, widen_lo(seg0)); \
+		acc1 = add(acc1, widen_hi(seg0)); \
+		acc2 = add(acc2, widen_lo(seg1)); \
+		acc3 = add(acc3, widen_hi(seg1)); \
+		i += 2 * (width); \
+	} \
+	while (i + (width) <= size) { \
+		vtype seg0 = load((ptype const*)(data + i)); \
+		acc0 = add(acc0, widen_lo(seg0)); \
+		acc1 = add(acc1, widen_hi(seg0)); \
+		i += (width); \
+	} \
+	storeu((wptype*)lanes, add(add(acc0, acc1), add(acc2, acc3))); \
+	for (j = 0; j < (width) / 8; ++j) \
+		total += lanes[j]; \
+	for (; i < size; i += sizeof(ctype)) \
+		total += *(const ctype*)(data + i); \
+	result.field = total; \
+	return result; \
+}
+
+// Vector Kahan summation of doubles, with two independent sums to hide the add latency
+#define SIMD_VEC_SUM_KAHAN(name, target, width, vtype, load, storeu, zero, add, sub) \
+static target union pysimd_lane_value name(const struct pysimd_vec_t* vec) { \
+	const unsigned char* data = vec->data; \
+	const size_t size = vec->size; \
+	vtype sum0 = zero(); \
+	vtype sum1 = zero(); \
+	vtype comp0 = zero(); \
+	vtype comp1 = zero(); \
+	double sums[(width) / 8]; \
+	double comps[(width) / 8]; \
+	double sum = 0.0; \
+	double compensation = 0.0; \
+	size_t i = 0; \
+	size_t j = 0; \
+	union pysimd_lane_value result; \
+	while (i + 2 * (width) <= size) { \
+		vtype corrected0 = sub(load((double const*)(data + i)), comp0); \
+		vtype corrected1 = sub(load((double const*)(data + i + (width))), comp1); \
+		vtype next0 = add(sum0, corrected0); \
+		vtype next1 = add(sum1, corrected1); \
+		comp0 = sub(sub(next0, sum0), corrected0); \
+		comp1 = sub(sub(next1, sum1), corrected1); \
+		sum0 = next0; \
+		sum1 = next1; \
+		i += 2 * (width); \
+	} \
+	storeu(sums, sum0); \
+	storeu(comps, comp0); \
+	for (j = 0; j < (width) / 8; ++j) { \
+		simd_kahan_add(&sum, &compensation, sums[j]); \
+		simd_kahan_add(&sum, &compensation, -comps[j]); \
+	} \
+	storeu(sums, sum1); \
+	storeu(comps, comp1); \
+	for (j = 0; j < (width) / 8; ++j) { \
+		simd_kahan_add(&sum, &compensation, sums[j]); \
+		simd_kahan_add(&sum, &compensation, -comps[j]); \
+	} \
+	for (; i < size; i += 8) \
+		simd_kahan_add(&sum, &compensation, *(const double*)(data + i)); \
+	result.f = sum; \
+	return result; \
+}
+
+/* Min and max keep four accumulators in flight, then fold them and the lanes of the
+ * result in scalar, along with whatever is left that is less than a register wide.
+ * The new lanes are the first operand of op, so NaN lanes leave the accumulator as is.
+ */
+#define SIMD_VEC_MINMAX_WIDE(name, target, width, vtype, ptype, load, storeu, set1, settype, op, ctype, field, init, cmp) \
+static target union pysimd_lane_value name(const struct pysimd_vec_t* vec) { \
+	const unsigned char* data = vec->data; \
+	const size_t size = vec->size; \
+	vtype acc0 = set1((settype)(init)); \
+	vtype acc1 = acc0; \
+	vtype acc2 = acc0; \
+	vtype acc3 = acc0; \
+	ctype lanes[(width) / sizeof(ctype)]; \
+	ctype best = init; \
+	size_t i = 0; \
+	size_t j = 0; \
+	union pysimd_lane_value result; \
+	while (i + 4 * (width) <= size) { \
+		acc0 = op(load((ptype const*)(data + i)), acc0); \
+		acc1 = op(load((ptype const*)(data + i + (width))), acc1); \
+		acc2 = op(load((ptype const*)(data + i + 2 * (width))), acc2); \
+		acc3 = op(load((ptype const*)(data + i + 3 * (width))), acc3); \
+		i += 4 * (width); \
+	} \
+	while (i + (width) <= size) { \
+		acc0 = op(load((ptype const*)(data + i)), acc0); \
+		i += (width); \
+	} \
+	storeu((ptype*)lanes, op(op(acc0, acc1), op(acc2, acc3))); \
+	for (j = 0; j < (width) / sizeof(ctype); ++j) { \
+		if (lanes[j] cmp best) \
+			best = lanes[j]; \
+	} \
+	for (; i < size; i += sizeof(ctype)) { \
+		if (*(const ctype*)(data + i) cmp best) \
+			best = *(const ctype*)(data + i); \
+	} \
+	result.field = best; \
+	return result; \
 }
 
+static PYSIMD_TARGET_SSE2 __m128i simd_widen_lo_i32_sse2(__m128i x) { return _mm_unpacklo_epi32(x, _mm_srai_epi32(x, 31)); }
+static PYSIMD_TARGET_SSE2 __m128i simd_widen_hi_i32_sse2(__m128i x) { return _mm_unpackhi_epi32(x, _mm_srai_epi32(x, 31)); }
+static PYSIMD_TARGET_SSE2 __m128i simd_widen_lo_u32_sse2(__m128i x) { return _mm_unpacklo_epi32(x, _mm_setzero_si128()); }
+static PYSIMD_TARGET_SSE2 __m128i simd_widen_hi_u32_sse2(__m128i x) { return _mm_unpackhi_epi32(x, _mm_setzero_si128()); }
+static PYSIMD_TARGET_SSE2 __m128i simd_widen_i64_sse2(__m128i x) { return x; }
+static PYSIMD_TARGET_SSE2 __m128i simd_widen_none_sse2(__m128i x) { return _mm_setzero_si128(); }
+static PYSIMD_TARGET_SSE2 __m128d simd_widen_lo_f32_sse2(__m128 x) { return _mm_cvtps_pd(x); }
+static PYSIMD_TARGET_SSE2 __m128d simd_widen_hi_f32_sse2(__m128 x) { return _mm_cvtps_pd(_mm_movehl_ps(x, x)); }
+
+SIMD_VEC_SUM_BYTES(simd_vec_sum_i8_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_setzero_si128, _mm_set1_epi8, _mm_xor_si128, _mm_sad_epu8, _mm_add_epi64, 0x80)
+SIMD_VEC_SUM_BYTES(simd_vec_sum_u8_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_setzero_si128, _mm_set1_epi8, _mm_xor_si128, _mm_sad_epu8, _mm_add_epi64, 0)
+SIMD_VEC_SUM_WORDS(simd_vec_sum_i16_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_setzero_si128, _mm_set1_epi16, _mm_xor_si128, _mm_madd_epi16, _mm_add_epi32, 0)
+SIMD_VEC_SUM_WORDS(simd_vec_sum_u16_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_setzero_si128, _mm_set1_epi16, _mm_xor_si128, _mm_madd_epi16, _mm_add_epi32, 0x8000)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_i32_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_setzero_si128, simd_widen_lo_i32_sse2, simd_widen_hi_i32_sse2, _mm_add_epi64, int32_t, int64_t, i)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_u32_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_setzero_si128, simd_widen_lo_u32_sse2, simd_widen_hi_u32_sse2, _mm_add_epi64, uint32_t, uint64_t, u)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_i64_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_setzero_si128, simd_widen_i64_sse2, simd_widen_none_sse2, _mm_add_epi64, uint64_t, uint64_t, u)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_f32_sse2, PYSIMD_TARGET_SSE2, 16, __m128, __m128d, float, double, _mm_load_ps, _mm_storeu_pd, _mm_setzero_pd, simd_widen_lo_f32_sse2, simd_widen_hi_f32_sse2, _mm_add_pd, float, double, f)
+SIMD_VEC_SUM_KAHAN(simd_vec_sum_f64_sse2, PYSIMD_TARGET_SSE2, 16, __m128d, _mm_load_pd, _mm_storeu_pd, _mm_setzero_pd, _mm_add_pd, _mm_sub_pd)
+
+// SSE2 only has min and max for unsigned bytes and signed words, the rest stay scalar on this tier
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_u8_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_set1_epi8, char, _mm_min_epu8, uint8_t, u, UINT8_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_i16_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_set1_epi16, short, _mm_min_epi16, int16_t, i, INT16_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_f32_sse2, PYSIMD_TARGET_SSE2, 16, __m128, float, _mm_load_ps, _mm_storeu_ps, _mm_set1_ps, float, _mm_min_ps, float, f, (float)HUGE_VAL, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_f64_sse2, PYSIMD_TARGET_SSE2, 16, __m128d, double, _mm_load_pd, _mm_storeu_pd, _mm_set1_pd, double, _mm_min_pd, double, f, HUGE_VAL, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_u8_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_set1_epi8, char, _mm_max_epu8, uint8_t, u, 0, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_i16_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_set1_epi16, short, _mm_max_epi16, int16_t, i, INT16_MIN, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_f32_sse2, PYSIMD_TARGET_SSE2, 16, __m128, float, _mm_load_ps, _mm_storeu_ps, _mm_set1_ps, float, _mm_max_ps, float, f, -(float)HUGE_VAL, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_f64_sse2, PYSIMD_TARGET_SSE2, 16, __m128d, double, _mm_load_pd, _mm_storeu_pd, _mm_set1_pd, double, _mm_max_pd, double, f, -HUGE_VAL, >)
+
+#if defined(PYSIMD_X86_AVX2)
+
+static PYSIMD_TARGET_AVX2 __m256i simd_widen_lo_i32_avx2(__m256i x) { return _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_widen_hi_i32_avx2(__m256i x) { return _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_widen_lo_u32_avx2(__m256i x) { return _mm256_cvtepu32_epi64(_mm256_castsi256_si128(x)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_widen_hi_u32_avx2(__m256i x) { return _mm256_cvtepu32_epi64(_mm256_extracti128_si256(x, 1)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_widen_i64_avx2(__m256i x) { return x; }
+static PYSIMD_TARGET_AVX2 __m256i simd_widen_none_avx2(__m256i x) { return _mm256_setzero_si256(); }
+static PYSIMD_TARGET_AVX2 __m256d simd_widen_lo_f32_avx2(__m256 x) { return _mm256_cvtps_pd(_mm256_castps256_ps128(x)); }
+static PYSIMD_TARGET_AVX2 __m256d simd_widen_hi_f32_avx2(__m256 x) { return _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)); }
+
+// AVX2 has no 64 bit min or max, so those compare and blend, unsigned lanes compare with the sign bit flipped
+static PYSIMD_TARGET_AVX2 __m256i simd_min_i64_avx2(__m256i a, __m256i b) { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_max_i64_avx2(__m256i a, __m256i b) { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_min_u64_avx2(__m256i a, __m256i b)
+{
+	const __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+	return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign)));
+}
+static PYSIMD_TARGET_AVX2 __m256i simd_max_u64_avx2(__m256i a, __m256i b)
+{
+	const __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+	return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign)));
+}
+
+SIMD_VEC_SUM_BYTES(simd_vec_sum_i8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_setzero_si256, _mm256_set1_epi8, _mm256_xor_si256, _mm256_sad_epu8, _mm256_add_epi64, 0x80)
+SIMD_VEC_SUM_BYTES(simd_vec_sum_u8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_setzero_si256, _mm256_set1_epi8, _mm256_xor_si256, _mm256_sad_epu8, _mm256_add_epi64, 0)
+SIMD_VEC_SUM_WORDS(simd_vec_sum_i16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_setzero_si256, _mm256_set1_epi16, _mm256_xor_si256, _mm256_madd_epi16, _mm256_add_epi32, 0)
+SIMD_VEC_SUM_WORDS(simd_vec_sum_u16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_setzero_si256, _mm256_set1_epi16, _mm256_xor_si256, _mm256_madd_epi16, _mm256_add_epi32, 0x8000)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_i32_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_setzero_si256, simd_widen_lo_i32_avx2, simd_widen_hi_i32_avx2, _mm256_add_epi64, int32_t, int64_t, i)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_u32_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_setzero_si256, simd_widen_lo_u32_avx2, simd_widen_hi_u32_avx2, _mm256_add_epi64, uint32_t, uint64_t, u)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_i64_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_setzero_si256, simd_widen_i64_avx2, simd_widen_none_avx2, _mm256_add_epi64, uint64_t, uint64_t, u)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_f32_avx2, PYSIMD_TARGET_AVX2, 32, __m256, __m256d, float, double, _mm256_loadu_ps, _mm256_storeu_pd, _mm256_setzero_pd, simd_widen_lo_f32_avx2, simd_widen_hi_f32_avx2, _mm256_add_pd, float, double, f)
+SIMD_VEC_SUM_KAHAN(simd_vec_sum_f64_avx2, PYSIMD_TARGET_AVX2, 32, __m256d, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_setzero_pd, _mm256_add_pd, _mm256_sub_pd)
+
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_i8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi8, char, _mm256_min_epi8, int8_t, i, INT8_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_u8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi8, char, _mm256_min_epu8, uint8_t, u, UINT8_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_i16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi16, short, _mm256_min_epi16, int16_t, i, INT16_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_u16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi16, short, _mm256_min_epu16, uint16_t, u, UINT16_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_i32_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi32, int, _mm256_min_epi32, int32_t, i, INT32_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_u32_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi32, int, _mm256_min_epu32, uint32_t, u, UINT32_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_i64_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi64x, long long, simd_min_i64_avx2, int64_t, i, INT64_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_u64_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi64x, long long, simd_min_u64_avx2, uint64_t, u, UINT64_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_f32_avx2, PYSIMD_TARGET_AVX2, 32, __m256, float, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, float, _mm256_min_ps, float, f, (float)HUGE_VAL, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_f64_avx2, PYSIMD_TARGET_AVX2, 32, __m256d, double, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, double, _mm256_min_pd, double, f, HUGE_VAL, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_i8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi8, char, _mm256_max_epi8, int8_t, i, INT8_MIN, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_u8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi8, char, _mm256_max_epu8, uint8_t, u, 0, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_i16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi16, short, _mm256_max_epi16, int16_t, i, INT16_MIN, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_u16_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi16, short, _mm256_max_epu16, uint16_t, u, 0, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_i32_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi32, int, _mm256_max_epi32, int32_t, i, INT32_MIN, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_u32_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi32, int, _mm256_max_epu32, uint32_t, u, 0, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_i64_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi64x, long long, simd_max_i64_avx2, int64_t, i, INT64_MIN, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_u64_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi64x, long long, simd_max_u64_avx2, uint64_t, u, 0, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_f32_avx2, PYSIMD_TARGET_AVX2, 32, __m256, float, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, float, _mm256_max_ps, float, f, -(float)HUGE_VAL, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_f64_avx2, PYSIMD_TARGET_AVX2, 32, __m256d, double, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, double, _mm256_max_pd, double, f, -HUGE_VAL, >)
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+static PYSIMD_TARGET_AVX512 __m512i simd_widen_lo_i32_avx512(__m512i x) { return _mm512_cvtepi32_epi64(_mm512_castsi512_si256(x)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_widen_hi_i32_avx512(__m512i x) { return _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(x, 1)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_widen_lo_u32_avx512(__m512i x) { return _mm512_cvtepu32_epi64(_mm512_castsi512_si256(x)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_widen_hi_u32_avx512(__m512i x) { return _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(x, 1)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_widen_i64_avx512(__m512i x) { return x; }
+static PYSIMD_TARGET_AVX512 __m512i simd_widen_none_avx512(__m512i x) { return _mm512_setzero_si512(); }
+static PYSIMD_TARGET_AVX512 __m512d simd_widen_lo_f32_avx512(__m512 x) { return _mm512_cvtps_pd(_mm512_castps512_ps256(x)); }
+static PYSIMD_TARGET_AVX512 __m512d simd_widen_hi_f32_avx512(__m512 x)
+{
+	return _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(x), 1)));
+}
+
+SIMD_VEC_SUM_BYTES(simd_vec_sum_i8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_setzero_si512, _mm512_set1_epi8, _mm512_xor_si512, _mm512_sad_epu8, _mm512_add_epi64, 0x80)
+SIMD_VEC_SUM_BYTES(simd_vec_sum_u8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_setzero_si512, _mm512_set1_epi8, _mm512_xor_si512, _mm512_sad_epu8, _mm512_add_epi64, 0)
+SIMD_VEC_SUM_WORDS(simd_vec_sum_i16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_setzero_si512, _mm512_set1_epi16, _mm512_xor_si512, _mm512_madd_epi16, _mm512_add_epi32, 0)
+SIMD_VEC_SUM_WORDS(simd_vec_sum_u16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_setzero_si512, _mm512_set1_epi16, _mm512_xor_si512, _mm512_madd_epi16, _mm512_add_epi32, 0x8000)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_i32_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, __m512i, void, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_setzero_si512, simd_widen_lo_i32_avx512, simd_widen_hi_i32_avx512, _mm512_add_epi64, int32_t, int64_t, i)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_u32_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, __m512i, void, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_setzero_si512, simd_widen_lo_u32_avx512, simd_widen_hi_u32_avx512, _mm512_add_epi64, uint32_t, uint64_t, u)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_i64_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, __m512i, void, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_setzero_si512, simd_widen_i64_avx512, simd_widen_none_avx512, _mm512_add_epi64, uint64_t, uint64_t, u)
+SIMD_VEC_SUM_WIDEN(simd_vec_sum_f32_avx512, PYSIMD_TARGET_AVX512, 64, __m512, __m512d, float, double, _mm512_loadu_ps, _mm512_storeu_pd, _mm512_setzero_pd, simd_widen_lo_f32_avx512, simd_widen_hi_f32_avx512, _mm512_add_pd, float, double, f)
+SIMD_VEC_SUM_KAHAN(simd_vec_sum_f64_avx512, PYSIMD_TARGET_AVX512, 64, __m512d, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_setzero_pd, _mm512_add_pd, _mm512_sub_pd)
+
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_i8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi8, char, _mm512_min_epi8, int8_t, i, INT8_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_u8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi8, char, _mm512_min_epu8, uint8_t, u, UINT8_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_i16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi16, short, _mm512_min_epi16, int16_t, i, INT16_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_u16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi16, short, _mm512_min_epu16, uint16_t, u, UINT16_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_i32_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi32, int, _mm512_min_epi32, int32_t, i, INT32_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_u32_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi32, int, _mm512_min_epu32, uint32_t, u, UINT32_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_i64_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi64, long long, _mm512_min_epi64, int64_t, i, INT64_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_u64_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi64, long long, _mm512_min_epu64, uint64_t, u, UINT64_MAX, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_f32_avx512, PYSIMD_TARGET_AVX512, 64, __m512, void, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, float, _mm512_min_ps, float, f, (float)HUGE_VAL, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_min_f64_avx512, PYSIMD_TARGET_AVX512, 64, __m512d, void, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, double, _mm512_min_pd, double, f, HUGE_VAL, <)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_i8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi8, char, _mm512_max_epi8, int8_t, i, INT8_MIN, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_u8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi8, char, _mm512_max_epu8, uint8_t, u, 0, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_i16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi16, short, _mm512_max_epi16, int16_t, i, INT16_MIN, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_u16_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi16, short, _mm512_max_epu16, uint16_t, u, 0, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_i32_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi32, int, _mm512_max_epi32, int32_t, i, INT32_MIN, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_u32_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi32, int, _mm512_max_epu32, uint32_t, u, 0, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_i64_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi64, long long, _mm512_max_epi64, int64_t, i, INT64_MIN, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_u64_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, void, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi64, long long, _mm512_max_epu64, uint64_t, u, 0, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_f32_avx512, PYSIMD_TARGET_AVX512, 64, __m512, void, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, float, _mm512_max_ps, float, f, -(float)HUGE_VAL, >)
+SIMD_VEC_MINMAX_WIDE(simd_vec_max_f64_avx512, PYSIMD_TARGET_AVX512, 64, __m512d, void, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, double, _mm512_max_pd, double, f, -HUGE_VAL, >)
+
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_VEC_SUM_BYTES
+#undef SIMD_VEC_SUM_WORDS
+#undef SIMD_VEC_SUM_WIDEN
+#undef SIMD_VEC_SUM_KAHAN
+#undef SIMD_VEC_MINMAX_WIDE
+
+#endif // PYSIMD_X86_SSE2
+
 #endif // SIMD_VEC_ARITH_H
@@ -0,0 +1,310 @@
+#ifndef SIMD_VEC_BITS_H
+#define SIMD_VEC_BITS_H
+
+#include "simd_vec_type.h"
+#include "vec_macros.h"
+
+/* Bitwise kernels treat vectors as plain bit sets, so lane width does not matter and
+ * every tier works a full register at a time. The binary ones follow the three operand
+ * form of the arithmetic kernels, dst = v1 op v2, and andnot is v1 & ~v2.
+ *
+ * Population counts return the number of set bits over the bytes the vectors have in
+ * common. The single vector count ignores its second operand, which is passed the
+ * first one again, so both counts share one signature.
+ */
+
+#define SIMD_VEC_BITOP_SCALAR(name, expr) \
+static void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2); \
+	size_t i = 0; \
+	for (; i < oper_region; i += 8) { \
+		const uint64_t a = *(const uint64_t*)(v1->data + i); \
+		const uint64_t b = *(const uint64_t*)(v2->data + i); \
+		*(uint64_t*)(dst->data + i) = (expr); \
+	} \
+}
+
+SIMD_VEC_BITOP_SCALAR(simd_vec_and_scalar, a & b)
+SIMD_VEC_BITOP_SCALAR(simd_vec_or_scalar, a | b)
+SIMD_VEC_BITOP_SCALAR(simd_vec_xor_scalar, a ^ b)
+SIMD_VEC_BITOP_SCALAR(simd_vec_andnot_scalar, a & ~b)
+
+#undef SIMD_VEC_BITOP_SCALAR
+
+static void simd_vec_not_scalar(struct pysimd_vec_t* dst, const struct pysimd_vec_t* src)
+{
+	size_t i = 0;
+	for (; i < src->size; i += 8)
+		*(uint64_t*)(dst->data + i) = ~*(const uint64_t*)(src->data + i);
+}
+
+// Counts bits within each byte, then adds the bytes up with a multiply
+static uint64_t simd_popcount_u64(uint64_t x)
+{
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	return (x * 0x0101010101010101ULL) >> 56;
+}
+
+static uint64_t simd_vec_popcount_scalar(const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2)
+{
+	uint64_t total = 0;
+	size_t i = 0;
+	(void)v2;
+	for (; i < v1->size; i += 8)
+		total += simd_popcount_u64(*(const uint64_t*)(v1->data + i));
+	return total;
+}
+
+static uint64_t simd_vec_and_popcount_scalar(const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2)
+{
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
+	uint64_t total = 0;
+	size_t i = 0;
+	for (; i < oper_region; i += 8)
+		total += simd_popcount_u64(*(const uint64_t*)(v1->data + i) & *(const uint64_t*)(v2->data + i));
+	return total;
+}
+
+#if defined(PYSIMD_X86_POPCNT)
+
+// The popcnt instruction has its own cpuid bit, these are bound when the cpu reports it
+static PYSIMD_TARGET_POPCNT uint64_t simd_vec_popcount_popcnt(const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2)
+{
+	const unsigned char* data = v1->data;
+	uint64_t total0 = 0;
+	uint64_t total1 = 0;
+	size_t i = 0;
+	(void)v2;
+	for (; i < v1->size; i += 16) {
+		total0 += (uint64_t)_mm_popcnt_u64(*(const uint64_t*)(data + i));
+		total1 += (uint64_t)_mm_popcnt_u64(*(const uint64_t*)(data + i + 8));
+	}
+	return total0 + total1;
+}
+
+static PYSIMD_TARGET_POPCNT uint64_t simd_vec_and_popcount_popcnt(const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2)
+{
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
+	const unsigned char* v1data = v1->data;
+	const unsigned char* v2data = v2->data;
+	uint64_t total0 = 0;
+	uint64_t total1 = 0;
+	size_t i = 0;
+	for (; i < oper_region; i += 16) {
+		total0 += (uint64_t)_mm_popcnt_u64(*(const uint64_t*)(v1data + i) & *(const uint64_t*)(v2data + i));
+		total1 += (uint64_t)_mm_popcnt_u64(*(const uint64_t*)(v1data + i + 8) & *(const uint64_t*)(v2data + i + 8));
+	}
+	return total0 + total1;
+}
+
+#endif // PYSIMD_X86_POPCNT
+
+#if defined(PYSIMD_X86_SSE2)
+
+#define SIMD_VEC_BITOP_WIDE(name, target, width, vtype, load, store, op) \
+static target void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2); \
+	unsigned char* dstdata = dst->data; \
+	const unsigned char* v1data = v1->data; \
+	const unsigned char* v2data = v2->data; \
+	size_t i = 0; \
+	while (i + 2 * (width) <= oper_region) { \
+		vtype v1seg0 = load((vtype const*)(v1data + i)); \
+		vtype v1seg1 = load((vtype const*)(v1data + i + (width))); \
+		vtype v2seg0 = load((vtype const*)(v2data + i)); \
+		vtype v2seg1 = load((vtype const*)(v2data + i + (width))); \
+		store((vtype*)(dstdata + i), op(v1seg0, v2seg0)); \
+		store((vtype*)(dstdata + i + (width)), op(v1seg1, v2seg1)); \
+		i += 2 * (width); \
+	} \
+	if (i < oper_region) { \
+		struct pysimd_vec_t dstrest = {oper_region - i, dst->data + i}; \
+		struct pysimd_vec_t v1rest = {oper_region - i, v1->data + i}; \
+		struct pysimd_vec_t v2rest = {oper_region - i, v2->data + i}; \
+		SIMD_VEC_BITOP_TAIL(name)(&dstrest, &v1rest, &v2rest); \
+	} \
+}
+
+#define SIMD_VEC_NOT_WIDE(name, target, width, vtype, load, store, xorv, ones) \
+static target void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* src) { \
+	const vtype all_set = ones; \
+	size_t i = 0; \
+	for (; i + (width) <= src->size; i += (width)) \
+		store((vtype*)(dst->data + i), xorv(load((vtype const*)(src->data + i)), all_set)); \
+	for (; i < src->size; i += 8) \
+		*(uint64_t*)(dst->data + i) = ~*(const uint64_t*)(src->data + i); \
+}
+
+static PYSIMD_TARGET_SSE2 __m128i simd_andnot_sse2(__m128i a, __m128i b) { return _mm_andnot_si128(b, a); }
+
+// The sse2 kernels step 16 bytes at a time, so their remainder is always empty
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_and_scalar
+SIMD_VEC_BITOP_WIDE(simd_vec_and_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, _mm_load_si128, _mm_store_si128, _mm_and_si128)
+#undef SIMD_VEC_BITOP_TAIL
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_or_scalar
+SIMD_VEC_BITOP_WIDE(simd_vec_or_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, _mm_load_si128, _mm_store_si128, _mm_or_si128)
+#undef SIMD_VEC_BITOP_TAIL
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_xor_scalar
+SIMD_VEC_BITOP_WIDE(simd_vec_xor_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, _mm_load_si128, _mm_store_si128, _mm_xor_si128)
+#undef SIMD_VEC_BITOP_TAIL
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_andnot_scalar
+SIMD_VEC_BITOP_WIDE(simd_vec_andnot_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, _mm_load_si128, _mm_store_si128, simd_andnot_sse2)
+#undef SIMD_VEC_BITOP_TAIL
+SIMD_VEC_NOT_WIDE(simd_vec_not_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, _mm_load_si128, _mm_store_si128, _mm_xor_si128, _mm_set1_epi32(-1))
+
+/* Without pshufb, bits are counted per byte with shifts and masks, and the bytes are
+ * summed into 64 bit lanes with psadbw.
+ */
+static PYSIMD_TARGET_SSE2 __m128i simd_popcount_bytes_sse2(__m128i x)
+{
+	const __m128i m1 = _mm_set1_epi8(0x55);
+	const __m128i m2 = _mm_set1_epi8(0x33);
+	const __m128i m4 = _mm_set1_epi8(0x0f);
+	x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi16(x, 1), m1));
+	x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi16(x, 2), m2));
+	return _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi16(x, 4)), m4);
+}
+
+static PYSIMD_TARGET_SSE2 uint64_t simd_vec_popcount_sse2(const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2)
+{
+	__m128i acc = _mm_setzero_si128();
+	uint64_t lanes[2];
+	size_t i = 0;
+	(void)v2;
+	for (; i < v1->size; i += 16)
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(simd_popcount_bytes_sse2(_mm_load_si128((__m128i const*)(v1->data + i))), _mm_setzero_si128()));
+	_mm_storeu_si128((__m128i*)lanes, acc);
+	return lanes[0] + lanes[1];
+}
+
+static PYSIMD_TARGET_SSE2 uint64_t simd_vec_and_popcount_sse2(const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2)
+{
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2);
+	__m128i acc = _mm_setzero_si128();
+	uint64_t lanes[2];
+	size_t i = 0;
+	for (; i < oper_region; i += 16) {
+		__m128i both = _mm_and_si128(_mm_load_si128((__m128i const*)(v1->data + i)), _mm_load_si128((__m128i const*)(v2->data + i)));
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(simd_popcount_bytes_sse2(both), _mm_setzero_si128()));
+	}
+	_mm_storeu_si128((__m128i*)lanes, acc);
+	return lanes[0] + lanes[1];
+}
+
+/* The wide counts look up the bit count of each nibble with pshufb. Byte counts are
+ * added up for up to 8 registers, at most 64 per byte, before psadbw widens them.
+ * fetch loads a register of the bits to count, from the first or both operands.
+ */
+#define SIMD_VEC_POPCOUNT_PSHUFB(name, target, width, vtype, fetch, storeu, zero, set1, andv, srli16, shuffle, add8, sad, add64, lut) \
+static target uint64_t name(const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(v1, v2); \
+	const unsigned char* v1data = v1->data; \
+	const unsigned char* v2data = v2->data; \
+	const vtype nibble_counts = lut; \
+	const vtype low_nibbles = set1(0x0f); \
+	vtype acc = zero(); \
+	uint64_t lanes[(width) / 8]; \
+	uint64_t total = 0; \
+	size_t i = 0; \
+	size_t j = 0; \
+	while (i + (width) <= oper_region) { \
+		vtype byte_counts = zero(); \
+		size_t block_end = oper_region - i > 8 * (size_t)(width) ? i + 8 * (size_t)(width) : oper_region; \
+		for (; i + (width) <= block_end; i += (width)) { \
+			vtype bits = fetch(v1data + i, v2data + i); \
+			vtype low = shuffle(nibble_counts, andv(bits, low_nibbles)); \
+			vtype high = shuffle(nibble_counts, andv(srli16(bits, 4), low_nibbles)); \
+			byte_counts = add8(byte_counts, add8(low, high)); \
+		} \
+		acc = add64(acc, sad(byte_counts, zero())); \
+	} \
+	storeu((vtype*)lanes, acc); \
+	for (j = 0; j < (width) / 8; ++j) \
+		total += lanes[j]; \
+	for (; i < oper_region; i += 8) \
+		total += simd_popcount_u64(*(const uint64_t*)(v1data + i) & *(const uint64_t*)(v2data + i)); \
+	return total; \
+}
+
+#if defined(PYSIMD_X86_AVX2)
+
+static PYSIMD_TARGET_AVX2 __m256i simd_fetch_one_avx2(const unsigned char* a, const unsigned char* b)
+{
+	(void)b;
+	return _mm256_loadu_si256((__m256i const*)a);
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_fetch_and_avx2(const unsigned char* a, const unsigned char* b)
+{
+	return _mm256_and_si256(_mm256_loadu_si256((__m256i const*)a), _mm256_loadu_si256((__m256i const*)b));
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_andnot_avx2(__m256i a, __m256i b) { return _mm256_andnot_si256(b, a); }
+
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_and_sse2
+SIMD_VEC_BITOP_WIDE(simd_vec_and_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_and_si256)
+#undef SIMD_VEC_BITOP_TAIL
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_or_sse2
+SIMD_VEC_BITOP_WIDE(simd_vec_or_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_or_si256)
+#undef SIMD_VEC_BITOP_TAIL
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_xor_sse2
+SIMD_VEC_BITOP_WIDE(simd_vec_xor_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_xor_si256)
+#undef SIMD_VEC_BITOP_TAIL
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_andnot_sse2
+SIMD_VEC_BITOP_WIDE(simd_vec_andnot_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, simd_andnot_avx2)
+#undef SIMD_VEC_BITOP_TAIL
+SIMD_VEC_NOT_WIDE(simd_vec_not_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_xor_si256, _mm256_set1_epi32(-1))
+
+#define SIMD_NIBBLE_COUNTS_AVX2 _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, \
+	                                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4)
+SIMD_VEC_POPCOUNT_PSHUFB(simd_vec_popcount_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, simd_fetch_one_avx2, _mm256_storeu_si256, _mm256_setzero_si256, _mm256_set1_epi8, _mm256_and_si256, _mm256_srli_epi16, _mm256_shuffle_epi8, _mm256_add_epi8, _mm256_sad_epu8, _mm256_add_epi64, SIMD_NIBBLE_COUNTS_AVX2)
+SIMD_VEC_POPCOUNT_PSHUFB(simd_vec_and_popcount_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, simd_fetch_and_avx2, _mm256_storeu_si256, _mm256_setzero_si256, _mm256_set1_epi8, _mm256_and_si256, _mm256_srli_epi16, _mm256_shuffle_epi8, _mm256_add_epi8, _mm256_sad_epu8, _mm256_add_epi64, SIMD_NIBBLE_COUNTS_AVX2)
+#undef SIMD_NIBBLE_COUNTS_AVX2
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+static PYSIMD_TARGET_AVX512 __m512i simd_fetch_one_avx512(const unsigned char* a, const unsigned char* b)
+{
+	(void)b;
+	return _mm512_loadu_si512((void const*)a);
+}
+
+static PYSIMD_TARGET_AVX512 __m512i simd_fetch_and_avx512(const unsigned char* a, const unsigned char* b)
+{
+	return _mm512_and_si512(_mm512_loadu_si512((void const*)a), _mm512_loadu_si512((void const*)b));
+}
+
+static PYSIMD_TARGET_AVX512 __m512i simd_andnot_avx512(__m512i a, __m512i b) { return _mm512_andnot_si512(b, a); }
+
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_and_sse2
+SIMD_VEC_BITOP_WIDE(simd_vec_and_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_and_si512)
+#undef SIMD_VEC_BITOP_TAIL
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_or_sse2
+SIMD_VEC_BITOP_WIDE(simd_vec_or_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_or_si512)
+#undef SIMD_VEC_BITOP_TAIL
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_xor_sse2
+SIMD_VEC_BITOP_WIDE(simd_vec_xor_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_xor_si512)
+#undef SIMD_VEC_BITOP_TAIL
+#define SIMD_VEC_BITOP_TAIL(name) simd_vec_andnot_sse2
+SIMD_VEC_BITOP_WIDE(simd_vec_andnot_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, simd_andnot_avx512)
+#undef SIMD_VEC_BITOP_TAIL
+SIMD_VEC_NOT_WIDE(simd_vec_not_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_xor_si512, _mm512_set1_epi32(-1))
+
+#define SIMD_NIBBLE_COUNTS_AVX512 _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4))
+SIMD_VEC_POPCOUNT_PSHUFB(simd_vec_popcount_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, simd_fetch_one_avx512, _mm512_storeu_si512, _mm512_setzero_si512, _mm512_set1_epi8, _mm512_and_si512, _mm512_srli_epi16, _mm512_shuffle_epi8, _mm512_add_epi8, _mm512_sad_epu8, _mm512_add_epi64, SIMD_NIBBLE_COUNTS_AVX512)
+SIMD_VEC_POPCOUNT_PSHUFB(simd_vec_and_popcount_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, simd_fetch_and_avx512, _mm512_storeu_si512, _mm512_setzero_si512, _mm512_set1_epi8, _mm512_and_si512, _mm512_srli_epi16, _mm512_shuffle_epi8, _mm512_add_epi8, _mm512_sad_epu8, _mm512_add_epi64, SIMD_NIBBLE_COUNTS_AVX512)
+#undef SIMD_NIBBLE_COUNTS_AVX512
+
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_VEC_BITOP_WIDE
+#undef SIMD_VEC_NOT_WIDE
+#undef SIMD_VEC_POPCOUNT_PSHUFB
+
+#endif // PYSIMD_X86_SSE2
+
+#endif // SIMD_VEC_BITS_H
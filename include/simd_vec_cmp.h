@@ -0,0 +1,413 @@
+#ifndef SIMD_VEC_CMP_H
+#define SIMD_VEC_CMP_H
+
+#include "simd_vec_type.h"
+#include "vec_macros.h"
+
+/* Comparison kernels write a lane mask, each lane of dst set to all ones where the
+ * comparison holds and to zero elsewhere. Every comparison is built from eq, gt and,
+ * for floats where NaN makes ge differ from not lt, ge, with these flags:
+ */
+
+// Compares v2 to v1 instead of v1 to v2, turning gt into lt and ge into le
+#define PYSIMD_CMP_SWAP 1
+// Inverts the result, turning eq into ne and gt into le
+#define PYSIMD_CMP_NEGATE 2
+// v2 holds a single value repeated over PYSIMD_CMP_BROADCAST_SIZE bytes, compared to every lane of v1
+#define PYSIMD_CMP_BROADCAST 4
+
+#define PYSIMD_CMP_BROADCAST_SIZE 64
+
+// Bytes of lane mask produced at a time when comparing into a packed bit mask, kept in L1
+#define PYSIMD_CMP_BLOCK ((size_t)1 << 12)
+
+#define SIMD_VEC_CMP_REGION(v1, v2, flags) ((flags) & PYSIMD_CMP_BROADCAST ? (v1)->size : PYSIMD_MIN_VEC_SIZE(v1, v2))
+
+#define SIMD_VEC_CMP_SCALAR(name, ctype, mtype, expr) \
+static void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2, int flags) { \
+	const size_t n_lanes = SIMD_VEC_CMP_REGION(v1, v2, flags) / sizeof(ctype); \
+	const size_t v2_step = flags & PYSIMD_CMP_BROADCAST ? 0 : 1; \
+	const mtype negate = flags & PYSIMD_CMP_NEGATE ? (mtype)-1 : 0; \
+	const ctype* v1data = (const ctype*)v1->data; \
+	const ctype* v2data = (const ctype*)v2->data; \
+	mtype* dstdata = (mtype*)dst->data; \
+	size_t i = 0; \
+	for (; i < n_lanes; ++i) { \
+		const ctype a = flags & PYSIMD_CMP_SWAP ? v2data[i * v2_step] : v1data[i]; \
+		const ctype b = flags & PYSIMD_CMP_SWAP ? v1data[i] : v2data[i * v2_step]; \
+		dstdata[i] = ((mtype)0 - (mtype)(expr)) ^ negate; \
+	} \
+}
+
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpeq_i8_scalar, uint8_t, uint8_t, a == b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpeq_i16_scalar, uint16_t, uint16_t, a == b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpeq_i32_scalar, uint32_t, uint32_t, a == b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpeq_i64_scalar, uint64_t, uint64_t, a == b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpeq_f32_scalar, float, uint32_t, a == b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpeq_f64_scalar, double, uint64_t, a == b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpgt_i8_scalar, int8_t, uint8_t, a > b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpgt_i16_scalar, int16_t, uint16_t, a > b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpgt_i32_scalar, int32_t, uint32_t, a > b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpgt_i64_scalar, int64_t, uint64_t, a > b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpgt_u8_scalar, uint8_t, uint8_t, a > b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpgt_u16_scalar, uint16_t, uint16_t, a > b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpgt_u32_scalar, uint32_t, uint32_t, a > b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpgt_u64_scalar, uint64_t, uint64_t, a > b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpgt_f32_scalar, float, uint32_t, a > b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpgt_f64_scalar, double, uint64_t, a > b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpge_f32_scalar, float, uint32_t, a >= b)
+SIMD_VEC_CMP_SCALAR(simd_vec_cmpge_f64_scalar, double, uint64_t, a >= b)
+
+#undef SIMD_VEC_CMP_SCALAR
+
+/* Packs a lane mask into one bit per lane, the top bit of each lane, with lane i at
+ * bit i % 8 of byte i / 8. The last byte is only partly used when the number of lanes
+ * is not a multiple of 8.
+ */
+#define SIMD_VEC_PACK_MASK_SCALAR(name, mtype) \
+static void name(unsigned char* bits, const struct pysimd_vec_t* mask) { \
+	const size_t n_lanes = mask->size / sizeof(mtype); \
+	const mtype* lanes = (const mtype*)mask->data; \
+	size_t i = 0; \
+	for (; i < n_lanes; i += 8) { \
+		unsigned char packed = 0; \
+		size_t j = 0; \
+		for (; j < 8 && i + j < n_lanes; ++j) \
+			packed |= (unsigned char)((lanes[i + j] >> (sizeof(mtype) * 8 - 1)) << j); \
+		bits[i / 8] = packed; \
+	} \
+}
+
+SIMD_VEC_PACK_MASK_SCALAR(simd_vec_pack_mask_i8_scalar, uint8_t)
+SIMD_VEC_PACK_MASK_SCALAR(simd_vec_pack_mask_i16_scalar, uint16_t)
+SIMD_VEC_PACK_MASK_SCALAR(simd_vec_pack_mask_i32_scalar, uint32_t)
+SIMD_VEC_PACK_MASK_SCALAR(simd_vec_pack_mask_i64_scalar, uint64_t)
+
+#undef SIMD_VEC_PACK_MASK_SCALAR
+
+// Takes the bits of a where mask is set and those of b elsewhere
+static void simd_vec_select_scalar(struct pysimd_vec_t* dst, const struct pysimd_vec_t* mask,
+	                               const struct pysimd_vec_t* a, const struct pysimd_vec_t* b)
+{
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(mask, a) < b->size ? PYSIMD_MIN_VEC_SIZE(mask, a) : b->size;
+	size_t i = 0;
+	for (; i < oper_region; i += 8) {
+		const uint64_t m = *(const uint64_t*)(mask->data + i);
+		*(uint64_t*)(dst->data + i) = (*(const uint64_t*)(a->data + i) & m) | (*(const uint64_t*)(b->data + i) & ~m);
+	}
+}
+
+#if defined(PYSIMD_X86_SSE2)
+
+/* The vector kernels load the broadcast value once, and otherwise follow the scalar
+ * ones. A wide kernel hands whatever is left of the vector, less than a register, to
+ * the kernel of the tier below, with the broadcast value passed on as it is.
+ */
+#define SIMD_VEC_CMP_VECTOR(name, target, width, vtype, load, store, xorv, ones, zero, op, tail) \
+static target void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* v1, const struct pysimd_vec_t* v2, int flags) { \
+	const size_t oper_region = SIMD_VEC_CMP_REGION(v1, v2, flags); \
+	const vtype negate = flags & PYSIMD_CMP_NEGATE ? ones : zero; \
+	const vtype fixed = flags & PYSIMD_CMP_BROADCAST ? load((vtype const*)v2->data) : zero; \
+	size_t i = 0; \
+	for (; i + (width) <= oper_region; i += (width)) { \
+		const vtype a = load((vtype const*)(v1->data + i)); \
+		const vtype b = flags & PYSIMD_CMP_BROADCAST ? fixed : load((vtype const*)(v2->data + i)); \
+		store((vtype*)(dst->data + i), xorv(flags & PYSIMD_CMP_SWAP ? op(b, a) : op(a, b), negate)); \
+	} \
+	if (i < oper_region) { \
+		struct pysimd_vec_t dstrest = {oper_region - i, dst->data + i}; \
+		struct pysimd_vec_t v1rest = {oper_region - i, v1->data + i}; \
+		struct pysimd_vec_t v2rest = {oper_region - i, v2->data + (flags & PYSIMD_CMP_BROADCAST ? 0 : i)}; \
+		tail(&dstrest, &v1rest, &v2rest, flags); \
+	} \
+}
+
+#define SIMD_VEC_CMP_SSE2(name, op, tail) \
+	SIMD_VEC_CMP_VECTOR(name, PYSIMD_TARGET_SSE2, 16, __m128i, _mm_load_si128, _mm_store_si128, _mm_xor_si128, \
+	                    _mm_set1_epi32(-1), _mm_setzero_si128(), op, tail)
+
+// Unsigned lanes compare as signed ones once the top bit of both sides is flipped
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpgt_epu8_sse2(__m128i a, __m128i b)
+{
+	const __m128i bias = _mm_set1_epi8((char)0x80);
+	return _mm_cmpgt_epi8(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpgt_epu16_sse2(__m128i a, __m128i b)
+{
+	const __m128i bias = _mm_set1_epi16((short)0x8000);
+	return _mm_cmpgt_epi16(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpgt_epu32_sse2(__m128i a, __m128i b)
+{
+	const __m128i bias = _mm_set1_epi32((int)0x80000000u);
+	return _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+// Both 32 bit halves must be equal
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpeq_epi64_sse2(__m128i a, __m128i b)
+{
+	const __m128i halves = _mm_cmpeq_epi32(a, b);
+	return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+/* Signed 64 bit compare from 32 bit ones, the high halves decide unless they are
+ * equal, in which case the low halves decide as unsigned numbers.
+ */
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpgt_epi64_sse2(__m128i a, __m128i b)
+{
+	const __m128i greater = _mm_cmpgt_epi32(a, b);
+	const __m128i equal = _mm_cmpeq_epi32(a, b);
+	const __m128i low_greater = simd_cmpgt_epu32_sse2(a, b);
+	const __m128i result = _mm_or_si128(greater, _mm_and_si128(equal, _mm_slli_epi64(low_greater, 32)));
+	return _mm_shuffle_epi32(result, _MM_SHUFFLE(3, 3, 1, 1));
+}
+
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpgt_epu64_sse2(__m128i a, __m128i b)
+{
+	const __m128i bias = _mm_set1_epi64x((long long)0x8000000000000000ULL);
+	return simd_cmpgt_epi64_sse2(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpeq_ps_sse2(__m128i a, __m128i b) { return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpgt_ps_sse2(__m128i a, __m128i b) { return _mm_castps_si128(_mm_cmpgt_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpge_ps_sse2(__m128i a, __m128i b) { return _mm_castps_si128(_mm_cmpge_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpeq_pd_sse2(__m128i a, __m128i b) { return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpgt_pd_sse2(__m128i a, __m128i b) { return _mm_castpd_si128(_mm_cmpgt_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+static PYSIMD_TARGET_SSE2 __m128i simd_cmpge_pd_sse2(__m128i a, __m128i b) { return _mm_castpd_si128(_mm_cmpge_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+
+// Sizes are multiples of 16, so the sse2 kernels never have anything left over
+SIMD_VEC_CMP_SSE2(simd_vec_cmpeq_i8_sse2, _mm_cmpeq_epi8, simd_vec_cmpeq_i8_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpeq_i16_sse2, _mm_cmpeq_epi16, simd_vec_cmpeq_i16_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpeq_i32_sse2, _mm_cmpeq_epi32, simd_vec_cmpeq_i32_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpeq_i64_sse2, simd_cmpeq_epi64_sse2, simd_vec_cmpeq_i64_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpeq_f32_sse2, simd_cmpeq_ps_sse2, simd_vec_cmpeq_f32_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpeq_f64_sse2, simd_cmpeq_pd_sse2, simd_vec_cmpeq_f64_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpgt_i8_sse2, _mm_cmpgt_epi8, simd_vec_cmpgt_i8_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpgt_i16_sse2, _mm_cmpgt_epi16, simd_vec_cmpgt_i16_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpgt_i32_sse2, _mm_cmpgt_epi32, simd_vec_cmpgt_i32_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpgt_i64_sse2, simd_cmpgt_epi64_sse2, simd_vec_cmpgt_i64_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpgt_u8_sse2, simd_cmpgt_epu8_sse2, simd_vec_cmpgt_u8_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpgt_u16_sse2, simd_cmpgt_epu16_sse2, simd_vec_cmpgt_u16_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpgt_u32_sse2, simd_cmpgt_epu32_sse2, simd_vec_cmpgt_u32_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpgt_u64_sse2, simd_cmpgt_epu64_sse2, simd_vec_cmpgt_u64_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpgt_f32_sse2, simd_cmpgt_ps_sse2, simd_vec_cmpgt_f32_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpgt_f64_sse2, simd_cmpgt_pd_sse2, simd_vec_cmpgt_f64_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpge_f32_sse2, simd_cmpge_ps_sse2, simd_vec_cmpge_f32_scalar)
+SIMD_VEC_CMP_SSE2(simd_vec_cmpge_f64_sse2, simd_cmpge_pd_sse2, simd_vec_cmpge_f64_scalar)
+
+#undef SIMD_VEC_CMP_SSE2
+
+/* Packing collects the movemask bits of each register into a 64 bit word, which is
+ * written out whenever it fills up, and once more at the end for what is left.
+ */
+#define SIMD_VEC_PACK_MASK_SSE2(name, lanes_per_reg, movemask) \
+static PYSIMD_TARGET_SSE2 void name(unsigned char* bits, const struct pysimd_vec_t* mask) { \
+	uint64_t word = 0; \
+	size_t n_bits = 0; \
+	size_t i = 0; \
+	for (; i < mask->size; i += 16) { \
+		word |= (uint64_t)(unsigned)movemask(_mm_load_si128((__m128i const*)(mask->data + i))) << n_bits; \
+		n_bits += (lanes_per_reg); \
+		if (n_bits == 64) { \
+			memcpy(bits, &word, 8); \
+			bits += 8; \
+			word = 0; \
+			n_bits = 0; \
+		} \
+	} \
+	for (i = 0; i < n_bits; i += 8) \
+		*bits++ = (unsigned char)(word >> i); \
+}
+
+static PYSIMD_TARGET_SSE2 int simd_movemask_epi16_sse2(__m128i mask) { return _mm_movemask_epi8(_mm_packs_epi16(mask, _mm_setzero_si128())); }
+static PYSIMD_TARGET_SSE2 int simd_movemask_epi32_sse2(__m128i mask) { return _mm_movemask_ps(_mm_castsi128_ps(mask)); }
+static PYSIMD_TARGET_SSE2 int simd_movemask_epi64_sse2(__m128i mask) { return _mm_movemask_pd(_mm_castsi128_pd(mask)); }
+
+SIMD_VEC_PACK_MASK_SSE2(simd_vec_pack_mask_i8_sse2, 16, _mm_movemask_epi8)
+SIMD_VEC_PACK_MASK_SSE2(simd_vec_pack_mask_i16_sse2, 8, simd_movemask_epi16_sse2)
+SIMD_VEC_PACK_MASK_SSE2(simd_vec_pack_mask_i32_sse2, 4, simd_movemask_epi32_sse2)
+SIMD_VEC_PACK_MASK_SSE2(simd_vec_pack_mask_i64_sse2, 2, simd_movemask_epi64_sse2)
+
+#undef SIMD_VEC_PACK_MASK_SSE2
+
+#define SIMD_VEC_SELECT_VECTOR(name, target, width, vtype, load, store, blend, tail) \
+static target void name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* mask, \
+	                    const struct pysimd_vec_t* a, const struct pysimd_vec_t* b) { \
+	const size_t oper_region = PYSIMD_MIN_VEC_SIZE(mask, a) < b->size ? PYSIMD_MIN_VEC_SIZE(mask, a) : b->size; \
+	size_t i = 0; \
+	for (; i + (width) <= oper_region; i += (width)) { \
+		const vtype m = load((vtype const*)(mask->data + i)); \
+		store((vtype*)(dst->data + i), blend(m, load((vtype const*)(a->data + i)), load((vtype const*)(b->data + i)))); \
+	} \
+	if (i < oper_region) { \
+		struct pysimd_vec_t dstrest = {oper_region - i, dst->data + i}; \
+		struct pysimd_vec_t maskrest = {oper_region - i, mask->data + i}; \
+		struct pysimd_vec_t arest = {oper_region - i, a->data + i}; \
+		struct pysimd_vec_t brest = {oper_region - i, b->data + i}; \
+		tail(&dstrest, &maskrest, &arest, &brest); \
+	} \
+}
+
+static PYSIMD_TARGET_SSE2 __m128i simd_select_sse2(__m128i m, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+SIMD_VEC_SELECT_VECTOR(simd_vec_select_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, _mm_load_si128, _mm_store_si128,
+	                   simd_select_sse2, simd_vec_select_scalar)
+
+#if defined(PYSIMD_X86_AVX2)
+
+#define SIMD_VEC_CMP_AVX2(name, op, tail) \
+	SIMD_VEC_CMP_VECTOR(name, PYSIMD_TARGET_AVX2, 32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_xor_si256, \
+	                    _mm256_set1_epi32(-1), _mm256_setzero_si256(), op, tail)
+
+static PYSIMD_TARGET_AVX2 __m256i simd_cmpgt_epu8_avx2(__m256i a, __m256i b)
+{
+	const __m256i bias = _mm256_set1_epi8((char)0x80);
+	return _mm256_cmpgt_epi8(_mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias));
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_cmpgt_epu16_avx2(__m256i a, __m256i b)
+{
+	const __m256i bias = _mm256_set1_epi16((short)0x8000);
+	return _mm256_cmpgt_epi16(_mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias));
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_cmpgt_epu32_avx2(__m256i a, __m256i b)
+{
+	const __m256i bias = _mm256_set1_epi32((int)0x80000000u);
+	return _mm256_cmpgt_epi32(_mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias));
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_cmpgt_epu64_avx2(__m256i a, __m256i b)
+{
+	const __m256i bias = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+	return _mm256_cmpgt_epi64(_mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias));
+}
+
+#define SIMD_CMP_FLOAT_AVX2(name, cast_in, cast_out, cmp, predicate) \
+static PYSIMD_TARGET_AVX2 __m256i name(__m256i a, __m256i b) { return cast_out(cmp(cast_in(a), cast_in(b), predicate)); }
+
+SIMD_CMP_FLOAT_AVX2(simd_cmpeq_ps_avx2, _mm256_castsi256_ps, _mm256_castps_si256, _mm256_cmp_ps, _CMP_EQ_OQ)
+SIMD_CMP_FLOAT_AVX2(simd_cmpgt_ps_avx2, _mm256_castsi256_ps, _mm256_castps_si256, _mm256_cmp_ps, _CMP_GT_OQ)
+SIMD_CMP_FLOAT_AVX2(simd_cmpge_ps_avx2, _mm256_castsi256_ps, _mm256_castps_si256, _mm256_cmp_ps, _CMP_GE_OQ)
+SIMD_CMP_FLOAT_AVX2(simd_cmpeq_pd_avx2, _mm256_castsi256_pd, _mm256_castpd_si256, _mm256_cmp_pd, _CMP_EQ_OQ)
+SIMD_CMP_FLOAT_AVX2(simd_cmpgt_pd_avx2, _mm256_castsi256_pd, _mm256_castpd_si256, _mm256_cmp_pd, _CMP_GT_OQ)
+SIMD_CMP_FLOAT_AVX2(simd_cmpge_pd_avx2, _mm256_castsi256_pd, _mm256_castpd_si256, _mm256_cmp_pd, _CMP_GE_OQ)
+
+#undef SIMD_CMP_FLOAT_AVX2
+
+SIMD_VEC_CMP_AVX2(simd_vec_cmpeq_i8_avx2, _mm256_cmpeq_epi8, simd_vec_cmpeq_i8_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpeq_i16_avx2, _mm256_cmpeq_epi16, simd_vec_cmpeq_i16_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpeq_i32_avx2, _mm256_cmpeq_epi32, simd_vec_cmpeq_i32_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpeq_i64_avx2, _mm256_cmpeq_epi64, simd_vec_cmpeq_i64_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpeq_f32_avx2, simd_cmpeq_ps_avx2, simd_vec_cmpeq_f32_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpeq_f64_avx2, simd_cmpeq_pd_avx2, simd_vec_cmpeq_f64_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpgt_i8_avx2, _mm256_cmpgt_epi8, simd_vec_cmpgt_i8_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpgt_i16_avx2, _mm256_cmpgt_epi16, simd_vec_cmpgt_i16_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpgt_i32_avx2, _mm256_cmpgt_epi32, simd_vec_cmpgt_i32_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpgt_i64_avx2, _mm256_cmpgt_epi64, simd_vec_cmpgt_i64_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpgt_u8_avx2, simd_cmpgt_epu8_avx2, simd_vec_cmpgt_u8_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpgt_u16_avx2, simd_cmpgt_epu16_avx2, simd_vec_cmpgt_u16_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpgt_u32_avx2, simd_cmpgt_epu32_avx2, simd_vec_cmpgt_u32_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpgt_u64_avx2, simd_cmpgt_epu64_avx2, simd_vec_cmpgt_u64_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpgt_f32_avx2, simd_cmpgt_ps_avx2, simd_vec_cmpgt_f32_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpgt_f64_avx2, simd_cmpgt_pd_avx2, simd_vec_cmpgt_f64_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpge_f32_avx2, simd_cmpge_ps_avx2, simd_vec_cmpge_f32_sse2)
+SIMD_VEC_CMP_AVX2(simd_vec_cmpge_f64_avx2, simd_cmpge_pd_avx2, simd_vec_cmpge_f64_sse2)
+
+#undef SIMD_VEC_CMP_AVX2
+
+static PYSIMD_TARGET_AVX2 __m256i simd_select_avx2(__m256i m, __m256i a, __m256i b)
+{
+	return _mm256_or_si256(_mm256_and_si256(m, a), _mm256_andnot_si256(m, b));
+}
+
+SIMD_VEC_SELECT_VECTOR(simd_vec_select_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256,
+	                   simd_select_avx2, simd_vec_select_sse2)
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+/* AVX-512 compares produce a bit per lane, expanded back into a lane mask with a
+ * zero masked move of all ones.
+ */
+#define SIMD_CMP_INT_AVX512(name, cmp, expand) \
+static PYSIMD_TARGET_AVX512 __m512i name(__m512i a, __m512i b) { return expand(cmp(a, b), _mm512_set1_epi32(-1)); }
+
+#define SIMD_CMP_FLOAT_AVX512(name, cast_in, cmp, predicate, expand) \
+static PYSIMD_TARGET_AVX512 __m512i name(__m512i a, __m512i b) { return expand(cmp(cast_in(a), cast_in(b), predicate), _mm512_set1_epi32(-1)); }
+
+SIMD_CMP_INT_AVX512(simd_cmpeq_epi8_avx512, _mm512_cmpeq_epi8_mask, _mm512_maskz_mov_epi8)
+SIMD_CMP_INT_AVX512(simd_cmpeq_epi16_avx512, _mm512_cmpeq_epi16_mask, _mm512_maskz_mov_epi16)
+SIMD_CMP_INT_AVX512(simd_cmpeq_epi32_avx512, _mm512_cmpeq_epi32_mask, _mm512_maskz_mov_epi32)
+SIMD_CMP_INT_AVX512(simd_cmpeq_epi64_avx512, _mm512_cmpeq_epi64_mask, _mm512_maskz_mov_epi64)
+SIMD_CMP_INT_AVX512(simd_cmpgt_epi8_avx512, _mm512_cmpgt_epi8_mask, _mm512_maskz_mov_epi8)
+SIMD_CMP_INT_AVX512(simd_cmpgt_epi16_avx512, _mm512_cmpgt_epi16_mask, _mm512_maskz_mov_epi16)
+SIMD_CMP_INT_AVX512(simd_cmpgt_epi32_avx512, _mm512_cmpgt_epi32_mask, _mm512_maskz_mov_epi32)
+SIMD_CMP_INT_AVX512(simd_cmpgt_epi64_avx512, _mm512_cmpgt_epi64_mask, _mm512_maskz_mov_epi64)
+SIMD_CMP_INT_AVX512(simd_cmpgt_epu8_avx512, _mm512_cmpgt_epu8_mask, _mm512_maskz_mov_epi8)
+SIMD_CMP_INT_AVX512(simd_cmpgt_epu16_avx512, _mm512_cmpgt_epu16_mask, _mm512_maskz_mov_epi16)
+SIMD_CMP_INT_AVX512(simd_cmpgt_epu32_avx512, _mm512_cmpgt_epu32_mask, _mm512_maskz_mov_epi32)
+SIMD_CMP_INT_AVX512(simd_cmpgt_epu64_avx512, _mm512_cmpgt_epu64_mask, _mm512_maskz_mov_epi64)
+SIMD_CMP_FLOAT_AVX512(simd_cmpeq_ps_avx512, _mm512_castsi512_ps, _mm512_cmp_ps_mask, _CMP_EQ_OQ, _mm512_maskz_mov_epi32)
+SIMD_CMP_FLOAT_AVX512(simd_cmpgt_ps_avx512, _mm512_castsi512_ps, _mm512_cmp_ps_mask, _CMP_GT_OQ, _mm512_maskz_mov_epi32)
+SIMD_CMP_FLOAT_AVX512(simd_cmpge_ps_avx512, _mm512_castsi512_ps, _mm512_cmp_ps_mask, _CMP_GE_OQ, _mm512_maskz_mov_epi32)
+SIMD_CMP_FLOAT_AVX512(simd_cmpeq_pd_avx512, _mm512_castsi512_pd, _mm512_cmp_pd_mask, _CMP_EQ_OQ, _mm512_maskz_mov_epi64)
+SIMD_CMP_FLOAT_AVX512(simd_cmpgt_pd_avx512, _mm512_castsi512_pd, _mm512_cmp_pd_mask, _CMP_GT_OQ, _mm512_maskz_mov_epi64)
+SIMD_CMP_FLOAT_AVX512(simd_cmpge_pd_avx512, _mm512_castsi512_pd, _mm512_cmp_pd_mask, _CMP_GE_OQ, _mm512_maskz_mov_epi64)
+
+#undef SIMD_CMP_INT_AVX512
+#undef SIMD_CMP_FLOAT_AVX512
+
+static PYSIMD_TARGET_AVX512 __m512i simd_load_avx512(__m512i const* ptr) { return _mm512_loadu_si512((void const*)ptr); }
+static PYSIMD_TARGET_AVX512 void simd_store_avx512(__m512i* ptr, __m512i value) { _mm512_storeu_si512((void*)ptr, value); }
+
+#define SIMD_VEC_CMP_AVX512(name, op, tail) \
+	SIMD_VEC_CMP_VECTOR(name, PYSIMD_TARGET_AVX512, 64, __m512i, simd_load_avx512, simd_store_avx512, _mm512_xor_si512, \
+	                    _mm512_set1_epi32(-1), _mm512_setzero_si512(), op, tail)
+
+SIMD_VEC_CMP_AVX512(simd_vec_cmpeq_i8_avx512, simd_cmpeq_epi8_avx512, simd_vec_cmpeq_i8_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpeq_i16_avx512, simd_cmpeq_epi16_avx512, simd_vec_cmpeq_i16_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpeq_i32_avx512, simd_cmpeq_epi32_avx512, simd_vec_cmpeq_i32_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpeq_i64_avx512, simd_cmpeq_epi64_avx512, simd_vec_cmpeq_i64_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpeq_f32_avx512, simd_cmpeq_ps_avx512, simd_vec_cmpeq_f32_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpeq_f64_avx512, simd_cmpeq_pd_avx512, simd_vec_cmpeq_f64_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpgt_i8_avx512, simd_cmpgt_epi8_avx512, simd_vec_cmpgt_i8_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpgt_i16_avx512, simd_cmpgt_epi16_avx512, simd_vec_cmpgt_i16_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpgt_i32_avx512, simd_cmpgt_epi32_avx512, simd_vec_cmpgt_i32_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpgt_i64_avx512, simd_cmpgt_epi64_avx512, simd_vec_cmpgt_i64_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpgt_u8_avx512, simd_cmpgt_epu8_avx512, simd_vec_cmpgt_u8_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpgt_u16_avx512, simd_cmpgt_epu16_avx512, simd_vec_cmpgt_u16_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpgt_u32_avx512, simd_cmpgt_epu32_avx512, simd_vec_cmpgt_u32_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpgt_u64_avx512, simd_cmpgt_epu64_avx512, simd_vec_cmpgt_u64_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpgt_f32_avx512, simd_cmpgt_ps_avx512, simd_vec_cmpgt_f32_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpgt_f64_avx512, simd_cmpgt_pd_avx512, simd_vec_cmpgt_f64_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpge_f32_avx512, simd_cmpge_ps_avx512, simd_vec_cmpge_f32_avx2)
+SIMD_VEC_CMP_AVX512(simd_vec_cmpge_f64_avx512, simd_cmpge_pd_avx512, simd_vec_cmpge_f64_avx2)
+
+#undef SIMD_VEC_CMP_AVX512
+
+// Bitwise a ? b : c in one instruction, 0xca is the truth table of that expression
+static PYSIMD_TARGET_AVX512 __m512i simd_select_avx512(__m512i m, __m512i a, __m512i b)
+{
+	return _mm512_ternarylogic_epi64(m, a, b, 0xca);
+}
+
+SIMD_VEC_SELECT_VECTOR(simd_vec_select_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, simd_load_avx512, simd_store_avx512,
+	                   simd_select_avx512, simd_vec_select_avx2)
+
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_VEC_CMP_VECTOR
+#undef SIMD_VEC_SELECT_VECTOR
+
+#endif // PYSIMD_X86_SSE2
+
+#undef SIMD_VEC_CMP_REGION
+
+#endif // SIMD_VEC_CMP_H
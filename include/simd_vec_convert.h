@@ -0,0 +1,621 @@
+#ifndef SIMD_VEC_CONVERT_H
+#define SIMD_VEC_CONVERT_H
+
+#include "simd_vec_type.h"
+#include "vec_macros.h"
+
+/* Lane conversions. A conversion kernel reads every lane of src as one lane type, and
+ * writes it into dst as another, which holds as many lanes of the new width. Integers
+ * that do not fit the new type saturate to its nearest value. Floats are truncated
+ * toward zero when converted to integers, NaN becomes 0, and integers that do not fit
+ * a float exactly are rounded to the nearest one.
+ *
+ * Every pair of lane types can be converted by simd_convert_lanes, a block of lanes at
+ * a time, through an array of 64 bit values. The vector tiers have kernels for the
+ * common pairs, which convert a fixed number of bytes at a time, and finish the lanes
+ * after the last whole block with simd_convert_lanes.
+ */
+
+// Lanes simd_convert_lanes reads into 64 bit values before writing them out
+#define PYSIMD_CONVERT_BLOCK 256
+
+union simd_convert_values {
+	int64_t i[PYSIMD_CONVERT_BLOCK];
+	uint64_t u[PYSIMD_CONVERT_BLOCK];
+	double f[PYSIMD_CONVERT_BLOCK];
+};
+
+static void simd_convert_read(union simd_convert_values* values, const unsigned char* src, enum pysimd_lane_type from, size_t n)
+{
+	size_t j = 0;
+	switch (from) {
+		case PYSIMD_LANE_I8: for (; j < n; ++j) values->i[j] = ((const int8_t*)src)[j]; break;
+		case PYSIMD_LANE_U8: for (; j < n; ++j) values->u[j] = ((const uint8_t*)src)[j]; break;
+		case PYSIMD_LANE_I16: for (; j < n; ++j) values->i[j] = ((const int16_t*)src)[j]; break;
+		case PYSIMD_LANE_U16: for (; j < n; ++j) values->u[j] = ((const uint16_t*)src)[j]; break;
+		case PYSIMD_LANE_I32: for (; j < n; ++j) values->i[j] = ((const int32_t*)src)[j]; break;
+		case PYSIMD_LANE_U32: for (; j < n; ++j) values->u[j] = ((const uint32_t*)src)[j]; break;
+		case PYSIMD_LANE_I64: for (; j < n; ++j) values->i[j] = ((const int64_t*)src)[j]; break;
+		case PYSIMD_LANE_U64: for (; j < n; ++j) values->u[j] = ((const uint64_t*)src)[j]; break;
+		case PYSIMD_LANE_F32: for (; j < n; ++j) values->f[j] = ((const float*)src)[j]; break;
+		case PYSIMD_LANE_F64: for (; j < n; ++j) values->f[j] = ((const double*)src)[j]; break;
+	}
+}
+
+/* Clamps values read as the kind from to the integer range [low, high], leaving them
+ * as i for signed ranges and u for unsigned ones.
+ */
+static void simd_convert_clamp(union simd_convert_values* values, enum pysimd_lane_kind from, int to_signed,
+	                           int64_t low, uint64_t high, size_t n)
+{
+	size_t j = 0;
+	for (; j < n; ++j) {
+		if (from == PYSIMD_LANE_FLOAT) {
+			const double f = values->f[j];
+			if (f != f)
+				values->u[j] = 0;
+			else if (f >= (double)high)
+				values->u[j] = high;
+			else if (f <= (double)low)
+				values->i[j] = low;
+			else if (to_signed)
+				values->i[j] = (int64_t)f;
+			else
+				values->u[j] = (uint64_t)f;
+		} else if (from == PYSIMD_LANE_INT) {
+			const int64_t i = values->i[j];
+			if (i < low)
+				values->i[j] = low;
+			else if (i > 0 && (uint64_t)i > high)
+				values->u[j] = high;
+		} else if (values->u[j] > high) {
+			values->u[j] = high;
+		}
+	}
+}
+
+static void simd_convert_write(unsigned char* dst, enum pysimd_lane_type to, enum pysimd_lane_kind from,
+	                           union simd_convert_values* values, size_t n)
+{
+	size_t j = 0;
+	switch (to) {
+		case PYSIMD_LANE_I8:
+			simd_convert_clamp(values, from, 1, INT8_MIN, INT8_MAX, n);
+			for (; j < n; ++j) ((int8_t*)dst)[j] = (int8_t)values->i[j];
+			break;
+		case PYSIMD_LANE_U8:
+			simd_convert_clamp(values, from, 0, 0, UINT8_MAX, n);
+			for (; j < n; ++j) ((uint8_t*)dst)[j] = (uint8_t)values->u[j];
+			break;
+		case PYSIMD_LANE_I16:
+			simd_convert_clamp(values, from, 1, INT16_MIN, INT16_MAX, n);
+			for (; j < n; ++j) ((int16_t*)dst)[j] = (int16_t)values->i[j];
+			break;
+		case PYSIMD_LANE_U16:
+			simd_convert_clamp(values, from, 0, 0, UINT16_MAX, n);
+			for (; j < n; ++j) ((uint16_t*)dst)[j] = (uint16_t)values->u[j];
+			break;
+		case PYSIMD_LANE_I32:
+			simd_convert_clamp(values, from, 1, INT32_MIN, INT32_MAX, n);
+			for (; j < n; ++j) ((int32_t*)dst)[j] = (int32_t)values->i[j];
+			break;
+		case PYSIMD_LANE_U32:
+			simd_convert_clamp(values, from, 0, 0, UINT32_MAX, n);
+			for (; j < n; ++j) ((uint32_t*)dst)[j] = (uint32_t)values->u[j];
+			break;
+		case PYSIMD_LANE_I64:
+			simd_convert_clamp(values, from, 1, INT64_MIN, INT64_MAX, n);
+			for (; j < n; ++j) ((int64_t*)dst)[j] = values->i[j];
+			break;
+		case PYSIMD_LANE_U64:
+			simd_convert_clamp(values, from, 0, 0, UINT64_MAX, n);
+			for (; j < n; ++j) ((uint64_t*)dst)[j] = values->u[j];
+			break;
+		// Integers are converted to float directly, rounding once
+		case PYSIMD_LANE_F32:
+			if (from == PYSIMD_LANE_INT)
+				for (; j < n; ++j) ((float*)dst)[j] = (float)values->i[j];
+			else if (from == PYSIMD_LANE_UINT)
+				for (; j < n; ++j) ((float*)dst)[j] = (float)values->u[j];
+			else
+				for (; j < n; ++j) ((float*)dst)[j] = (float)values->f[j];
+			break;
+		case PYSIMD_LANE_F64:
+			if (from == PYSIMD_LANE_INT)
+				for (; j < n; ++j) ((double*)dst)[j] = (double)values->i[j];
+			else if (from == PYSIMD_LANE_UINT)
+				for (; j < n; ++j) ((double*)dst)[j] = (double)values->u[j];
+			else
+				for (; j < n; ++j) ((double*)dst)[j] = values->f[j];
+			break;
+	}
+}
+
+// Converts n lanes of src from one lane type to another into dst
+static void simd_convert_lanes(unsigned char* dst, struct pysimd_lane_t to, const unsigned char* src,
+	                           struct pysimd_lane_t from, size_t n)
+{
+	union simd_convert_values values;
+	size_t start = 0;
+	for (; start < n; start += PYSIMD_CONVERT_BLOCK) {
+		const size_t count = n - start < PYSIMD_CONVERT_BLOCK ? n - start : PYSIMD_CONVERT_BLOCK;
+		simd_convert_read(&values, src + start * from.width, (enum pysimd_lane_type)pysimd_lane_index(from), count);
+		simd_convert_write(dst + start * to.width, (enum pysimd_lane_type)pysimd_lane_index(to), from.kind, &values, count);
+	}
+}
+
+/* The vector kernels share this loop, given a block function that converts in_bytes
+ * of src into out_bytes of dst.
+ */
+#define SIMD_VEC_CONVERT(name, target, in_bytes, out_bytes, block, from_kind, from_width, to_kind, to_width) \
+static target void name(unsigned char* dst, const struct pysimd_vec_t* src) { \
+	const size_t whole = src->size - src->size % (in_bytes); \
+	struct pysimd_lane_t from; \
+	struct pysimd_lane_t to; \
+	size_t i = 0; \
+	for (; i < whole; i += (in_bytes)) \
+		block(dst + i / (in_bytes) * (out_bytes), src->data + i); \
+	from.kind = from_kind; \
+	from.width = from_width; \
+	to.kind = to_kind; \
+	to.width = to_width; \
+	simd_convert_lanes(dst + whole / (in_bytes) * (out_bytes), to, src->data + whole, from, (src->size - whole) / (from_width)); \
+}
+
+#if defined(PYSIMD_X86_SSE2)
+
+static PYSIMD_TARGET_SSE2 __m128i simd_convert_load4_sse2(const unsigned char* src)
+{
+	int32_t bits = 0;
+	memcpy(&bits, src, sizeof(bits));
+	return _mm_cvtsi32_si128(bits);
+}
+static PYSIMD_TARGET_SSE2 __m128i simd_convert_load8_sse2(const unsigned char* src) { return _mm_loadl_epi64((__m128i const*)src); }
+static PYSIMD_TARGET_SSE2 __m128i simd_convert_load16_sse2(const unsigned char* src) { return _mm_loadu_si128((__m128i const*)src); }
+
+/* SSE2 widens with unpacks, interleaving lanes with zeros, or with their sign spread
+ * over a lane by a comparison against zero.
+ */
+#define SIMD_CONVERT_WIDEN_SSE2(name, unpacklo, unpackhi, high_bits) \
+static PYSIMD_TARGET_SSE2 void name(unsigned char* dst, const unsigned char* src) { \
+	const __m128i x = _mm_loadu_si128((__m128i const*)src); \
+	const __m128i high = high_bits; \
+	_mm_storeu_si128((__m128i*)dst, unpacklo(x, high)); \
+	_mm_storeu_si128((__m128i*)(dst + 16), unpackhi(x, high)); \
+}
+
+SIMD_CONVERT_WIDEN_SSE2(simd_convert_block_i8_i16_sse2, _mm_unpacklo_epi8, _mm_unpackhi_epi8, _mm_cmpgt_epi8(_mm_setzero_si128(), x))
+SIMD_CONVERT_WIDEN_SSE2(simd_convert_block_u8_x16_sse2, _mm_unpacklo_epi8, _mm_unpackhi_epi8, _mm_setzero_si128())
+SIMD_CONVERT_WIDEN_SSE2(simd_convert_block_i16_i32_sse2, _mm_unpacklo_epi16, _mm_unpackhi_epi16, _mm_srai_epi16(x, 15))
+SIMD_CONVERT_WIDEN_SSE2(simd_convert_block_u16_x32_sse2, _mm_unpacklo_epi16, _mm_unpackhi_epi16, _mm_setzero_si128())
+SIMD_CONVERT_WIDEN_SSE2(simd_convert_block_i32_i64_sse2, _mm_unpacklo_epi32, _mm_unpackhi_epi32, _mm_srai_epi32(x, 31))
+SIMD_CONVERT_WIDEN_SSE2(simd_convert_block_u32_x64_sse2, _mm_unpacklo_epi32, _mm_unpackhi_epi32, _mm_setzero_si128())
+
+#undef SIMD_CONVERT_WIDEN_SSE2
+
+// Narrows two registers into one with a saturating pack
+#define SIMD_CONVERT_NARROW_SSE2(name, pack) \
+static PYSIMD_TARGET_SSE2 void name(unsigned char* dst, const unsigned char* src) { \
+	_mm_storeu_si128((__m128i*)dst, pack(_mm_loadu_si128((__m128i const*)src), _mm_loadu_si128((__m128i const*)(src + 16)))); \
+}
+
+SIMD_CONVERT_NARROW_SSE2(simd_convert_block_i16_i8_sse2, _mm_packs_epi16)
+SIMD_CONVERT_NARROW_SSE2(simd_convert_block_i16_u8_sse2, _mm_packus_epi16)
+SIMD_CONVERT_NARROW_SSE2(simd_convert_block_i32_i16_sse2, _mm_packs_epi32)
+
+#undef SIMD_CONVERT_NARROW_SSE2
+
+/* Lanes of 8 or 16 bits are widened to 32 bits on the way to f32, 16 bytes of them
+ * into 64 or 32 bytes of floats.
+ */
+static PYSIMD_TARGET_SSE2 void simd_convert_store_ps_sse2(unsigned char* dst, __m128i x)
+{
+	_mm_storeu_ps((float*)dst, _mm_cvtepi32_ps(x));
+}
+
+static PYSIMD_TARGET_SSE2 void simd_convert_block_u8_f32_sse2(unsigned char* dst, const unsigned char* src)
+{
+	const __m128i x = _mm_loadu_si128((__m128i const*)src);
+	const __m128i lo = _mm_unpacklo_epi8(x, _mm_setzero_si128());
+	const __m128i hi = _mm_unpackhi_epi8(x, _mm_setzero_si128());
+	simd_convert_store_ps_sse2(dst, _mm_unpacklo_epi16(lo, _mm_setzero_si128()));
+	simd_convert_store_ps_sse2(dst + 16, _mm_unpackhi_epi16(lo, _mm_setzero_si128()));
+	simd_convert_store_ps_sse2(dst + 32, _mm_unpacklo_epi16(hi, _mm_setzero_si128()));
+	simd_convert_store_ps_sse2(dst + 48, _mm_unpackhi_epi16(hi, _mm_setzero_si128()));
+}
+
+// Unpacking a lane into the top of a wider one and shifting it back down extends its sign
+static PYSIMD_TARGET_SSE2 void simd_convert_block_i8_f32_sse2(unsigned char* dst, const unsigned char* src)
+{
+	const __m128i x = _mm_loadu_si128((__m128i const*)src);
+	const __m128i lo = _mm_unpacklo_epi8(x, x);
+	const __m128i hi = _mm_unpackhi_epi8(x, x);
+	simd_convert_store_ps_sse2(dst, _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 24));
+	simd_convert_store_ps_sse2(dst + 16, _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 24));
+	simd_convert_store_ps_sse2(dst + 32, _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 24));
+	simd_convert_store_ps_sse2(dst + 48, _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 24));
+}
+
+static PYSIMD_TARGET_SSE2 void simd_convert_block_u16_f32_sse2(unsigned char* dst, const unsigned char* src)
+{
+	const __m128i x = _mm_loadu_si128((__m128i const*)src);
+	simd_convert_store_ps_sse2(dst, _mm_unpacklo_epi16(x, _mm_setzero_si128()));
+	simd_convert_store_ps_sse2(dst + 16, _mm_unpackhi_epi16(x, _mm_setzero_si128()));
+}
+
+static PYSIMD_TARGET_SSE2 void simd_convert_block_i16_f32_sse2(unsigned char* dst, const unsigned char* src)
+{
+	const __m128i x = _mm_loadu_si128((__m128i const*)src);
+	simd_convert_store_ps_sse2(dst, _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+	simd_convert_store_ps_sse2(dst + 16, _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+}
+
+static PYSIMD_TARGET_SSE2 void simd_convert_block_i32_f32_sse2(unsigned char* dst, const unsigned char* src)
+{
+	simd_convert_store_ps_sse2(dst, _mm_loadu_si128((__m128i const*)src));
+}
+
+/* Truncation gives 0x80000000 for floats out of range and NaN, which is right for
+ * large negative floats. Large positive ones flip it to 0x7fffffff, NaNs clear it.
+ */
+static PYSIMD_TARGET_SSE2 void simd_convert_block_f32_i32_sse2(unsigned char* dst, const unsigned char* src)
+{
+	const __m128 x = _mm_loadu_ps((const float*)src);
+	const __m128i too_large = _mm_castps_si128(_mm_cmpge_ps(x, _mm_set1_ps(2147483648.0f)));
+	const __m128i nan = _mm_castps_si128(_mm_cmpunord_ps(x, x));
+	_mm_storeu_si128((__m128i*)dst, _mm_andnot_si128(nan, _mm_xor_si128(_mm_cvttps_epi32(x), too_large)));
+}
+
+static PYSIMD_TARGET_SSE2 void simd_convert_block_i32_f64_sse2(unsigned char* dst, const unsigned char* src)
+{
+	_mm_storeu_pd((double*)dst, _mm_cvtepi32_pd(_mm_loadl_epi64((__m128i const*)src)));
+}
+
+static PYSIMD_TARGET_SSE2 void simd_convert_block_f32_f64_sse2(unsigned char* dst, const unsigned char* src)
+{
+	_mm_storeu_pd((double*)dst, _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((__m128i const*)src))));
+}
+
+static PYSIMD_TARGET_SSE2 void simd_convert_block_f64_f32_sse2(unsigned char* dst, const unsigned char* src)
+{
+	_mm_storel_epi64((__m128i*)dst, _mm_castps_si128(_mm_cvtpd_ps(_mm_loadu_pd((const double*)src))));
+}
+
+SIMD_VEC_CONVERT(simd_convert_i8_i16_sse2, PYSIMD_TARGET_SSE2, 16, 32, simd_convert_block_i8_i16_sse2, PYSIMD_LANE_INT, 1, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_u8_i16_sse2, PYSIMD_TARGET_SSE2, 16, 32, simd_convert_block_u8_x16_sse2, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_u8_u16_sse2, PYSIMD_TARGET_SSE2, 16, 32, simd_convert_block_u8_x16_sse2, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_UINT, 2)
+SIMD_VEC_CONVERT(simd_convert_i16_i32_sse2, PYSIMD_TARGET_SSE2, 16, 32, simd_convert_block_i16_i32_sse2, PYSIMD_LANE_INT, 2, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_u16_i32_sse2, PYSIMD_TARGET_SSE2, 16, 32, simd_convert_block_u16_x32_sse2, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_u16_u32_sse2, PYSIMD_TARGET_SSE2, 16, 32, simd_convert_block_u16_x32_sse2, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_UINT, 4)
+SIMD_VEC_CONVERT(simd_convert_i32_i64_sse2, PYSIMD_TARGET_SSE2, 16, 32, simd_convert_block_i32_i64_sse2, PYSIMD_LANE_INT, 4, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u32_i64_sse2, PYSIMD_TARGET_SSE2, 16, 32, simd_convert_block_u32_x64_sse2, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u32_u64_sse2, PYSIMD_TARGET_SSE2, 16, 32, simd_convert_block_u32_x64_sse2, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_UINT, 8)
+SIMD_VEC_CONVERT(simd_convert_i16_i8_sse2, PYSIMD_TARGET_SSE2, 32, 16, simd_convert_block_i16_i8_sse2, PYSIMD_LANE_INT, 2, PYSIMD_LANE_INT, 1)
+SIMD_VEC_CONVERT(simd_convert_i16_u8_sse2, PYSIMD_TARGET_SSE2, 32, 16, simd_convert_block_i16_u8_sse2, PYSIMD_LANE_INT, 2, PYSIMD_LANE_UINT, 1)
+SIMD_VEC_CONVERT(simd_convert_i32_i16_sse2, PYSIMD_TARGET_SSE2, 32, 16, simd_convert_block_i32_i16_sse2, PYSIMD_LANE_INT, 4, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_u8_f32_sse2, PYSIMD_TARGET_SSE2, 16, 64, simd_convert_block_u8_f32_sse2, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_i8_f32_sse2, PYSIMD_TARGET_SSE2, 16, 64, simd_convert_block_i8_f32_sse2, PYSIMD_LANE_INT, 1, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_u16_f32_sse2, PYSIMD_TARGET_SSE2, 16, 32, simd_convert_block_u16_f32_sse2, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_i16_f32_sse2, PYSIMD_TARGET_SSE2, 16, 32, simd_convert_block_i16_f32_sse2, PYSIMD_LANE_INT, 2, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_i32_f32_sse2, PYSIMD_TARGET_SSE2, 16, 16, simd_convert_block_i32_f32_sse2, PYSIMD_LANE_INT, 4, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_f32_i32_sse2, PYSIMD_TARGET_SSE2, 16, 16, simd_convert_block_f32_i32_sse2, PYSIMD_LANE_FLOAT, 4, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_i32_f64_sse2, PYSIMD_TARGET_SSE2, 8, 16, simd_convert_block_i32_f64_sse2, PYSIMD_LANE_INT, 4, PYSIMD_LANE_FLOAT, 8)
+SIMD_VEC_CONVERT(simd_convert_f32_f64_sse2, PYSIMD_TARGET_SSE2, 8, 16, simd_convert_block_f32_f64_sse2, PYSIMD_LANE_FLOAT, 4, PYSIMD_LANE_FLOAT, 8)
+SIMD_VEC_CONVERT(simd_convert_f64_f32_sse2, PYSIMD_TARGET_SSE2, 16, 8, simd_convert_block_f64_f32_sse2, PYSIMD_LANE_FLOAT, 8, PYSIMD_LANE_FLOAT, 4)
+
+#endif // PYSIMD_X86_SSE2
+
+#if defined(PYSIMD_X86_AVX2)
+
+static PYSIMD_TARGET_AVX2 void simd_convert_store32_avx2(unsigned char* dst, __m256i x) { _mm256_storeu_si256((__m256i*)dst, x); }
+
+// AVX2 widens with a single sign or zero extension from as many bytes as fill a register
+#define SIMD_CONVERT_WIDEN_AVX2(name, load, extend) \
+static PYSIMD_TARGET_AVX2 void name(unsigned char* dst, const unsigned char* src) { \
+	simd_convert_store32_avx2(dst, extend(load(src))); \
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_convert_u8_f32_lanes_avx2(__m128i x) { return _mm256_castps_si256(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(x))); }
+static PYSIMD_TARGET_AVX2 __m256i simd_convert_i8_f32_lanes_avx2(__m128i x) { return _mm256_castps_si256(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(x))); }
+static PYSIMD_TARGET_AVX2 __m256i simd_convert_u16_f32_lanes_avx2(__m128i x) { return _mm256_castps_si256(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(x))); }
+static PYSIMD_TARGET_AVX2 __m256i simd_convert_i16_f32_lanes_avx2(__m128i x) { return _mm256_castps_si256(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(x))); }
+static PYSIMD_TARGET_AVX2 __m256i simd_convert_i32_f64_lanes_avx2(__m128i x) { return _mm256_castpd_si256(_mm256_cvtepi32_pd(x)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_convert_f32_f64_lanes_avx2(__m128i x) { return _mm256_castpd_si256(_mm256_cvtps_pd(_mm_castsi128_ps(x))); }
+
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_i8_i16_avx2, simd_convert_load16_sse2, _mm256_cvtepi8_epi16)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_u8_x16_avx2, simd_convert_load16_sse2, _mm256_cvtepu8_epi16)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_i8_i32_avx2, simd_convert_load8_sse2, _mm256_cvtepi8_epi32)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_u8_x32_avx2, simd_convert_load8_sse2, _mm256_cvtepu8_epi32)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_i8_i64_avx2, simd_convert_load4_sse2, _mm256_cvtepi8_epi64)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_u8_x64_avx2, simd_convert_load4_sse2, _mm256_cvtepu8_epi64)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_i16_i32_avx2, simd_convert_load16_sse2, _mm256_cvtepi16_epi32)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_u16_x32_avx2, simd_convert_load16_sse2, _mm256_cvtepu16_epi32)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_i16_i64_avx2, simd_convert_load8_sse2, _mm256_cvtepi16_epi64)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_u16_x64_avx2, simd_convert_load8_sse2, _mm256_cvtepu16_epi64)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_i32_i64_avx2, simd_convert_load16_sse2, _mm256_cvtepi32_epi64)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_u32_x64_avx2, simd_convert_load16_sse2, _mm256_cvtepu32_epi64)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_u8_f32_avx2, simd_convert_load8_sse2, simd_convert_u8_f32_lanes_avx2)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_i8_f32_avx2, simd_convert_load8_sse2, simd_convert_i8_f32_lanes_avx2)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_u16_f32_avx2, simd_convert_load16_sse2, simd_convert_u16_f32_lanes_avx2)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_i16_f32_avx2, simd_convert_load16_sse2, simd_convert_i16_f32_lanes_avx2)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_i32_f64_avx2, simd_convert_load16_sse2, simd_convert_i32_f64_lanes_avx2)
+SIMD_CONVERT_WIDEN_AVX2(simd_convert_block_f32_f64_avx2, simd_convert_load16_sse2, simd_convert_f32_f64_lanes_avx2)
+
+#undef SIMD_CONVERT_WIDEN_AVX2
+
+// Packs work within each half, the packed quarters are put back in order after
+#define SIMD_CONVERT_NARROW_AVX2(name, pack) \
+static PYSIMD_TARGET_AVX2 void name(unsigned char* dst, const unsigned char* src) { \
+	const __m256i packed = pack(_mm256_loadu_si256((__m256i const*)src), _mm256_loadu_si256((__m256i const*)(src + 32))); \
+	simd_convert_store32_avx2(dst, _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0))); \
+}
+
+SIMD_CONVERT_NARROW_AVX2(simd_convert_block_i16_i8_avx2, _mm256_packs_epi16)
+SIMD_CONVERT_NARROW_AVX2(simd_convert_block_i16_u8_avx2, _mm256_packus_epi16)
+SIMD_CONVERT_NARROW_AVX2(simd_convert_block_i32_i16_avx2, _mm256_packs_epi32)
+SIMD_CONVERT_NARROW_AVX2(simd_convert_block_i32_u16_avx2, _mm256_packus_epi32)
+
+#undef SIMD_CONVERT_NARROW_AVX2
+
+static PYSIMD_TARGET_AVX2 void simd_convert_block_i32_f32_avx2(unsigned char* dst, const unsigned char* src)
+{
+	_mm256_storeu_ps((float*)dst, _mm256_cvtepi32_ps(_mm256_loadu_si256((__m256i const*)src)));
+}
+
+static PYSIMD_TARGET_AVX2 void simd_convert_block_f32_i32_avx2(unsigned char* dst, const unsigned char* src)
+{
+	const __m256 x = _mm256_loadu_ps((const float*)src);
+	const __m256i too_large = _mm256_castps_si256(_mm256_cmp_ps(x, _mm256_set1_ps(2147483648.0f), _CMP_GE_OQ));
+	const __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+	simd_convert_store32_avx2(dst, _mm256_andnot_si256(nan, _mm256_xor_si256(_mm256_cvttps_epi32(x), too_large)));
+}
+
+static PYSIMD_TARGET_AVX2 void simd_convert_block_f64_f32_avx2(unsigned char* dst, const unsigned char* src)
+{
+	_mm_storeu_ps((float*)dst, _mm256_cvtpd_ps(_mm256_loadu_pd((const double*)src)));
+}
+
+/* There is no 64 bit integer conversion before AVX-512DQ. The high half of an i64 is
+ * converted as a signed 32 bit integer and scaled by 2^32, the low half is made exact
+ * by placing it in the mantissa of 2^52, and the two are added with a single rounding.
+ */
+static PYSIMD_TARGET_AVX2 void simd_convert_block_i64_f64_avx2(unsigned char* dst, const unsigned char* src)
+{
+	const __m256i x = _mm256_loadu_si256((__m256i const*)src);
+	const __m256i magic = _mm256_set1_epi64x(0x4330000000000000LL);
+	const __m256d low = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_blend_epi32(magic, x, 0x55)), _mm256_set1_pd(4503599627370496.0));
+	const __m128i high_halves = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(1, 3, 5, 7, 1, 3, 5, 7)));
+	const __m256d high = _mm256_mul_pd(_mm256_cvtepi32_pd(high_halves), _mm256_set1_pd(4294967296.0));
+	_mm256_storeu_pd((double*)dst, _mm256_add_pd(high, low));
+}
+
+/* The other way, the truncated double is split into a high half, floor(x / 2^32), and
+ * a low half below 2^32, both exact. The high half converts as an i32, the low half is
+ * read out of the mantissa of itself plus 2^52. Out of range doubles saturate.
+ */
+static PYSIMD_TARGET_AVX2 void simd_convert_block_f64_i64_avx2(unsigned char* dst, const unsigned char* src)
+{
+	const __m256d x = _mm256_loadu_pd((const double*)src);
+	const __m256d whole = _mm256_round_pd(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+	const __m256d high = _mm256_floor_pd(_mm256_mul_pd(whole, _mm256_set1_pd(1.0 / 4294967296.0)));
+	const __m256d low = _mm256_sub_pd(whole, _mm256_mul_pd(high, _mm256_set1_pd(4294967296.0)));
+	const __m256i low_bits = _mm256_castpd_si256(_mm256_add_pd(low, _mm256_set1_pd(4503599627370496.0)));
+	const __m256i high_bits = _mm256_slli_epi64(_mm256_cvtepi32_epi64(_mm256_cvttpd_epi32(high)), 32);
+	const __m256i too_large = _mm256_castpd_si256(_mm256_cmp_pd(x, _mm256_set1_pd(9223372036854775808.0), _CMP_GE_OQ));
+	const __m256i too_small = _mm256_castpd_si256(_mm256_cmp_pd(x, _mm256_set1_pd(-9223372036854775808.0), _CMP_LT_OQ));
+	const __m256i nan = _mm256_castpd_si256(_mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+	__m256i result = _mm256_or_si256(high_bits, _mm256_and_si256(low_bits, _mm256_set1_epi64x(0xffffffffLL)));
+	result = _mm256_blendv_epi8(result, _mm256_set1_epi64x(INT64_MAX), too_large);
+	result = _mm256_blendv_epi8(result, _mm256_set1_epi64x(INT64_MIN), too_small);
+	simd_convert_store32_avx2(dst, _mm256_andnot_si256(nan, result));
+}
+
+SIMD_VEC_CONVERT(simd_convert_i8_i16_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_i8_i16_avx2, PYSIMD_LANE_INT, 1, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_u8_i16_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_u8_x16_avx2, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_u8_u16_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_u8_x16_avx2, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_UINT, 2)
+SIMD_VEC_CONVERT(simd_convert_i8_i32_avx2, PYSIMD_TARGET_AVX2, 8, 32, simd_convert_block_i8_i32_avx2, PYSIMD_LANE_INT, 1, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_u8_i32_avx2, PYSIMD_TARGET_AVX2, 8, 32, simd_convert_block_u8_x32_avx2, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_u8_u32_avx2, PYSIMD_TARGET_AVX2, 8, 32, simd_convert_block_u8_x32_avx2, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_UINT, 4)
+SIMD_VEC_CONVERT(simd_convert_i8_i64_avx2, PYSIMD_TARGET_AVX2, 4, 32, simd_convert_block_i8_i64_avx2, PYSIMD_LANE_INT, 1, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u8_i64_avx2, PYSIMD_TARGET_AVX2, 4, 32, simd_convert_block_u8_x64_avx2, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u8_u64_avx2, PYSIMD_TARGET_AVX2, 4, 32, simd_convert_block_u8_x64_avx2, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_UINT, 8)
+SIMD_VEC_CONVERT(simd_convert_i16_i32_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_i16_i32_avx2, PYSIMD_LANE_INT, 2, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_u16_i32_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_u16_x32_avx2, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_u16_u32_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_u16_x32_avx2, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_UINT, 4)
+SIMD_VEC_CONVERT(simd_convert_i16_i64_avx2, PYSIMD_TARGET_AVX2, 8, 32, simd_convert_block_i16_i64_avx2, PYSIMD_LANE_INT, 2, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u16_i64_avx2, PYSIMD_TARGET_AVX2, 8, 32, simd_convert_block_u16_x64_avx2, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u16_u64_avx2, PYSIMD_TARGET_AVX2, 8, 32, simd_convert_block_u16_x64_avx2, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_UINT, 8)
+SIMD_VEC_CONVERT(simd_convert_i32_i64_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_i32_i64_avx2, PYSIMD_LANE_INT, 4, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u32_i64_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_u32_x64_avx2, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u32_u64_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_u32_x64_avx2, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_UINT, 8)
+SIMD_VEC_CONVERT(simd_convert_i16_i8_avx2, PYSIMD_TARGET_AVX2, 64, 32, simd_convert_block_i16_i8_avx2, PYSIMD_LANE_INT, 2, PYSIMD_LANE_INT, 1)
+SIMD_VEC_CONVERT(simd_convert_i16_u8_avx2, PYSIMD_TARGET_AVX2, 64, 32, simd_convert_block_i16_u8_avx2, PYSIMD_LANE_INT, 2, PYSIMD_LANE_UINT, 1)
+SIMD_VEC_CONVERT(simd_convert_i32_i16_avx2, PYSIMD_TARGET_AVX2, 64, 32, simd_convert_block_i32_i16_avx2, PYSIMD_LANE_INT, 4, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_i32_u16_avx2, PYSIMD_TARGET_AVX2, 64, 32, simd_convert_block_i32_u16_avx2, PYSIMD_LANE_INT, 4, PYSIMD_LANE_UINT, 2)
+SIMD_VEC_CONVERT(simd_convert_u8_f32_avx2, PYSIMD_TARGET_AVX2, 8, 32, simd_convert_block_u8_f32_avx2, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_i8_f32_avx2, PYSIMD_TARGET_AVX2, 8, 32, simd_convert_block_i8_f32_avx2, PYSIMD_LANE_INT, 1, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_u16_f32_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_u16_f32_avx2, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_i16_f32_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_i16_f32_avx2, PYSIMD_LANE_INT, 2, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_i32_f32_avx2, PYSIMD_TARGET_AVX2, 32, 32, simd_convert_block_i32_f32_avx2, PYSIMD_LANE_INT, 4, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_f32_i32_avx2, PYSIMD_TARGET_AVX2, 32, 32, simd_convert_block_f32_i32_avx2, PYSIMD_LANE_FLOAT, 4, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_i32_f64_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_i32_f64_avx2, PYSIMD_LANE_INT, 4, PYSIMD_LANE_FLOAT, 8)
+SIMD_VEC_CONVERT(simd_convert_f32_f64_avx2, PYSIMD_TARGET_AVX2, 16, 32, simd_convert_block_f32_f64_avx2, PYSIMD_LANE_FLOAT, 4, PYSIMD_LANE_FLOAT, 8)
+SIMD_VEC_CONVERT(simd_convert_f64_f32_avx2, PYSIMD_TARGET_AVX2, 32, 16, simd_convert_block_f64_f32_avx2, PYSIMD_LANE_FLOAT, 8, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_i64_f64_avx2, PYSIMD_TARGET_AVX2, 32, 32, simd_convert_block_i64_f64_avx2, PYSIMD_LANE_INT, 8, PYSIMD_LANE_FLOAT, 8)
+SIMD_VEC_CONVERT(simd_convert_f64_i64_avx2, PYSIMD_TARGET_AVX2, 32, 32, simd_convert_block_f64_i64_avx2, PYSIMD_LANE_FLOAT, 8, PYSIMD_LANE_INT, 8)
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+static PYSIMD_TARGET_AVX512 __m256i simd_convert_load32_avx512(const unsigned char* src) { return _mm256_loadu_si256((__m256i const*)src); }
+static PYSIMD_TARGET_AVX512 void simd_convert_store64_avx512(unsigned char* dst, __m512i x) { _mm512_storeu_si512((void*)dst, x); }
+static PYSIMD_TARGET_AVX512 void simd_convert_store32_avx512(unsigned char* dst, __m256i x) { _mm256_storeu_si256((__m256i*)dst, x); }
+static PYSIMD_TARGET_AVX512 void simd_convert_store16_avx512(unsigned char* dst, __m128i x) { _mm_storeu_si128((__m128i*)dst, x); }
+static PYSIMD_TARGET_AVX512 void simd_convert_store8_avx512(unsigned char* dst, __m128i x) { _mm_storel_epi64((__m128i*)dst, x); }
+
+#define SIMD_CONVERT_WIDEN_AVX512(name, load, extend) \
+static PYSIMD_TARGET_AVX512 void name(unsigned char* dst, const unsigned char* src) { \
+	simd_convert_store64_avx512(dst, extend(load(src))); \
+}
+
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_u8_f32_lanes_avx512(__m128i x) { return _mm512_castps_si512(_mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(x))); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_i8_f32_lanes_avx512(__m128i x) { return _mm512_castps_si512(_mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(x))); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_u16_f32_lanes_avx512(__m256i x) { return _mm512_castps_si512(_mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(x))); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_i16_f32_lanes_avx512(__m256i x) { return _mm512_castps_si512(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(x))); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_i32_f64_lanes_avx512(__m256i x) { return _mm512_castpd_si512(_mm512_cvtepi32_pd(x)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_u32_f64_lanes_avx512(__m256i x) { return _mm512_castpd_si512(_mm512_cvtepu32_pd(x)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_f32_f64_lanes_avx512(__m256i x) { return _mm512_castpd_si512(_mm512_cvtps_pd(_mm256_castsi256_ps(x))); }
+
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_i8_i16_avx512, simd_convert_load32_avx512, _mm512_cvtepi8_epi16)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_u8_x16_avx512, simd_convert_load32_avx512, _mm512_cvtepu8_epi16)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_i8_i32_avx512, simd_convert_load16_sse2, _mm512_cvtepi8_epi32)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_u8_x32_avx512, simd_convert_load16_sse2, _mm512_cvtepu8_epi32)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_i8_i64_avx512, simd_convert_load8_sse2, _mm512_cvtepi8_epi64)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_u8_x64_avx512, simd_convert_load8_sse2, _mm512_cvtepu8_epi64)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_i16_i32_avx512, simd_convert_load32_avx512, _mm512_cvtepi16_epi32)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_u16_x32_avx512, simd_convert_load32_avx512, _mm512_cvtepu16_epi32)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_i16_i64_avx512, simd_convert_load16_sse2, _mm512_cvtepi16_epi64)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_u16_x64_avx512, simd_convert_load16_sse2, _mm512_cvtepu16_epi64)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_i32_i64_avx512, simd_convert_load32_avx512, _mm512_cvtepi32_epi64)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_u32_x64_avx512, simd_convert_load32_avx512, _mm512_cvtepu32_epi64)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_u8_f32_avx512, simd_convert_load16_sse2, simd_convert_u8_f32_lanes_avx512)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_i8_f32_avx512, simd_convert_load16_sse2, simd_convert_i8_f32_lanes_avx512)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_u16_f32_avx512, simd_convert_load32_avx512, simd_convert_u16_f32_lanes_avx512)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_i16_f32_avx512, simd_convert_load32_avx512, simd_convert_i16_f32_lanes_avx512)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_i32_f64_avx512, simd_convert_load32_avx512, simd_convert_i32_f64_lanes_avx512)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_u32_f64_avx512, simd_convert_load32_avx512, simd_convert_u32_f64_lanes_avx512)
+SIMD_CONVERT_WIDEN_AVX512(simd_convert_block_f32_f64_avx512, simd_convert_load32_avx512, simd_convert_f32_f64_lanes_avx512)
+
+#undef SIMD_CONVERT_WIDEN_AVX512
+
+/* AVX-512 narrows with saturation from any width to any narrower one, signed to signed
+ * or unsigned to unsigned. Signed lanes going unsigned are clamped at 0 first, and
+ * unsigned lanes going signed are clamped to the largest signed value first.
+ */
+#define SIMD_CONVERT_NARROW_AVX512(name, clamp, narrow, store) \
+static PYSIMD_TARGET_AVX512 void name(unsigned char* dst, const unsigned char* src) { \
+	store(dst, narrow(clamp(_mm512_loadu_si512((void const*)src)))); \
+}
+
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_keep_avx512(__m512i x) { return x; }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_positive_16_avx512(__m512i x) { return _mm512_max_epi16(x, _mm512_setzero_si512()); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_positive_32_avx512(__m512i x) { return _mm512_max_epi32(x, _mm512_setzero_si512()); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_positive_64_avx512(__m512i x) { return _mm512_max_epi64(x, _mm512_setzero_si512()); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_below_i8_16_avx512(__m512i x) { return _mm512_min_epu16(x, _mm512_set1_epi16(INT8_MAX)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_below_i8_32_avx512(__m512i x) { return _mm512_min_epu32(x, _mm512_set1_epi32(INT8_MAX)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_below_i16_32_avx512(__m512i x) { return _mm512_min_epu32(x, _mm512_set1_epi32(INT16_MAX)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_below_i8_64_avx512(__m512i x) { return _mm512_min_epu64(x, _mm512_set1_epi64(INT8_MAX)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_below_i16_64_avx512(__m512i x) { return _mm512_min_epu64(x, _mm512_set1_epi64(INT16_MAX)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_convert_below_i32_64_avx512(__m512i x) { return _mm512_min_epu64(x, _mm512_set1_epi64(INT32_MAX)); }
+
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i16_i8_avx512, simd_convert_keep_avx512, _mm512_cvtsepi16_epi8, simd_convert_store32_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i16_u8_avx512, simd_convert_positive_16_avx512, _mm512_cvtusepi16_epi8, simd_convert_store32_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u16_i8_avx512, simd_convert_below_i8_16_avx512, _mm512_cvtusepi16_epi8, simd_convert_store32_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u16_u8_avx512, simd_convert_keep_avx512, _mm512_cvtusepi16_epi8, simd_convert_store32_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i32_i8_avx512, simd_convert_keep_avx512, _mm512_cvtsepi32_epi8, simd_convert_store16_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i32_u8_avx512, simd_convert_positive_32_avx512, _mm512_cvtusepi32_epi8, simd_convert_store16_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u32_i8_avx512, simd_convert_below_i8_32_avx512, _mm512_cvtusepi32_epi8, simd_convert_store16_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u32_u8_avx512, simd_convert_keep_avx512, _mm512_cvtusepi32_epi8, simd_convert_store16_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i32_i16_avx512, simd_convert_keep_avx512, _mm512_cvtsepi32_epi16, simd_convert_store32_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i32_u16_avx512, simd_convert_positive_32_avx512, _mm512_cvtusepi32_epi16, simd_convert_store32_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u32_i16_avx512, simd_convert_below_i16_32_avx512, _mm512_cvtusepi32_epi16, simd_convert_store32_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u32_u16_avx512, simd_convert_keep_avx512, _mm512_cvtusepi32_epi16, simd_convert_store32_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i64_i8_avx512, simd_convert_keep_avx512, _mm512_cvtsepi64_epi8, simd_convert_store8_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i64_u8_avx512, simd_convert_positive_64_avx512, _mm512_cvtusepi64_epi8, simd_convert_store8_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u64_i8_avx512, simd_convert_below_i8_64_avx512, _mm512_cvtusepi64_epi8, simd_convert_store8_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u64_u8_avx512, simd_convert_keep_avx512, _mm512_cvtusepi64_epi8, simd_convert_store8_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i64_i16_avx512, simd_convert_keep_avx512, _mm512_cvtsepi64_epi16, simd_convert_store16_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i64_u16_avx512, simd_convert_positive_64_avx512, _mm512_cvtusepi64_epi16, simd_convert_store16_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u64_i16_avx512, simd_convert_below_i16_64_avx512, _mm512_cvtusepi64_epi16, simd_convert_store16_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u64_u16_avx512, simd_convert_keep_avx512, _mm512_cvtusepi64_epi16, simd_convert_store16_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i64_i32_avx512, simd_convert_keep_avx512, _mm512_cvtsepi64_epi32, simd_convert_store32_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_i64_u32_avx512, simd_convert_positive_64_avx512, _mm512_cvtusepi64_epi32, simd_convert_store32_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u64_i32_avx512, simd_convert_below_i32_64_avx512, _mm512_cvtusepi64_epi32, simd_convert_store32_avx512)
+SIMD_CONVERT_NARROW_AVX512(simd_convert_block_u64_u32_avx512, simd_convert_keep_avx512, _mm512_cvtusepi64_epi32, simd_convert_store32_avx512)
+
+#undef SIMD_CONVERT_NARROW_AVX512
+
+static PYSIMD_TARGET_AVX512 void simd_convert_block_i32_f32_avx512(unsigned char* dst, const unsigned char* src)
+{
+	_mm512_storeu_ps((float*)dst, _mm512_cvtepi32_ps(_mm512_loadu_si512((void const*)src)));
+}
+
+static PYSIMD_TARGET_AVX512 void simd_convert_block_u32_f32_avx512(unsigned char* dst, const unsigned char* src)
+{
+	_mm512_storeu_ps((float*)dst, _mm512_cvtepu32_ps(_mm512_loadu_si512((void const*)src)));
+}
+
+static PYSIMD_TARGET_AVX512 void simd_convert_block_f32_i32_avx512(unsigned char* dst, const unsigned char* src)
+{
+	const __m512 x = _mm512_loadu_ps((const float*)src);
+	const __mmask16 too_large = _mm512_cmp_ps_mask(x, _mm512_set1_ps(2147483648.0f), _CMP_GE_OQ);
+	const __mmask16 number = _mm512_cmp_ps_mask(x, x, _CMP_ORD_Q);
+	const __m512i result = _mm512_mask_mov_epi32(_mm512_cvttps_epi32(x), too_large, _mm512_set1_epi32(INT32_MAX));
+	simd_convert_store64_avx512(dst, _mm512_maskz_mov_epi32(number, result));
+}
+
+static PYSIMD_TARGET_AVX512 void simd_convert_block_f64_f32_avx512(unsigned char* dst, const unsigned char* src)
+{
+	_mm256_storeu_ps((float*)dst, _mm512_cvtpd_ps(_mm512_loadu_pd((const double*)src)));
+}
+
+SIMD_VEC_CONVERT(simd_convert_i8_i16_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_i8_i16_avx512, PYSIMD_LANE_INT, 1, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_u8_i16_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_u8_x16_avx512, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_u8_u16_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_u8_x16_avx512, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_UINT, 2)
+SIMD_VEC_CONVERT(simd_convert_i8_i32_avx512, PYSIMD_TARGET_AVX512, 16, 64, simd_convert_block_i8_i32_avx512, PYSIMD_LANE_INT, 1, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_u8_i32_avx512, PYSIMD_TARGET_AVX512, 16, 64, simd_convert_block_u8_x32_avx512, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_u8_u32_avx512, PYSIMD_TARGET_AVX512, 16, 64, simd_convert_block_u8_x32_avx512, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_UINT, 4)
+SIMD_VEC_CONVERT(simd_convert_i8_i64_avx512, PYSIMD_TARGET_AVX512, 8, 64, simd_convert_block_i8_i64_avx512, PYSIMD_LANE_INT, 1, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u8_i64_avx512, PYSIMD_TARGET_AVX512, 8, 64, simd_convert_block_u8_x64_avx512, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u8_u64_avx512, PYSIMD_TARGET_AVX512, 8, 64, simd_convert_block_u8_x64_avx512, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_UINT, 8)
+SIMD_VEC_CONVERT(simd_convert_i16_i32_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_i16_i32_avx512, PYSIMD_LANE_INT, 2, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_u16_i32_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_u16_x32_avx512, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_u16_u32_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_u16_x32_avx512, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_UINT, 4)
+SIMD_VEC_CONVERT(simd_convert_i16_i64_avx512, PYSIMD_TARGET_AVX512, 16, 64, simd_convert_block_i16_i64_avx512, PYSIMD_LANE_INT, 2, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u16_i64_avx512, PYSIMD_TARGET_AVX512, 16, 64, simd_convert_block_u16_x64_avx512, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u16_u64_avx512, PYSIMD_TARGET_AVX512, 16, 64, simd_convert_block_u16_x64_avx512, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_UINT, 8)
+SIMD_VEC_CONVERT(simd_convert_i32_i64_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_i32_i64_avx512, PYSIMD_LANE_INT, 4, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u32_i64_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_u32_x64_avx512, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_INT, 8)
+SIMD_VEC_CONVERT(simd_convert_u32_u64_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_u32_x64_avx512, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_UINT, 8)
+SIMD_VEC_CONVERT(simd_convert_i16_i8_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_i16_i8_avx512, PYSIMD_LANE_INT, 2, PYSIMD_LANE_INT, 1)
+SIMD_VEC_CONVERT(simd_convert_i16_u8_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_i16_u8_avx512, PYSIMD_LANE_INT, 2, PYSIMD_LANE_UINT, 1)
+SIMD_VEC_CONVERT(simd_convert_u16_i8_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_u16_i8_avx512, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_INT, 1)
+SIMD_VEC_CONVERT(simd_convert_u16_u8_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_u16_u8_avx512, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_UINT, 1)
+SIMD_VEC_CONVERT(simd_convert_i32_i8_avx512, PYSIMD_TARGET_AVX512, 64, 16, simd_convert_block_i32_i8_avx512, PYSIMD_LANE_INT, 4, PYSIMD_LANE_INT, 1)
+SIMD_VEC_CONVERT(simd_convert_i32_u8_avx512, PYSIMD_TARGET_AVX512, 64, 16, simd_convert_block_i32_u8_avx512, PYSIMD_LANE_INT, 4, PYSIMD_LANE_UINT, 1)
+SIMD_VEC_CONVERT(simd_convert_u32_i8_avx512, PYSIMD_TARGET_AVX512, 64, 16, simd_convert_block_u32_i8_avx512, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_INT, 1)
+SIMD_VEC_CONVERT(simd_convert_u32_u8_avx512, PYSIMD_TARGET_AVX512, 64, 16, simd_convert_block_u32_u8_avx512, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_UINT, 1)
+SIMD_VEC_CONVERT(simd_convert_i32_i16_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_i32_i16_avx512, PYSIMD_LANE_INT, 4, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_i32_u16_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_i32_u16_avx512, PYSIMD_LANE_INT, 4, PYSIMD_LANE_UINT, 2)
+SIMD_VEC_CONVERT(simd_convert_u32_i16_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_u32_i16_avx512, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_u32_u16_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_u32_u16_avx512, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_UINT, 2)
+SIMD_VEC_CONVERT(simd_convert_i64_i8_avx512, PYSIMD_TARGET_AVX512, 64, 8, simd_convert_block_i64_i8_avx512, PYSIMD_LANE_INT, 8, PYSIMD_LANE_INT, 1)
+SIMD_VEC_CONVERT(simd_convert_i64_u8_avx512, PYSIMD_TARGET_AVX512, 64, 8, simd_convert_block_i64_u8_avx512, PYSIMD_LANE_INT, 8, PYSIMD_LANE_UINT, 1)
+SIMD_VEC_CONVERT(simd_convert_u64_i8_avx512, PYSIMD_TARGET_AVX512, 64, 8, simd_convert_block_u64_i8_avx512, PYSIMD_LANE_UINT, 8, PYSIMD_LANE_INT, 1)
+SIMD_VEC_CONVERT(simd_convert_u64_u8_avx512, PYSIMD_TARGET_AVX512, 64, 8, simd_convert_block_u64_u8_avx512, PYSIMD_LANE_UINT, 8, PYSIMD_LANE_UINT, 1)
+SIMD_VEC_CONVERT(simd_convert_i64_i16_avx512, PYSIMD_TARGET_AVX512, 64, 16, simd_convert_block_i64_i16_avx512, PYSIMD_LANE_INT, 8, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_i64_u16_avx512, PYSIMD_TARGET_AVX512, 64, 16, simd_convert_block_i64_u16_avx512, PYSIMD_LANE_INT, 8, PYSIMD_LANE_UINT, 2)
+SIMD_VEC_CONVERT(simd_convert_u64_i16_avx512, PYSIMD_TARGET_AVX512, 64, 16, simd_convert_block_u64_i16_avx512, PYSIMD_LANE_UINT, 8, PYSIMD_LANE_INT, 2)
+SIMD_VEC_CONVERT(simd_convert_u64_u16_avx512, PYSIMD_TARGET_AVX512, 64, 16, simd_convert_block_u64_u16_avx512, PYSIMD_LANE_UINT, 8, PYSIMD_LANE_UINT, 2)
+SIMD_VEC_CONVERT(simd_convert_i64_i32_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_i64_i32_avx512, PYSIMD_LANE_INT, 8, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_i64_u32_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_i64_u32_avx512, PYSIMD_LANE_INT, 8, PYSIMD_LANE_UINT, 4)
+SIMD_VEC_CONVERT(simd_convert_u64_i32_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_u64_i32_avx512, PYSIMD_LANE_UINT, 8, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_u64_u32_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_u64_u32_avx512, PYSIMD_LANE_UINT, 8, PYSIMD_LANE_UINT, 4)
+SIMD_VEC_CONVERT(simd_convert_u8_f32_avx512, PYSIMD_TARGET_AVX512, 16, 64, simd_convert_block_u8_f32_avx512, PYSIMD_LANE_UINT, 1, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_i8_f32_avx512, PYSIMD_TARGET_AVX512, 16, 64, simd_convert_block_i8_f32_avx512, PYSIMD_LANE_INT, 1, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_u16_f32_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_u16_f32_avx512, PYSIMD_LANE_UINT, 2, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_i16_f32_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_i16_f32_avx512, PYSIMD_LANE_INT, 2, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_i32_f32_avx512, PYSIMD_TARGET_AVX512, 64, 64, simd_convert_block_i32_f32_avx512, PYSIMD_LANE_INT, 4, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_u32_f32_avx512, PYSIMD_TARGET_AVX512, 64, 64, simd_convert_block_u32_f32_avx512, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_FLOAT, 4)
+SIMD_VEC_CONVERT(simd_convert_f32_i32_avx512, PYSIMD_TARGET_AVX512, 64, 64, simd_convert_block_f32_i32_avx512, PYSIMD_LANE_FLOAT, 4, PYSIMD_LANE_INT, 4)
+SIMD_VEC_CONVERT(simd_convert_i32_f64_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_i32_f64_avx512, PYSIMD_LANE_INT, 4, PYSIMD_LANE_FLOAT, 8)
+SIMD_VEC_CONVERT(simd_convert_u32_f64_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_u32_f64_avx512, PYSIMD_LANE_UINT, 4, PYSIMD_LANE_FLOAT, 8)
+SIMD_VEC_CONVERT(simd_convert_f32_f64_avx512, PYSIMD_TARGET_AVX512, 32, 64, simd_convert_block_f32_f64_avx512, PYSIMD_LANE_FLOAT, 4, PYSIMD_LANE_FLOAT, 8)
+SIMD_VEC_CONVERT(simd_convert_f64_f32_avx512, PYSIMD_TARGET_AVX512, 64, 32, simd_convert_block_f64_f32_avx512, PYSIMD_LANE_FLOAT, 8, PYSIMD_LANE_FLOAT, 4)
+
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_VEC_CONVERT
+
+#endif // SIMD_VEC_CONVERT_H
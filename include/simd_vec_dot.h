@@ -0,0 +1,228 @@
+#ifndef SIMD_VEC_DOT_H
+#define SIMD_VEC_DOT_H
+
+#include "simd_vec_type.h"
+#include "vec_macros.h"
+#include "simd_vec_arith.h"
+
+/* Distance kernels read the lanes of two vectors of the same size pairwise, and sum
+ * them into up to three totals. dot sums a * b, l2 sums (a - b)^2, and cosine sums
+ * a * b, a * a and b * b at once. f32 totals are doubles in .f, i8 totals are exact
+ * in .i, unused totals are 0.
+ *
+ * The vector kernels keep two sets of accumulators of float or 32 bit lanes, and add
+ * them into the totals every PYSIMD_DIST_BLOCK lanes. That bounds the rounding of f32
+ * sums, and keeps i8 sums from overflowing, as 16384 * 255^2 < 2^31.
+ */
+
+enum pysimd_dist_metric {
+	PYSIMD_DIST_DOT,
+	PYSIMD_DIST_L2,
+	PYSIMD_DIST_COSINE
+};
+
+#define PYSIMD_N_DIST_METRICS 3
+
+#define PYSIMD_DIST_BLOCK 16384
+
+#define SIMD_DOT_STEP_SCALAR(totals, x, y) ((totals)[0] += (x) * (y))
+#define SIMD_L2_STEP_SCALAR(totals, x, y) ((totals)[0] += ((x) - (y)) * ((x) - (y)))
+#define SIMD_COSINE_STEP_SCALAR(totals, x, y) \
+	((totals)[0] += (x) * (y), (totals)[1] += (x) * (x), (totals)[2] += (y) * (y))
+
+#define SIMD_VEC_DIST_SCALAR(name, ltype, total_type, field, step) \
+static void name(const struct pysimd_vec_t* a, const struct pysimd_vec_t* b, union pysimd_lane_value* sums) { \
+	const ltype* x = (const ltype*)a->data; \
+	const ltype* y = (const ltype*)b->data; \
+	const size_t n = a->size / sizeof(ltype); \
+	total_type totals[3] = {0, 0, 0}; \
+	size_t i = 0; \
+	for (; i < n; ++i) \
+		step(totals, (total_type)x[i], (total_type)y[i]); \
+	for (i = 0; i < 3; ++i) \
+		sums[i].field = totals[i]; \
+}
+
+SIMD_VEC_DIST_SCALAR(simd_vec_dot_f32_scalar, float, double, f, SIMD_DOT_STEP_SCALAR)
+SIMD_VEC_DIST_SCALAR(simd_vec_l2_f32_scalar, float, double, f, SIMD_L2_STEP_SCALAR)
+SIMD_VEC_DIST_SCALAR(simd_vec_cosine_f32_scalar, float, double, f, SIMD_COSINE_STEP_SCALAR)
+SIMD_VEC_DIST_SCALAR(simd_vec_dot_i8_scalar, int8_t, int64_t, i, SIMD_DOT_STEP_SCALAR)
+SIMD_VEC_DIST_SCALAR(simd_vec_l2_i8_scalar, int8_t, int64_t, i, SIMD_L2_STEP_SCALAR)
+SIMD_VEC_DIST_SCALAR(simd_vec_cosine_i8_scalar, int8_t, int64_t, i, SIMD_COSINE_STEP_SCALAR)
+
+#undef SIMD_VEC_DIST_SCALAR
+
+/* The vector loop, given a step that adds one register of lanes from each side into
+ * three accumulators. The lanes after the last pair of registers go through the
+ * scalar step, straight into the totals.
+ */
+#define SIMD_VEC_DIST(name, target, reg_lanes, vtype, ltype, acc_type, total_type, field, load, setzero, add, store, \
+	                  step, scalar_step) \
+static target void name(const struct pysimd_vec_t* a, const struct pysimd_vec_t* b, union pysimd_lane_value* sums) { \
+	const ltype* x = (const ltype*)a->data; \
+	const ltype* y = (const ltype*)b->data; \
+	const size_t n = a->size / sizeof(ltype); \
+	total_type totals[3] = {0, 0, 0}; \
+	acc_type parts[sizeof(vtype) / sizeof(acc_type)]; \
+	vtype acc0[3]; \
+	vtype acc1[3]; \
+	size_t i = 0; \
+	size_t j = 0; \
+	size_t k = 0; \
+	while (i + 2 * (reg_lanes) <= n) { \
+		const size_t block_end = n - i > PYSIMD_DIST_BLOCK ? i + PYSIMD_DIST_BLOCK : n; \
+		for (k = 0; k < 3; ++k) { \
+			acc0[k] = setzero(); \
+			acc1[k] = setzero(); \
+		} \
+		for (; i + 2 * (reg_lanes) <= block_end; i += 2 * (reg_lanes)) { \
+			step(load(x + i), load(y + i), acc0); \
+			step(load(x + i + (reg_lanes)), load(y + i + (reg_lanes)), acc1); \
+		} \
+		for (k = 0; k < 3; ++k) { \
+			store(parts, add(acc0[k], acc1[k])); \
+			for (j = 0; j < sizeof(parts) / sizeof(parts[0]); ++j) \
+				totals[k] += parts[j]; \
+		} \
+	} \
+	for (; i < n; ++i) \
+		scalar_step(totals, (total_type)x[i], (total_type)y[i]); \
+	for (k = 0; k < 3; ++k) \
+		sums[k].field = totals[k]; \
+}
+
+// The f32 steps for a tier, given its a * b + c, rounded once or not
+#define SIMD_DIST_STEPS_F32(suffix, target, vtype, muladd, sub) \
+static target void simd_dot_step_f32_##suffix(vtype x, vtype y, vtype* acc) { \
+	acc[0] = muladd(x, y, acc[0]); \
+} \
+static target void simd_l2_step_f32_##suffix(vtype x, vtype y, vtype* acc) { \
+	const vtype d = sub(x, y); \
+	acc[0] = muladd(d, d, acc[0]); \
+} \
+static target void simd_cosine_step_f32_##suffix(vtype x, vtype y, vtype* acc) { \
+	acc[0] = muladd(x, y, acc[0]); \
+	acc[1] = muladd(x, x, acc[1]); \
+	acc[2] = muladd(y, y, acc[2]); \
+}
+
+/* The i8 steps widen each half of a register to 16 bit lanes, and multiply and add
+ * neighbouring pairs of them into 32 bit lanes with madd.
+ */
+#define SIMD_DIST_STEPS_I8(suffix, target, vtype, widen_lo, widen_hi, madd, add32, sub16) \
+static target void simd_dot_step_i8_##suffix(vtype x, vtype y, vtype* acc) { \
+	acc[0] = add32(acc[0], add32(madd(widen_lo(x), widen_lo(y)), madd(widen_hi(x), widen_hi(y)))); \
+} \
+static target void simd_l2_step_i8_##suffix(vtype x, vtype y, vtype* acc) { \
+	const vtype lo = sub16(widen_lo(x), widen_lo(y)); \
+	const vtype hi = sub16(widen_hi(x), widen_hi(y)); \
+	acc[0] = add32(acc[0], add32(madd(lo, lo), madd(hi, hi))); \
+} \
+static target void simd_cosine_step_i8_##suffix(vtype x, vtype y, vtype* acc) { \
+	const vtype x_lo = widen_lo(x); \
+	const vtype x_hi = widen_hi(x); \
+	const vtype y_lo = widen_lo(y); \
+	const vtype y_hi = widen_hi(y); \
+	acc[0] = add32(acc[0], add32(madd(x_lo, y_lo), madd(x_hi, y_hi))); \
+	acc[1] = add32(acc[1], add32(madd(x_lo, x_lo), madd(x_hi, x_hi))); \
+	acc[2] = add32(acc[2], add32(madd(y_lo, y_lo), madd(y_hi, y_hi))); \
+}
+
+#if defined(PYSIMD_X86_SSE2)
+
+static PYSIMD_TARGET_SSE2 __m128i simd_dist_load_i8_sse2(const int8_t* src) { return _mm_loadu_si128((__m128i const*)src); }
+static PYSIMD_TARGET_SSE2 void simd_dist_store_i32_sse2(int32_t* dst, __m128i x) { _mm_storeu_si128((__m128i*)dst, x); }
+static PYSIMD_TARGET_SSE2 __m128i simd_dist_widen_lo_sse2(__m128i x) { return _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8); }
+static PYSIMD_TARGET_SSE2 __m128i simd_dist_widen_hi_sse2(__m128i x) { return _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8); }
+
+SIMD_DIST_STEPS_F32(sse2, PYSIMD_TARGET_SSE2, __m128, simd_muladd_ps_sse2, _mm_sub_ps)
+SIMD_DIST_STEPS_I8(sse2, PYSIMD_TARGET_SSE2, __m128i, simd_dist_widen_lo_sse2, simd_dist_widen_hi_sse2, _mm_madd_epi16, _mm_add_epi32, _mm_sub_epi16)
+
+SIMD_VEC_DIST(simd_vec_dot_f32_sse2, PYSIMD_TARGET_SSE2, 4, __m128, float, float, double, f, _mm_loadu_ps, _mm_setzero_ps, _mm_add_ps, _mm_storeu_ps,
+	          simd_dot_step_f32_sse2, SIMD_DOT_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_l2_f32_sse2, PYSIMD_TARGET_SSE2, 4, __m128, float, float, double, f, _mm_loadu_ps, _mm_setzero_ps, _mm_add_ps, _mm_storeu_ps,
+	          simd_l2_step_f32_sse2, SIMD_L2_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_cosine_f32_sse2, PYSIMD_TARGET_SSE2, 4, __m128, float, float, double, f, _mm_loadu_ps, _mm_setzero_ps, _mm_add_ps, _mm_storeu_ps,
+	          simd_cosine_step_f32_sse2, SIMD_COSINE_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_dot_i8_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, int8_t, int32_t, int64_t, i, simd_dist_load_i8_sse2, _mm_setzero_si128, _mm_add_epi32,
+	          simd_dist_store_i32_sse2, simd_dot_step_i8_sse2, SIMD_DOT_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_l2_i8_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, int8_t, int32_t, int64_t, i, simd_dist_load_i8_sse2, _mm_setzero_si128, _mm_add_epi32,
+	          simd_dist_store_i32_sse2, simd_l2_step_i8_sse2, SIMD_L2_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_cosine_i8_sse2, PYSIMD_TARGET_SSE2, 16, __m128i, int8_t, int32_t, int64_t, i, simd_dist_load_i8_sse2, _mm_setzero_si128, _mm_add_epi32,
+	          simd_dist_store_i32_sse2, simd_cosine_step_i8_sse2, SIMD_COSINE_STEP_SCALAR)
+
+#endif // PYSIMD_X86_SSE2
+
+#if defined(PYSIMD_X86_AVX2)
+
+static PYSIMD_TARGET_AVX2 __m256i simd_dist_load_i8_avx2(const int8_t* src) { return _mm256_loadu_si256((__m256i const*)src); }
+static PYSIMD_TARGET_AVX2 void simd_dist_store_i32_avx2(int32_t* dst, __m256i x) { _mm256_storeu_si256((__m256i*)dst, x); }
+static PYSIMD_TARGET_AVX2 __m256i simd_dist_widen_lo_avx2(__m256i x) { return _mm256_cvtepi8_epi16(_mm256_castsi256_si128(x)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_dist_widen_hi_avx2(__m256i x) { return _mm256_cvtepi8_epi16(_mm256_extracti128_si256(x, 1)); }
+
+SIMD_DIST_STEPS_F32(avx2, PYSIMD_TARGET_AVX2, __m256, simd_muladd_ps_avx2, _mm256_sub_ps)
+SIMD_DIST_STEPS_I8(avx2, PYSIMD_TARGET_AVX2, __m256i, simd_dist_widen_lo_avx2, simd_dist_widen_hi_avx2, _mm256_madd_epi16, _mm256_add_epi32, _mm256_sub_epi16)
+
+SIMD_VEC_DIST(simd_vec_dot_f32_avx2, PYSIMD_TARGET_AVX2, 8, __m256, float, float, double, f, _mm256_loadu_ps, _mm256_setzero_ps, _mm256_add_ps, _mm256_storeu_ps,
+	          simd_dot_step_f32_avx2, SIMD_DOT_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_l2_f32_avx2, PYSIMD_TARGET_AVX2, 8, __m256, float, float, double, f, _mm256_loadu_ps, _mm256_setzero_ps, _mm256_add_ps, _mm256_storeu_ps,
+	          simd_l2_step_f32_avx2, SIMD_L2_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_cosine_f32_avx2, PYSIMD_TARGET_AVX2, 8, __m256, float, float, double, f, _mm256_loadu_ps, _mm256_setzero_ps, _mm256_add_ps, _mm256_storeu_ps,
+	          simd_cosine_step_f32_avx2, SIMD_COSINE_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_dot_i8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, int8_t, int32_t, int64_t, i, simd_dist_load_i8_avx2, _mm256_setzero_si256, _mm256_add_epi32,
+	          simd_dist_store_i32_avx2, simd_dot_step_i8_avx2, SIMD_DOT_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_l2_i8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, int8_t, int32_t, int64_t, i, simd_dist_load_i8_avx2, _mm256_setzero_si256, _mm256_add_epi32,
+	          simd_dist_store_i32_avx2, simd_l2_step_i8_avx2, SIMD_L2_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_cosine_i8_avx2, PYSIMD_TARGET_AVX2, 32, __m256i, int8_t, int32_t, int64_t, i, simd_dist_load_i8_avx2, _mm256_setzero_si256, _mm256_add_epi32,
+	          simd_dist_store_i32_avx2, simd_cosine_step_i8_avx2, SIMD_COSINE_STEP_SCALAR)
+
+#if defined(PYSIMD_X86_FMA)
+
+// Bound in place of the f32 kernels above when the cpu reports FMA as well
+SIMD_DIST_STEPS_F32(fma, PYSIMD_TARGET_FMA, __m256, _mm256_fmadd_ps, _mm256_sub_ps)
+
+SIMD_VEC_DIST(simd_vec_dot_f32_fma, PYSIMD_TARGET_FMA, 8, __m256, float, float, double, f, _mm256_loadu_ps, _mm256_setzero_ps, _mm256_add_ps, _mm256_storeu_ps,
+	          simd_dot_step_f32_fma, SIMD_DOT_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_l2_f32_fma, PYSIMD_TARGET_FMA, 8, __m256, float, float, double, f, _mm256_loadu_ps, _mm256_setzero_ps, _mm256_add_ps, _mm256_storeu_ps,
+	          simd_l2_step_f32_fma, SIMD_L2_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_cosine_f32_fma, PYSIMD_TARGET_FMA, 8, __m256, float, float, double, f, _mm256_loadu_ps, _mm256_setzero_ps, _mm256_add_ps, _mm256_storeu_ps,
+	          simd_cosine_step_f32_fma, SIMD_COSINE_STEP_SCALAR)
+
+#endif // PYSIMD_X86_FMA
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+static PYSIMD_TARGET_AVX512 __m512i simd_dist_load_i8_avx512(const int8_t* src) { return _mm512_loadu_si512((void const*)src); }
+static PYSIMD_TARGET_AVX512 void simd_dist_store_i32_avx512(int32_t* dst, __m512i x) { _mm512_storeu_si512((void*)dst, x); }
+static PYSIMD_TARGET_AVX512 __m512i simd_dist_widen_lo_avx512(__m512i x) { return _mm512_cvtepi8_epi16(_mm512_castsi512_si256(x)); }
+static PYSIMD_TARGET_AVX512 __m512i simd_dist_widen_hi_avx512(__m512i x) { return _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(x, 1)); }
+
+SIMD_DIST_STEPS_F32(avx512, PYSIMD_TARGET_AVX512, __m512, _mm512_fmadd_ps, _mm512_sub_ps)
+SIMD_DIST_STEPS_I8(avx512, PYSIMD_TARGET_AVX512, __m512i, simd_dist_widen_lo_avx512, simd_dist_widen_hi_avx512, _mm512_madd_epi16, _mm512_add_epi32,
+	               _mm512_sub_epi16)
+
+SIMD_VEC_DIST(simd_vec_dot_f32_avx512, PYSIMD_TARGET_AVX512, 16, __m512, float, float, double, f, _mm512_loadu_ps, _mm512_setzero_ps, _mm512_add_ps,
+	          _mm512_storeu_ps, simd_dot_step_f32_avx512, SIMD_DOT_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_l2_f32_avx512, PYSIMD_TARGET_AVX512, 16, __m512, float, float, double, f, _mm512_loadu_ps, _mm512_setzero_ps, _mm512_add_ps,
+	          _mm512_storeu_ps, simd_l2_step_f32_avx512, SIMD_L2_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_cosine_f32_avx512, PYSIMD_TARGET_AVX512, 16, __m512, float, float, double, f, _mm512_loadu_ps, _mm512_setzero_ps, _mm512_add_ps,
+	          _mm512_storeu_ps, simd_cosine_step_f32_avx512, SIMD_COSINE_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_dot_i8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, int8_t, int32_t, int64_t, i, simd_dist_load_i8_avx512, _mm512_setzero_si512,
+	          _mm512_add_epi32, simd_dist_store_i32_avx512, simd_dot_step_i8_avx512, SIMD_DOT_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_l2_i8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, int8_t, int32_t, int64_t, i, simd_dist_load_i8_avx512, _mm512_setzero_si512,
+	          _mm512_add_epi32, simd_dist_store_i32_avx512, simd_l2_step_i8_avx512, SIMD_L2_STEP_SCALAR)
+SIMD_VEC_DIST(simd_vec_cosine_i8_avx512, PYSIMD_TARGET_AVX512, 64, __m512i, int8_t, int32_t, int64_t, i, simd_dist_load_i8_avx512, _mm512_setzero_si512,
+	          _mm512_add_epi32, simd_dist_store_i32_avx512, simd_cosine_step_i8_avx512, SIMD_COSINE_STEP_SCALAR)
+
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_VEC_DIST
+#undef SIMD_DIST_STEPS_F32
+#undef SIMD_DIST_STEPS_I8
+#undef SIMD_DOT_STEP_SCALAR
+#undef SIMD_L2_STEP_SCALAR
+#undef SIMD_COSINE_STEP_SCALAR
+
+#endif // SIMD_VEC_DOT_H
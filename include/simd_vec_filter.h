@@ -4,233 +4,424 @@
 #include "simd_vec_type.h"
 #include "vec_macros.h"
 
+/* Stream compaction. A filter kernel copies the lanes of src that lie within a range
+ * to dst, packed together in their original order, and returns how many it copied.
+ *
+ * Predicates are folded into a closed range before a kernel runs. Integer ranges are
+ * held in u, as the bit patterns of the lanes they start and end on, and a lane x is
+ * kept when (x - lo) <= (hi - lo) in unsigned arithmetic of the lane width. That one
+ * comparison covers signed and unsigned lanes alike. Float ranges are held in f, and
+ * NaN lanes never pass.
+ *
+ * Kernels write whole registers at the current output position, which never runs
+ * ahead of the input position, so nothing past dst + src->size is ever written.
+ */
 
-static int pysimd_vec_filter_32(struct pysimd_vec_t* vec, int* gt,
-	                                                      int* lt,
-	                                                      int* eq) {
-#if defined(PYSIMD_X86_SSE2)
-	// pass
-	unsigned char* ptr = vec->data;
-	const unsigned char* ptr_end = ptr + vec->size;
-	while (ptr < ptr_end) {
-		__m128i loaded = _mm_load_si128((__m128i const*)ptr);
-		__m128i mask = _mm_set1_epi8(0xff);
-		if (gt != NULL) {
-			__m128i gtnum = _mm_set1_epi32(*gt);
-			__m128i gtres = _mm_cmpgt_epi32 (loaded, gtnum);
-			mask = _mm_and_si128(mask, gtres);
-		}
-		if (lt != NULL) {
-			__m128i ltnum = _mm_set1_epi32(*lt);
-			__m128i ltres = _mm_cmplt_epi32 (loaded, ltnum);
-			mask = _mm_and_si128(mask, ltres);
-		}
-		if (eq != NULL) {
-			__m128i eqnum = _mm_set1_epi32(*eq);
-			__m128i eqres = _mm_cmpeq_epi32 (loaded, eqnum);
-			mask = _mm_and_si128(mask, eqres);
-		}
-		__m128i final_result = _mm_and_si128(mask, loaded);
-		int mask_result = _mm_movemask_epi8 (final_result);
-		size_t to_advance = 0;
-		switch (mask_result) {
-			case 0xFFFF:
-			case 0x0FFF:
-			case 0x00FF:
-			case 0x000F:
-			case 0x0:
-			      // no filtering needed
-			      to_advance = 16;
-			      break;
-			case 0xFF0F:
-			      final_result = _mm_shuffle_epi32(final_result, 0x78);
-			      to_advance = 12;
-			      break;
-			case 0xF00F:
-			      // shuffle, reverse order of 0b10101100
-			      final_result = _mm_shuffle_epi32(final_result, 0xac);
-			      to_advance = 8;
-			      break;
-			case 0x0FF0:
-			      // shuffle, reverse order of 0b11001001
-			      final_result = _mm_shuffle_epi32(final_result, 0xc9);
-			      to_advance = 8;
-			      break;
-			case 0xF0F0:
-			      // shuffle, reverse order of 0b10001101
-			      final_result = _mm_shuffle_epi32(final_result, 0x8d);
-			      to_advance = 8;
-			      break;
-			case 0x0F0F:
-			      // shuffle, reverse order of 0b11011000
-			      final_result = _mm_shuffle_epi32(final_result, 0xd8);
-			      to_advance = 8;
-			      break;
-			case 0xF0FF:
-			      final_result = _mm_shuffle_epi32(final_result, 0xb4);
-			      to_advance = 12;
-			      break;
-			case 0xFFF0:
-			      // shuffle, reversed order of 00011011
-			      final_result = _mm_shuffle_epi32(final_result, 0x1b);
-			      to_advance = 12;
-			      break;
-			case 0xFF00:
-			      // shuffle, reversed order of 00001110
-			      final_result = _mm_shuffle_epi32(final_result, 0xe);
-			      to_advance = 8;
-			      break;
-			case 0xF000:
-			      // shuffle, reversed order of 00000011
-			      final_result = _mm_shuffle_epi32(final_result, 0x3);
-			      to_advance = 4;
-			      break;
-			case 0x0F00:
-			      // shuffle, reversed order of 0b00000010
-			      final_result = _mm_shuffle_epi32(final_result, 0x2);
-			      to_advance = 4;
-			      break;
-			case 0x00F0:
-			      // shuffle, reversed order of 0b00000001
-			      final_result = _mm_shuffle_epi32(final_result, 0x1);
-			      to_advance = 4;
-			      break;
-			default:
-			      fprintf(stderr, "Got impossible mask value: 0x%x, aborting ...\n", mask_result);
-			      abort();
-		}
-		_mm_store_si128 ((__m128i*)ptr, final_result);
-		ptr += to_advance;
-	}
-#else
-	const unsigned char* reader = vec->data;
-	const unsigned char* read_end = reader + vec->size;
-	void* new_buf = calloc(1, vec->size);
-	unsigned char* writer = new_buf;
-	while (reader < read_end) {
-		if (*reader) {
-			*writer++ = *reader;
+struct pysimd_filter_range {
+	union pysimd_lane_value lo;
+	union pysimd_lane_value hi;
+};
+
+/* Positions of the set bits of every 8 bit mask, in increasing order, and their count.
+ * These drive the shuffles that move kept lanes to the front of a register.
+ */
+static unsigned char pysimd_filter_index[256][8];
+static unsigned char pysimd_filter_count[256];
+
+static void pysimd_filter_tables_init(void)
+{
+	size_t mask = 0;
+	for (; mask < 256; ++mask) {
+		unsigned char n_set = 0;
+		unsigned char bit = 0;
+		for (; bit < 8; ++bit) {
+			if (mask & ((size_t)1 << bit))
+				pysimd_filter_index[mask][n_set++] = bit;
 		}
-		++reader;
+		pysimd_filter_count[mask] = n_set;
 	}
-	free(vec->data);
-	vec->data = new_buf;
-#endif
-	return 1;
 }
 
-static int pysimd_vec_filter_64(struct pysimd_vec_t* vec, long long* gt,
-	                                                      long long* lt,
-	                                                      long long* eq) {
+#define SIMD_VEC_FILTER_SCALAR(name, ctype) \
+static size_t name(unsigned char* dst, const struct pysimd_vec_t* src, const struct pysimd_filter_range* range) { \
+	const ctype* reader = (const ctype*)src->data; \
+	ctype* writer = (ctype*)dst; \
+	const ctype lo = (ctype)range->lo.u; \
+	const ctype span = (ctype)(range->hi.u - range->lo.u); \
+	const size_t n_lanes = src->size / sizeof(ctype); \
+	size_t kept = 0; \
+	size_t i = 0; \
+	for (; i < n_lanes; ++i) { \
+		const ctype x = reader[i]; \
+		writer[kept] = x; \
+		kept += (ctype)(x - lo) <= span; \
+	} \
+	return kept; \
+}
+
+#define SIMD_VEC_FILTER_SCALAR_FLOAT(name, ctype) \
+static size_t name(unsigned char* dst, const struct pysimd_vec_t* src, const struct pysimd_filter_range* range) { \
+	const ctype* reader = (const ctype*)src->data; \
+	ctype* writer = (ctype*)dst; \
+	const ctype lo = (ctype)range->lo.f; \
+	const ctype hi = (ctype)range->hi.f; \
+	const size_t n_lanes = src->size / sizeof(ctype); \
+	size_t kept = 0; \
+	size_t i = 0; \
+	for (; i < n_lanes; ++i) { \
+		const ctype x = reader[i]; \
+		writer[kept] = x; \
+		kept += (x >= lo) & (x <= hi); \
+	} \
+	return kept; \
+}
+
+SIMD_VEC_FILTER_SCALAR(simd_vec_filter_i8_scalar, uint8_t)
+SIMD_VEC_FILTER_SCALAR(simd_vec_filter_i16_scalar, uint16_t)
+SIMD_VEC_FILTER_SCALAR(simd_vec_filter_i32_scalar, uint32_t)
+SIMD_VEC_FILTER_SCALAR(simd_vec_filter_i64_scalar, uint64_t)
+SIMD_VEC_FILTER_SCALAR_FLOAT(simd_vec_filter_f32_scalar, float)
+SIMD_VEC_FILTER_SCALAR_FLOAT(simd_vec_filter_f64_scalar, double)
+
+#undef SIMD_VEC_FILTER_SCALAR
+#undef SIMD_VEC_FILTER_SCALAR_FLOAT
+
 #if defined(PYSIMD_X86_SSE2)
-	// pass
-	unsigned char* ptr = vec->data;
-	const unsigned char* ptr_end = ptr + vec->size;
-	while (ptr < ptr_end) {
-		__m128i loaded = _mm_load_si128((__m128i const*)ptr);
-		__m128i mask = _mm_set1_epi8(0xff);
-		if (gt != NULL) {
-			__m128i gtnum = _mm_set1_epi64(*gt);
-			__m128i gtres = _mm_cmpgt_epi64(loaded, gtnum);
-			mask = _mm_and_si128(mask, gtres);
-		}
-		if (lt != NULL) {
-			__m128i ltnum = _mm_set1_epi64(*lt);
-			__m128i ltres = _mm_cmplt_epi64(loaded, ltnum);
-			mask = _mm_and_si128(mask, ltres);
-		}
-		if (eq != NULL) {
-			__m128i eqnum = _mm_set1_epi64(*eq);
-			__m128i eqres = _mm_cmpeq_epi64(loaded, eqnum);
-			mask = _mm_and_si128(mask, eqres);
-		}
-		__m128i final_result = _mm_and_si128(mask, loaded);
-		int mask_result = _mm_movemask_epi8 (final_result);
-		size_t to_advance = 0;
-		switch (mask_result) {
-			case 0xFFFF:
-			case 0x0FFF:
-			case 0x00FF:
-			case 0x000F:
-			case 0x0:
-			      // no filtering needed
-			      to_advance = 16;
-			      break;
-			case 0xFF0F:
-			      final_result = _mm_shuffle_epi32(final_result, 0x78);
-			      to_advance = 12;
-			      break;
-			case 0xF00F:
-			      // shuffle, reverse order of 0b10101100
-			      final_result = _mm_shuffle_epi32(final_result, 0xac);
-			      to_advance = 8;
-			      break;
-			case 0x0FF0:
-			      // shuffle, reverse order of 0b11001001
-			      final_result = _mm_shuffle_epi32(final_result, 0xc9);
-			      to_advance = 8;
-			      break;
-			case 0xF0F0:
-			      // shuffle, reverse order of 0b10001101
-			      final_result = _mm_shuffle_epi32(final_result, 0x8d);
-			      to_advance = 8;
-			      break;
-			case 0x0F0F:
-			      // shuffle, reverse order of 0b11011000
-			      final_result = _mm_shuffle_epi32(final_result, 0xd8);
-			      to_advance = 8;
-			      break;
-			case 0xF0FF:
-			      final_result = _mm_shuffle_epi32(final_result, 0xb4);
-			      to_advance = 12;
-			      break;
-			case 0xFFF0:
-			      // shuffle, reversed order of 00011011
-			      final_result = _mm_shuffle_epi32(final_result, 0x1b);
-			      to_advance = 12;
-			      break;
-			case 0xFF00:
-			      // shuffle, reversed order of 00001110
-			      final_result = _mm_shuffle_epi32(final_result, 0xe);
-			      to_advance = 8;
-			      break;
-			case 0xF000:
-			      // shuffle, reversed order of 00000011
-			      final_result = _mm_shuffle_epi32(final_result, 0x3);
-			      to_advance = 4;
-			      break;
-			case 0x0F00:
-			      // shuffle, reversed order of 0b00000010
-			      final_result = _mm_shuffle_epi32(final_result, 0x2);
-			      to_advance = 4;
-			      break;
-			case 0x00F0:
-			      // shuffle, reversed order of 0b00000001
-			      final_result = _mm_shuffle_epi32(final_result, 0x1);
-			      to_advance = 4;
-			      break;
-			default:
-			      fprintf(stderr, "Got impossible mask value: 0x%x, aborting ...\n", mask_result);
-			      abort();
-		}
-		_mm_store_si128 ((__m128i*)ptr, final_result);
-		ptr += to_advance;
+
+/* SSE2 has no byte shuffle with a variable control, so after comparing a register
+ * at a time, the kept lanes are moved out one by one, without branching on the mask.
+ * Each tier keeps its bounds in two registers, set up once per call, and a keep
+ * function turns a register of lanes into a bit mask of the lanes in range.
+ */
+#define SIMD_VEC_FILTER_SSE2(name, ctype, bounds_fn, keep_fn) \
+static PYSIMD_TARGET_SSE2 size_t name(unsigned char* dst, const struct pysimd_vec_t* src, const struct pysimd_filter_range* range) { \
+	ctype* writer = (ctype*)dst; \
+	__m128i bounds[2]; \
+	size_t kept = 0; \
+	size_t i = 0; \
+	size_t j = 0; \
+	bounds_fn(range, bounds); \
+	for (; i < src->size; i += 16) { \
+		const ctype* block = (const ctype*)(src->data + i); \
+		const int keep_bits = keep_fn(_mm_load_si128((__m128i const*)(src->data + i)), bounds); \
+		for (j = 0; j < 16 / sizeof(ctype); ++j) { \
+			writer[kept] = block[j]; \
+			kept += (keep_bits >> j) & 1; \
+		} \
+	} \
+	return kept; \
+}
+
+static PYSIMD_TARGET_SSE2 void simd_filter_bounds_i8_sse2(const struct pysimd_filter_range* range, __m128i* bounds)
+{
+	bounds[0] = _mm_set1_epi8((char)range->lo.u);
+	bounds[1] = _mm_set1_epi8((char)(range->hi.u - range->lo.u));
+}
+
+static PYSIMD_TARGET_SSE2 void simd_filter_bounds_i16_sse2(const struct pysimd_filter_range* range, __m128i* bounds)
+{
+	bounds[0] = _mm_set1_epi16((short)range->lo.u);
+	bounds[1] = _mm_set1_epi16((short)(range->hi.u - range->lo.u));
+}
+
+// The 32 and 64 bit spans are kept with the sign bit of every 32 bits flipped, for unsigned compares
+static PYSIMD_TARGET_SSE2 void simd_filter_bounds_i32_sse2(const struct pysimd_filter_range* range, __m128i* bounds)
+{
+	bounds[0] = _mm_set1_epi32((int)range->lo.u);
+	bounds[1] = _mm_set1_epi32((int)((uint32_t)(range->hi.u - range->lo.u) ^ 0x80000000u));
+}
+
+static PYSIMD_TARGET_SSE2 void simd_filter_bounds_i64_sse2(const struct pysimd_filter_range* range, __m128i* bounds)
+{
+	bounds[0] = _mm_set1_epi64x((long long)range->lo.u);
+	bounds[1] = _mm_xor_si128(_mm_set1_epi64x((long long)(range->hi.u - range->lo.u)), _mm_set1_epi32((int)0x80000000u));
+}
+
+static PYSIMD_TARGET_SSE2 void simd_filter_bounds_f32_sse2(const struct pysimd_filter_range* range, __m128i* bounds)
+{
+	bounds[0] = _mm_castps_si128(_mm_set1_ps((float)range->lo.f));
+	bounds[1] = _mm_castps_si128(_mm_set1_ps((float)range->hi.f));
+}
+
+static PYSIMD_TARGET_SSE2 void simd_filter_bounds_f64_sse2(const struct pysimd_filter_range* range, __m128i* bounds)
+{
+	bounds[0] = _mm_castpd_si128(_mm_set1_pd(range->lo.f));
+	bounds[1] = _mm_castpd_si128(_mm_set1_pd(range->hi.f));
+}
+
+// x - lo <= span holds when the unsigned saturating difference of the two sides is zero
+static PYSIMD_TARGET_SSE2 int simd_filter_keep_i8_sse2(__m128i x, const __m128i* bounds)
+{
+	__m128i offset = _mm_sub_epi8(x, bounds[0]);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(offset, bounds[1]), _mm_setzero_si128()));
+}
+
+static PYSIMD_TARGET_SSE2 int simd_filter_keep_i16_sse2(__m128i x, const __m128i* bounds)
+{
+	__m128i offset = _mm_sub_epi16(x, bounds[0]);
+	__m128i keep = _mm_cmpeq_epi16(_mm_subs_epu16(offset, bounds[1]), _mm_setzero_si128());
+	return _mm_movemask_epi8(_mm_packs_epi16(keep, _mm_setzero_si128()));
+}
+
+static PYSIMD_TARGET_SSE2 int simd_filter_keep_i32_sse2(__m128i x, const __m128i* bounds)
+{
+	__m128i offset = _mm_xor_si128(_mm_sub_epi32(x, bounds[0]), _mm_set1_epi32((int)0x80000000u));
+	return ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(offset, bounds[1]))) & 0xf;
+}
+
+/* Without a 64 bit compare, the high halves decide unless they are equal, in which
+ * case the low halves do. Only the top bit of each 64 bit lane is read by movemask.
+ */
+static PYSIMD_TARGET_SSE2 int simd_filter_keep_i64_sse2(__m128i x, const __m128i* bounds)
+{
+	__m128i offset = _mm_xor_si128(_mm_sub_epi64(x, bounds[0]), _mm_set1_epi32((int)0x80000000u));
+	__m128i greater = _mm_cmpgt_epi32(offset, bounds[1]);
+	__m128i equal = _mm_cmpeq_epi32(offset, bounds[1]);
+	__m128i rejected = _mm_or_si128(greater, _mm_and_si128(equal, _mm_slli_epi64(greater, 32)));
+	return ~_mm_movemask_pd(_mm_castsi128_pd(rejected)) & 0x3;
+}
+
+static PYSIMD_TARGET_SSE2 int simd_filter_keep_f32_sse2(__m128i x, const __m128i* bounds)
+{
+	__m128 lanes = _mm_castsi128_ps(x);
+	return _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(lanes, _mm_castsi128_ps(bounds[0])),
+	                                  _mm_cmple_ps(lanes, _mm_castsi128_ps(bounds[1]))));
+}
+
+static PYSIMD_TARGET_SSE2 int simd_filter_keep_f64_sse2(__m128i x, const __m128i* bounds)
+{
+	__m128d lanes = _mm_castsi128_pd(x);
+	return _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(lanes, _mm_castsi128_pd(bounds[0])),
+	                                  _mm_cmple_pd(lanes, _mm_castsi128_pd(bounds[1]))));
+}
+
+SIMD_VEC_FILTER_SSE2(simd_vec_filter_i8_sse2, uint8_t, simd_filter_bounds_i8_sse2, simd_filter_keep_i8_sse2)
+SIMD_VEC_FILTER_SSE2(simd_vec_filter_i16_sse2, uint16_t, simd_filter_bounds_i16_sse2, simd_filter_keep_i16_sse2)
+SIMD_VEC_FILTER_SSE2(simd_vec_filter_i32_sse2, uint32_t, simd_filter_bounds_i32_sse2, simd_filter_keep_i32_sse2)
+SIMD_VEC_FILTER_SSE2(simd_vec_filter_i64_sse2, uint64_t, simd_filter_bounds_i64_sse2, simd_filter_keep_i64_sse2)
+SIMD_VEC_FILTER_SSE2(simd_vec_filter_f32_sse2, uint32_t, simd_filter_bounds_f32_sse2, simd_filter_keep_f32_sse2)
+SIMD_VEC_FILTER_SSE2(simd_vec_filter_f64_sse2, uint64_t, simd_filter_bounds_f64_sse2, simd_filter_keep_f64_sse2)
+
+#undef SIMD_VEC_FILTER_SSE2
+
+// The wide kernels filter the last register or so of a vector with the kernel of the tier below
+#define SIMD_VEC_FILTER_TAIL(tail, width) \
+	if (i < src->size) { \
+		struct pysimd_vec_t rest = {src->size - i, src->data + i}; \
+		kept_bytes += tail(dst + kept_bytes, &rest, range) * (width); \
 	}
-#else
-	const unsigned char* reader = vec->data;
-	const unsigned char* read_end = reader + vec->size;
-	void* new_buf = calloc(1, vec->size);
-	unsigned char* writer = new_buf;
-	while (reader < read_end) {
-		if (*reader) {
-			*writer++ = *reader;
+
+#if defined(PYSIMD_X86_AVX2)
+
+/* The 32 and 64 bit kernels compact a register with one cross lane permute, whose
+ * control comes from the position table, indexed by the mask of kept 32 bit halves.
+ */
+#define SIMD_VEC_FILTER_DWORDS_AVX2(name, tail, width, bounds_fn, keep_fn) \
+static PYSIMD_TARGET_AVX2 size_t name(unsigned char* dst, const struct pysimd_vec_t* src, const struct pysimd_filter_range* range) { \
+	__m256i bounds[2]; \
+	size_t kept_bytes = 0; \
+	size_t i = 0; \
+	bounds_fn(range, bounds); \
+	for (; i + 32 <= src->size; i += 32) { \
+		const __m256i x = _mm256_loadu_si256((__m256i const*)(src->data + i)); \
+		const int keep_bits = keep_fn(x, bounds); \
+		const __m256i control = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const*)pysimd_filter_index[keep_bits])); \
+		_mm256_storeu_si256((__m256i*)(dst + kept_bytes), _mm256_permutevar8x32_epi32(x, control)); \
+		kept_bytes += (size_t)pysimd_filter_count[keep_bits] * 4; \
+	} \
+	SIMD_VEC_FILTER_TAIL(tail, width) \
+	return kept_bytes / (width); \
+}
+
+static PYSIMD_TARGET_AVX2 void simd_filter_bounds_i8_avx2(const struct pysimd_filter_range* range, __m256i* bounds)
+{
+	bounds[0] = _mm256_set1_epi8((char)range->lo.u);
+	bounds[1] = _mm256_set1_epi8((char)(range->hi.u - range->lo.u));
+}
+
+static PYSIMD_TARGET_AVX2 void simd_filter_bounds_i16_avx2(const struct pysimd_filter_range* range, __m256i* bounds)
+{
+	bounds[0] = _mm256_set1_epi16((short)range->lo.u);
+	bounds[1] = _mm256_set1_epi16((short)(range->hi.u - range->lo.u));
+}
+
+static PYSIMD_TARGET_AVX2 void simd_filter_bounds_i32_avx2(const struct pysimd_filter_range* range, __m256i* bounds)
+{
+	bounds[0] = _mm256_set1_epi32((int)range->lo.u);
+	bounds[1] = _mm256_set1_epi32((int)(range->hi.u - range->lo.u));
+}
+
+// AVX2 lacks an unsigned 64 bit minimum, so that span has its sign bit flipped for a signed compare
+static PYSIMD_TARGET_AVX2 void simd_filter_bounds_i64_avx2(const struct pysimd_filter_range* range, __m256i* bounds)
+{
+	bounds[0] = _mm256_set1_epi64x((long long)range->lo.u);
+	bounds[1] = _mm256_set1_epi64x((long long)((range->hi.u - range->lo.u) ^ 0x8000000000000000ULL));
+}
+
+static PYSIMD_TARGET_AVX2 void simd_filter_bounds_f32_avx2(const struct pysimd_filter_range* range, __m256i* bounds)
+{
+	bounds[0] = _mm256_castps_si256(_mm256_set1_ps((float)range->lo.f));
+	bounds[1] = _mm256_castps_si256(_mm256_set1_ps((float)range->hi.f));
+}
+
+static PYSIMD_TARGET_AVX2 void simd_filter_bounds_f64_avx2(const struct pysimd_filter_range* range, __m256i* bounds)
+{
+	bounds[0] = _mm256_castpd_si256(_mm256_set1_pd(range->lo.f));
+	bounds[1] = _mm256_castpd_si256(_mm256_set1_pd(range->hi.f));
+}
+
+// x - lo <= span holds when the unsigned minimum of the two sides is x - lo
+static PYSIMD_TARGET_AVX2 int simd_filter_keep_i32_avx2(__m256i x, const __m256i* bounds)
+{
+	__m256i offset = _mm256_sub_epi32(x, bounds[0]);
+	return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_min_epu32(offset, bounds[1]), offset)));
+}
+
+static PYSIMD_TARGET_AVX2 int simd_filter_keep_i64_avx2(__m256i x, const __m256i* bounds)
+{
+	__m256i offset = _mm256_xor_si256(_mm256_sub_epi64(x, bounds[0]), _mm256_set1_epi64x((long long)0x8000000000000000ULL));
+	return ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi64(offset, bounds[1]))) & 0xff;
+}
+
+static PYSIMD_TARGET_AVX2 int simd_filter_keep_f32_avx2(__m256i x, const __m256i* bounds)
+{
+	__m256 lanes = _mm256_castsi256_ps(x);
+	return _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(lanes, _mm256_castsi256_ps(bounds[0]), _CMP_GE_OQ),
+	                                        _mm256_cmp_ps(lanes, _mm256_castsi256_ps(bounds[1]), _CMP_LE_OQ)));
+}
+
+// Read as eight 32 bit halves, so each kept lane sets two adjacent bits
+static PYSIMD_TARGET_AVX2 int simd_filter_keep_f64_avx2(__m256i x, const __m256i* bounds)
+{
+	__m256d lanes = _mm256_castsi256_pd(x);
+	__m256d keep = _mm256_and_pd(_mm256_cmp_pd(lanes, _mm256_castsi256_pd(bounds[0]), _CMP_GE_OQ),
+	                             _mm256_cmp_pd(lanes, _mm256_castsi256_pd(bounds[1]), _CMP_LE_OQ));
+	return _mm256_movemask_ps(_mm256_castpd_ps(keep));
+}
+
+SIMD_VEC_FILTER_DWORDS_AVX2(simd_vec_filter_i32_avx2, simd_vec_filter_i32_sse2, 4, simd_filter_bounds_i32_avx2, simd_filter_keep_i32_avx2)
+SIMD_VEC_FILTER_DWORDS_AVX2(simd_vec_filter_i64_avx2, simd_vec_filter_i64_sse2, 8, simd_filter_bounds_i64_avx2, simd_filter_keep_i64_avx2)
+SIMD_VEC_FILTER_DWORDS_AVX2(simd_vec_filter_f32_avx2, simd_vec_filter_f32_sse2, 4, simd_filter_bounds_f32_avx2, simd_filter_keep_f32_avx2)
+SIMD_VEC_FILTER_DWORDS_AVX2(simd_vec_filter_f64_avx2, simd_vec_filter_f64_sse2, 8, simd_filter_bounds_f64_avx2, simd_filter_keep_f64_avx2)
+
+#undef SIMD_VEC_FILTER_DWORDS_AVX2
+
+/* 16 bit lanes are compacted a 128 bit half at a time with pshufb. The position of
+ * each kept lane j becomes the byte pair 2j, 2j + 1 of the shuffle control.
+ */
+static PYSIMD_TARGET_AVX2 size_t simd_vec_filter_i16_avx2(unsigned char* dst, const struct pysimd_vec_t* src, const struct pysimd_filter_range* range)
+{
+	const __m128i pair_scale = _mm_set1_epi16(0x0202);
+	const __m128i pair_offset = _mm_set1_epi16(0x0100);
+	__m256i bounds[2];
+	size_t kept_bytes = 0;
+	size_t i = 0;
+	simd_filter_bounds_i16_avx2(range, bounds);
+	for (; i + 32 <= src->size; i += 32) {
+		const __m256i x = _mm256_loadu_si256((__m256i const*)(src->data + i));
+		const __m256i offset = _mm256_sub_epi16(x, bounds[0]);
+		const __m256i keep = _mm256_cmpeq_epi16(_mm256_min_epu16(offset, bounds[1]), offset);
+		// Packing leaves one byte per lane, the low half's lanes in bits 0-7, the high half's in bits 16-23
+		const unsigned keep_bits = (unsigned)_mm256_movemask_epi8(_mm256_packs_epi16(keep, _mm256_setzero_si256()));
+		const unsigned low_bits = keep_bits & 0xff;
+		const unsigned high_bits = (keep_bits >> 16) & 0xff;
+		__m128i control = _mm_cvtepu8_epi16(_mm_loadl_epi64((__m128i const*)pysimd_filter_index[low_bits]));
+		control = _mm_add_epi16(_mm_mullo_epi16(control, pair_scale), pair_offset);
+		_mm_storeu_si128((__m128i*)(dst + kept_bytes), _mm_shuffle_epi8(_mm256_castsi256_si128(x), control));
+		kept_bytes += (size_t)pysimd_filter_count[low_bits] * 2;
+		control = _mm_cvtepu8_epi16(_mm_loadl_epi64((__m128i const*)pysimd_filter_index[high_bits]));
+		control = _mm_add_epi16(_mm_mullo_epi16(control, pair_scale), pair_offset);
+		_mm_storeu_si128((__m128i*)(dst + kept_bytes), _mm_shuffle_epi8(_mm256_extracti128_si256(x, 1), control));
+		kept_bytes += (size_t)pysimd_filter_count[high_bits] * 2;
+	}
+	SIMD_VEC_FILTER_TAIL(simd_vec_filter_i16_sse2, 2)
+	return kept_bytes / 2;
+}
+
+/* 8 bit lanes are compacted 8 at a time, each group of 8 shuffled to the front of its
+ * 128 bit half and written with a 64 bit store.
+ */
+static PYSIMD_TARGET_AVX2 size_t simd_vec_filter_i8_avx2(unsigned char* dst, const struct pysimd_vec_t* src, const struct pysimd_filter_range* range)
+{
+	const __m128i high_group = _mm_set1_epi8(8);
+	__m256i bounds[2];
+	size_t kept_bytes = 0;
+	size_t i = 0;
+	simd_filter_bounds_i8_avx2(range, bounds);
+	for (; i + 32 <= src->size; i += 32) {
+		const __m256i x = _mm256_loadu_si256((__m256i const*)(src->data + i));
+		const __m256i offset = _mm256_sub_epi8(x, bounds[0]);
+		const unsigned keep_bits = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(offset, bounds[1]), offset));
+		const __m128i halves[2] = {_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1)};
+		size_t group = 0;
+		for (; group < 4; ++group) {
+			const unsigned group_bits = (keep_bits >> (group * 8)) & 0xff;
+			__m128i control = _mm_loadl_epi64((__m128i const*)pysimd_filter_index[group_bits]);
+			if (group & 1)
+				control = _mm_add_epi8(control, high_group);
+			_mm_storel_epi64((__m128i*)(dst + kept_bytes), _mm_shuffle_epi8(halves[group >> 1], control));
+			kept_bytes += pysimd_filter_count[group_bits];
 		}
-		++reader;
 	}
-	free(vec->data);
-	vec->data = new_buf;
-#endif
-	return 1;
+	SIMD_VEC_FILTER_TAIL(simd_vec_filter_i8_sse2, 1)
+	return kept_bytes;
 }
 
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+/* AVX-512F compacts 32 and 64 bit lanes in one instruction. The compressed register
+ * is written with a full store rather than a masked compressing store, which is much
+ * slower on some cpus. 8 and 16 bit compaction needs VBMI2, those lanes keep the
+ * AVX2 kernels.
+ */
+#define SIMD_VEC_FILTER_AVX512(name, tail, width, vtype, set1, compress, keep_expr, count_expr) \
+static PYSIMD_TARGET_AVX512 size_t name(unsigned char* dst, const struct pysimd_vec_t* src, const struct pysimd_filter_range* range) { \
+	size_t kept_bytes = 0; \
+	size_t i = 0; \
+	const vtype lo = set1(range->lo); \
+	const vtype hi = set1(range->hi); \
+	for (; i + 64 <= src->size; i += 64) { \
+		const __m512i x = _mm512_loadu_si512((void const*)(src->data + i)); \
+		const __mmask16 keep = keep_expr; \
+		_mm512_storeu_si512((void*)(dst + kept_bytes), compress); \
+		kept_bytes += (size_t)(count_expr) * (width); \
+	} \
+	SIMD_VEC_FILTER_TAIL(tail, width) \
+	return kept_bytes / (width); \
+}
+
+static PYSIMD_TARGET_AVX512 __m512i simd_filter_set1_i32_avx512(union pysimd_lane_value value) { return _mm512_set1_epi32((int)value.u); }
+static PYSIMD_TARGET_AVX512 __m512i simd_filter_set1_i64_avx512(union pysimd_lane_value value) { return _mm512_set1_epi64((long long)value.u); }
+static PYSIMD_TARGET_AVX512 __m512 simd_filter_set1_f32_avx512(union pysimd_lane_value value) { return _mm512_set1_ps((float)value.f); }
+static PYSIMD_TARGET_AVX512 __m512d simd_filter_set1_f64_avx512(union pysimd_lane_value value) { return _mm512_set1_pd(value.f); }
+
+#define SIMD_FILTER_COUNT16(mask) (pysimd_filter_count[(mask) & 0xff] + pysimd_filter_count[(mask) >> 8])
+SIMD_VEC_FILTER_AVX512(simd_vec_filter_i32_avx512, simd_vec_filter_i32_avx2, 4, __m512i, simd_filter_set1_i32_avx512,
+	                   _mm512_maskz_compress_epi32(keep, x),
+	                   _mm512_cmple_epu32_mask(_mm512_sub_epi32(x, lo), _mm512_sub_epi32(hi, lo)),
+	                   SIMD_FILTER_COUNT16(keep))
+SIMD_VEC_FILTER_AVX512(simd_vec_filter_i64_avx512, simd_vec_filter_i64_avx2, 8, __m512i, simd_filter_set1_i64_avx512,
+	                   _mm512_maskz_compress_epi64((__mmask8)keep, x),
+	                   _mm512_cmple_epu64_mask(_mm512_sub_epi64(x, lo), _mm512_sub_epi64(hi, lo)),
+	                   pysimd_filter_count[keep])
+SIMD_VEC_FILTER_AVX512(simd_vec_filter_f32_avx512, simd_vec_filter_f32_avx2, 4, __m512, simd_filter_set1_f32_avx512,
+	                   _mm512_maskz_compress_epi32(keep, x),
+	                   _mm512_cmp_ps_mask(_mm512_castsi512_ps(x), lo, _CMP_GE_OQ) & _mm512_cmp_ps_mask(_mm512_castsi512_ps(x), hi, _CMP_LE_OQ),
+	                   SIMD_FILTER_COUNT16(keep))
+SIMD_VEC_FILTER_AVX512(simd_vec_filter_f64_avx512, simd_vec_filter_f64_avx2, 8, __m512d, simd_filter_set1_f64_avx512,
+	                   _mm512_maskz_compress_epi64((__mmask8)keep, x),
+	                   _mm512_cmp_pd_mask(_mm512_castsi512_pd(x), lo, _CMP_GE_OQ) & _mm512_cmp_pd_mask(_mm512_castsi512_pd(x), hi, _CMP_LE_OQ),
+	                   pysimd_filter_count[keep])
+#undef SIMD_FILTER_COUNT16
+
+#undef SIMD_VEC_FILTER_AVX512
+
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_VEC_FILTER_TAIL
+
+#endif // PYSIMD_X86_SSE2
+
 #endif // PYSIMD_VEC_FILTER_H
@@ -0,0 +1,398 @@
+#ifndef SIMD_VEC_FIND_H
+#define SIMD_VEC_FIND_H
+
+#include "simd_vec_type.h"
+#include "vec_macros.h"
+#include "simd_vec_cmp.h"
+
+#if defined(PYSIMD_CC_MSVC)
+#  include <intrin.h>
+#endif
+
+/* Search kernels look for lanes equal to a value, given as a block of
+ * PYSIMD_CMP_BROADCAST_SIZE bytes holding the value repeated, like the broadcast
+ * operand of a comparison. find and rfind return the index of the first or last such
+ * lane, count returns how many there are. find_any takes up to PYSIMD_FIND_ANY_MAX
+ * such blocks one after the other, and returns the first lane equal to any of them.
+ * A search that finds nothing returns the number of lanes of the vector.
+ *
+ * Integer kernels compare bits, so they serve signed and unsigned lanes alike. Float
+ * kernels compare as floats, 0.0 finds -0.0 and NaN finds nothing.
+ */
+
+#define PYSIMD_FIND_ANY_MAX 8
+
+// Index of the lowest set bit of a word that is not zero, a single tzcnt or bsf
+static size_t simd_lowest_bit(uint64_t bits)
+{
+#if defined(PYSIMD_CC_GCC) || defined(PYSIMD_CC_CLANG)
+	return (size_t)__builtin_ctzll(bits);
+#elif defined(PYSIMD_CC_MSVC)
+	unsigned long index = 0;
+	_BitScanForward64(&index, bits);
+	return (size_t)index;
+#else
+	size_t index = 0;
+	for (; !(bits & 1); bits >>= 1)
+		++index;
+	return index;
+#endif
+}
+
+// Index of the highest set bit of a word that is not zero
+static size_t simd_highest_bit(uint64_t bits)
+{
+#if defined(PYSIMD_CC_GCC) || defined(PYSIMD_CC_CLANG)
+	return (size_t)(63 - __builtin_clzll(bits));
+#elif defined(PYSIMD_CC_MSVC)
+	unsigned long index = 0;
+	_BitScanReverse64(&index, bits);
+	return (size_t)index;
+#else
+	size_t index = 63;
+	for (; !(bits >> 63); bits <<= 1)
+		--index;
+	return index;
+#endif
+}
+
+#define SIMD_VEC_FIND_SCALAR(name, ctype) \
+static size_t name(const struct pysimd_vec_t* vec, const unsigned char* value) { \
+	const size_t n_lanes = vec->size / sizeof(ctype); \
+	const ctype* lanes = (const ctype*)vec->data; \
+	ctype wanted; \
+	size_t i = 0; \
+	memcpy(&wanted, value, sizeof(ctype)); \
+	for (; i < n_lanes; ++i) { \
+		if (lanes[i] == wanted) \
+			return i; \
+	} \
+	return n_lanes; \
+}
+
+#define SIMD_VEC_RFIND_SCALAR(name, ctype) \
+static size_t name(const struct pysimd_vec_t* vec, const unsigned char* value) { \
+	const size_t n_lanes = vec->size / sizeof(ctype); \
+	const ctype* lanes = (const ctype*)vec->data; \
+	ctype wanted; \
+	size_t i = n_lanes; \
+	memcpy(&wanted, value, sizeof(ctype)); \
+	while (i > 0) { \
+		if (lanes[--i] == wanted) \
+			return i; \
+	} \
+	return n_lanes; \
+}
+
+#define SIMD_VEC_COUNT_SCALAR(name, ctype) \
+static size_t name(const struct pysimd_vec_t* vec, const unsigned char* value) { \
+	const size_t n_lanes = vec->size / sizeof(ctype); \
+	const ctype* lanes = (const ctype*)vec->data; \
+	ctype wanted; \
+	size_t total = 0; \
+	size_t i = 0; \
+	memcpy(&wanted, value, sizeof(ctype)); \
+	for (; i < n_lanes; ++i) \
+		total += lanes[i] == wanted; \
+	return total; \
+}
+
+#define SIMD_VEC_FIND_ANY_SCALAR(name, ctype) \
+static size_t name(const struct pysimd_vec_t* vec, const unsigned char* values, size_t n_values) { \
+	const size_t n_lanes = vec->size / sizeof(ctype); \
+	const ctype* lanes = (const ctype*)vec->data; \
+	ctype wanted[PYSIMD_FIND_ANY_MAX]; \
+	size_t i = 0; \
+	size_t k = 0; \
+	for (; k < n_values; ++k) \
+		memcpy(&wanted[k], values + k * PYSIMD_CMP_BROADCAST_SIZE, sizeof(ctype)); \
+	for (; i < n_lanes; ++i) { \
+		for (k = 0; k < n_values; ++k) { \
+			if (lanes[i] == wanted[k]) \
+				return i; \
+		} \
+	} \
+	return n_lanes; \
+}
+
+SIMD_VEC_FIND_SCALAR(simd_vec_find_i8_scalar, uint8_t)
+SIMD_VEC_FIND_SCALAR(simd_vec_find_i16_scalar, uint16_t)
+SIMD_VEC_FIND_SCALAR(simd_vec_find_i32_scalar, uint32_t)
+SIMD_VEC_FIND_SCALAR(simd_vec_find_i64_scalar, uint64_t)
+SIMD_VEC_FIND_SCALAR(simd_vec_find_f32_scalar, float)
+SIMD_VEC_FIND_SCALAR(simd_vec_find_f64_scalar, double)
+SIMD_VEC_RFIND_SCALAR(simd_vec_rfind_i8_scalar, uint8_t)
+SIMD_VEC_RFIND_SCALAR(simd_vec_rfind_i16_scalar, uint16_t)
+SIMD_VEC_RFIND_SCALAR(simd_vec_rfind_i32_scalar, uint32_t)
+SIMD_VEC_RFIND_SCALAR(simd_vec_rfind_i64_scalar, uint64_t)
+SIMD_VEC_RFIND_SCALAR(simd_vec_rfind_f32_scalar, float)
+SIMD_VEC_RFIND_SCALAR(simd_vec_rfind_f64_scalar, double)
+SIMD_VEC_COUNT_SCALAR(simd_vec_count_i8_scalar, uint8_t)
+SIMD_VEC_COUNT_SCALAR(simd_vec_count_i16_scalar, uint16_t)
+SIMD_VEC_COUNT_SCALAR(simd_vec_count_i32_scalar, uint32_t)
+SIMD_VEC_COUNT_SCALAR(simd_vec_count_i64_scalar, uint64_t)
+SIMD_VEC_COUNT_SCALAR(simd_vec_count_f32_scalar, float)
+SIMD_VEC_COUNT_SCALAR(simd_vec_count_f64_scalar, double)
+SIMD_VEC_FIND_ANY_SCALAR(simd_vec_find_any_i8_scalar, uint8_t)
+SIMD_VEC_FIND_ANY_SCALAR(simd_vec_find_any_i16_scalar, uint16_t)
+SIMD_VEC_FIND_ANY_SCALAR(simd_vec_find_any_i32_scalar, uint32_t)
+SIMD_VEC_FIND_ANY_SCALAR(simd_vec_find_any_i64_scalar, uint64_t)
+SIMD_VEC_FIND_ANY_SCALAR(simd_vec_find_any_f32_scalar, float)
+SIMD_VEC_FIND_ANY_SCALAR(simd_vec_find_any_f64_scalar, double)
+
+#undef SIMD_VEC_FIND_SCALAR
+#undef SIMD_VEC_RFIND_SCALAR
+#undef SIMD_VEC_COUNT_SCALAR
+#undef SIMD_VEC_FIND_ANY_SCALAR
+
+#if defined(PYSIMD_X86_SSE2)
+
+/* The vector kernels work like a fast memchr. Four registers are compared at a time
+ * and or'ed together, so the loop takes a single branch on a single movemask, and only
+ * once something matched are the registers looked at one by one. The movemask has a
+ * bit per byte, the lowest set bit divided by the lane width is the lane found. What
+ * is left of the vector, less than a register, goes to the kernel of the tier below.
+ */
+#define SIMD_VEC_FIND_VECTOR(name, target, width, vtype, load, orv, movemask, lane_bytes, eq, tail) \
+static target size_t name(const struct pysimd_vec_t* vec, const unsigned char* value) { \
+	const vtype needle = load((vtype const*)value); \
+	const unsigned char* data = vec->data; \
+	uint64_t bits = 0; \
+	size_t i = 0; \
+	for (; i + 4 * (width) <= vec->size; i += 4 * (width)) { \
+		const vtype e0 = eq(load((vtype const*)(data + i)), needle); \
+		const vtype e1 = eq(load((vtype const*)(data + i + (width))), needle); \
+		const vtype e2 = eq(load((vtype const*)(data + i + 2 * (width))), needle); \
+		const vtype e3 = eq(load((vtype const*)(data + i + 3 * (width))), needle); \
+		if (movemask(orv(orv(e0, e1), orv(e2, e3))) == 0) \
+			continue; \
+		if ((bits = movemask(e0)) != 0) \
+			return (i + simd_lowest_bit(bits)) / (lane_bytes); \
+		if ((bits = movemask(e1)) != 0) \
+			return (i + (width) + simd_lowest_bit(bits)) / (lane_bytes); \
+		if ((bits = movemask(e2)) != 0) \
+			return (i + 2 * (width) + simd_lowest_bit(bits)) / (lane_bytes); \
+		return (i + 3 * (width) + simd_lowest_bit(movemask(e3))) / (lane_bytes); \
+	} \
+	for (; i + (width) <= vec->size; i += (width)) { \
+		if ((bits = movemask(eq(load((vtype const*)(data + i)), needle))) != 0) \
+			return (i + simd_lowest_bit(bits)) / (lane_bytes); \
+	} \
+	if (i < vec->size) { \
+		struct pysimd_vec_t rest = {vec->size - i, vec->data + i}; \
+		return i / (lane_bytes) + tail(&rest, value); \
+	} \
+	return vec->size / (lane_bytes); \
+}
+
+// Searches from the end, the part less than a register at the end is searched first
+#define SIMD_VEC_RFIND_VECTOR(name, target, width, vtype, load, orv, movemask, lane_bytes, eq, tail) \
+static target size_t name(const struct pysimd_vec_t* vec, const unsigned char* value) { \
+	const vtype needle = load((vtype const*)value); \
+	const unsigned char* data = vec->data; \
+	size_t end = vec->size - vec->size % (width); \
+	uint64_t bits = 0; \
+	if (end < vec->size) { \
+		struct pysimd_vec_t rest = {vec->size - end, vec->data + end}; \
+		const size_t found = tail(&rest, value); \
+		if (found < rest.size / (lane_bytes)) \
+			return end / (lane_bytes) + found; \
+	} \
+	while (end >= 4 * (width)) { \
+		vtype e0, e1, e2, e3; \
+		end -= 4 * (width); \
+		e0 = eq(load((vtype const*)(data + end)), needle); \
+		e1 = eq(load((vtype const*)(data + end + (width))), needle); \
+		e2 = eq(load((vtype const*)(data + end + 2 * (width))), needle); \
+		e3 = eq(load((vtype const*)(data + end + 3 * (width))), needle); \
+		if (movemask(orv(orv(e0, e1), orv(e2, e3))) == 0) \
+			continue; \
+		if ((bits = movemask(e3)) != 0) \
+			return (end + 3 * (width) + simd_highest_bit(bits)) / (lane_bytes); \
+		if ((bits = movemask(e2)) != 0) \
+			return (end + 2 * (width) + simd_highest_bit(bits)) / (lane_bytes); \
+		if ((bits = movemask(e1)) != 0) \
+			return (end + (width) + simd_highest_bit(bits)) / (lane_bytes); \
+		return (end + simd_highest_bit(movemask(e0))) / (lane_bytes); \
+	} \
+	while (end >= (width)) { \
+		end -= (width); \
+		if ((bits = movemask(eq(load((vtype const*)(data + end)), needle))) != 0) \
+			return (end + simd_highest_bit(bits)) / (lane_bytes); \
+	} \
+	return vec->size / (lane_bytes); \
+}
+
+/* Counting subtracts each lane mask, all ones where a lane matched, from counters as
+ * wide as the lanes. Narrow counters are added up before they can wrap, every limit
+ * registers.
+ */
+#define SIMD_VEC_COUNT_VECTOR(name, target, width, vtype, load, storeu, zero, sub, ctype, limit, eq, tail) \
+static target size_t name(const struct pysimd_vec_t* vec, const unsigned char* value) { \
+	const vtype needle = load((vtype const*)value); \
+	const unsigned char* data = vec->data; \
+	vtype counters = zero; \
+	ctype lanes[(width) / sizeof(ctype)]; \
+	size_t total = 0; \
+	size_t run = 0; \
+	size_t i = 0; \
+	size_t j = 0; \
+	for (; i + (width) <= vec->size; i += (width)) { \
+		counters = sub(counters, eq(load((vtype const*)(data + i)), needle)); \
+		if (++run == (limit) || i + 2 * (width) > vec->size) { \
+			storeu((vtype*)lanes, counters); \
+			for (j = 0; j < (width) / sizeof(ctype); ++j) \
+				total += lanes[j]; \
+			counters = zero; \
+			run = 0; \
+		} \
+	} \
+	if (i < vec->size) { \
+		struct pysimd_vec_t rest = {vec->size - i, vec->data + i}; \
+		total += tail(&rest, value); \
+	} \
+	return total; \
+}
+
+#define SIMD_VEC_FIND_ANY_VECTOR(name, target, width, vtype, load, orv, movemask, lane_bytes, eq, tail) \
+static target size_t name(const struct pysimd_vec_t* vec, const unsigned char* values, size_t n_values) { \
+	const unsigned char* data = vec->data; \
+	vtype needles[PYSIMD_FIND_ANY_MAX]; \
+	uint64_t bits = 0; \
+	size_t i = 0; \
+	size_t k = 0; \
+	for (; k < n_values; ++k) \
+		needles[k] = load((vtype const*)(values + k * PYSIMD_CMP_BROADCAST_SIZE)); \
+	for (; i + (width) <= vec->size; i += (width)) { \
+		const vtype lanes = load((vtype const*)(data + i)); \
+		vtype matched = eq(lanes, needles[0]); \
+		for (k = 1; k < n_values; ++k) \
+			matched = orv(matched, eq(lanes, needles[k])); \
+		if ((bits = movemask(matched)) != 0) \
+			return (i + simd_lowest_bit(bits)) / (lane_bytes); \
+	} \
+	if (i < vec->size) { \
+		struct pysimd_vec_t rest = {vec->size - i, vec->data + i}; \
+		return i / (lane_bytes) + tail(&rest, values, n_values); \
+	} \
+	return vec->size / (lane_bytes); \
+}
+
+static PYSIMD_TARGET_SSE2 uint64_t simd_find_movemask_sse2(__m128i mask) { return (uint64_t)(unsigned)_mm_movemask_epi8(mask); }
+
+#define SIMD_VEC_SEARCH_SSE2(find, rfind, count, find_any, lane_bytes, eq, sub, ctype, limit, tail_find, tail_rfind, tail_count, tail_find_any) \
+	SIMD_VEC_FIND_VECTOR(find, PYSIMD_TARGET_SSE2, 16, __m128i, _mm_load_si128, _mm_or_si128, simd_find_movemask_sse2, \
+	                     lane_bytes, eq, tail_find) \
+	SIMD_VEC_RFIND_VECTOR(rfind, PYSIMD_TARGET_SSE2, 16, __m128i, _mm_load_si128, _mm_or_si128, simd_find_movemask_sse2, \
+	                      lane_bytes, eq, tail_rfind) \
+	SIMD_VEC_COUNT_VECTOR(count, PYSIMD_TARGET_SSE2, 16, __m128i, _mm_load_si128, _mm_storeu_si128, _mm_setzero_si128(), \
+	                      sub, ctype, limit, eq, tail_count) \
+	SIMD_VEC_FIND_ANY_VECTOR(find_any, PYSIMD_TARGET_SSE2, 16, __m128i, _mm_load_si128, _mm_or_si128, simd_find_movemask_sse2, \
+	                         lane_bytes, eq, tail_find_any)
+
+SIMD_VEC_SEARCH_SSE2(simd_vec_find_i8_sse2, simd_vec_rfind_i8_sse2, simd_vec_count_i8_sse2, simd_vec_find_any_i8_sse2,
+	                 1, _mm_cmpeq_epi8, _mm_sub_epi8, uint8_t, UINT8_MAX,
+	                 simd_vec_find_i8_scalar, simd_vec_rfind_i8_scalar, simd_vec_count_i8_scalar, simd_vec_find_any_i8_scalar)
+SIMD_VEC_SEARCH_SSE2(simd_vec_find_i16_sse2, simd_vec_rfind_i16_sse2, simd_vec_count_i16_sse2, simd_vec_find_any_i16_sse2,
+	                 2, _mm_cmpeq_epi16, _mm_sub_epi16, uint16_t, UINT16_MAX,
+	                 simd_vec_find_i16_scalar, simd_vec_rfind_i16_scalar, simd_vec_count_i16_scalar, simd_vec_find_any_i16_scalar)
+SIMD_VEC_SEARCH_SSE2(simd_vec_find_i32_sse2, simd_vec_rfind_i32_sse2, simd_vec_count_i32_sse2, simd_vec_find_any_i32_sse2,
+	                 4, _mm_cmpeq_epi32, _mm_sub_epi32, uint32_t, UINT32_MAX,
+	                 simd_vec_find_i32_scalar, simd_vec_rfind_i32_scalar, simd_vec_count_i32_scalar, simd_vec_find_any_i32_scalar)
+SIMD_VEC_SEARCH_SSE2(simd_vec_find_i64_sse2, simd_vec_rfind_i64_sse2, simd_vec_count_i64_sse2, simd_vec_find_any_i64_sse2,
+	                 8, simd_cmpeq_epi64_sse2, _mm_sub_epi64, uint64_t, SIZE_MAX,
+	                 simd_vec_find_i64_scalar, simd_vec_rfind_i64_scalar, simd_vec_count_i64_scalar, simd_vec_find_any_i64_scalar)
+SIMD_VEC_SEARCH_SSE2(simd_vec_find_f32_sse2, simd_vec_rfind_f32_sse2, simd_vec_count_f32_sse2, simd_vec_find_any_f32_sse2,
+	                 4, simd_cmpeq_ps_sse2, _mm_sub_epi32, uint32_t, UINT32_MAX,
+	                 simd_vec_find_f32_scalar, simd_vec_rfind_f32_scalar, simd_vec_count_f32_scalar, simd_vec_find_any_f32_scalar)
+SIMD_VEC_SEARCH_SSE2(simd_vec_find_f64_sse2, simd_vec_rfind_f64_sse2, simd_vec_count_f64_sse2, simd_vec_find_any_f64_sse2,
+	                 8, simd_cmpeq_pd_sse2, _mm_sub_epi64, uint64_t, SIZE_MAX,
+	                 simd_vec_find_f64_scalar, simd_vec_rfind_f64_scalar, simd_vec_count_f64_scalar, simd_vec_find_any_f64_scalar)
+
+#undef SIMD_VEC_SEARCH_SSE2
+
+#if defined(PYSIMD_X86_AVX2)
+
+static PYSIMD_TARGET_AVX2 uint64_t simd_find_movemask_avx2(__m256i mask) { return (uint64_t)(unsigned)_mm256_movemask_epi8(mask); }
+
+#define SIMD_VEC_SEARCH_AVX2(find, rfind, count, find_any, lane_bytes, eq, sub, ctype, limit, tail_find, tail_rfind, tail_count, tail_find_any) \
+	SIMD_VEC_FIND_VECTOR(find, PYSIMD_TARGET_AVX2, 32, __m256i, _mm256_loadu_si256, _mm256_or_si256, simd_find_movemask_avx2, \
+	                     lane_bytes, eq, tail_find) \
+	SIMD_VEC_RFIND_VECTOR(rfind, PYSIMD_TARGET_AVX2, 32, __m256i, _mm256_loadu_si256, _mm256_or_si256, simd_find_movemask_avx2, \
+	                      lane_bytes, eq, tail_rfind) \
+	SIMD_VEC_COUNT_VECTOR(count, PYSIMD_TARGET_AVX2, 32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_setzero_si256(), \
+	                      sub, ctype, limit, eq, tail_count) \
+	SIMD_VEC_FIND_ANY_VECTOR(find_any, PYSIMD_TARGET_AVX2, 32, __m256i, _mm256_loadu_si256, _mm256_or_si256, simd_find_movemask_avx2, \
+	                         lane_bytes, eq, tail_find_any)
+
+SIMD_VEC_SEARCH_AVX2(simd_vec_find_i8_avx2, simd_vec_rfind_i8_avx2, simd_vec_count_i8_avx2, simd_vec_find_any_i8_avx2,
+	                 1, _mm256_cmpeq_epi8, _mm256_sub_epi8, uint8_t, UINT8_MAX,
+	                 simd_vec_find_i8_sse2, simd_vec_rfind_i8_sse2, simd_vec_count_i8_sse2, simd_vec_find_any_i8_sse2)
+SIMD_VEC_SEARCH_AVX2(simd_vec_find_i16_avx2, simd_vec_rfind_i16_avx2, simd_vec_count_i16_avx2, simd_vec_find_any_i16_avx2,
+	                 2, _mm256_cmpeq_epi16, _mm256_sub_epi16, uint16_t, UINT16_MAX,
+	                 simd_vec_find_i16_sse2, simd_vec_rfind_i16_sse2, simd_vec_count_i16_sse2, simd_vec_find_any_i16_sse2)
+SIMD_VEC_SEARCH_AVX2(simd_vec_find_i32_avx2, simd_vec_rfind_i32_avx2, simd_vec_count_i32_avx2, simd_vec_find_any_i32_avx2,
+	                 4, _mm256_cmpeq_epi32, _mm256_sub_epi32, uint32_t, UINT32_MAX,
+	                 simd_vec_find_i32_sse2, simd_vec_rfind_i32_sse2, simd_vec_count_i32_sse2, simd_vec_find_any_i32_sse2)
+SIMD_VEC_SEARCH_AVX2(simd_vec_find_i64_avx2, simd_vec_rfind_i64_avx2, simd_vec_count_i64_avx2, simd_vec_find_any_i64_avx2,
+	                 8, _mm256_cmpeq_epi64, _mm256_sub_epi64, uint64_t, SIZE_MAX,
+	                 simd_vec_find_i64_sse2, simd_vec_rfind_i64_sse2, simd_vec_count_i64_sse2, simd_vec_find_any_i64_sse2)
+SIMD_VEC_SEARCH_AVX2(simd_vec_find_f32_avx2, simd_vec_rfind_f32_avx2, simd_vec_count_f32_avx2, simd_vec_find_any_f32_avx2,
+	                 4, simd_cmpeq_ps_avx2, _mm256_sub_epi32, uint32_t, UINT32_MAX,
+	                 simd_vec_find_f32_sse2, simd_vec_rfind_f32_sse2, simd_vec_count_f32_sse2, simd_vec_find_any_f32_sse2)
+SIMD_VEC_SEARCH_AVX2(simd_vec_find_f64_avx2, simd_vec_rfind_f64_avx2, simd_vec_count_f64_avx2, simd_vec_find_any_f64_avx2,
+	                 8, simd_cmpeq_pd_avx2, _mm256_sub_epi64, uint64_t, SIZE_MAX,
+	                 simd_vec_find_f64_sse2, simd_vec_rfind_f64_sse2, simd_vec_count_f64_sse2, simd_vec_find_any_f64_sse2)
+
+#undef SIMD_VEC_SEARCH_AVX2
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+/* The lane masks of the comparison kernels are reused here, with the sign bit of each
+ * byte gathered into a 64 bit word, so the byte to lane arithmetic stays the same.
+ */
+static PYSIMD_TARGET_AVX512 uint64_t simd_find_movemask_avx512(__m512i mask) { return (uint64_t)_mm512_movepi8_mask(mask); }
+
+#define SIMD_VEC_SEARCH_AVX512(find, rfind, count, find_any, lane_bytes, eq, sub, ctype, limit, tail_find, tail_rfind, tail_count, tail_find_any) \
+	SIMD_VEC_FIND_VECTOR(find, PYSIMD_TARGET_AVX512, 64, __m512i, simd_load_avx512, _mm512_or_si512, simd_find_movemask_avx512, \
+	                     lane_bytes, eq, tail_find) \
+	SIMD_VEC_RFIND_VECTOR(rfind, PYSIMD_TARGET_AVX512, 64, __m512i, simd_load_avx512, _mm512_or_si512, simd_find_movemask_avx512, \
+	                      lane_bytes, eq, tail_rfind) \
+	SIMD_VEC_COUNT_VECTOR(count, PYSIMD_TARGET_AVX512, 64, __m512i, simd_load_avx512, simd_store_avx512, _mm512_setzero_si512(), \
+	                      sub, ctype, limit, eq, tail_count) \
+	SIMD_VEC_FIND_ANY_VECTOR(find_any, PYSIMD_TARGET_AVX512, 64, __m512i, simd_load_avx512, _mm512_or_si512, simd_find_movemask_avx512, \
+	                         lane_bytes, eq, tail_find_any)
+
+SIMD_VEC_SEARCH_AVX512(simd_vec_find_i8_avx512, simd_vec_rfind_i8_avx512, simd_vec_count_i8_avx512, simd_vec_find_any_i8_avx512,
+	                   1, simd_cmpeq_epi8_avx512, _mm512_sub_epi8, uint8_t, UINT8_MAX,
+	                   simd_vec_find_i8_avx2, simd_vec_rfind_i8_avx2, simd_vec_count_i8_avx2, simd_vec_find_any_i8_avx2)
+SIMD_VEC_SEARCH_AVX512(simd_vec_find_i16_avx512, simd_vec_rfind_i16_avx512, simd_vec_count_i16_avx512, simd_vec_find_any_i16_avx512,
+	                   2, simd_cmpeq_epi16_avx512, _mm512_sub_epi16, uint16_t, UINT16_MAX,
+	                   simd_vec_find_i16_avx2, simd_vec_rfind_i16_avx2, simd_vec_count_i16_avx2, simd_vec_find_any_i16_avx2)
+SIMD_VEC_SEARCH_AVX512(simd_vec_find_i32_avx512, simd_vec_rfind_i32_avx512, simd_vec_count_i32_avx512, simd_vec_find_any_i32_avx512,
+	                   4, simd_cmpeq_epi32_avx512, _mm512_sub_epi32, uint32_t, UINT32_MAX,
+	                   simd_vec_find_i32_avx2, simd_vec_rfind_i32_avx2, simd_vec_count_i32_avx2, simd_vec_find_any_i32_avx2)
+SIMD_VEC_SEARCH_AVX512(simd_vec_find_i64_avx512, simd_vec_rfind_i64_avx512, simd_vec_count_i64_avx512, simd_vec_find_any_i64_avx512,
+	                   8, simd_cmpeq_epi64_avx512, _mm512_sub_epi64, uint64_t, SIZE_MAX,
+	                   simd_vec_find_i64_avx2, simd_vec_rfind_i64_avx2, simd_vec_count_i64_avx2, simd_vec_find_any_i64_avx2)
+SIMD_VEC_SEARCH_AVX512(simd_vec_find_f32_avx512, simd_vec_rfind_f32_avx512, simd_vec_count_f32_avx512, simd_vec_find_any_f32_avx512,
+	                   4, simd_cmpeq_ps_avx512, _mm512_sub_epi32, uint32_t, UINT32_MAX,
+	                   simd_vec_find_f32_avx2, simd_vec_rfind_f32_avx2, simd_vec_count_f32_avx2, simd_vec_find_any_f32_avx2)
+SIMD_VEC_SEARCH_AVX512(simd_vec_find_f64_avx512, simd_vec_rfind_f64_avx512, simd_vec_count_f64_avx512, simd_vec_find_any_f64_avx512,
+	                   8, simd_cmpeq_pd_avx512, _mm512_sub_epi64, uint64_t, SIZE_MAX,
+	                   simd_vec_find_f64_avx2, simd_vec_rfind_f64_avx2, simd_vec_count_f64_avx2, simd_vec_find_any_f64_avx2)
+
+#undef SIMD_VEC_SEARCH_AVX512
+
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_VEC_FIND_VECTOR
+#undef SIMD_VEC_RFIND_VECTOR
+#undef SIMD_VEC_COUNT_VECTOR
+#undef SIMD_VEC_FIND_ANY_VECTOR
+
+#endif // PYSIMD_X86_SSE2
+
+#endif // SIMD_VEC_FIND_H
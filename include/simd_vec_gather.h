@@ -0,0 +1,204 @@
+#ifndef SIMD_VEC_GATHER_H
+#define SIMD_VEC_GATHER_H
+
+#include "simd_vec_type.h"
+#include "vec_macros.h"
+
+/* Gather kernels read lanes of 32 or 64 bits at u32 lane positions, and scatter kernels
+ * write lanes to them, later lanes over earlier ones at the same position. Neither
+ * checks its positions, that is done first for all of them with index_max, whose
+ * result must be below the lane count of the vector read or written.
+ *
+ * The vector gathers and scatters take their positions as signed 32 bit offsets, so
+ * they are only bound for positions up to PYSIMD_GATHER_INDEX_MAX, and the scalar
+ * kernels are used past it.
+ */
+#define PYSIMD_GATHER_INDEX_MAX ((uint32_t)INT32_MAX)
+
+typedef uint32_t (*pysimd_vec_index_max_t)(const uint32_t*, size_t);
+typedef void (*pysimd_vec_gather_t)(unsigned char*, const unsigned char*, const uint32_t*, size_t);
+typedef void (*pysimd_vec_scatter_t)(unsigned char*, const uint32_t*, const unsigned char*, size_t);
+
+static uint32_t simd_vec_index_max_scalar(const uint32_t* index, size_t n)
+{
+	uint32_t m0 = 0, m1 = 0, m2 = 0, m3 = 0;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		m0 = index[i] > m0 ? index[i] : m0;
+		m1 = index[i + 1] > m1 ? index[i + 1] : m1;
+		m2 = index[i + 2] > m2 ? index[i + 2] : m2;
+		m3 = index[i + 3] > m3 ? index[i + 3] : m3;
+	}
+	for (; i < n; ++i)
+		m0 = index[i] > m0 ? index[i] : m0;
+	m0 = m1 > m0 ? m1 : m0;
+	m2 = m3 > m2 ? m3 : m2;
+	return m2 > m0 ? m2 : m0;
+}
+
+#define SIMD_VEC_GATHER_SCALAR(bits) \
+static void simd_vec_gather_##bits##_scalar(unsigned char* dst, const unsigned char* src, const uint32_t* index, size_t n) { \
+	uint##bits##_t* to = (uint##bits##_t*)dst; \
+	const uint##bits##_t* from = (const uint##bits##_t*)src; \
+	size_t i = 0; \
+	for (; i + 4 <= n; i += 4) { \
+		to[i] = from[index[i]]; \
+		to[i + 1] = from[index[i + 1]]; \
+		to[i + 2] = from[index[i + 2]]; \
+		to[i + 3] = from[index[i + 3]]; \
+	} \
+	for (; i < n; ++i) \
+		to[i] = from[index[i]]; \
+} \
+static void simd_vec_scatter_##bits##_scalar(unsigned char* dst, const uint32_t* index, const unsigned char* values, size_t n) { \
+	uint##bits##_t* to = (uint##bits##_t*)dst; \
+	const uint##bits##_t* from = (const uint##bits##_t*)values; \
+	size_t i = 0; \
+	for (; i + 4 <= n; i += 4) { \
+		to[index[i]] = from[i]; \
+		to[index[i + 1]] = from[i + 1]; \
+		to[index[i + 2]] = from[i + 2]; \
+		to[index[i + 3]] = from[i + 3]; \
+	} \
+	for (; i < n; ++i) \
+		to[index[i]] = from[i]; \
+}
+
+SIMD_VEC_GATHER_SCALAR(32)
+SIMD_VEC_GATHER_SCALAR(64)
+
+#undef SIMD_VEC_GATHER_SCALAR
+
+#if defined(PYSIMD_X86_SSE2)
+
+// SSE2 has no unsigned max, positions are compared as signed after flipping the top bit
+static PYSIMD_TARGET_SSE2 uint32_t simd_vec_index_max_sse2(const uint32_t* index, size_t n)
+{
+	const __m128i bias = _mm_set1_epi32(INT32_MIN);
+	__m128i m0 = bias;
+	__m128i m1 = bias;
+	uint32_t parts[4];
+	uint32_t found = 0;
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(index + i)), bias);
+		const __m128i x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(index + i + 4)), bias);
+		const __m128i gt0 = _mm_cmpgt_epi32(x0, m0);
+		const __m128i gt1 = _mm_cmpgt_epi32(x1, m1);
+		m0 = _mm_or_si128(_mm_and_si128(gt0, x0), _mm_andnot_si128(gt0, m0));
+		m1 = _mm_or_si128(_mm_and_si128(gt1, x1), _mm_andnot_si128(gt1, m1));
+	}
+	_mm_storeu_si128((__m128i*)parts, _mm_xor_si128(m0, bias));
+	found = simd_vec_index_max_scalar(parts, 4);
+	_mm_storeu_si128((__m128i*)parts, _mm_xor_si128(m1, bias));
+	parts[0] = simd_vec_index_max_scalar(parts, 4);
+	found = parts[0] > found ? parts[0] : found;
+	parts[0] = simd_vec_index_max_scalar(index + i, n - i);
+	return parts[0] > found ? parts[0] : found;
+}
+
+#endif // PYSIMD_X86_SSE2
+
+#if defined(PYSIMD_X86_AVX2)
+
+static PYSIMD_TARGET_AVX2 uint32_t simd_vec_index_max_avx2(const uint32_t* index, size_t n)
+{
+	__m256i m0 = _mm256_setzero_si256();
+	__m256i m1 = _mm256_setzero_si256();
+	uint32_t parts[8];
+	uint32_t found = 0;
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		m0 = _mm256_max_epu32(m0, _mm256_loadu_si256((const __m256i*)(index + i)));
+		m1 = _mm256_max_epu32(m1, _mm256_loadu_si256((const __m256i*)(index + i + 8)));
+	}
+	_mm256_storeu_si256((__m256i*)parts, _mm256_max_epu32(m0, m1));
+	found = simd_vec_index_max_scalar(parts, 8);
+	parts[0] = simd_vec_index_max_scalar(index + i, n - i);
+	return parts[0] > found ? parts[0] : found;
+}
+
+static PYSIMD_TARGET_AVX2 void simd_vec_gather_32_avx2(unsigned char* dst, const unsigned char* src, const uint32_t* index, size_t n)
+{
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const __m256i at = _mm256_loadu_si256((const __m256i*)(index + i));
+		_mm256_storeu_si256((__m256i*)(dst + i * 4), _mm256_i32gather_epi32((const int*)src, at, 4));
+	}
+	simd_vec_gather_32_scalar(dst + i * 4, src, index + i, n - i);
+}
+
+static PYSIMD_TARGET_AVX2 void simd_vec_gather_64_avx2(unsigned char* dst, const unsigned char* src, const uint32_t* index, size_t n)
+{
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m128i at = _mm_loadu_si128((const __m128i*)(index + i));
+		_mm256_storeu_si256((__m256i*)(dst + i * 8), _mm256_i32gather_epi64((const long long*)src, at, 8));
+	}
+	simd_vec_gather_64_scalar(dst + i * 8, src, index + i, n - i);
+}
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+static PYSIMD_TARGET_AVX512 uint32_t simd_vec_index_max_avx512(const uint32_t* index, size_t n)
+{
+	__m512i m0 = _mm512_setzero_si512();
+	__m512i m1 = _mm512_setzero_si512();
+	uint32_t found = 0;
+	uint32_t rest = 0;
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		m0 = _mm512_max_epu32(m0, _mm512_loadu_si512((const void*)(index + i)));
+		m1 = _mm512_max_epu32(m1, _mm512_loadu_si512((const void*)(index + i + 16)));
+	}
+	found = _mm512_reduce_max_epu32(_mm512_max_epu32(m0, m1));
+	rest = simd_vec_index_max_scalar(index + i, n - i);
+	return rest > found ? rest : found;
+}
+
+static PYSIMD_TARGET_AVX512 void simd_vec_gather_32_avx512(unsigned char* dst, const unsigned char* src, const uint32_t* index, size_t n)
+{
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		const __m512i at = _mm512_loadu_si512((const void*)(index + i));
+		_mm512_storeu_si512((void*)(dst + i * 4), _mm512_i32gather_epi32(at, (const void*)src, 4));
+	}
+	simd_vec_gather_32_scalar(dst + i * 4, src, index + i, n - i);
+}
+
+static PYSIMD_TARGET_AVX512 void simd_vec_gather_64_avx512(unsigned char* dst, const unsigned char* src, const uint32_t* index, size_t n)
+{
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const __m256i at = _mm256_loadu_si256((const __m256i*)(index + i));
+		_mm512_storeu_si512((void*)(dst + i * 8), _mm512_i32gather_epi64(at, (const void*)src, 8));
+	}
+	simd_vec_gather_64_scalar(dst + i * 8, src, index + i, n - i);
+}
+
+// Lanes of one scatter at the same position are written in order, so the last one stays
+static PYSIMD_TARGET_AVX512 void simd_vec_scatter_32_avx512(unsigned char* dst, const uint32_t* index, const unsigned char* values, size_t n)
+{
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		const __m512i at = _mm512_loadu_si512((const void*)(index + i));
+		_mm512_i32scatter_epi32((void*)dst, at, _mm512_loadu_si512((const void*)(values + i * 4)), 4);
+	}
+	simd_vec_scatter_32_scalar(dst, index + i, values + i * 4, n - i);
+}
+
+static PYSIMD_TARGET_AVX512 void simd_vec_scatter_64_avx512(unsigned char* dst, const uint32_t* index, const unsigned char* values, size_t n)
+{
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const __m256i at = _mm256_loadu_si256((const __m256i*)(index + i));
+		_mm512_i32scatter_epi64((void*)dst, at, _mm512_loadu_si512((const void*)(values + i * 8)), 8);
+	}
+	simd_vec_scatter_64_scalar(dst, index + i, values + i * 8, n - i);
+}
+
+#endif // PYSIMD_X86_AVX512
+
+#endif // SIMD_VEC_GATHER_H
@@ -0,0 +1,267 @@
+#ifndef SIMD_VEC_HASH_H
+#define SIMD_VEC_HASH_H
+
+#include "simd_vec_type.h"
+#include "vec_macros.h"
+
+/* Lane hashes are the murmur3 finalizers of each 32 or 64 bit lane, xored first with a
+ * key made from the seed. The finalizers are bijections, so distinct lanes never share
+ * a hash, and every output bit depends on every input bit.
+ *
+ * CRC32C kernels advance a raw crc state, neither inverted at the start nor at the end,
+ * over n bytes. Running a kernel from a state s over bytes B gives s * x^(8 |B|) xor the
+ * state it gives from 0, so states of separate runs of bytes are combined by a multiply
+ * modulo the polynomial, which is how the bytes are split over several streams.
+ */
+#define PYSIMD_CRC32C_POLY 0x82f63b78u
+// Bytes each of the three interleaved streams covers before they are combined
+#define PYSIMD_CRC32C_STRIDE 2048
+
+typedef void (*pysimd_vec_hash_t)(unsigned char*, const unsigned char*, size_t, uint64_t);
+typedef uint32_t (*pysimd_vec_crc32c_t)(uint32_t, const unsigned char*, size_t);
+
+static uint32_t simd_hash_fmix32(uint32_t h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+static uint64_t simd_hash_fmix64(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+// Spreads a seed over all 64 bits, so that nearby seeds give unrelated hashes
+static uint64_t simd_hash_key(uint64_t seed)
+{
+	return simd_hash_fmix64(seed + 0x9e3779b97f4a7c15ull);
+}
+
+static void simd_vec_hash_32_scalar(unsigned char* dst, const unsigned char* src, size_t n, uint64_t key)
+{
+	const uint32_t k = (uint32_t)key;
+	size_t i = 0;
+	for (; i < n; ++i)
+		((uint32_t*)dst)[i] = simd_hash_fmix32(((const uint32_t*)src)[i] ^ k);
+}
+
+static void simd_vec_hash_64_scalar(unsigned char* dst, const unsigned char* src, size_t n, uint64_t key)
+{
+	size_t i = 0;
+	for (; i < n; ++i)
+		((uint64_t*)dst)[i] = simd_hash_fmix64(((const uint64_t*)src)[i] ^ key);
+}
+
+// Slicing by 8 tables, filled once by simd_crc32c_init at import
+static uint32_t simd_crc32c_table[8][256];
+
+static void simd_crc32c_init(void)
+{
+	uint32_t i = 0;
+	size_t k = 0;
+	for (; i < 256; ++i) {
+		uint32_t crc = i;
+		for (k = 0; k < 8; ++k)
+			crc = crc & 1 ? (crc >> 1) ^ PYSIMD_CRC32C_POLY : crc >> 1;
+		simd_crc32c_table[0][i] = crc;
+	}
+	for (i = 0; i < 256; ++i)
+		for (k = 1; k < 8; ++k)
+			simd_crc32c_table[k][i] = (simd_crc32c_table[k - 1][i] >> 8) ^ simd_crc32c_table[0][simd_crc32c_table[k - 1][i] & 0xff];
+}
+
+static uint32_t simd_vec_crc32c_scalar(uint32_t state, const unsigned char* data, size_t n)
+{
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		uint64_t word = 0;
+		memcpy(&word, data + i, 8);
+		word ^= state;
+		state = simd_crc32c_table[7][word & 0xff] ^ simd_crc32c_table[6][(word >> 8) & 0xff] ^
+		        simd_crc32c_table[5][(word >> 16) & 0xff] ^ simd_crc32c_table[4][(word >> 24) & 0xff] ^
+		        simd_crc32c_table[3][(word >> 32) & 0xff] ^ simd_crc32c_table[2][(word >> 40) & 0xff] ^
+		        simd_crc32c_table[1][(word >> 48) & 0xff] ^ simd_crc32c_table[0][word >> 56];
+	}
+	for (; i < n; ++i)
+		state = (state >> 8) ^ simd_crc32c_table[0][(state ^ data[i]) & 0xff];
+	return state;
+}
+
+// Multiplies two polynomials modulo the CRC32C polynomial, bit reflected, x^0 at bit 31
+static uint32_t simd_crc32c_multiply(uint32_t a, uint32_t b)
+{
+	uint32_t product = 0;
+	uint32_t m = (uint32_t)1 << 31;
+	for (; m != 0 && a != 0; m >>= 1) {
+		if (a & m) {
+			product ^= b;
+			a ^= m;
+		}
+		b = b & 1 ? (b >> 1) ^ PYSIMD_CRC32C_POLY : b >> 1;
+	}
+	return product;
+}
+
+// Returns x^(8 n) modulo the CRC32C polynomial, what a state is multiplied by to skip n bytes
+static uint32_t simd_crc32c_shift(size_t n)
+{
+	uint32_t power = (uint32_t)1 << 31;
+	uint32_t square = (uint32_t)1 << 23;
+	for (; n != 0; n >>= 1) {
+		if (n & 1)
+			power = simd_crc32c_multiply(square, power);
+		square = simd_crc32c_multiply(square, square);
+	}
+	return power;
+}
+
+#if defined(PYSIMD_X86_SSE2)
+
+// 32 bit multiplies by a constant, from the even and odd lanes of two 64 bit multiplies
+static PYSIMD_TARGET_SSE2 __m128i simd_hash_mul32_sse2(__m128i x, uint32_t c)
+{
+	const __m128i factor = _mm_set1_epi32((int)c);
+	const __m128i even = _mm_mul_epu32(x, factor);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), factor);
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, 0x08), _mm_shuffle_epi32(odd, 0x08));
+}
+
+// Low 64 bits of 64 bit multiplies by a constant, out of three 32 by 32 bit multiplies
+static PYSIMD_TARGET_SSE2 __m128i simd_hash_mul64_sse2(__m128i x, uint64_t c)
+{
+	const __m128i c_lo = _mm_set1_epi64x((long long)(c & 0xffffffffu));
+	const __m128i c_hi = _mm_set1_epi64x((long long)(c >> 32));
+	const __m128i cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(x, 32), c_lo), _mm_mul_epu32(x, c_hi));
+	return _mm_add_epi64(_mm_mul_epu32(x, c_lo), _mm_slli_epi64(cross, 32));
+}
+
+#endif // PYSIMD_X86_SSE2
+
+#if defined(PYSIMD_X86_AVX2)
+
+static PYSIMD_TARGET_AVX2 __m256i simd_hash_mul32_avx2(__m256i x, uint32_t c)
+{
+	return _mm256_mullo_epi32(x, _mm256_set1_epi32((int)c));
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_hash_mul64_avx2(__m256i x, uint64_t c)
+{
+	const __m256i c_lo = _mm256_set1_epi64x((long long)(c & 0xffffffffu));
+	const __m256i c_hi = _mm256_set1_epi64x((long long)(c >> 32));
+	const __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), c_lo), _mm256_mul_epu32(x, c_hi));
+	return _mm256_add_epi64(_mm256_mul_epu32(x, c_lo), _mm256_slli_epi64(cross, 32));
+}
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+static PYSIMD_TARGET_AVX512 __m512i simd_hash_mul32_avx512(__m512i x, uint32_t c)
+{
+	return _mm512_mullo_epi32(x, _mm512_set1_epi32((int)c));
+}
+
+// A single 64 bit multiply needs AVX-512DQ, which the tier does not require
+static PYSIMD_TARGET_AVX512 __m512i simd_hash_mul64_avx512(__m512i x, uint64_t c)
+{
+	const __m512i c_lo = _mm512_set1_epi64((long long)(c & 0xffffffffu));
+	const __m512i c_hi = _mm512_set1_epi64((long long)(c >> 32));
+	const __m512i cross = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(x, 32), c_lo), _mm512_mul_epu32(x, c_hi));
+	return _mm512_add_epi64(_mm512_mul_epu32(x, c_lo), _mm512_slli_epi64(cross, 32));
+}
+
+#endif // PYSIMD_X86_AVX512
+
+#define SIMD_VEC_HASH_VECTOR(tier, target, vtype, bytes, load, store, set1_32, set1_64, xor, srli32, srli64) \
+static target void simd_vec_hash_32_##tier(unsigned char* dst, const unsigned char* src, size_t n, uint64_t key) { \
+	const vtype k = set1_32((int)(uint32_t)key); \
+	size_t i = 0; \
+	for (; i + (bytes) / 4 <= n; i += (bytes) / 4) { \
+		vtype x = xor(load((const vtype*)(src + i * 4)), k); \
+		x = xor(x, srli32(x, 16)); \
+		x = simd_hash_mul32_##tier(x, 0x85ebca6bu); \
+		x = xor(x, srli32(x, 13)); \
+		x = simd_hash_mul32_##tier(x, 0xc2b2ae35u); \
+		store((vtype*)(dst + i * 4), xor(x, srli32(x, 16))); \
+	} \
+	simd_vec_hash_32_scalar(dst + i * 4, src + i * 4, n - i, key); \
+} \
+static target void simd_vec_hash_64_##tier(unsigned char* dst, const unsigned char* src, size_t n, uint64_t key) { \
+	const vtype k = set1_64((long long)key); \
+	size_t i = 0; \
+	for (; i + (bytes) / 8 <= n; i += (bytes) / 8) { \
+		vtype x = xor(load((const vtype*)(src + i * 8)), k); \
+		x = xor(x, srli64(x, 33)); \
+		x = simd_hash_mul64_##tier(x, 0xff51afd7ed558ccdull); \
+		x = xor(x, srli64(x, 33)); \
+		x = simd_hash_mul64_##tier(x, 0xc4ceb9fe1a85ec53ull); \
+		store((vtype*)(dst + i * 8), xor(x, srli64(x, 33))); \
+	} \
+	simd_vec_hash_64_scalar(dst + i * 8, src + i * 8, n - i, key); \
+}
+
+#if defined(PYSIMD_X86_SSE2)
+SIMD_VEC_HASH_VECTOR(sse2, PYSIMD_TARGET_SSE2, __m128i, 16, _mm_loadu_si128, _mm_storeu_si128, _mm_set1_epi32,
+	                 _mm_set1_epi64x, _mm_xor_si128, _mm_srli_epi32, _mm_srli_epi64)
+#endif // PYSIMD_X86_SSE2
+
+#if defined(PYSIMD_X86_AVX2)
+SIMD_VEC_HASH_VECTOR(avx2, PYSIMD_TARGET_AVX2, __m256i, 32, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi32,
+	                 _mm256_set1_epi64x, _mm256_xor_si256, _mm256_srli_epi32, _mm256_srli_epi64)
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+SIMD_VEC_HASH_VECTOR(avx512, PYSIMD_TARGET_AVX512, __m512i, 64, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi32,
+	                 _mm512_set1_epi64, _mm512_xor_si512, _mm512_srli_epi32, _mm512_srli_epi64)
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_VEC_HASH_VECTOR
+
+#if defined(PYSIMD_X86_SSE42)
+
+/* The crc32 instruction takes three cycles, but a new one can start every cycle, so
+ * three runs of PYSIMD_CRC32C_STRIDE bytes are checksummed at once and then combined.
+ */
+static PYSIMD_TARGET_SSE42 uint32_t simd_vec_crc32c_sse42(uint32_t state, const unsigned char* data, size_t n)
+{
+	uint64_t crc = state;
+	size_t i = 0;
+	if (n >= 3 * PYSIMD_CRC32C_STRIDE) {
+		const uint32_t skip = simd_crc32c_shift(PYSIMD_CRC32C_STRIDE);
+		for (; n >= 3 * PYSIMD_CRC32C_STRIDE; n -= 3 * PYSIMD_CRC32C_STRIDE, data += 3 * PYSIMD_CRC32C_STRIDE) {
+			uint64_t crc1 = 0;
+			uint64_t crc2 = 0;
+			for (i = 0; i < PYSIMD_CRC32C_STRIDE; i += 8) {
+				uint64_t word0 = 0, word1 = 0, word2 = 0;
+				memcpy(&word0, data + i, 8);
+				memcpy(&word1, data + PYSIMD_CRC32C_STRIDE + i, 8);
+				memcpy(&word2, data + 2 * PYSIMD_CRC32C_STRIDE + i, 8);
+				crc = _mm_crc32_u64(crc, word0);
+				crc1 = _mm_crc32_u64(crc1, word1);
+				crc2 = _mm_crc32_u64(crc2, word2);
+			}
+			crc = simd_crc32c_multiply(skip, simd_crc32c_multiply(skip, (uint32_t)crc) ^ (uint32_t)crc1) ^ (uint32_t)crc2;
+		}
+	}
+	for (i = 0; i + 8 <= n; i += 8) {
+		uint64_t word = 0;
+		memcpy(&word, data + i, 8);
+		crc = _mm_crc32_u64(crc, word);
+	}
+	for (; i < n; ++i)
+		crc = _mm_crc32_u8((uint32_t)crc, data[i]);
+	return (uint32_t)crc;
+}
+
+#endif // PYSIMD_X86_SSE42
+
+#endif // SIMD_VEC_HASH_H
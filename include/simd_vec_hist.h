@@ -0,0 +1,221 @@
+#ifndef SIMD_VEC_HIST_H
+#define SIMD_VEC_HIST_H
+
+#include "simd_vec_type.h"
+#include "vec_macros.h"
+
+/* Histograms count lanes into nbins equal bins over [lo, hi], the bin of a lane being
+ * (x - lo) * scale truncated, where scale is nbins / (hi - lo), and hi falling in the
+ * last bin. Lanes are read as doubles, lanes outside of the range and NaNs are dropped.
+ *
+ * Lanes are first turned into bin numbers a block at a time, dropped lanes into the
+ * number nbins, and the numbers then counted into PYSIMD_HIST_WAYS histograms in turn,
+ * so that runs of lanes in one bin do not wait on the store of the previous count.
+ */
+#define PYSIMD_HIST_BLOCK 1024
+#define PYSIMD_HIST_WAYS 4
+// Bin numbers go through signed 32 bit conversions
+#define PYSIMD_HIST_MAX_BINS ((size_t)1 << 24)
+
+struct pysimd_hist_range {
+	double lo;
+	double hi;
+	double scale;
+	uint32_t nbins;
+};
+
+typedef void (*pysimd_vec_hist_index_t)(uint32_t*, const unsigned char*, size_t, const struct pysimd_hist_range*);
+
+#define SIMD_VEC_HIST_INDEX_SCALAR(name, ctype) \
+static void name(uint32_t* bins, const unsigned char* lanes, size_t n, const struct pysimd_hist_range* range) { \
+	const ctype* xs = (const ctype*)lanes; \
+	const double last = (double)(range->nbins - 1); \
+	size_t i = 0; \
+	for (; i < n; ++i) { \
+		const double x = (double)xs[i]; \
+		double t = 0.0; \
+		if (!(x >= range->lo && x <= range->hi)) { \
+			bins[i] = range->nbins; \
+			continue; \
+		} \
+		t = (x - range->lo) * range->scale; \
+		bins[i] = t < last ? (uint32_t)t : range->nbins - 1; \
+	} \
+}
+
+SIMD_VEC_HIST_INDEX_SCALAR(simd_vec_hist_index_i8_scalar, int8_t)
+SIMD_VEC_HIST_INDEX_SCALAR(simd_vec_hist_index_i16_scalar, int16_t)
+SIMD_VEC_HIST_INDEX_SCALAR(simd_vec_hist_index_i32_scalar, int32_t)
+SIMD_VEC_HIST_INDEX_SCALAR(simd_vec_hist_index_i64_scalar, int64_t)
+SIMD_VEC_HIST_INDEX_SCALAR(simd_vec_hist_index_u8_scalar, uint8_t)
+SIMD_VEC_HIST_INDEX_SCALAR(simd_vec_hist_index_u16_scalar, uint16_t)
+SIMD_VEC_HIST_INDEX_SCALAR(simd_vec_hist_index_u32_scalar, uint32_t)
+SIMD_VEC_HIST_INDEX_SCALAR(simd_vec_hist_index_u64_scalar, uint64_t)
+SIMD_VEC_HIST_INDEX_SCALAR(simd_vec_hist_index_f32_scalar, float)
+SIMD_VEC_HIST_INDEX_SCALAR(simd_vec_hist_index_f64_scalar, double)
+
+#undef SIMD_VEC_HIST_INDEX_SCALAR
+
+/* Counts the bin numbers of n lanes into counts, of nbins + 1 entries, the last for the
+ * dropped lanes. ways is room for PYSIMD_HIST_WAYS histograms of as many entries, or
+ * NULL to count into counts alone.
+ */
+static void simd_hist_lanes(pysimd_vec_hist_index_t index, size_t width, const unsigned char* lanes, size_t n,
+	                        const struct pysimd_hist_range* range, uint64_t* counts, uint64_t* ways)
+{
+	const size_t stride = ways != NULL ? (size_t)range->nbins + 1 : 0;
+	uint64_t* way = ways != NULL ? ways : counts;
+	uint32_t bins[PYSIMD_HIST_BLOCK];
+	size_t start = 0;
+	size_t i = 0;
+	if (ways != NULL)
+		memset(ways, 0, PYSIMD_HIST_WAYS * stride * sizeof(uint64_t));
+	for (; start < n; start += PYSIMD_HIST_BLOCK) {
+		const size_t block = n - start < PYSIMD_HIST_BLOCK ? n - start : PYSIMD_HIST_BLOCK;
+		index(bins, lanes + start * width, block, range);
+		for (i = 0; i + 4 <= block; i += 4) {
+			way[bins[i]] += 1;
+			way[stride + bins[i + 1]] += 1;
+			way[2 * stride + bins[i + 2]] += 1;
+			way[3 * stride + bins[i + 3]] += 1;
+		}
+		for (; i < block; ++i)
+			way[bins[i]] += 1;
+	}
+	if (ways == NULL)
+		return;
+	for (i = 0; i < stride; ++i)
+		counts[i] += ways[i] + ways[stride + i] + ways[2 * stride + i] + ways[3 * stride + i];
+}
+
+/* Counts every value of n bytes into counts, exactly, reading eight bytes at a time
+ * and spreading them over PYSIMD_HIST_WAYS tables.
+ */
+static void simd_vec_bincount_u8(uint64_t* counts, const unsigned char* data, size_t n)
+{
+	uint64_t ways[PYSIMD_HIST_WAYS][256];
+	size_t i = 0;
+	size_t k = 0;
+	memset(ways, 0, sizeof(ways));
+	for (; i + 8 <= n; i += 8) {
+		uint64_t word = 0;
+		memcpy(&word, data + i, 8);
+		ways[0][word & 0xff] += 1;
+		ways[1][(word >> 8) & 0xff] += 1;
+		ways[2][(word >> 16) & 0xff] += 1;
+		ways[3][(word >> 24) & 0xff] += 1;
+		ways[0][(word >> 32) & 0xff] += 1;
+		ways[1][(word >> 40) & 0xff] += 1;
+		ways[2][(word >> 48) & 0xff] += 1;
+		ways[3][word >> 56] += 1;
+	}
+	for (; i < n; ++i)
+		ways[0][data[i]] += 1;
+	for (; k < 256; ++k)
+		counts[k] += ways[0][k] + ways[1][k] + ways[2][k] + ways[3][k];
+}
+
+/* The vector kernels widen f32 lanes to f64, as the scalar ones do, so every tier puts
+ * a lane in the same bin. The bin numbers are clamped to the last bin before they are
+ * truncated, and replaced by nbins where the lane is outside of the range or NaN.
+ */
+#define simd_vec_hist_index_float_tail simd_vec_hist_index_f32_scalar
+#define simd_vec_hist_index_double_tail simd_vec_hist_index_f64_scalar
+
+#if defined(PYSIMD_X86_SSE2)
+
+#define SIMD_VEC_HIST_INDEX_SSE2(name, ctype, load) \
+static PYSIMD_TARGET_SSE2 void name(uint32_t* bins, const unsigned char* lanes, size_t n, const struct pysimd_hist_range* range) { \
+	const ctype* xs = (const ctype*)lanes; \
+	const __m128d lo = _mm_set1_pd(range->lo); \
+	const __m128d hi = _mm_set1_pd(range->hi); \
+	const __m128d scale = _mm_set1_pd(range->scale); \
+	const __m128d last = _mm_set1_pd((double)(range->nbins - 1)); \
+	const __m128i dropped = _mm_set1_epi32((int)range->nbins); \
+	size_t i = 0; \
+	for (; i + 2 <= n; i += 2) { \
+		const __m128d x = load(xs + i); \
+		const __m128d inside = _mm_and_pd(_mm_cmpge_pd(x, lo), _mm_cmple_pd(x, hi)); \
+		const __m128i keep = _mm_shuffle_epi32(_mm_castpd_si128(inside), 0x08); \
+		const __m128i at = _mm_cvttpd_epi32(_mm_min_pd(_mm_mul_pd(_mm_sub_pd(x, lo), scale), last)); \
+		_mm_storel_epi64((__m128i*)(bins + i), _mm_or_si128(_mm_and_si128(keep, at), _mm_andnot_si128(keep, dropped))); \
+	} \
+	simd_vec_hist_index_##ctype##_tail(bins + i, lanes + i * sizeof(ctype), n - i, range); \
+}
+
+#define SIMD_HIST_LOAD_F32_SSE2(at) _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)(at))))
+
+SIMD_VEC_HIST_INDEX_SSE2(simd_vec_hist_index_f32_sse2, float, SIMD_HIST_LOAD_F32_SSE2)
+SIMD_VEC_HIST_INDEX_SSE2(simd_vec_hist_index_f64_sse2, double, _mm_loadu_pd)
+
+#undef SIMD_VEC_HIST_INDEX_SSE2
+#undef SIMD_HIST_LOAD_F32_SSE2
+
+#endif // PYSIMD_X86_SSE2
+
+#if defined(PYSIMD_X86_AVX2)
+
+#define SIMD_VEC_HIST_INDEX_AVX2(name, ctype, load) \
+static PYSIMD_TARGET_AVX2 void name(uint32_t* bins, const unsigned char* lanes, size_t n, const struct pysimd_hist_range* range) { \
+	const ctype* xs = (const ctype*)lanes; \
+	const __m256d lo = _mm256_set1_pd(range->lo); \
+	const __m256d hi = _mm256_set1_pd(range->hi); \
+	const __m256d scale = _mm256_set1_pd(range->scale); \
+	const __m256d last = _mm256_set1_pd((double)(range->nbins - 1)); \
+	const __m128 dropped = _mm_castsi128_ps(_mm_set1_epi32((int)range->nbins)); \
+	const __m256i pick = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6); \
+	size_t i = 0; \
+	for (; i + 4 <= n; i += 4) { \
+		const __m256d x = load(xs + i); \
+		const __m256d inside = _mm256_and_pd(_mm256_cmp_pd(x, lo, _CMP_GE_OQ), _mm256_cmp_pd(x, hi, _CMP_LE_OQ)); \
+		const __m128 keep = _mm256_castps256_ps128(_mm256_permutevar8x32_ps(_mm256_castpd_ps(inside), pick)); \
+		const __m128i at = _mm256_cvttpd_epi32(_mm256_min_pd(_mm256_mul_pd(_mm256_sub_pd(x, lo), scale), last)); \
+		_mm_storeu_si128((__m128i*)(bins + i), _mm_castps_si128(_mm_blendv_ps(dropped, _mm_castsi128_ps(at), keep))); \
+	} \
+	simd_vec_hist_index_##ctype##_tail(bins + i, lanes + i * sizeof(ctype), n - i, range); \
+}
+
+#define SIMD_HIST_LOAD_F32_AVX2(at) _mm256_cvtps_pd(_mm_loadu_ps(at))
+
+SIMD_VEC_HIST_INDEX_AVX2(simd_vec_hist_index_f32_avx2, float, SIMD_HIST_LOAD_F32_AVX2)
+SIMD_VEC_HIST_INDEX_AVX2(simd_vec_hist_index_f64_avx2, double, _mm256_loadu_pd)
+
+#undef SIMD_VEC_HIST_INDEX_AVX2
+#undef SIMD_HIST_LOAD_F32_AVX2
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+#define SIMD_VEC_HIST_INDEX_AVX512(name, ctype, load) \
+static PYSIMD_TARGET_AVX512 void name(uint32_t* bins, const unsigned char* lanes, size_t n, const struct pysimd_hist_range* range) { \
+	const ctype* xs = (const ctype*)lanes; \
+	const __m512d lo = _mm512_set1_pd(range->lo); \
+	const __m512d hi = _mm512_set1_pd(range->hi); \
+	const __m512d scale = _mm512_set1_pd(range->scale); \
+	const __m512d last = _mm512_set1_pd((double)(range->nbins - 1)); \
+	const __m256i dropped = _mm256_set1_epi32((int)range->nbins); \
+	size_t i = 0; \
+	for (; i + 8 <= n; i += 8) { \
+		const __m512d x = load(xs + i); \
+		const __mmask8 inside = _mm512_cmp_pd_mask(x, lo, _CMP_GE_OQ) & _mm512_cmp_pd_mask(x, hi, _CMP_LE_OQ); \
+		const __m512d t = _mm512_min_pd(_mm512_mul_pd(_mm512_sub_pd(x, lo), scale), last); \
+		_mm256_storeu_si256((__m256i*)(bins + i), _mm512_mask_cvttpd_epi32(dropped, inside, t)); \
+	} \
+	simd_vec_hist_index_##ctype##_tail(bins + i, lanes + i * sizeof(ctype), n - i, range); \
+}
+
+#define SIMD_HIST_LOAD_F32_AVX512(at) _mm512_cvtps_pd(_mm256_loadu_ps(at))
+
+SIMD_VEC_HIST_INDEX_AVX512(simd_vec_hist_index_f32_avx512, float, SIMD_HIST_LOAD_F32_AVX512)
+SIMD_VEC_HIST_INDEX_AVX512(simd_vec_hist_index_f64_avx512, double, _mm512_loadu_pd)
+
+#undef SIMD_VEC_HIST_INDEX_AVX512
+#undef SIMD_HIST_LOAD_F32_AVX512
+
+#endif // PYSIMD_X86_AVX512
+
+#undef simd_vec_hist_index_float_tail
+#undef simd_vec_hist_index_double_tail
+
+#endif // SIMD_VEC_HIST_H
@@ -0,0 +1,321 @@
+#ifndef SIMD_VEC_SCAN_H
+#define SIMD_VEC_SCAN_H
+
+#include "simd_vec_type.h"
+#include "vec_macros.h"
+#include "simd_vec_cmp.h"
+
+/* Prefix sums. A scan kernel writes the running totals of the lanes of src into dst,
+ * which may be src itself. An inclusive scan counts each lane in its own total, an
+ * exclusive one only the lanes before it. The total carried in from earlier lanes is
+ * passed in carry, and the total after the last lane is left there, so a vector can be
+ * scanned a part at a time.
+ *
+ * When flags are given, a lane with a flag lane of the same width that is not zero
+ * starts a new segment, and the total goes back to 0 before it. Kernels return whether
+ * any flag was set, in which case the carry left is the total of the last segment.
+ *
+ * Integer lanes wrap around, so the same kernels serve signed and unsigned lanes. Float
+ * kernels add lanes a register at a time, in log steps, so their totals may round
+ * differently than adding lanes one by one.
+ */
+
+// Carries are kept as u for integer lanes and f for float lanes
+static uint32_t simd_scan_get_i32(const union pysimd_lane_value* carry) { return (uint32_t)carry->u; }
+static uint64_t simd_scan_get_i64(const union pysimd_lane_value* carry) { return carry->u; }
+static float simd_scan_get_f32(const union pysimd_lane_value* carry) { return (float)carry->f; }
+static double simd_scan_get_f64(const union pysimd_lane_value* carry) { return carry->f; }
+static void simd_scan_put_i32(union pysimd_lane_value* carry, uint32_t total) { carry->u = total; }
+static void simd_scan_put_i64(union pysimd_lane_value* carry, uint64_t total) { carry->u = total; }
+static void simd_scan_put_f32(union pysimd_lane_value* carry, float total) { carry->f = total; }
+static void simd_scan_put_f64(union pysimd_lane_value* carry, double total) { carry->f = total; }
+
+#define SIMD_VEC_SCAN_SCALAR(name, ctype, ftype, get, put) \
+static int name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* src, const struct pysimd_vec_t* flags, \
+	            int exclusive, union pysimd_lane_value* carry) { \
+	const ctype* lanes = (const ctype*)src->data; \
+	const ftype* marks = flags != NULL ? (const ftype*)flags->data : NULL; \
+	ctype* totals = (ctype*)dst->data; \
+	const size_t n = src->size / sizeof(ctype); \
+	ctype total = get(carry); \
+	int flagged = 0; \
+	size_t i = 0; \
+	for (; i < n; ++i) { \
+		const ctype x = lanes[i]; \
+		if (marks != NULL && marks[i] != 0) { \
+			total = 0; \
+			flagged = 1; \
+		} \
+		if (exclusive) { \
+			totals[i] = total; \
+			total += x; \
+		} else { \
+			total += x; \
+			totals[i] = total; \
+		} \
+	} \
+	put(carry, total); \
+	return flagged; \
+}
+
+SIMD_VEC_SCAN_SCALAR(simd_vec_cumsum_i32_scalar, uint32_t, uint32_t, simd_scan_get_i32, simd_scan_put_i32)
+SIMD_VEC_SCAN_SCALAR(simd_vec_cumsum_i64_scalar, uint64_t, uint64_t, simd_scan_get_i64, simd_scan_put_i64)
+SIMD_VEC_SCAN_SCALAR(simd_vec_cumsum_f32_scalar, float, uint32_t, simd_scan_get_f32, simd_scan_put_f32)
+SIMD_VEC_SCAN_SCALAR(simd_vec_cumsum_f64_scalar, double, uint64_t, simd_scan_get_f64, simd_scan_put_f64)
+
+#undef SIMD_VEC_SCAN_SCALAR
+
+/* A register is scanned in log steps, adding to each lane the lane 1, 2, 4 ... lanes
+ * below it. In a segmented scan, a lane only adds lanes below it while no flag has been
+ * seen between them, and the flags are spread up along with the totals. The total
+ * carried in is then added to the lanes before the first flag, and the last lane is
+ * carried on. An exclusive scan shifts the totals up a lane, with the carry below them.
+ *
+ * The vector kernels share this loop, given a register of reg_bytes bytes, shifts by a
+ * number of bytes, the scan of a register with and without flags, and a kernel to
+ * finish the lanes after the last whole register.
+ */
+#define SIMD_VEC_SCAN_VECTOR(name, target, reg_bytes, vtype, ctype, lane_bytes, load, store, setzero, set1_ones, \
+	                         add, and_, andnot, or_, xor_, shift, broadcast_last, eq, any, prefix, seg_prefix, get, put, \
+	                         tail) \
+static target int name(struct pysimd_vec_t* dst, const struct pysimd_vec_t* src, const struct pysimd_vec_t* flags, \
+	                   int exclusive, union pysimd_lane_value* carry) { \
+	const size_t whole = src->size - src->size % (reg_bytes); \
+	const vtype ones = set1_ones; \
+	const vtype first = xor_(shift(ones, lane_bytes), ones); \
+	ctype carried[(reg_bytes) / sizeof(ctype)]; \
+	vtype total; \
+	int flagged = 0; \
+	size_t i = 0; \
+	for (; i < (reg_bytes) / sizeof(ctype); ++i) \
+		carried[i] = get(carry); \
+	total = load((vtype const*)carried); \
+	for (i = 0; i < whole; i += (reg_bytes)) { \
+		const vtype x = load((vtype const*)(src->data + i)); \
+		vtype marks = setzero; \
+		vtype seen = setzero; \
+		vtype sums; \
+		if (flags != NULL) { \
+			marks = xor_(eq(load((vtype const*)(flags->data + i)), setzero), ones); \
+			seen = marks; \
+			sums = seg_prefix(x, &seen); \
+			flagged |= any(marks); \
+		} else { \
+			sums = prefix(x); \
+		} \
+		sums = add(sums, andnot(seen, total)); \
+		if (exclusive) \
+			store((vtype*)(dst->data + i), andnot(marks, or_(shift(sums, lane_bytes), and_(total, first)))); \
+		else \
+			store((vtype*)(dst->data + i), sums); \
+		total = broadcast_last(sums); \
+	} \
+	store((vtype*)carried, total); \
+	put(carry, carried[0]); \
+	if (whole < src->size) { \
+		struct pysimd_vec_t dst_rest = {src->size - whole, dst->data + whole, 0}; \
+		struct pysimd_vec_t src_rest = {src->size - whole, src->data + whole, 0}; \
+		struct pysimd_vec_t flags_rest = {src->size - whole, flags != NULL ? flags->data + whole : NULL, 0}; \
+		flagged |= tail(&dst_rest, &src_rest, flags != NULL ? &flags_rest : NULL, exclusive, carry); \
+	} \
+	return flagged; \
+}
+
+/* Scans of a register for each tier and lane width, adding lanes with add. The steps
+ * past 8 bytes are the same for every lane width.
+ */
+#define SIMD_SCAN_PREFIX(prefix, seg_prefix, target, vtype, lane_bytes, add, andnot, or_, shift, wide_steps, seg_wide_steps) \
+static target vtype prefix(vtype x) { \
+	x = add(x, shift(x, lane_bytes)); \
+	if ((lane_bytes) == 4) \
+		x = add(x, shift(x, 8)); \
+	wide_steps \
+	return x; \
+} \
+static target vtype seg_prefix(vtype x, vtype* seen) { \
+	x = add(x, andnot(*seen, shift(x, lane_bytes))); \
+	*seen = or_(*seen, shift(*seen, lane_bytes)); \
+	if ((lane_bytes) == 4) { \
+		x = add(x, andnot(*seen, shift(x, 8))); \
+		*seen = or_(*seen, shift(*seen, 8)); \
+	} \
+	seg_wide_steps \
+	return x; \
+}
+
+#if defined(PYSIMD_X86_SSE2)
+
+#define SIMD_SCAN_SHIFT_SSE2(x, bytes) _mm_slli_si128((x), (bytes))
+
+static PYSIMD_TARGET_SSE2 __m128i simd_scan_add_i32_sse2(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+static PYSIMD_TARGET_SSE2 __m128i simd_scan_add_i64_sse2(__m128i a, __m128i b) { return _mm_add_epi64(a, b); }
+static PYSIMD_TARGET_SSE2 __m128i simd_scan_add_f32_sse2(__m128i a, __m128i b)
+{
+	return _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+}
+static PYSIMD_TARGET_SSE2 __m128i simd_scan_add_f64_sse2(__m128i a, __m128i b)
+{
+	return _mm_castpd_si128(_mm_add_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+}
+static PYSIMD_TARGET_SSE2 __m128i simd_scan_last_32_sse2(__m128i x) { return _mm_shuffle_epi32(x, 0xff); }
+static PYSIMD_TARGET_SSE2 __m128i simd_scan_last_64_sse2(__m128i x) { return _mm_shuffle_epi32(x, 0xee); }
+static PYSIMD_TARGET_SSE2 int simd_scan_any_sse2(__m128i marks) { return _mm_movemask_epi8(marks) != 0; }
+
+#define SIMD_SCAN_PREFIX_SSE2(prefix, seg_prefix, lane_bytes, add) \
+	SIMD_SCAN_PREFIX(prefix, seg_prefix, PYSIMD_TARGET_SSE2, __m128i, lane_bytes, add, _mm_andnot_si128, _mm_or_si128, \
+	                 SIMD_SCAN_SHIFT_SSE2, , )
+
+SIMD_SCAN_PREFIX_SSE2(simd_scan_prefix_i32_sse2, simd_scan_seg_prefix_i32_sse2, 4, simd_scan_add_i32_sse2)
+SIMD_SCAN_PREFIX_SSE2(simd_scan_prefix_i64_sse2, simd_scan_seg_prefix_i64_sse2, 8, simd_scan_add_i64_sse2)
+SIMD_SCAN_PREFIX_SSE2(simd_scan_prefix_f32_sse2, simd_scan_seg_prefix_f32_sse2, 4, simd_scan_add_f32_sse2)
+SIMD_SCAN_PREFIX_SSE2(simd_scan_prefix_f64_sse2, simd_scan_seg_prefix_f64_sse2, 8, simd_scan_add_f64_sse2)
+
+#undef SIMD_SCAN_PREFIX_SSE2
+
+#define SIMD_VEC_SCAN_SSE2(name, ctype, lane_bytes, eq, last, add, prefix, seg_prefix, get, put, tail) \
+	SIMD_VEC_SCAN_VECTOR(name, PYSIMD_TARGET_SSE2, 16, __m128i, ctype, lane_bytes, _mm_loadu_si128, _mm_storeu_si128, \
+	                     _mm_setzero_si128(), _mm_set1_epi32(-1), add, _mm_and_si128, _mm_andnot_si128, _mm_or_si128, \
+	                     _mm_xor_si128, SIMD_SCAN_SHIFT_SSE2, last, eq, simd_scan_any_sse2, prefix, seg_prefix, \
+	                     get, put, tail)
+
+SIMD_VEC_SCAN_SSE2(simd_vec_cumsum_i32_sse2, uint32_t, 4, _mm_cmpeq_epi32, simd_scan_last_32_sse2, simd_scan_add_i32_sse2,
+	               simd_scan_prefix_i32_sse2, simd_scan_seg_prefix_i32_sse2, simd_scan_get_i32, simd_scan_put_i32,
+	               simd_vec_cumsum_i32_scalar)
+SIMD_VEC_SCAN_SSE2(simd_vec_cumsum_i64_sse2, uint64_t, 8, simd_cmpeq_epi64_sse2, simd_scan_last_64_sse2, simd_scan_add_i64_sse2,
+	               simd_scan_prefix_i64_sse2, simd_scan_seg_prefix_i64_sse2, simd_scan_get_i64, simd_scan_put_i64,
+	               simd_vec_cumsum_i64_scalar)
+SIMD_VEC_SCAN_SSE2(simd_vec_cumsum_f32_sse2, float, 4, _mm_cmpeq_epi32, simd_scan_last_32_sse2, simd_scan_add_f32_sse2,
+	               simd_scan_prefix_f32_sse2, simd_scan_seg_prefix_f32_sse2, simd_scan_get_f32, simd_scan_put_f32,
+	               simd_vec_cumsum_f32_scalar)
+SIMD_VEC_SCAN_SSE2(simd_vec_cumsum_f64_sse2, double, 8, simd_cmpeq_epi64_sse2, simd_scan_last_64_sse2, simd_scan_add_f64_sse2,
+	               simd_scan_prefix_f64_sse2, simd_scan_seg_prefix_f64_sse2, simd_scan_get_f64, simd_scan_put_f64,
+	               simd_vec_cumsum_f64_scalar)
+
+#undef SIMD_VEC_SCAN_SSE2
+
+#endif // PYSIMD_X86_SSE2
+
+#if defined(PYSIMD_X86_AVX2)
+
+// Shifts lanes up across the two halves, bringing the top of the low half into the high half
+#define SIMD_SCAN_SHIFT_AVX2(x, bytes) _mm256_alignr_epi8((x), _mm256_permute2x128_si256((x), (x), 0x08), 16 - (bytes))
+
+static PYSIMD_TARGET_AVX2 __m256i simd_scan_add_i32_avx2(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+static PYSIMD_TARGET_AVX2 __m256i simd_scan_add_i64_avx2(__m256i a, __m256i b) { return _mm256_add_epi64(a, b); }
+static PYSIMD_TARGET_AVX2 __m256i simd_scan_add_f32_avx2(__m256i a, __m256i b)
+{
+	return _mm256_castps_si256(_mm256_add_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b)));
+}
+static PYSIMD_TARGET_AVX2 __m256i simd_scan_add_f64_avx2(__m256i a, __m256i b)
+{
+	return _mm256_castpd_si256(_mm256_add_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b)));
+}
+static PYSIMD_TARGET_AVX2 __m256i simd_scan_last_32_avx2(__m256i x) { return _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(7)); }
+static PYSIMD_TARGET_AVX2 __m256i simd_scan_last_64_avx2(__m256i x) { return _mm256_permute4x64_epi64(x, 0xff); }
+static PYSIMD_TARGET_AVX2 int simd_scan_any_avx2(__m256i marks) { return _mm256_movemask_epi8(marks) != 0; }
+static PYSIMD_TARGET_AVX2 __m256i simd_scan_load_avx2(__m256i const* ptr) { return _mm256_loadu_si256(ptr); }
+static PYSIMD_TARGET_AVX2 void simd_scan_store_avx2(__m256i* ptr, __m256i value) { _mm256_storeu_si256(ptr, value); }
+
+#define SIMD_SCAN_PREFIX_AVX2(prefix, seg_prefix, lane_bytes, add) \
+	SIMD_SCAN_PREFIX(prefix, seg_prefix, PYSIMD_TARGET_AVX2, __m256i, lane_bytes, add, _mm256_andnot_si256, _mm256_or_si256, \
+	                 SIMD_SCAN_SHIFT_AVX2, \
+	                 x = add(x, SIMD_SCAN_SHIFT_AVX2(x, 16));, \
+	                 x = add(x, _mm256_andnot_si256(*seen, SIMD_SCAN_SHIFT_AVX2(x, 16))); \
+	                 *seen = _mm256_or_si256(*seen, SIMD_SCAN_SHIFT_AVX2(*seen, 16));)
+
+SIMD_SCAN_PREFIX_AVX2(simd_scan_prefix_i32_avx2, simd_scan_seg_prefix_i32_avx2, 4, simd_scan_add_i32_avx2)
+SIMD_SCAN_PREFIX_AVX2(simd_scan_prefix_i64_avx2, simd_scan_seg_prefix_i64_avx2, 8, simd_scan_add_i64_avx2)
+SIMD_SCAN_PREFIX_AVX2(simd_scan_prefix_f32_avx2, simd_scan_seg_prefix_f32_avx2, 4, simd_scan_add_f32_avx2)
+SIMD_SCAN_PREFIX_AVX2(simd_scan_prefix_f64_avx2, simd_scan_seg_prefix_f64_avx2, 8, simd_scan_add_f64_avx2)
+
+#undef SIMD_SCAN_PREFIX_AVX2
+
+#define SIMD_VEC_SCAN_AVX2(name, ctype, lane_bytes, eq, last, add, prefix, seg_prefix, get, put, tail) \
+	SIMD_VEC_SCAN_VECTOR(name, PYSIMD_TARGET_AVX2, 32, __m256i, ctype, lane_bytes, simd_scan_load_avx2, simd_scan_store_avx2, \
+	                     _mm256_setzero_si256(), _mm256_set1_epi32(-1), add, _mm256_and_si256, _mm256_andnot_si256, \
+	                     _mm256_or_si256, _mm256_xor_si256, SIMD_SCAN_SHIFT_AVX2, last, eq, simd_scan_any_avx2, prefix, \
+	                     seg_prefix, get, put, tail)
+
+SIMD_VEC_SCAN_AVX2(simd_vec_cumsum_i32_avx2, uint32_t, 4, _mm256_cmpeq_epi32, simd_scan_last_32_avx2, simd_scan_add_i32_avx2,
+	               simd_scan_prefix_i32_avx2, simd_scan_seg_prefix_i32_avx2, simd_scan_get_i32, simd_scan_put_i32,
+	               simd_vec_cumsum_i32_sse2)
+SIMD_VEC_SCAN_AVX2(simd_vec_cumsum_i64_avx2, uint64_t, 8, _mm256_cmpeq_epi64, simd_scan_last_64_avx2, simd_scan_add_i64_avx2,
+	               simd_scan_prefix_i64_avx2, simd_scan_seg_prefix_i64_avx2, simd_scan_get_i64, simd_scan_put_i64,
+	               simd_vec_cumsum_i64_sse2)
+SIMD_VEC_SCAN_AVX2(simd_vec_cumsum_f32_avx2, float, 4, _mm256_cmpeq_epi32, simd_scan_last_32_avx2, simd_scan_add_f32_avx2,
+	               simd_scan_prefix_f32_avx2, simd_scan_seg_prefix_f32_avx2, simd_scan_get_f32, simd_scan_put_f32,
+	               simd_vec_cumsum_f32_sse2)
+SIMD_VEC_SCAN_AVX2(simd_vec_cumsum_f64_avx2, double, 8, _mm256_cmpeq_epi64, simd_scan_last_64_avx2, simd_scan_add_f64_avx2,
+	               simd_scan_prefix_f64_avx2, simd_scan_seg_prefix_f64_avx2, simd_scan_get_f64, simd_scan_put_f64,
+	               simd_vec_cumsum_f64_sse2)
+
+#undef SIMD_VEC_SCAN_AVX2
+
+#endif // PYSIMD_X86_AVX2
+
+#if defined(PYSIMD_X86_AVX512)
+
+// Shifts lanes up by a number of bytes, a multiple of 4, across the whole register
+#define SIMD_SCAN_SHIFT_AVX512(x, bytes) _mm512_alignr_epi32((x), _mm512_setzero_si512(), 16 - (bytes) / 4)
+
+static PYSIMD_TARGET_AVX512 __m512i simd_scan_add_i32_avx512(__m512i a, __m512i b) { return _mm512_add_epi32(a, b); }
+static PYSIMD_TARGET_AVX512 __m512i simd_scan_add_i64_avx512(__m512i a, __m512i b) { return _mm512_add_epi64(a, b); }
+static PYSIMD_TARGET_AVX512 __m512i simd_scan_add_f32_avx512(__m512i a, __m512i b)
+{
+	return _mm512_castps_si512(_mm512_add_ps(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b)));
+}
+static PYSIMD_TARGET_AVX512 __m512i simd_scan_add_f64_avx512(__m512i a, __m512i b)
+{
+	return _mm512_castpd_si512(_mm512_add_pd(_mm512_castsi512_pd(a), _mm512_castsi512_pd(b)));
+}
+static PYSIMD_TARGET_AVX512 __m512i simd_scan_last_32_avx512(__m512i x) { return _mm512_permutexvar_epi32(_mm512_set1_epi32(15), x); }
+static PYSIMD_TARGET_AVX512 __m512i simd_scan_last_64_avx512(__m512i x) { return _mm512_permutexvar_epi64(_mm512_set1_epi64(7), x); }
+static PYSIMD_TARGET_AVX512 int simd_scan_any_avx512(__m512i marks) { return _mm512_test_epi32_mask(marks, marks) != 0; }
+
+#define SIMD_SCAN_PREFIX_AVX512(prefix, seg_prefix, lane_bytes, add) \
+	SIMD_SCAN_PREFIX(prefix, seg_prefix, PYSIMD_TARGET_AVX512, __m512i, lane_bytes, add, _mm512_andnot_si512, _mm512_or_si512, \
+	                 SIMD_SCAN_SHIFT_AVX512, \
+	                 x = add(x, SIMD_SCAN_SHIFT_AVX512(x, 16)); \
+	                 x = add(x, SIMD_SCAN_SHIFT_AVX512(x, 32));, \
+	                 x = add(x, _mm512_andnot_si512(*seen, SIMD_SCAN_SHIFT_AVX512(x, 16))); \
+	                 *seen = _mm512_or_si512(*seen, SIMD_SCAN_SHIFT_AVX512(*seen, 16)); \
+	                 x = add(x, _mm512_andnot_si512(*seen, SIMD_SCAN_SHIFT_AVX512(x, 32))); \
+	                 *seen = _mm512_or_si512(*seen, SIMD_SCAN_SHIFT_AVX512(*seen, 32));)
+
+SIMD_SCAN_PREFIX_AVX512(simd_scan_prefix_i32_avx512, simd_scan_seg_prefix_i32_avx512, 4, simd_scan_add_i32_avx512)
+SIMD_SCAN_PREFIX_AVX512(simd_scan_prefix_i64_avx512, simd_scan_seg_prefix_i64_avx512, 8, simd_scan_add_i64_avx512)
+SIMD_SCAN_PREFIX_AVX512(simd_scan_prefix_f32_avx512, simd_scan_seg_prefix_f32_avx512, 4, simd_scan_add_f32_avx512)
+SIMD_SCAN_PREFIX_AVX512(simd_scan_prefix_f64_avx512, simd_scan_seg_prefix_f64_avx512, 8, simd_scan_add_f64_avx512)
+
+#undef SIMD_SCAN_PREFIX_AVX512
+
+#define SIMD_VEC_SCAN_AVX512(name, ctype, lane_bytes, eq, last, add, prefix, seg_prefix, get, put, tail) \
+	SIMD_VEC_SCAN_VECTOR(name, PYSIMD_TARGET_AVX512, 64, __m512i, ctype, lane_bytes, simd_load_avx512, simd_store_avx512, \
+	                     _mm512_setzero_si512(), _mm512_set1_epi32(-1), add, _mm512_and_si512, _mm512_andnot_si512, \
+	                     _mm512_or_si512, _mm512_xor_si512, SIMD_SCAN_SHIFT_AVX512, last, eq, simd_scan_any_avx512, prefix, \
+	                     seg_prefix, get, put, tail)
+
+SIMD_VEC_SCAN_AVX512(simd_vec_cumsum_i32_avx512, uint32_t, 4, simd_cmpeq_epi32_avx512, simd_scan_last_32_avx512,
+	                 simd_scan_add_i32_avx512, simd_scan_prefix_i32_avx512, simd_scan_seg_prefix_i32_avx512,
+	                 simd_scan_get_i32, simd_scan_put_i32, simd_vec_cumsum_i32_avx2)
+SIMD_VEC_SCAN_AVX512(simd_vec_cumsum_i64_avx512, uint64_t, 8, simd_cmpeq_epi64_avx512, simd_scan_last_64_avx512,
+	                 simd_scan_add_i64_avx512, simd_scan_prefix_i64_avx512, simd_scan_seg_prefix_i64_avx512,
+	                 simd_scan_get_i64, simd_scan_put_i64, simd_vec_cumsum_i64_avx2)
+SIMD_VEC_SCAN_AVX512(simd_vec_cumsum_f32_avx512, float, 4, simd_cmpeq_epi32_avx512, simd_scan_last_32_avx512,
+	                 simd_scan_add_f32_avx512, simd_scan_prefix_f32_avx512, simd_scan_seg_prefix_f32_avx512,
+	                 simd_scan_get_f32, simd_scan_put_f32, simd_vec_cumsum_f32_avx2)
+SIMD_VEC_SCAN_AVX512(simd_vec_cumsum_f64_avx512, double, 8, simd_cmpeq_epi64_avx512, simd_scan_last_64_avx512,
+	                 simd_scan_add_f64_avx512, simd_scan_prefix_f64_avx512, simd_scan_seg_prefix_f64_avx512,
+	                 simd_scan_get_f64, simd_scan_put_f64, simd_vec_cumsum_f64_avx2)
+
+#undef SIMD_VEC_SCAN_AVX512
+
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_VEC_SCAN_VECTOR
+#undef SIMD_SCAN_PREFIX
+#undef SIMD_SCAN_SHIFT_SSE2
+#undef SIMD_SCAN_SHIFT_AVX2
+#undef SIMD_SCAN_SHIFT_AVX512
+
+#endif // SIMD_VEC_SCAN_H
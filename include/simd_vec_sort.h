@@ -0,0 +1,639 @@
+#ifndef SIMD_VEC_SORT_H
+#define SIMD_VEC_SORT_H
+
+#include "simd_vec_type.h"
+#include "simd_vec_filter.h"
+
+/* Sorting. A sort kernel sorts n signed integer keys of 32 or 64 bits in place, in
+ * ascending order, and returns 0, or -1 when it runs out of memory. The 64 bit kernels
+ * also take an array of 64 bit values, moved along with their keys, or NULL for none.
+ * Kernels do not keep equal keys in their original order. Other lane types are encoded
+ * into signed keys first, with simd_sort_encode_32 and simd_sort_encode_64.
+ *
+ * Ranges are split by quicksort around the median of three keys, until they are small
+ * enough to be sorted in registers by a bitonic network, or fall back to heapsort when
+ * they split badly too many times. A partition moves the keys that go left down over
+ * those already read, and the others into a scratch array, which is copied back after
+ * them.
+ */
+
+// Keys the vector tiers sort in registers at most, as a number of registers
+#define PYSIMD_SORT_NETWORK_REGS 8
+
+// Ranges the scalar kernels leave to insertion sort
+#define PYSIMD_SORT_SCALAR_SMALL 16
+
+// Room the scratch arrays need past n keys, as partitions store whole registers
+#define PYSIMD_SORT_SCRATCH_PAD 16
+
+/* Encodes 32 bit lanes of a kind into signed keys that compare in the same order, and
+ * decodes them back, as every encoding is its own inverse. Unsigned lanes have their
+ * top bit flipped. Negative floats have every bit but the sign flipped, which reverses
+ * their order. NaNs lose their sign when encoded, so they all sort after infinity.
+ */
+static void simd_sort_encode_32(uint32_t* keys, size_t n, enum pysimd_lane_kind kind, int decode)
+{
+	size_t i = 0;
+	if (kind == PYSIMD_LANE_UINT) {
+		for (; i < n; ++i)
+			keys[i] ^= 0x80000000u;
+	} else if (kind == PYSIMD_LANE_FLOAT) {
+		for (; i < n; ++i) {
+			uint32_t x = keys[i];
+			if (!decode && (x & 0x7fffffffu) > 0x7f800000u)
+				x &= 0x7fffffffu;
+			keys[i] = x ^ ((uint32_t)((int32_t)x >> 31) & 0x7fffffffu);
+		}
+	}
+}
+
+static void simd_sort_encode_64(uint64_t* keys, size_t n, enum pysimd_lane_kind kind, int decode)
+{
+	size_t i = 0;
+	if (kind == PYSIMD_LANE_UINT) {
+		for (; i < n; ++i)
+			keys[i] ^= 0x8000000000000000ULL;
+	} else if (kind == PYSIMD_LANE_FLOAT) {
+		for (; i < n; ++i) {
+			uint64_t x = keys[i];
+			if (!decode && (x & 0x7fffffffffffffffULL) > 0x7ff0000000000000ULL)
+				x &= 0x7fffffffffffffffULL;
+			keys[i] = x ^ ((uint64_t)((int64_t)x >> 63) & 0x7fffffffffffffffULL);
+		}
+	}
+}
+
+#define SIMD_SORT_INSERTION(name, ktype) \
+static void name(ktype* keys, int64_t* values, size_t n) { \
+	size_t i = 1; \
+	for (; i < n; ++i) { \
+		const ktype key = keys[i]; \
+		const int64_t value = values != NULL ? values[i] : 0; \
+		size_t j = i; \
+		for (; j > 0 && keys[j - 1] > key; --j) { \
+			keys[j] = keys[j - 1]; \
+			if (values != NULL) \
+				values[j] = values[j - 1]; \
+		} \
+		keys[j] = key; \
+		if (values != NULL) \
+			values[j] = value; \
+	} \
+}
+
+#define SIMD_SORT_HEAP(name, ktype) \
+static void name(ktype* keys, int64_t* values, size_t n) { \
+	size_t start = n / 2; \
+	size_t end = n; \
+	while (end > 1) { \
+		size_t root = 0; \
+		if (start > 0) { \
+			root = --start; \
+		} else { \
+			const ktype key = keys[--end]; \
+			keys[end] = keys[0]; \
+			keys[0] = key; \
+			if (values != NULL) { \
+				const int64_t value = values[end]; \
+				values[end] = values[0]; \
+				values[0] = value; \
+			} \
+		} \
+		for (;;) { \
+			size_t child = 2 * root + 1; \
+			if (child >= end) \
+				break; \
+			if (child + 1 < end && keys[child + 1] > keys[child]) \
+				++child; \
+			if (keys[root] >= keys[child]) \
+				break; \
+			{ \
+				const ktype key = keys[root]; \
+				keys[root] = keys[child]; \
+				keys[child] = key; \
+				if (values != NULL) { \
+					const int64_t value = values[root]; \
+					values[root] = values[child]; \
+					values[child] = value; \
+				} \
+			} \
+			root = child; \
+		} \
+	} \
+}
+
+SIMD_SORT_INSERTION(simd_sort_insertion_i32, int32_t)
+SIMD_SORT_INSERTION(simd_sort_insertion_i64, int64_t)
+SIMD_SORT_HEAP(simd_sort_heap_i32, int32_t)
+SIMD_SORT_HEAP(simd_sort_heap_i64, int64_t)
+
+#undef SIMD_SORT_INSERTION
+#undef SIMD_SORT_HEAP
+
+/* Partitions finish the keys past the last whole register one at a time, the same way
+ * the scalar partitions handle all of them, without a branch on where a key goes.
+ */
+#define SIMD_SORT_PARTITION_REST(ktype) \
+	for (; i < n; ++i) { \
+		const ktype key = keys[i]; \
+		const size_t goes_left = or_equal ? key <= pivot : key < pivot; \
+		const int64_t value = values != NULL ? values[i] : 0; \
+		keys[left] = key; \
+		scratch[right] = key; \
+		if (values != NULL) { \
+			values[left] = value; \
+			scratch_values[right] = value; \
+		} \
+		left += goes_left; \
+		right += 1 - goes_left; \
+	} \
+	memcpy(keys + left, scratch, right * sizeof(ktype)); \
+	if (values != NULL) \
+		memcpy(values + left, scratch_values, right * sizeof(int64_t));
+
+#define SIMD_SORT_PARTITION_SCALAR(name, ktype) \
+static size_t name(ktype* keys, int64_t* values, size_t n, ktype pivot, int or_equal, \
+	               ktype* scratch, int64_t* scratch_values) { \
+	size_t left = 0; \
+	size_t right = 0; \
+	size_t i = 0; \
+	SIMD_SORT_PARTITION_REST(ktype) \
+	return left; \
+}
+
+SIMD_SORT_PARTITION_SCALAR(simd_sort_partition_i32_scalar, int32_t)
+SIMD_SORT_PARTITION_SCALAR(simd_sort_partition_i64_scalar, int64_t)
+
+#undef SIMD_SORT_PARTITION_SCALAR
+
+static size_t simd_sort_median3(size_t a, size_t b, size_t c, const void* keys, int wide)
+{
+	const int64_t ka = wide ? ((const int64_t*)keys)[a] : ((const int32_t*)keys)[a];
+	const int64_t kb = wide ? ((const int64_t*)keys)[b] : ((const int32_t*)keys)[b];
+	const int64_t kc = wide ? ((const int64_t*)keys)[c] : ((const int32_t*)keys)[c];
+	if (ka < kb)
+		return kb < kc ? b : (ka < kc ? c : a);
+	return ka < kc ? a : (kb < kc ? c : b);
+}
+
+struct simd_sort_range {
+	size_t start;
+	size_t n;
+	size_t depth;
+};
+
+/* The quicksort driver shared by every tier. The smaller side of a split is sorted
+ * first and the larger one stacked, which bounds the stack by the log of n. When no key
+ * is below the pivot, it is the smallest key, and the keys equal to it are moved to the
+ * front and left there, so runs of equal keys cannot stall the split.
+ */
+#define SIMD_SORT_QUICKSORT(name, target, ktype, wide, small_max, partition, small_sort, heap_sort) \
+static target int name(void* keys_data, int64_t* values, size_t n) { \
+	ktype* keys = (ktype*)keys_data; \
+	struct simd_sort_range stack[64]; \
+	ktype* scratch = NULL; \
+	int64_t* scratch_values = NULL; \
+	size_t depth = 0; \
+	size_t top = 0; \
+	if (n <= (small_max)) { \
+		small_sort(keys, values, n); \
+		return 0; \
+	} \
+	scratch = (ktype*)malloc((n + PYSIMD_SORT_SCRATCH_PAD) * sizeof(ktype)); \
+	if (values != NULL) \
+		scratch_values = (int64_t*)malloc((n + PYSIMD_SORT_SCRATCH_PAD) * sizeof(int64_t)); \
+	if (scratch == NULL || (values != NULL && scratch_values == NULL)) { \
+		free(scratch); \
+		free(scratch_values); \
+		return -1; \
+	} \
+	for (; ((size_t)1 << depth) < n; ++depth) {} \
+	stack[top].start = 0; \
+	stack[top].n = n; \
+	stack[top++].depth = 2 * depth; \
+	while (top > 0) { \
+		struct simd_sort_range range = stack[--top]; \
+		while (range.n > (small_max)) { \
+			ktype* part_keys = keys + range.start; \
+			int64_t* part_values = values != NULL ? values + range.start : NULL; \
+			ktype pivot; \
+			size_t left = 0; \
+			if (range.depth == 0) { \
+				heap_sort(part_keys, part_values, range.n); \
+				range.n = 0; \
+				break; \
+			} \
+			--range.depth; \
+			pivot = part_keys[simd_sort_median3(range.n / 4, range.n / 2, range.n / 4 * 3, part_keys, (wide))]; \
+			left = partition(part_keys, part_values, range.n, pivot, 0, scratch, scratch_values); \
+			if (left == 0) { \
+				left = partition(part_keys, part_values, range.n, pivot, 1, scratch, scratch_values); \
+				range.start += left; \
+				range.n -= left; \
+				continue; \
+			} \
+			if (left < range.n - left) { \
+				stack[top].start = range.start + left; \
+				stack[top].n = range.n - left; \
+				stack[top++].depth = range.depth; \
+				range.n = left; \
+			} else { \
+				stack[top].start = range.start; \
+				stack[top].n = left; \
+				stack[top++].depth = range.depth; \
+				range.start += left; \
+				range.n -= left; \
+			} \
+		} \
+		if (range.n > 1) \
+			small_sort(keys + range.start, values != NULL ? values + range.start : NULL, range.n); \
+	} \
+	free(scratch); \
+	free(scratch_values); \
+	return 0; \
+}
+
+SIMD_SORT_QUICKSORT(simd_sort_i32_scalar, , int32_t, 0, PYSIMD_SORT_SCALAR_SMALL,
+	                simd_sort_partition_i32_scalar, simd_sort_insertion_i32, simd_sort_heap_i32)
+SIMD_SORT_QUICKSORT(simd_sort_i64_scalar, , int64_t, 1, PYSIMD_SORT_SCALAR_SMALL,
+	                simd_sort_partition_i64_scalar, simd_sort_insertion_i64, simd_sort_heap_i64)
+
+#if defined(PYSIMD_X86_AVX2)
+
+/* Sorting networks. Up to PYSIMD_SORT_NETWORK_REGS registers are loaded, padded with
+ * the largest key, and each register is sorted on its own by a bitonic network. Pairs
+ * of sorted runs are then merged, the second run reversed so the pair is bitonic, and
+ * cleaned across registers and then within each register, until one run is left.
+ *
+ * A step within registers compares each lane to the lane its index xor j away, and
+ * keeps the larger key where take_max is set, the smaller one elsewhere. Padding keys
+ * are indistinguishable from real largest keys, so with values, real largest keys are
+ * moved to the end first, and kept out of the network.
+ */
+#define SIMD_SORT_NETWORK(name, target, ktype, lanes, vtype, mtype, kmax, loadu, storeu, network, step, exchange, reverse) \
+static target void name(ktype* keys, int64_t* values, size_t n) { \
+	vtype regs[PYSIMD_SORT_NETWORK_REGS]; \
+	vtype value_regs[PYSIMD_SORT_NETWORK_REGS]; \
+	ktype key_buf[PYSIMD_SORT_NETWORK_REGS * (lanes)]; \
+	int64_t value_buf[PYSIMD_SORT_NETWORK_REGS * (lanes)]; \
+	const int with_values = values != NULL; \
+	vtype partner; \
+	mtype take_max; \
+	size_t n_regs = 1; \
+	size_t run = 0; \
+	size_t base = 0; \
+	size_t span = 0; \
+	size_t i = 0; \
+	size_t j = 0; \
+	if (with_values) { \
+		size_t kept = 0; \
+		for (i = 0; i < n; ++i) { \
+			if (keys[i] != (kmax)) { \
+				key_buf[kept] = keys[i]; \
+				value_buf[kept++] = values[i]; \
+			} \
+		} \
+		for (i = 0, j = kept; i < n; ++i) { \
+			if (keys[i] == (kmax)) \
+				value_buf[j++] = values[i]; \
+		} \
+		memcpy(values, value_buf, n * sizeof(int64_t)); \
+		for (i = kept; i < n; ++i) \
+			keys[i] = (kmax); \
+		memcpy(keys, key_buf, kept * sizeof(ktype)); \
+		n = kept; \
+	} \
+	if (n < 2) \
+		return; \
+	while (n_regs * (lanes) < n) \
+		n_regs *= 2; \
+	memcpy(key_buf, keys, n * sizeof(ktype)); \
+	for (i = n; i < n_regs * (lanes); ++i) \
+		key_buf[i] = (kmax); \
+	for (i = 0; i < n_regs; ++i) \
+		regs[i] = loadu(key_buf + i * (lanes)); \
+	if (with_values) { \
+		memcpy(value_buf, values, n * sizeof(int64_t)); \
+		for (i = 0; i < n_regs; ++i) \
+			value_regs[i] = loadu((ktype*)(value_buf + i * (lanes))); \
+	} \
+	for (span = 2; span <= (lanes); span *= 2) { \
+		for (j = span / 2; j > 0; j /= 2) { \
+			network(j, span, &partner, &take_max); \
+			for (i = 0; i < n_regs; ++i) \
+				step(&regs[i], &value_regs[i], partner, take_max, with_values); \
+		} \
+	} \
+	for (run = 1; run < n_regs; run *= 2) { \
+		for (base = 0; base < n_regs; base += 2 * run) { \
+			for (i = 0; i < run / 2; ++i) { \
+				const vtype low = regs[base + run + i]; \
+				regs[base + run + i] = reverse(regs[base + 2 * run - 1 - i]); \
+				regs[base + 2 * run - 1 - i] = reverse(low); \
+				if (with_values) { \
+					const vtype low_values = value_regs[base + run + i]; \
+					value_regs[base + run + i] = reverse(value_regs[base + 2 * run - 1 - i]); \
+					value_regs[base + 2 * run - 1 - i] = reverse(low_values); \
+				} \
+			} \
+			if (run == 1) { \
+				regs[base + 1] = reverse(regs[base + 1]); \
+				if (with_values) \
+					value_regs[base + 1] = reverse(value_regs[base + 1]); \
+			} \
+			for (span = run; span > 0; span /= 2) { \
+				for (i = base; i < base + 2 * run; ++i) { \
+					if (((i - base) & span) == 0) \
+						exchange(&regs[i], &regs[i + span], &value_regs[i], &value_regs[i + span], with_values); \
+				} \
+			} \
+			for (j = (lanes) / 2; j > 0; j /= 2) { \
+				network(j, (lanes), &partner, &take_max); \
+				for (i = base; i < base + 2 * run; ++i) \
+					step(&regs[i], &value_regs[i], partner, take_max, with_values); \
+			} \
+		} \
+	} \
+	for (i = 0; i < n_regs; ++i) \
+		storeu(key_buf + i * (lanes), regs[i]); \
+	memcpy(keys, key_buf, n * sizeof(ktype)); \
+	if (with_values) { \
+		for (i = 0; i < n_regs; ++i) \
+			storeu((ktype*)(value_buf + i * (lanes)), value_regs[i]); \
+		memcpy(values, value_buf, n * sizeof(int64_t)); \
+	} \
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_sort_loadu_i32_avx2(const int32_t* src) { return _mm256_loadu_si256((__m256i const*)src); }
+static PYSIMD_TARGET_AVX2 void simd_sort_storeu_i32_avx2(int32_t* dst, __m256i keys) { _mm256_storeu_si256((__m256i*)dst, keys); }
+static PYSIMD_TARGET_AVX2 __m256i simd_sort_loadu_i64_avx2(const int64_t* src) { return _mm256_loadu_si256((__m256i const*)src); }
+static PYSIMD_TARGET_AVX2 void simd_sort_storeu_i64_avx2(int64_t* dst, __m256i keys) { _mm256_storeu_si256((__m256i*)dst, keys); }
+
+// Lane i takes the max in step (j, span) when bit j and bit span of i differ
+static PYSIMD_TARGET_AVX2 void simd_sort_network_i32_avx2(size_t j, size_t span, __m256i* partner, __m256i* take_max)
+{
+	const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i j_bit = _mm256_set1_epi32((int)j);
+	const __m256i span_bit = _mm256_set1_epi32((int)span);
+	*partner = _mm256_xor_si256(lane, j_bit);
+	*take_max = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_and_si256(lane, j_bit), j_bit),
+	                             _mm256_cmpeq_epi32(_mm256_and_si256(lane, span_bit), span_bit));
+}
+
+static PYSIMD_TARGET_AVX2 void simd_sort_step_i32_avx2(__m256i* keys, __m256i* values, __m256i partner, __m256i take_max, int with_values)
+{
+	const __m256i other = _mm256_permutevar8x32_epi32(*keys, partner);
+	*keys = _mm256_blendv_epi8(_mm256_min_epi32(*keys, other), _mm256_max_epi32(*keys, other), take_max);
+	(void)values;
+	(void)with_values;
+}
+
+static PYSIMD_TARGET_AVX2 void simd_sort_exchange_i32_avx2(__m256i* low, __m256i* high, __m256i* low_values,
+	                                                        __m256i* high_values, int with_values)
+{
+	const __m256i smaller = _mm256_min_epi32(*low, *high);
+	*high = _mm256_max_epi32(*low, *high);
+	*low = smaller;
+	(void)low_values;
+	(void)high_values;
+	(void)with_values;
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_sort_reverse_i32_avx2(__m256i keys)
+{
+	return _mm256_permutevar8x32_epi32(keys, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+// 64 bit lanes move as pairs of 32 bit halves, so their partner halves are xor 2 * j away
+static PYSIMD_TARGET_AVX2 void simd_sort_network_i64_avx2(size_t j, size_t span, __m256i* partner, __m256i* take_max)
+{
+	const __m256i half = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i lane = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+	const __m256i j_bit = _mm256_set1_epi32((int)j);
+	const __m256i span_bit = _mm256_set1_epi32((int)span);
+	*partner = _mm256_xor_si256(half, _mm256_set1_epi32((int)(2 * j)));
+	*take_max = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_and_si256(lane, j_bit), j_bit),
+	                             _mm256_cmpeq_epi32(_mm256_and_si256(lane, span_bit), span_bit));
+}
+
+// AVX2 has no 64 bit min or max, lanes take their partner where it is on the side they keep
+static PYSIMD_TARGET_AVX2 void simd_sort_step_i64_avx2(__m256i* keys, __m256i* values, __m256i partner, __m256i take_max, int with_values)
+{
+	const __m256i other = _mm256_permutevar8x32_epi32(*keys, partner);
+	const __m256i take = _mm256_blendv_epi8(_mm256_cmpgt_epi64(*keys, other), _mm256_cmpgt_epi64(other, *keys), take_max);
+	*keys = _mm256_blendv_epi8(*keys, other, take);
+	if (with_values)
+		*values = _mm256_blendv_epi8(*values, _mm256_permutevar8x32_epi32(*values, partner), take);
+}
+
+static PYSIMD_TARGET_AVX2 void simd_sort_exchange_i64_avx2(__m256i* low, __m256i* high, __m256i* low_values,
+	                                                        __m256i* high_values, int with_values)
+{
+	const __m256i swap = _mm256_cmpgt_epi64(*low, *high);
+	const __m256i first = *low;
+	*low = _mm256_blendv_epi8(*low, *high, swap);
+	*high = _mm256_blendv_epi8(*high, first, swap);
+	if (with_values) {
+		const __m256i first_values = *low_values;
+		*low_values = _mm256_blendv_epi8(*low_values, *high_values, swap);
+		*high_values = _mm256_blendv_epi8(*high_values, first_values, swap);
+	}
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_sort_reverse_i64_avx2(__m256i keys)
+{
+	return _mm256_permute4x64_epi64(keys, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+SIMD_SORT_NETWORK(simd_sort_network_i32_avx2_run, PYSIMD_TARGET_AVX2, int32_t, 8, __m256i, __m256i, INT32_MAX,
+	              simd_sort_loadu_i32_avx2, simd_sort_storeu_i32_avx2, simd_sort_network_i32_avx2,
+	              simd_sort_step_i32_avx2, simd_sort_exchange_i32_avx2, simd_sort_reverse_i32_avx2)
+SIMD_SORT_NETWORK(simd_sort_network_i64_avx2_run, PYSIMD_TARGET_AVX2, int64_t, 4, __m256i, __m256i, INT64_MAX,
+	              simd_sort_loadu_i64_avx2, simd_sort_storeu_i64_avx2, simd_sort_network_i64_avx2,
+	              simd_sort_step_i64_avx2, simd_sort_exchange_i64_avx2, simd_sort_reverse_i64_avx2)
+
+/* Partitions compact the keys going left to the front of a register, and those going
+ * right to the front of another, with one cross lane permute each, controlled by the
+ * filter position table, indexed by the mask of 32 bit halves going left.
+ */
+#define SIMD_SORT_PARTITION_AVX2(name, ktype, lanes, set1, cmpgt) \
+static PYSIMD_TARGET_AVX2 size_t name(ktype* keys, int64_t* values, size_t n, ktype pivot, int or_equal, \
+	                                  ktype* scratch, int64_t* scratch_values) { \
+	const __m256i bound = set1(pivot); \
+	const int flip = or_equal ? 0xff : 0; \
+	size_t left = 0; \
+	size_t right = 0; \
+	size_t i = 0; \
+	for (; i + (lanes) <= n; i += (lanes)) { \
+		const __m256i x = _mm256_loadu_si256((__m256i const*)(keys + i)); \
+		const __m256i goes = or_equal ? cmpgt(x, bound) : cmpgt(bound, x); \
+		const int left_bits = _mm256_movemask_ps(_mm256_castsi256_ps(goes)) ^ flip; \
+		const __m256i to_left = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const*)pysimd_filter_index[left_bits])); \
+		const __m256i to_right = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const*)pysimd_filter_index[left_bits ^ 0xff])); \
+		const size_t n_left = (size_t)pysimd_filter_count[left_bits] * (lanes) / 8; \
+		_mm256_storeu_si256((__m256i*)(keys + left), _mm256_permutevar8x32_epi32(x, to_left)); \
+		_mm256_storeu_si256((__m256i*)(scratch + right), _mm256_permutevar8x32_epi32(x, to_right)); \
+		if (values != NULL) { \
+			const __m256i v = _mm256_loadu_si256((__m256i const*)(values + i)); \
+			_mm256_storeu_si256((__m256i*)(values + left), _mm256_permutevar8x32_epi32(v, to_left)); \
+			_mm256_storeu_si256((__m256i*)(scratch_values + right), _mm256_permutevar8x32_epi32(v, to_right)); \
+		} \
+		left += n_left; \
+		right += (lanes) - n_left; \
+	} \
+	SIMD_SORT_PARTITION_REST(ktype) \
+	return left; \
+}
+
+static PYSIMD_TARGET_AVX2 __m256i simd_sort_set1_i32_avx2(int32_t key) { return _mm256_set1_epi32(key); }
+static PYSIMD_TARGET_AVX2 __m256i simd_sort_set1_i64_avx2(int64_t key) { return _mm256_set1_epi64x(key); }
+
+SIMD_SORT_PARTITION_AVX2(simd_sort_partition_i32_avx2, int32_t, 8, simd_sort_set1_i32_avx2, _mm256_cmpgt_epi32)
+SIMD_SORT_PARTITION_AVX2(simd_sort_partition_i64_avx2, int64_t, 4, simd_sort_set1_i64_avx2, _mm256_cmpgt_epi64)
+
+#undef SIMD_SORT_PARTITION_AVX2
+
+SIMD_SORT_QUICKSORT(simd_sort_i32_avx2, PYSIMD_TARGET_AVX2, int32_t, 0, PYSIMD_SORT_NETWORK_REGS * 8,
+	                simd_sort_partition_i32_avx2, simd_sort_network_i32_avx2_run, simd_sort_heap_i32)
+SIMD_SORT_QUICKSORT(simd_sort_i64_avx2, PYSIMD_TARGET_AVX2, int64_t, 1, PYSIMD_SORT_NETWORK_REGS * 4,
+	                simd_sort_partition_i64_avx2, simd_sort_network_i64_avx2_run, simd_sort_heap_i64)
+
+#if defined(PYSIMD_X86_AVX512)
+
+static PYSIMD_TARGET_AVX512 __m512i simd_sort_loadu_i32_avx512(const int32_t* src) { return _mm512_loadu_si512((void const*)src); }
+static PYSIMD_TARGET_AVX512 void simd_sort_storeu_i32_avx512(int32_t* dst, __m512i keys) { _mm512_storeu_si512((void*)dst, keys); }
+static PYSIMD_TARGET_AVX512 __m512i simd_sort_loadu_i64_avx512(const int64_t* src) { return _mm512_loadu_si512((void const*)src); }
+static PYSIMD_TARGET_AVX512 void simd_sort_storeu_i64_avx512(int64_t* dst, __m512i keys) { _mm512_storeu_si512((void*)dst, keys); }
+
+static PYSIMD_TARGET_AVX512 void simd_sort_network_i32_avx512(size_t j, size_t span, __m512i* partner, __mmask16* take_max)
+{
+	const __m512i lane = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	const __m512i j_bit = _mm512_set1_epi32((int)j);
+	*partner = _mm512_xor_si512(lane, j_bit);
+	*take_max = _mm512_test_epi32_mask(lane, j_bit) ^ _mm512_test_epi32_mask(lane, _mm512_set1_epi32((int)span));
+}
+
+static PYSIMD_TARGET_AVX512 void simd_sort_step_i32_avx512(__m512i* keys, __m512i* values, __m512i partner, __mmask16 take_max, int with_values)
+{
+	const __m512i other = _mm512_permutexvar_epi32(partner, *keys);
+	*keys = _mm512_mask_blend_epi32(take_max, _mm512_min_epi32(*keys, other), _mm512_max_epi32(*keys, other));
+	(void)values;
+	(void)with_values;
+}
+
+static PYSIMD_TARGET_AVX512 void simd_sort_exchange_i32_avx512(__m512i* low, __m512i* high, __m512i* low_values,
+	                                                            __m512i* high_values, int with_values)
+{
+	const __m512i smaller = _mm512_min_epi32(*low, *high);
+	*high = _mm512_max_epi32(*low, *high);
+	*low = smaller;
+	(void)low_values;
+	(void)high_values;
+	(void)with_values;
+}
+
+static PYSIMD_TARGET_AVX512 __m512i simd_sort_reverse_i32_avx512(__m512i keys)
+{
+	return _mm512_permutexvar_epi32(_mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), keys);
+}
+
+static PYSIMD_TARGET_AVX512 void simd_sort_network_i64_avx512(size_t j, size_t span, __m512i* partner, __mmask8* take_max)
+{
+	const __m512i lane = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m512i j_bit = _mm512_set1_epi64((long long)j);
+	*partner = _mm512_xor_si512(lane, j_bit);
+	*take_max = _mm512_test_epi64_mask(lane, j_bit) ^ _mm512_test_epi64_mask(lane, _mm512_set1_epi64((long long)span));
+}
+
+static PYSIMD_TARGET_AVX512 void simd_sort_step_i64_avx512(__m512i* keys, __m512i* values, __m512i partner, __mmask8 take_max, int with_values)
+{
+	const __m512i other = _mm512_permutexvar_epi64(partner, *keys);
+	if (with_values) {
+		const __mmask8 take = (__mmask8)((take_max & _mm512_cmpgt_epi64_mask(other, *keys)) |
+		                                 (~take_max & _mm512_cmpgt_epi64_mask(*keys, other)));
+		*keys = _mm512_mask_blend_epi64(take, *keys, other);
+		*values = _mm512_mask_blend_epi64(take, *values, _mm512_permutexvar_epi64(partner, *values));
+	} else {
+		*keys = _mm512_mask_blend_epi64(take_max, _mm512_min_epi64(*keys, other), _mm512_max_epi64(*keys, other));
+	}
+}
+
+static PYSIMD_TARGET_AVX512 void simd_sort_exchange_i64_avx512(__m512i* low, __m512i* high, __m512i* low_values,
+	                                                            __m512i* high_values, int with_values)
+{
+	const __mmask8 swap = _mm512_cmpgt_epi64_mask(*low, *high);
+	const __m512i first = *low;
+	*low = _mm512_mask_blend_epi64(swap, *low, *high);
+	*high = _mm512_mask_blend_epi64(swap, *high, first);
+	if (with_values) {
+		const __m512i first_values = *low_values;
+		*low_values = _mm512_mask_blend_epi64(swap, *low_values, *high_values);
+		*high_values = _mm512_mask_blend_epi64(swap, *high_values, first_values);
+	}
+}
+
+static PYSIMD_TARGET_AVX512 __m512i simd_sort_reverse_i64_avx512(__m512i keys)
+{
+	return _mm512_permutexvar_epi64(_mm512_setr_epi64(7, 6, 5, 4, 3, 2, 1, 0), keys);
+}
+
+SIMD_SORT_NETWORK(simd_sort_network_i32_avx512_run, PYSIMD_TARGET_AVX512, int32_t, 16, __m512i, __mmask16, INT32_MAX,
+	              simd_sort_loadu_i32_avx512, simd_sort_storeu_i32_avx512, simd_sort_network_i32_avx512,
+	              simd_sort_step_i32_avx512, simd_sort_exchange_i32_avx512, simd_sort_reverse_i32_avx512)
+SIMD_SORT_NETWORK(simd_sort_network_i64_avx512_run, PYSIMD_TARGET_AVX512, int64_t, 8, __m512i, __mmask8, INT64_MAX,
+	              simd_sort_loadu_i64_avx512, simd_sort_storeu_i64_avx512, simd_sort_network_i64_avx512,
+	              simd_sort_step_i64_avx512, simd_sort_exchange_i64_avx512, simd_sort_reverse_i64_avx512)
+
+// AVX-512 compacts each side with a compress, the position table is not needed
+#define SIMD_SORT_PARTITION_AVX512(name, ktype, lanes, mtype, set1, cmplt, cmple, compress, count) \
+static PYSIMD_TARGET_AVX512 size_t name(ktype* keys, int64_t* values, size_t n, ktype pivot, int or_equal, \
+	                                    ktype* scratch, int64_t* scratch_values) { \
+	const __m512i bound = set1(pivot); \
+	size_t left = 0; \
+	size_t right = 0; \
+	size_t i = 0; \
+	for (; i + (lanes) <= n; i += (lanes)) { \
+		const __m512i x = _mm512_loadu_si512((void const*)(keys + i)); \
+		const mtype goes = or_equal ? cmple(x, bound) : cmplt(x, bound); \
+		const size_t n_left = count(goes); \
+		_mm512_storeu_si512((void*)(keys + left), compress(goes, x)); \
+		_mm512_storeu_si512((void*)(scratch + right), compress((mtype)~goes, x)); \
+		if (values != NULL) { \
+			const __m512i v = _mm512_loadu_si512((void const*)(values + i)); \
+			_mm512_storeu_si512((void*)(values + left), compress(goes, v)); \
+			_mm512_storeu_si512((void*)(scratch_values + right), compress((mtype)~goes, v)); \
+		} \
+		left += n_left; \
+		right += (lanes) - n_left; \
+	} \
+	SIMD_SORT_PARTITION_REST(ktype) \
+	return left; \
+}
+
+static PYSIMD_TARGET_AVX512 __m512i simd_sort_set1_i32_avx512(int32_t key) { return _mm512_set1_epi32(key); }
+static PYSIMD_TARGET_AVX512 __m512i simd_sort_set1_i64_avx512(int64_t key) { return _mm512_set1_epi64(key); }
+static size_t simd_sort_count16(__mmask16 mask) { return (size_t)pysimd_filter_count[mask & 0xff] + pysimd_filter_count[mask >> 8]; }
+static size_t simd_sort_count8(__mmask8 mask) { return (size_t)pysimd_filter_count[mask]; }
+
+SIMD_SORT_PARTITION_AVX512(simd_sort_partition_i32_avx512, int32_t, 16, __mmask16, simd_sort_set1_i32_avx512,
+	                       _mm512_cmplt_epi32_mask, _mm512_cmple_epi32_mask, _mm512_maskz_compress_epi32, simd_sort_count16)
+SIMD_SORT_PARTITION_AVX512(simd_sort_partition_i64_avx512, int64_t, 8, __mmask8, simd_sort_set1_i64_avx512,
+	                       _mm512_cmplt_epi64_mask, _mm512_cmple_epi64_mask, _mm512_maskz_compress_epi64, simd_sort_count8)
+
+#undef SIMD_SORT_PARTITION_AVX512
+
+SIMD_SORT_QUICKSORT(simd_sort_i32_avx512, PYSIMD_TARGET_AVX512, int32_t, 0, PYSIMD_SORT_NETWORK_REGS * 16,
+	                simd_sort_partition_i32_avx512, simd_sort_network_i32_avx512_run, simd_sort_heap_i32)
+SIMD_SORT_QUICKSORT(simd_sort_i64_avx512, PYSIMD_TARGET_AVX512, int64_t, 1, PYSIMD_SORT_NETWORK_REGS * 8,
+	                simd_sort_partition_i64_avx512, simd_sort_network_i64_avx512_run, simd_sort_heap_i64)
+
+#endif // PYSIMD_X86_AVX512
+
+#undef SIMD_SORT_NETWORK
+
+#endif // PYSIMD_X86_AVX2
+
+#undef SIMD_SORT_QUICKSORT
+#undef SIMD_SORT_PARTITION_REST
+
+#endif // SIMD_VEC_SORT_H
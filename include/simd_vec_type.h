@@ -6,6 +6,96 @@
 struct pysimd_vec_t {
 	size_t size;
 	uint8_t* data;
+	// Bytes reserved for data by the allocator, may exceed size
+	size_t capacity;
 };
 
+/* Vectors are untyped bytes, operations that need to interpret those bytes take
+ * a lane type, the kind of number in each lane and its width in bytes.
+ */
+enum pysimd_lane_kind {
+	PYSIMD_LANE_INT,
+	PYSIMD_LANE_UINT,
+	PYSIMD_LANE_FLOAT
+};
+
+struct pysimd_lane_t {
+	enum pysimd_lane_kind kind;
+	size_t width;
+};
+
+/* Parses a lane type name, such as 'i8', 'u32' or 'f64'.
+ * Returns 0 if the name is not a valid lane type.
+ */
+static int pysimd_lane_parse(const char* name, struct pysimd_lane_t* lane)
+{
+	switch (name[0]) {
+		case 'i': lane->kind = PYSIMD_LANE_INT; break;
+		case 'u': lane->kind = PYSIMD_LANE_UINT; break;
+		case 'f': lane->kind = PYSIMD_LANE_FLOAT; break;
+		default:
+		    return 0;
+	}
+	if (strcmp(name + 1, "8") == 0)
+		lane->width = 1;
+	else if (strcmp(name + 1, "16") == 0)
+		lane->width = 2;
+	else if (strcmp(name + 1, "32") == 0)
+		lane->width = 4;
+	else if (strcmp(name + 1, "64") == 0)
+		lane->width = 8;
+	else
+		return 0;
+	return lane->kind != PYSIMD_LANE_FLOAT || lane->width >= 4;
+}
+
+// Number of distinct lane types, see pysimd_lane_index
+#define PYSIMD_N_LANE_TYPES 10
+
+// Positions of each lane type in tables indexed by pysimd_lane_index
+enum pysimd_lane_type {
+	PYSIMD_LANE_I8,
+	PYSIMD_LANE_U8,
+	PYSIMD_LANE_I16,
+	PYSIMD_LANE_U16,
+	PYSIMD_LANE_I32,
+	PYSIMD_LANE_U32,
+	PYSIMD_LANE_I64,
+	PYSIMD_LANE_U64,
+	PYSIMD_LANE_F32,
+	PYSIMD_LANE_F64
+};
+
+/* Numbers lane types in the order i8, u8, i16, u16, i32, u32, i64, u64, f32, f64,
+ * for tables of kernels that have a variant per lane type.
+ */
+static size_t pysimd_lane_index(struct pysimd_lane_t lane)
+{
+	if (lane.kind == PYSIMD_LANE_FLOAT)
+		return lane.width == 4 ? 8 : 9;
+	return (lane.width == 1 ? 0 : lane.width == 2 ? 2 : lane.width == 4 ? 4 : 6) + (lane.kind == PYSIMD_LANE_UINT);
+}
+
+// A single lane value widened to 64 bits, the member in use follows the lane kind
+union pysimd_lane_value {
+	int64_t i;
+	uint64_t u;
+	double f;
+};
+
+// Returns the name of a lane type, the inverse of pysimd_lane_parse
+static const char* pysimd_lane_name(struct pysimd_lane_t lane)
+{
+	static const char* int_names[] = {"i8", "i16", "i32", "i64"};
+	static const char* uint_names[] = {"u8", "u16", "u32", "u64"};
+	const size_t index = lane.width == 1 ? 0 : lane.width == 2 ? 1 : lane.width == 4 ? 2 : 3;
+	switch (lane.kind) {
+		case PYSIMD_LANE_INT: return int_names[index];
+		case PYSIMD_LANE_UINT: return uint_names[index];
+		case PYSIMD_LANE_FLOAT:
+		default:
+		    return lane.width == 4 ? "f32" : "f64";
+	}
+}
+
 #endif // SIMD_VEC_TYPE_H
\ No newline at end of file
@@ -2,7 +2,7 @@
 #define PYSIMD_VEC_MACROS_H
 
 
-#define PYSIMD_MIN_VEC_SIZE(v1, v2) (((v1)->size) < ((v2)->size)) ? ((v1)->size) : ((v2)->size)
+#define PYSIMD_MIN_VEC_SIZE(v1, v2) ((((v1)->size) < ((v2)->size)) ? ((v1)->size) : ((v2)->size))
 
 
 #endif // PYSIMD_VEC_MACROS_H
@@ -46,6 +46,9 @@ macro_defs = [
 ]
 
 # extra_compile_args
+# No -m flags are passed for the whole module, so the extension can be imported on any
+# x86_64 cpu. Wider kernels are compiled per function, and picked at import time, from
+# what the running cpu supports. The checks below only establish what the compiler can emit.
 compiler_flags = []
 
 x86_header_string = """
@@ -65,7 +68,7 @@ with CheckCCompiles("sse2", x86_header_string + """
 }
 
 """) as sse2_test:
-  if sse2_test.works:
+  if sse2_test.compiles:
     macro_defs.append(('PYSIMD_X86_SSE2', '1'))
     pysimd_minimum_align = 16
 
@@ -78,10 +81,8 @@ with CheckCCompiles("sse3", x86_header_string + """
     return 0;
 }
 """) as sse3_test:
-  if sse3_test.works:
+  if sse3_test.compiles:
     macro_defs.append(('PYSIMD_X86_SSE3', '1'))
-    if DEFAULT_COMPILER == 'unix':
-      compiler_flags.append('-msse3')
 
 with CheckCCompiles("ssse3", x86_header_string + """
 
@@ -97,10 +98,8 @@ with CheckCCompiles("ssse3", x86_header_string + """
     return 0;
 } 
 """) as ssse3_test:
-  if ssse3_test.works:
+  if ssse3_test.compiles:
     macro_defs.append(('PYSIMD_X86_SSSE3', '1'))
-    if DEFAULT_COMPILER == 'unix':
-      compiler_flags.append('-mssse3')
 
 with CheckCCompiles("avx", x86_header_string + """
 
@@ -112,11 +111,9 @@ int main(void) {
     return 0;
 } 
 """) as avx_test:
-  if avx_test.works:
+  if avx_test.compiles:
     macro_defs.append(('PYSIMD_X86_AVX', '1'))
     pysimd_minimum_align = 32
-    if DEFAULT_COMPILER == 'unix':
-      compiler_flags.append('-mavx')
 
 with CheckCCompiles("avx2", x86_header_string + """
 
@@ -128,11 +125,44 @@ int main(void) {
     return 0;
 } 
 """) as avx2_test:
-  if avx2_test.works:
+  if avx2_test.compiles:
     macro_defs.append(('PYSIMD_X86_AVX2', '1'))
     pysimd_minimum_align = 32
-    if DEFAULT_COMPILER == 'unix':
-      compiler_flags.append('-mavx2')
+
+with CheckCCompiles("fma", x86_header_string + """
+
+int main(void) {
+    __m256 a = _mm256_set1_ps(2.0f);
+    __m256 fused = _mm256_fmadd_ps(a, a, a);
+    (void)fused;
+    return 0;
+}
+""") as fma_test:
+  if fma_test.compiles:
+    macro_defs.append(('PYSIMD_X86_FMA', '1'))
+
+with CheckCCompiles("popcnt", x86_header_string + """
+
+int main(void) {
+    unsigned long long bits = 0xff00ff00ULL;
+    long long counted = _mm_popcnt_u64(bits);
+    (void)counted;
+    return 0;
+}
+""") as popcnt_test:
+  if popcnt_test.compiles:
+    macro_defs.append(('PYSIMD_X86_POPCNT', '1'))
+
+with CheckCCompiles("sse4.2", x86_header_string + """
+
+int main(void) {
+    unsigned long long crc = _mm_crc32_u64(0xffffffffULL, 0x0123456789abcdefULL);
+    (void)crc;
+    return 0;
+}
+""") as sse42_test:
+  if sse42_test.compiles:
+    macro_defs.append(('PYSIMD_X86_SSE42', '1'))
 
 with CheckCCompiles("avx512f", x86_header_string + """
 
@@ -148,11 +178,24 @@ int main(void) {
     return 0;
 } 
 """) as avx512f_test:
-  if avx512f_test.works:
+  if avx512f_test.compiles:
     macro_defs.append(('PYSIMD_X86_AVX512F', '1'))
     pysimd_minimum_align = 64
-    if DEFAULT_COMPILER == 'unix':
-      compiler_flags.append('-mavx512f')
+
+with CheckCCompiles("avx512bw", x86_header_string + """
+
+static char storedata[256];
+
+int main(void) {
+    __m512i a = _mm512_set1_epi8(3);
+    __m512i b = _mm512_set1_epi8(3);
+    __m512i added =  _mm512_add_epi8(a, b);
+    _mm512_storeu_si512((void*)storedata, added);
+    return 0;
+} 
+""") as avx512bw_test:
+  if avx512bw_test.compiles:
+    macro_defs.append(('PYSIMD_X86_AVX512BW', '1'))
 
 macro_defs.append(('PYSIMD_MIN_ALIGN', str(pysimd_minimum_align)))
 
@@ -1,10 +1,10 @@
 #include "core_simd_info.h"
-#include "simd_vec.h"
-#include "simd_vec_arith.h"
-//#include "simd_vec_filter.h"
+#include "simd_dispatch.h"
+#include "simd_expr.h"
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 #include "structmember.h"
+#include <float.h>
 
 #define RETURN_OR_SYS_ERROR(variable) \
     if (variable == NULL) { \
@@ -15,14 +15,110 @@
 typedef struct {
     PyObject_HEAD
     struct pysimd_vec_t vec;
+    // Number of live buffer exports, the data cannot move while this is non zero
+    Py_ssize_t exports;
+    // Set when the data is borrowed from another object, which is kept alive by it
+    Py_buffer source;
+    int readonly;
+    // Element type, used by operators and as the default by methods taking a type
+    struct pysimd_lane_t lane;
 } SimdObject;
 
 extern PyTypeObject SimdObjectType;
+extern PyTypeObject ExprObjectType;
+extern PyTypeObject MatObjectType;
 static PyObject *SimdError;
 
+/* A deferred chain of elementwise operations on a base vector. Operations are only
+ * recorded, and run fused in a single pass over memory when the expression is evaluated.
+ */
+typedef struct {
+    PyObject_HEAD
+    SimdObject* base;
+    struct pysimd_expr_step* steps;
+    // References to the vectors the steps operate with, in the same order
+    SimdObject** operands;
+    Py_ssize_t n_steps;
+    Py_ssize_t capacity;
+} ExprObject;
+
+// Frees owned data, or lets go of borrowed data, leaving the vector empty
+static void SimdObject_release_data(SimdObject* self)
+{
+    if (self->source.obj != NULL) {
+        PyBuffer_Release(&(self->source));
+        pysimd_vec_clear(&(self->vec));
+    } else {
+        pysimd_vec_deinit(&(self->vec));
+    }
+    self->readonly = 0;
+}
+
+// Replaces borrowed data with an owned copy of it, so the vector can be reallocated
+static int SimdObject_own_data(SimdObject* self)
+{
+    struct pysimd_vec_t owned;
+    if (self->source.obj == NULL) {
+        return 1;
+    }
+    if (!pysimd_dispatch.copy(&owned, &(self->vec), 0, self->vec.size)) {
+        return 0;
+    }
+    PyBuffer_Release(&(self->source));
+    self->vec = owned;
+    return 1;
+}
+
+static int SimdObject_check_writable(SimdObject* self)
+{
+    if (self->readonly) {
+        PyErr_SetString(SimdError, "vector borrows read-only memory and cannot be modified");
+        return 0;
+    }
+    return 1;
+}
+
+/* Converts the type and width arguments taken by methods that interpret lanes.
+ * The type is either a lane type name like 'u8' or 'f32', in which case the width
+ * may be left as 0, or int or float along with a width in bytes.
+ */
+static int pysimd_lane_from_args(PyObject* type, Py_ssize_t width,
+                                 struct pysimd_lane_t* lane, const char* method)
+{
+    if (PyUnicode_Check(type)) {
+        const char* name = PyUnicode_AsUTF8(type);
+        if (name == NULL) {
+            return 0;
+        }
+        if (!pysimd_lane_parse(name, lane) || (width != 0 && (size_t)width != lane->width)) {
+            PyErr_Format(SimdError, "The type '%s' is not supported for method '%s'", name, method);
+            return 0;
+        }
+        return 1;
+    }
+    if ((PyTypeObject*)type == &PyLong_Type) {
+        lane->kind = PYSIMD_LANE_INT;
+        if (width != 1 && width != 2 && width != 4 && width != 8) {
+            PyErr_Format(SimdError, "The width '%zd' is not supported for method '%s'", width, method);
+            return 0;
+        }
+    } else if ((PyTypeObject*)type == &PyFloat_Type) {
+        lane->kind = PYSIMD_LANE_FLOAT;
+        if (width != 4 && width != 8) {
+            PyErr_Format(SimdError, "The width '%zd' is not supported for floats for '%s'", width, method);
+            return 0;
+        }
+    } else {
+        PyErr_Format(SimdError, "The type '%s' is not supported for method '%s'", type->ob_type->tp_name, method);
+        return 0;
+    }
+    lane->width = (size_t)width;
+    return 1;
+}
+
 static void SimdObject_dealloc(SimdObject* self)
 {
-    pysimd_vec_deinit(&(self->vec));
+    SimdObject_release_data(self);
     Py_TYPE(self)->tp_free((PyObject*)self);
 }
 
@@ -33,36 +129,68 @@ SimdObject_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     self = (SimdObject*) type->tp_alloc(type, 0);
     if (self != NULL) {
         pysimd_vec_clear(&(self->vec));
+        self->exports = 0;
+        self->source.obj = NULL;
+        self->readonly = 0;
+        self->lane.kind = PYSIMD_LANE_UINT;
+        self->lane.width = 1;
     }
     return (PyObject *) self;
 }
 
 static int SimdObject_init(SimdObject* self, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {"size", "repeat_value", "repeat_size", NULL};
+    static char *kwlist[] = {"size", "repeat_value", "repeat_size", "zero", "type", NULL};
     Py_ssize_t param_size = 0;
     PyObject* param_rep_val = NULL;
     unsigned char param_rep_size = 0;
+    int param_zero = 1;
+    PyObject* param_type = NULL;
+    struct pysimd_lane_t lane = {PYSIMD_LANE_UINT, 1};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|nOb", kwlist,
-                                     &param_size, &param_rep_val, &param_rep_size))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|nObpO", kwlist,
+                                     &param_size, &param_rep_val, &param_rep_size, &param_zero, &param_type))
         return -1;
+    // Without an explicit type, the element type follows the repeated value
+    if (param_type != NULL) {
+        if (!pysimd_lane_from_args(param_type, PyUnicode_Check(param_type) ? 0 : param_rep_size, &lane, "Vec")) {
+            return -1;
+        }
+    } else if (param_rep_val != NULL && param_rep_size != 0) {
+        lane.kind = PyFloat_Check(param_rep_val) ? PYSIMD_LANE_FLOAT : PYSIMD_LANE_INT;
+        lane.width = param_rep_size;
+    }
     if (param_size > 0 && param_size % 16 != 0) {
         PyErr_Format(SimdError, "The size '%zu' cannot be aligned by at least 16 bytes", (size_t)param_size);
         return -1;
     }
     param_size = param_size == 0 ? /*default*/ 64 : param_size;
-    pysimd_vec_init(&(self->vec), (size_t)param_size);
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot reinitialize a vector while its buffer is exported or in use");
+        return -1;
+    }
+    SimdObject_release_data(self);
+    // A repeated value overwrites the whole vector, so zeroing it first is wasted work
+    if (param_zero && (param_rep_val == NULL || param_rep_size == 0)) {
+        pysimd_vec_init(&(self->vec), (size_t)param_size);
+    } else {
+        pysimd_vec_init_raw(&(self->vec), (size_t)param_size);
+    }
+    if (self->vec.data == NULL) {
+        pysimd_vec_clear(&(self->vec));
+        PyErr_NoMemory();
+        return -1;
+    }
     if (param_rep_val != NULL && param_rep_size != 0) {
         if (PyLong_Check(param_rep_val)) {
             size_t rep_value = PyLong_AsSize_t(param_rep_val);
-            if (!pysimd_vec_fill(&(self->vec), rep_value, param_rep_size)) {
+            if (!pysimd_dispatch.fill(&(self->vec), rep_value, param_rep_size)) {
                 PyErr_Format(SimdError, "Invalid repeat parameters, value: %zu, size: %u", rep_value, param_rep_size);
                 return -1;
             }
         } else if (PyFloat_Check(param_rep_val)) {
             double rep_value = PyFloat_AsDouble(param_rep_val);
-            if (!pysimd_vec_fill_float(&(self->vec), rep_value, param_rep_size)) {
+            if (!pysimd_dispatch.fill_float(&(self->vec), rep_value, param_rep_size)) {
                 PyErr_Format(SimdError, "Invalid repeat parameters, value: %f, size: %u", rep_value, param_rep_size);
                 return -1;
             }
@@ -71,9 +199,28 @@ static int SimdObject_init(SimdObject* self, PyObject *args, PyObject *kwds)
             return -1;
         }
     }
+    self->lane = lane;
     return 0;
 }
 
+// Makes a vector of size bytes with unspecified contents, for results about to be written
+static SimdObject* SimdObject_make(size_t size, struct pysimd_lane_t lane)
+{
+    SimdObject* made = (SimdObject*)SimdObjectType.tp_alloc(&SimdObjectType, 0);
+    if (made == NULL) {
+        return NULL;
+    }
+    made->lane = lane;
+    pysimd_vec_init_raw(&(made->vec), size);
+    if (made->vec.data == NULL) {
+        pysimd_vec_clear(&(made->vec));
+        Py_DECREF(made);
+        PyErr_NoMemory();
+        return NULL;
+    }
+    return made;
+}
+
 static PyObject*
 SimdObject_copy(SimdObject *self, PyObject *args, PyObject *kwargs)
 {
@@ -114,7 +261,8 @@ SimdObject_copy(SimdObject *self, PyObject *args, PyObject *kwargs)
         PyErr_Format(PyExc_SystemError, "Internal object failure line: %u", __LINE__);
         return NULL;
     }
-    if (!pysimd_vec_copy( &((SimdObject*)copied)->vec, &self->vec, actual_start, actual_end)) {
+    ((SimdObject*)copied)->lane = self->lane;
+    if (!pysimd_dispatch.copy( &((SimdObject*)copied)->vec, &self->vec, actual_start, actual_end)) {
         PyErr_SetString(SimdError, "Internal vector copy failure");
         SimdObject_dealloc((SimdObject*)copied);
         return NULL;
@@ -153,353 +301,3617 @@ SimdObject_resize(SimdObject *self, PyObject *args, PyObject *kwargs)
     } else if (resize_to % 16 != 0) {
         PyErr_SetString(SimdError, "vector can only be resized to 16-byte aligned size");
         return NULL;
+    } else if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot resize a vector while its buffer is exported or in use");
+        return NULL;
+    }
+    if (!SimdObject_check_writable(self)) {
+        return NULL;
+    }
+    if (!SimdObject_own_data(self)) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    if (!pysimd_vec_resize(&self->vec, (size_t)resize_to)) {
+        PyErr_NoMemory();
+        return NULL;
     }
-    pysimd_vec_resize(&self->vec, (size_t)resize_to);
     size_val = PyLong_FromSize_t(self->vec.size);
     RETURN_OR_SYS_ERROR(size_val);
 }
 
-static PyObject*
-SimdObject_add(SimdObject *self, PyObject *args, PyObject *kwargs)
+/* Runs a binary kernel, dst = v1 op v2. On large vectors, other Python threads run
+ * meanwhile, so the vectors count as exported for the duration, which keeps them
+ * from being resized or reinitialized under the kernel.
+ */
+static void SimdObject_run_binop(pysimd_vec_binop_t op, SimdObject* dst, SimdObject* v1, SimdObject* v2)
 {
-    static char *kwlist[] = {"other", "width", NULL};
-    Py_ssize_t param_width = 0;
-    PyObject* param_other = NULL;
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On", kwlist,
-                                     &param_other, &param_width)) {
+    if (PYSIMD_MIN_VEC_SIZE(&(v1->vec), &(v2->vec)) < PYSIMD_NOGIL_MIN) {
+        op(&(dst->vec), &(v1->vec), &(v2->vec));
+        return;
+    }
+    dst->exports += 1;
+    v1->exports += 1;
+    v2->exports += 1;
+    Py_BEGIN_ALLOW_THREADS
+    pysimd_binop_run(op, &(dst->vec), &(v1->vec), &(v2->vec));
+    Py_END_ALLOW_THREADS
+    dst->exports -= 1;
+    v1->exports -= 1;
+    v2->exports -= 1;
+}
+
+static void SimdObject_run_unop(pysimd_vec_unop_t op, SimdObject* dst, SimdObject* src)
+{
+    if (src->vec.size < PYSIMD_NOGIL_MIN) {
+        op(&(dst->vec), &(src->vec));
+        return;
+    }
+    dst->exports += 1;
+    src->exports += 1;
+    Py_BEGIN_ALLOW_THREADS
+    pysimd_unop_run(op, &(dst->vec), &(src->vec));
+    Py_END_ALLOW_THREADS
+    dst->exports -= 1;
+    src->exports -= 1;
+}
+
+static void SimdObject_run_ternop(pysimd_vec_ternop_t op, SimdObject* dst, SimdObject* v1,
+                                  SimdObject* v2, SimdObject* v3)
+{
+    if (PYSIMD_MIN_VEC_SIZE(&(v1->vec), &(v2->vec)) < PYSIMD_NOGIL_MIN || v3->vec.size < PYSIMD_NOGIL_MIN) {
+        op(&(dst->vec), &(v1->vec), &(v2->vec), &(v3->vec));
+        return;
+    }
+    dst->exports += 1;
+    v1->exports += 1;
+    v2->exports += 1;
+    v3->exports += 1;
+    Py_BEGIN_ALLOW_THREADS
+    pysimd_ternop_run(op, &(dst->vec), &(v1->vec), &(v2->vec), &(v3->vec));
+    Py_END_ALLOW_THREADS
+    dst->exports -= 1;
+    v1->exports -= 1;
+    v2->exports -= 1;
+    v3->exports -= 1;
+}
+
+/* Picks the vector to write the result of an operation over oper_region bytes into,
+ * out when it is given, and the vector itself otherwise. Returns NULL with an exception
+ * set when out is not a writable vector of at least that size.
+ */
+static SimdObject* SimdObject_result_target(SimdObject* self, PyObject* out, size_t oper_region)
+{
+    SimdObject* dst = self;
+    if (out != Py_None) {
+        if (!PyObject_TypeCheck(out, &SimdObjectType)) {
+            PyErr_Format(SimdError, "Expected vector for 'out', got type '%s'", out->ob_type->tp_name);
+            return NULL;
+        }
+        dst = (SimdObject*)out;
+        if (dst->vec.size < oper_region) {
+            PyErr_Format(SimdError, "'out' vector of size %zu is smaller than the %zu bytes operated on",
+                         dst->vec.size, oper_region);
+            return NULL;
+        }
+    }
+    if (!SimdObject_check_writable(dst)) {
         return NULL;
     }
+    return dst;
+}
 
-    if (param_other->ob_type != &SimdObjectType) {
-        PyErr_Format(SimdError, "Expected vector, got type '%s'", param_other->ob_type->tp_name);
+/* Shared by the arithmetic methods. Applies op to the vector and other, writing into
+ * out when it is given, and into the vector itself otherwise.
+ */
+static PyObject* SimdObject_apply_binop(SimdObject* self, PyObject* other, PyObject* out, pysimd_vec_binop_t op)
+{
+    SimdObject* dst = NULL;
+    if (!PyObject_TypeCheck(other, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector, got type '%s'", other->ob_type->tp_name);
         return NULL;
     }
+    dst = SimdObject_result_target(self, out, PYSIMD_MIN_VEC_SIZE(&(self->vec), &(((SimdObject*)other)->vec)));
+    if (dst == NULL) {
+        return NULL;
+    }
+    SimdObject_run_binop(op, dst, self, (SimdObject*)other);
+    if (out == Py_None) {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+    Py_INCREF(out);
+    return out;
+}
 
-    switch (param_width) {
-        case 1:
-            simd_vec_add_i8(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        case 2:
-            simd_vec_add_i16(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        case 4:
-            simd_vec_add_i32(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        case 8:
-            simd_vec_add_i64(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        default:
-            PyErr_Format(SimdError, "Unrecognized width: %zu for add operation", (size_t)param_width);
-            return NULL;
+#define PYSIMD_DISPATCH_KERNELS(op) { \
+    pysimd_dispatch.op##_i8, pysimd_dispatch.op##_i16, pysimd_dispatch.op##_i32, \
+    pysimd_dispatch.op##_i64, pysimd_dispatch.op##_f32, pysimd_dispatch.op##_f64 }
+
+/* Picks the kernel for a width in bytes, out of kernels ordered i8, i16, i32, i64, f32, f64.
+ * Sets an exception and returns NULL when there is none for that width.
+ */
+static pysimd_vec_binop_t pysimd_width_kernel(const pysimd_vec_binop_t* kernels, Py_ssize_t width,
+                                              int is_float, const char* method)
+{
+    pysimd_vec_binop_t op = NULL;
+    if (is_float) {
+        op = width == 4 ? kernels[4] : width == 8 ? kernels[5] : NULL;
+    } else {
+        op = width == 1 ? kernels[0] : width == 2 ? kernels[1] : width == 4 ? kernels[2] : width == 8 ? kernels[3] : NULL;
     }
-    Py_INCREF(Py_None);
-    return Py_None;
+    if (op == NULL) {
+        PyErr_Format(SimdError, "Unrecognized width: %zu for %s operation", (size_t)width, method);
+    }
+    return op;
 }
 
-static PyObject*
-SimdObject_fadd(SimdObject *self, PyObject *args, PyObject *kwargs)
+// Parses the arguments shared by the arithmetic methods, then applies the kernel for the width
+static PyObject* SimdObject_binop_method(SimdObject *self, PyObject *args, PyObject *kwargs,
+                                         const pysimd_vec_binop_t* kernels, int is_float, const char* method)
 {
-    static char *kwlist[] = {"other", "width", NULL};
+    static char *kwlist[] = {"other", "width", "out", NULL};
     Py_ssize_t param_width = 0;
     PyObject* param_other = NULL;
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On", kwlist,
-                                     &param_other, &param_width)) {
+    PyObject* param_out = Py_None;
+    pysimd_vec_binop_t op = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On|O", kwlist,
+                                     &param_other, &param_width, &param_out)) {
         return NULL;
     }
-
-    if (param_other->ob_type != &SimdObjectType) {
-        PyErr_Format(SimdError, "Expected vector, got type '%s'", param_other->ob_type->tp_name);
+    op = pysimd_width_kernel(kernels, param_width, is_float, method);
+    if (op == NULL) {
         return NULL;
     }
+    return SimdObject_apply_binop(self, param_other, param_out, op);
+}
 
-    switch (param_width) {
-        case 4:
-            simd_vec_add_f32(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        case 8:
-            simd_vec_add_f64(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        default:
-            PyErr_Format(SimdError, "Unrecognized width: %zu for fadd operation", (size_t)param_width);
-            return NULL;
-    }
-    Py_INCREF(Py_None);
-    return Py_None;
+/* Integer operations whose result depends on signedness, treat lanes as signed, unless
+ * the element type of the vector is unsigned of the width operated on.
+ */
+static int pysimd_lane_is_unsigned(struct pysimd_lane_t lane, Py_ssize_t width)
+{
+    return lane.kind == PYSIMD_LANE_UINT && lane.width == (size_t)width;
 }
 
-static PyObject*
-SimdObject_sub(SimdObject *self, PyObject *args, PyObject *kwargs)
+/* Parses the arguments of add and sub, which with saturate set clamp the results of
+ * 8 and 16 bit lanes to their range instead of wrapping around.
+ */
+static PyObject* SimdObject_saturating_method(SimdObject *self, PyObject *args, PyObject *kwargs,
+                                              const pysimd_vec_binop_t* kernels,
+                                              const pysimd_vec_binop_t* signed_kernels,
+                                              const pysimd_vec_binop_t* unsigned_kernels, const char* method)
 {
-    static char *kwlist[] = {"other", "width", NULL};
+    static char *kwlist[] = {"other", "width", "out", "saturate", NULL};
     Py_ssize_t param_width = 0;
     PyObject* param_other = NULL;
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On", kwlist,
-                                     &param_other, &param_width)) {
+    PyObject* param_out = Py_None;
+    int param_saturate = 0;
+    pysimd_vec_binop_t op = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On|Op", kwlist,
+                                     &param_other, &param_width, &param_out, &param_saturate)) {
         return NULL;
     }
-
-    if (param_other->ob_type != &SimdObjectType) {
-        PyErr_Format(SimdError, "Expected vector, got type '%s'", param_other->ob_type->tp_name);
+    if (param_saturate) {
+        kernels = pysimd_lane_is_unsigned(self->lane, param_width) ? unsigned_kernels : signed_kernels;
+    }
+    op = pysimd_width_kernel(kernels, param_width, 0, method);
+    if (op == NULL) {
         return NULL;
     }
+    return SimdObject_apply_binop(self, param_other, param_out, op);
+}
 
-    switch (param_width) {
-        case 1:
-            simd_vec_sub_i8(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        case 2:
-            simd_vec_sub_i16(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        case 4:
-            simd_vec_sub_i32(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        case 8:
-            simd_vec_sub_i64(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        default:
-            PyErr_Format(SimdError, "Unrecognized width: %zu for sub operation", (size_t)param_width);
-            return NULL;
-    }
-    Py_INCREF(Py_None);
-    return Py_None;
+static PyObject*
+SimdObject_add(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(add);
+    const pysimd_vec_binop_t signed_kernels[] = {pysimd_dispatch.adds_i8, pysimd_dispatch.adds_i16, NULL, NULL, NULL, NULL};
+    const pysimd_vec_binop_t unsigned_kernels[] = {pysimd_dispatch.adds_u8, pysimd_dispatch.adds_u16, NULL, NULL, NULL, NULL};
+    return SimdObject_saturating_method(self, args, kwargs, kernels, signed_kernels, unsigned_kernels, "add");
+}
+
+static PyObject*
+SimdObject_fadd(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(add);
+    return SimdObject_binop_method(self, args, kwargs, kernels, 1, "fadd");
+}
+
+static PyObject*
+SimdObject_sub(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(sub);
+    const pysimd_vec_binop_t signed_kernels[] = {pysimd_dispatch.subs_i8, pysimd_dispatch.subs_i16, NULL, NULL, NULL, NULL};
+    const pysimd_vec_binop_t unsigned_kernels[] = {pysimd_dispatch.subs_u8, pysimd_dispatch.subs_u16, NULL, NULL, NULL, NULL};
+    return SimdObject_saturating_method(self, args, kwargs, kernels, signed_kernels, unsigned_kernels, "sub");
 }
 
 static PyObject*
 SimdObject_fsub(SimdObject *self, PyObject *args, PyObject *kwargs)
 {
-    static char *kwlist[] = {"other", "width", NULL};
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(sub);
+    return SimdObject_binop_method(self, args, kwargs, kernels, 1, "fsub");
+}
+
+/* Multiplies by another vector. Keeps the low half of each product, or with high set, the
+ * high half, which depends on signedness.
+ */
+static PyObject*
+SimdObject_mul(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"other", "width", "out", "high", NULL};
     Py_ssize_t param_width = 0;
     PyObject* param_other = NULL;
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On", kwlist,
-                                     &param_other, &param_width)) {
+    PyObject* param_out = Py_None;
+    int param_high = 0;
+    const pysimd_vec_binop_t low_kernels[] = {NULL, pysimd_dispatch.mul_i16, pysimd_dispatch.mul_i32,
+                                              pysimd_dispatch.mul_i64, NULL, NULL};
+    const pysimd_vec_binop_t high_kernels[] = {NULL, pysimd_dispatch.mulhi_i16, pysimd_dispatch.mulhi_i32,
+                                               pysimd_dispatch.mulhi_i64, NULL, NULL};
+    const pysimd_vec_binop_t uhigh_kernels[] = {NULL, pysimd_dispatch.mulhi_u16, pysimd_dispatch.mulhi_u32,
+                                                pysimd_dispatch.mulhi_u64, NULL, NULL};
+    const pysimd_vec_binop_t* kernels = low_kernels;
+    pysimd_vec_binop_t op = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On|Op", kwlist,
+                                     &param_other, &param_width, &param_out, &param_high)) {
         return NULL;
     }
-
-    if (param_other->ob_type != &SimdObjectType) {
-        PyErr_Format(SimdError, "Expected vector, got type '%s'", param_other->ob_type->tp_name);
+    if (param_high) {
+        kernels = pysimd_lane_is_unsigned(self->lane, param_width) ? uhigh_kernels : high_kernels;
+    }
+    op = pysimd_width_kernel(kernels, param_width, 0, "mul");
+    if (op == NULL) {
         return NULL;
     }
+    return SimdObject_apply_binop(self, param_other, param_out, op);
+}
 
-    switch (param_width) {
-        case 4:
-            simd_vec_sub_f32(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        case 8:
-            simd_vec_sub_f64(&(self->vec), &(((SimdObject*)param_other)->vec));
-            break;
-        default:
-            PyErr_Format(SimdError, "Unrecognized width: %zu for fsub operation", (size_t)param_width);
-            return NULL;
-    }
-    Py_INCREF(Py_None);
-    return Py_None;
+static PyObject*
+SimdObject_fmul(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = {NULL, NULL, NULL, NULL, pysimd_dispatch.mul_f32, pysimd_dispatch.mul_f64};
+    return SimdObject_binop_method(self, args, kwargs, kernels, 1, "fmul");
 }
 
 static PyObject*
-SimdObject_as_bytes(SimdObject *self, PyObject *args, PyObject *kwargs)
+SimdObject_fdiv(SimdObject *self, PyObject *args, PyObject *kwargs)
 {
-    static char *kwlist[] = {"start", "end", NULL};
-    Py_ssize_t param_start = 0;
-    Py_ssize_t param_end = 0;
-    size_t actual_start = 0;
-    size_t actual_end = self->vec.size;
-    PyObject* bytes_made = NULL;
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nn", kwlist,
-                                     &param_start, &param_end)) {
+    const pysimd_vec_binop_t kernels[] = {NULL, NULL, NULL, NULL, pysimd_dispatch.div_f32, pysimd_dispatch.div_f64};
+    return SimdObject_binop_method(self, args, kwargs, kernels, 1, "fdiv");
+}
+
+static PyObject*
+SimdObject_fsqrt(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"width", "out", NULL};
+    Py_ssize_t param_width = 0;
+    PyObject* param_out = Py_None;
+    pysimd_vec_unop_t op = NULL;
+    SimdObject* dst = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|O", kwlist,
+                                     &param_width, &param_out)) {
         return NULL;
     }
-
-    if (param_start != 0) {
-        if (param_start > self->vec.size || param_start < 0) {
-            PyErr_Format(SimdError, "start: '%ld', is out of bounds for vector of size %zu", param_start, self->vec.size);
-            return NULL;
-        }
-        actual_start = (size_t)param_start;
+    op = param_width == 4 ? pysimd_dispatch.sqrt_f32 : param_width == 8 ? pysimd_dispatch.sqrt_f64 : NULL;
+    if (op == NULL) {
+        PyErr_Format(SimdError, "Unrecognized width: %zu for fsqrt operation", (size_t)param_width);
+        return NULL;
     }
-
-    if (param_end != 0) {
-        if (param_end > self->vec.size || param_end < 0) {
-            PyErr_Format(SimdError, "end: '%ld', is out of bounds for vector of size %zu", param_end, self->vec.size);
-            return NULL;
-        }
-        actual_end = (size_t)param_end;
+    dst = SimdObject_result_target(self, param_out, self->vec.size);
+    if (dst == NULL) {
+        return NULL;
     }
+    SimdObject_run_unop(op, dst, self);
+    if (param_out == Py_None) {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+    Py_INCREF(param_out);
+    return param_out;
+}
 
-    bytes_made = PyBytes_FromStringAndSize((const char*)self->vec.data +  actual_start, actual_end - actual_start);
-    RETURN_OR_SYS_ERROR(bytes_made);
-
+// Rounding average of unsigned 8 or 16 bit lanes
+static PyObject*
+SimdObject_avg(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = {pysimd_dispatch.avg_u8, pysimd_dispatch.avg_u16, NULL, NULL, NULL, NULL};
+    return SimdObject_binop_method(self, args, kwargs, kernels, 0, "avg");
 }
 
+// Absolute difference of 8 or 16 bit lanes, written as unsigned lanes
 static PyObject*
-SimdObject_as_tuple(SimdObject *self, PyObject *args, PyObject *kwargs)
+SimdObject_absdiff(SimdObject *self, PyObject *args, PyObject *kwargs)
 {
-    static char *kwlist[] = {"type", "width", NULL};
-    PyObject* tuple_to_give = NULL;
-    PyObject* param_type = NULL;
+    static char *kwlist[] = {"other", "width", "out", NULL};
     Py_ssize_t param_width = 0;
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On", kwlist,
-                                     &param_type, &param_width)) {
+    PyObject* param_other = NULL;
+    PyObject* param_out = Py_None;
+    const pysimd_vec_binop_t signed_kernels[] = {pysimd_dispatch.absdiff_i8, pysimd_dispatch.absdiff_i16, NULL, NULL, NULL, NULL};
+    const pysimd_vec_binop_t unsigned_kernels[] = {pysimd_dispatch.absdiff_u8, pysimd_dispatch.absdiff_u16, NULL, NULL, NULL, NULL};
+    pysimd_vec_binop_t op = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On|O", kwlist,
+                                     &param_other, &param_width, &param_out)) {
         return NULL;
     }
-
-    size_t actual_width = (size_t)param_width;
-    if (actual_width != 1 && actual_width != 2 && actual_width != 4 && actual_width != 8) {
-        PyErr_Format(SimdError, "The width '%zu' is not supported for method 'as_tuple'", actual_width);
+    op = pysimd_width_kernel(pysimd_lane_is_unsigned(self->lane, param_width) ? unsigned_kernels : signed_kernels,
+                             param_width, 0, "absdiff");
+    if (op == NULL) {
         return NULL;
     }
-    size_t n_members = self->vec.size / actual_width;
-    tuple_to_give = PyTuple_New(n_members);
+    return SimdObject_apply_binop(self, param_other, param_out, op);
+}
 
-    if ((PyTypeObject*)param_type == &PyLong_Type) {
-        if (actual_width == 1) {
-            char* reader = (char*)(self->vec.data);
-            for (size_t i = 0; i < n_members; ++i) {
-                PyObject* to_put = PyLong_FromLong(reader[i]);
-                if (to_put == NULL) {
-                    Py_DECREF(tuple_to_give);
-                    PyErr_Format(PyExc_SystemError, "Internal object failure line: %u", __LINE__);
-                    return NULL;
-                }
-                PyTuple_SET_ITEM(tuple_to_give, i, to_put);
-            }
-        } else if (actual_width == 2) {
-            short* reader = (short*)(self->vec.data);
-            for (size_t i = 0; i < n_members; ++i) {
-                PyObject* to_put = PyLong_FromLong(reader[i]);
-                if (to_put == NULL) {
-                    Py_DECREF(tuple_to_give);
-                    PyErr_Format(PyExc_SystemError, "Internal object failure line: %u", __LINE__);
-                    return NULL;
-                }
-                PyTuple_SET_ITEM(tuple_to_give, i, to_put);
-            }
-        } else if (actual_width == 4) {
-            int* reader = (int*)(self->vec.data);
-            for (size_t i = 0; i < n_members; ++i) {
-                PyObject* to_put = PyLong_FromLong(reader[i]);
-                if (to_put == NULL) {
-                    Py_DECREF(tuple_to_give);
-                    PyErr_Format(PyExc_SystemError, "Internal object failure line: %u", __LINE__);
-                    return NULL;
-                }
-                PyTuple_SET_ITEM(tuple_to_give, i, to_put);
-            }
-        } else if (actual_width == 8) {
-            long long* reader = (long long*)(self->vec.data);
-            for (size_t i = 0; i < n_members; ++i) {
-                PyObject* to_put = PyLong_FromLongLong(reader[i]);
-                if (to_put == NULL) {
-                    Py_DECREF(tuple_to_give);
-                    PyErr_Format(PyExc_SystemError, "Internal object failure line: %u", __LINE__);
-                    return NULL;
-                }
-                PyTuple_SET_ITEM(tuple_to_give, i, to_put);
-            }
-        } else {
-            Py_FatalError("Should not reach this point in 'as_tuple', width error");
-        }
-    } else if ((PyTypeObject*)param_type == &PyFloat_Type) {
-        if (actual_width == 4) {
-            float* reader = (float*)(self->vec.data);
-            for (size_t i = 0; i < n_members; ++i) {
-                PyObject* to_put = PyFloat_FromDouble((double)reader[i]);
-                if (to_put == NULL) {
-                    Py_DECREF(tuple_to_give);
-                    PyErr_Format(PyExc_SystemError, "Internal object failure line: %u", __LINE__);
-                    return NULL;
-                }
-                PyTuple_SET_ITEM(tuple_to_give, i, to_put);
-            }
-        } else if (actual_width == 8) {
-            double* reader = (double*)(self->vec.data);
-            for (size_t i = 0; i < n_members; ++i) {
-                PyObject* to_put = PyFloat_FromDouble(reader[i]);
-                if (to_put == NULL) {
-                    Py_DECREF(tuple_to_give);
-                    PyErr_Format(PyExc_SystemError, "Internal object failure line: %u", __LINE__);
-                    return NULL;
-                }
-                PyTuple_SET_ITEM(tuple_to_give, i, to_put);
-            }
-        } else {
-            if (actual_width == 1 || actual_width == 2) {
-                PyErr_Format(SimdError, "The width '%zu' is not supported for floats for 'as_tuple'", actual_width);
-                Py_DECREF(tuple_to_give);
-                return NULL;
-            } else {
-                Py_FatalError("Should not reach invalid state for float in 'as_tuple");
-            }
-        }
+/* Runs a counting kernel over the vector and other, which must be a vector, without
+ * the GIL for large vectors. Returns NULL with an exception set on failure.
+ */
+static PyObject* SimdObject_run_count(SimdObject* self, PyObject* other, pysimd_vec_count_t kernel)
+{
+    SimdObject* v2 = NULL;
+    uint64_t total = 0;
+    if (!PyObject_TypeCheck(other, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector, got type '%s'", other->ob_type->tp_name);
+        return NULL;
+    }
+    v2 = (SimdObject*)other;
+    if (PYSIMD_MIN_VEC_SIZE(&(self->vec), &(v2->vec)) < PYSIMD_NOGIL_MIN) {
+        total = kernel(&(self->vec), &(v2->vec));
     } else {
-        Py_DECREF(tuple_to_give);
-        PyErr_Format(SimdError, "The type '%s' is not supported for method 'as_tuple'", param_type->ob_type->tp_name);
+        self->exports += 1;
+        v2->exports += 1;
+        Py_BEGIN_ALLOW_THREADS
+        total = pysimd_count_run(kernel, &(self->vec), &(v2->vec));
+        Py_END_ALLOW_THREADS
+        self->exports -= 1;
+        v2->exports -= 1;
+    }
+    return PyLong_FromUnsignedLongLong((unsigned long long)total);
+}
+
+// Sum of the absolute differences of the bytes of two vectors, as unsigned bytes
+static PyObject*
+SimdObject_sad(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"other", NULL};
+    PyObject* param_other = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", kwlist, &param_other)) {
         return NULL;
     }
-    return tuple_to_give;
+    return SimdObject_run_count(self, param_other, pysimd_dispatch.sad_u8);
 }
 
-static PyObject *
-SimdObject_clear(SimdObject *self, PyObject *Py_UNUSED(ignored))
+// Parses the arguments shared by the bitwise methods, which do not depend on the lane width
+static PyObject* SimdObject_bitop_method(SimdObject *self, PyObject *args, PyObject *kwargs, pysimd_vec_binop_t op)
 {
-    pysimd_vec_clear_data(&(self->vec));
-    Py_INCREF(Py_None);
-    return Py_None;
+    static char *kwlist[] = {"other", "out", NULL};
+    PyObject* param_other = NULL;
+    PyObject* param_out = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, &param_other, &param_out)) {
+        return NULL;
+    }
+    return SimdObject_apply_binop(self, param_other, param_out, op);
 }
 
-static PyMethodDef SimdObject_methods[] = {
-    {"clear", (PyCFunction) SimdObject_clear, METH_NOARGS,
-     "Sets all bytes in the vector to 0"
-    },
-    {"size", (PyCFunction) SimdObject_size, METH_NOARGS,
-     "Returns the current size of the vector"
-    },
-    {"resize", (PyCFunction) SimdObject_resize, METH_VARARGS | METH_KEYWORDS,
-    "Resizes the vector to the desired capacity"
-    },
-    {"add", (PyCFunction) SimdObject_add, METH_VARARGS | METH_KEYWORDS,
-    "Adds a vector into another vector, without creating a new vector"
-    },
-    {"fadd", (PyCFunction) SimdObject_fadd, METH_VARARGS | METH_KEYWORDS,
-    "Adds a vector into another vector as floating point numbers"
-    },
-    {"sub", (PyCFunction) SimdObject_sub, METH_VARARGS | METH_KEYWORDS,
-    "Subtracts a vector from another vector, without creating a new vector"
-    },
-    {"fsub", (PyCFunction) SimdObject_fsub, METH_VARARGS | METH_KEYWORDS,
-    "Subtracts a vector from another vector as floating point numbers"
+static PyObject*
+SimdObject_and(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_bitop_method(self, args, kwargs, pysimd_dispatch.and_);
+}
+
+static PyObject*
+SimdObject_or(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_bitop_method(self, args, kwargs, pysimd_dispatch.or_);
+}
+
+static PyObject*
+SimdObject_xor(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_bitop_method(self, args, kwargs, pysimd_dispatch.xor_);
+}
+
+// The bits of the vector that are not set in other
+static PyObject*
+SimdObject_andnot(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_bitop_method(self, args, kwargs, pysimd_dispatch.andnot);
+}
+
+static PyObject*
+SimdObject_not(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"out", NULL};
+    PyObject* param_out = Py_None;
+    SimdObject* dst = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist, &param_out)) {
+        return NULL;
+    }
+    dst = SimdObject_result_target(self, param_out, self->vec.size);
+    if (dst == NULL) {
+        return NULL;
+    }
+    SimdObject_run_unop(pysimd_dispatch.not_, dst, self);
+    if (param_out == Py_None) {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+    Py_INCREF(param_out);
+    return param_out;
+}
+
+// Number of set bits in the vector
+static PyObject*
+SimdObject_popcount(SimdObject *self, PyObject *Py_UNUSED(ignored))
+{
+    return SimdObject_run_count(self, (PyObject*)self, pysimd_dispatch.popcount);
+}
+
+// Number of bits set in both vectors, without writing their intersection anywhere
+static PyObject*
+SimdObject_and_popcount(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"other", NULL};
+    PyObject* param_other = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", kwlist, &param_other)) {
+        return NULL;
+    }
+    return SimdObject_run_count(self, param_other, pysimd_dispatch.and_popcount);
+}
+
+/* Places an integer bound among the values of an integer lane type, numbered from 0
+ * for the smallest one up. Returns 0 with the number of the bound in key when it is
+ * one of those values, -1 or 1 when it is below or above all of them, and 2 with an
+ * exception set when it is not an integer.
+ */
+static int pysimd_filter_int_place(PyObject* bound, struct pysimd_lane_t lane, uint64_t* key)
+{
+    const unsigned bits = (unsigned)(lane.width * 8);
+    const uint64_t key_max = bits == 64 ? UINT64_MAX : ((uint64_t)1 << bits) - 1;
+    int overflow = 0;
+    long long value = 0;
+    PyObject* index = PyNumber_Index(bound);
+    if (index == NULL) {
+        return 2;
+    }
+    value = PyLong_AsLongLongAndOverflow(index, &overflow);
+    if (value == -1 && PyErr_Occurred()) {
+        Py_DECREF(index);
+        return 2;
+    }
+    if (lane.kind == PYSIMD_LANE_UINT) {
+        if (overflow > 0 && bits == 64) {
+            unsigned long long large = PyLong_AsUnsignedLongLong(index);
+            Py_DECREF(index);
+            if (large == (unsigned long long)-1 && PyErr_Occurred()) {
+                PyErr_Clear();
+                return 1;
+            }
+            *key = large;
+            return 0;
+        }
+        Py_DECREF(index);
+        if (overflow < 0 || (overflow == 0 && value < 0)) {
+            return -1;
+        }
+        if (overflow > 0 || (uint64_t)value > key_max) {
+            return 1;
+        }
+        *key = (uint64_t)value;
+        return 0;
+    }
+    Py_DECREF(index);
+    if (overflow != 0) {
+        return overflow;
+    }
+    if (value < -(long long)(key_max >> 1) - 1) {
+        return -1;
+    }
+    if (value > (long long)(key_max >> 1)) {
+        return 1;
+    }
+    *key = (uint64_t)value + ((uint64_t)1 << (bits - 1));
+    return 0;
+}
+
+/* Folds the gt, lt and eq bounds of an integer filter into a range of lanes. Returns 1
+ * when some lane can pass, 0 when none can, and -1 with an exception set on bad bounds.
+ */
+static int pysimd_filter_int_range(PyObject* gt, PyObject* lt, PyObject* eq, struct pysimd_lane_t lane,
+                                   struct pysimd_filter_range* range)
+{
+    const unsigned bits = (unsigned)(lane.width * 8);
+    const uint64_t key_max = bits == 64 ? UINT64_MAX : ((uint64_t)1 << bits) - 1;
+    const uint64_t bias = lane.kind == PYSIMD_LANE_UINT ? 0 : (uint64_t)1 << (bits - 1);
+    uint64_t lo = 0;
+    uint64_t hi = key_max;
+    uint64_t key = 0;
+    int place = 0;
+    if (gt != Py_None) {
+        place = pysimd_filter_int_place(gt, lane, &key);
+        if (place == 2) {
+            return -1;
+        }
+        if (place == 1 || (place == 0 && key == key_max)) {
+            return 0;
+        }
+        if (place == 0 && key + 1 > lo) {
+            lo = key + 1;
+        }
+    }
+    if (lt != Py_None) {
+        place = pysimd_filter_int_place(lt, lane, &key);
+        if (place == 2) {
+            return -1;
+        }
+        if (place == -1 || (place == 0 && key == 0)) {
+            return 0;
+        }
+        if (place == 0 && key - 1 < hi) {
+            hi = key - 1;
+        }
+    }
+    if (eq != Py_None) {
+        place = pysimd_filter_int_place(eq, lane, &key);
+        if (place == 2) {
+            return -1;
+        }
+        if (place != 0) {
+            return 0;
+        }
+        lo = key > lo ? key : lo;
+        hi = key < hi ? key : hi;
+    }
+    if (lo > hi) {
+        return 0;
+    }
+    range->lo.u = lo - bias;
+    range->hi.u = hi - bias;
+    return 1;
+}
+
+// The smallest value of a float lane type above bound, which is neither NaN nor infinity
+static double pysimd_float_above(double bound, size_t width)
+{
+    float narrowed = 0.0f;
+    if (width == 8) {
+        return nextafter(bound, HUGE_VAL);
+    }
+    if (bound < -FLT_MAX) {
+        return -FLT_MAX;
+    }
+    if (bound >= FLT_MAX) {
+        return HUGE_VAL;
+    }
+    narrowed = (float)bound;
+    return (double)narrowed > bound ? narrowed : nextafterf(narrowed, HUGE_VALF);
+}
+
+// The largest value of a float lane type below bound, which is neither NaN nor minus infinity
+static double pysimd_float_below(double bound, size_t width)
+{
+    float narrowed = 0.0f;
+    if (width == 8) {
+        return nextafter(bound, -HUGE_VAL);
+    }
+    if (bound > FLT_MAX) {
+        return FLT_MAX;
+    }
+    if (bound <= -FLT_MAX) {
+        return -HUGE_VAL;
+    }
+    narrowed = (float)bound;
+    return (double)narrowed < bound ? narrowed : nextafterf(narrowed, -HUGE_VALF);
+}
+
+// Same as pysimd_filter_int_range for float lanes, where the strict bounds become inclusive ones
+static int pysimd_filter_float_range(PyObject* gt, PyObject* lt, PyObject* eq, struct pysimd_lane_t lane,
+                                     struct pysimd_filter_range* range)
+{
+    double lo = -HUGE_VAL;
+    double hi = HUGE_VAL;
+    double value = 0.0;
+    if (gt != Py_None) {
+        value = PyFloat_AsDouble(gt);
+        if (value == -1.0 && PyErr_Occurred()) {
+            return -1;
+        }
+        if (isnan(value) || value == HUGE_VAL) {
+            return 0;
+        }
+        value = pysimd_float_above(value, lane.width);
+        lo = value > lo ? value : lo;
+    }
+    if (lt != Py_None) {
+        value = PyFloat_AsDouble(lt);
+        if (value == -1.0 && PyErr_Occurred()) {
+            return -1;
+        }
+        if (isnan(value) || value == -HUGE_VAL) {
+            return 0;
+        }
+        value = pysimd_float_below(value, lane.width);
+        hi = value < hi ? value : hi;
+    }
+    if (eq != Py_None) {
+        value = PyFloat_AsDouble(eq);
+        if (value == -1.0 && PyErr_Occurred()) {
+            return -1;
+        }
+        if (isnan(value)) {
+            return 0;
+        }
+        if (lane.width == 4 && !isinf(value) && (fabs(value) > FLT_MAX || (double)(float)value != value)) {
+            return 0;
+        }
+        lo = value > lo ? value : lo;
+        hi = value < hi ? value : hi;
+    }
+    if (lo > hi) {
+        return 0;
+    }
+    range->lo.f = lo;
+    range->hi.f = hi;
+    return 1;
+}
+
+enum pysimd_cmp_op {
+    PYSIMD_CMP_EQ,
+    PYSIMD_CMP_NE,
+    PYSIMD_CMP_LT,
+    PYSIMD_CMP_LE,
+    PYSIMD_CMP_GT,
+    PYSIMD_CMP_GE
+};
+
+static int pysimd_cmp_op_parse(const char* name, enum pysimd_cmp_op* op)
+{
+    static const char* names[] = {"eq", "ne", "lt", "le", "gt", "ge"};
+    size_t i = 0;
+    for (; i < sizeof(names) / sizeof(names[0]); ++i) {
+        if (strcmp(name, names[i]) == 0) {
+            *op = (enum pysimd_cmp_op)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Repeats a lane value over the PYSIMD_CMP_BROADCAST_SIZE bytes of block
+static void pysimd_lane_broadcast(union pysimd_lane_value value, struct pysimd_lane_t lane, unsigned char* block)
+{
+    union {
+        uint8_t u8;
+        uint16_t u16;
+        uint32_t u32;
+        uint64_t u64;
+        float f32;
+        double f64;
+    } bits;
+    size_t i = 0;
+    if (lane.kind == PYSIMD_LANE_FLOAT) {
+        if (lane.width == 4) {
+            bits.f32 = (float)value.f;
+        } else {
+            bits.f64 = value.f;
+        }
+    } else {
+        switch (lane.width) {
+            case 1: bits.u8 = (uint8_t)value.u; break;
+            case 2: bits.u16 = (uint16_t)value.u; break;
+            case 4: bits.u32 = (uint32_t)value.u; break;
+            default: bits.u64 = value.u; break;
+        }
+    }
+    for (; i < PYSIMD_CMP_BROADCAST_SIZE; i += lane.width) {
+        memcpy(block + i, &bits, lane.width);
+    }
+}
+
+/* Fills the first PYSIMD_CMP_BROADCAST_SIZE bytes of block with a scalar, as a lane of
+ * the given type. Returns 1 when done, 0 when the scalar is below or above every value
+ * of an integer lane type, with place set to -1 or 1, and -1 with an exception set when
+ * the scalar is not a number of the right kind.
+ */
+static int pysimd_cmp_broadcast(PyObject* scalar, struct pysimd_lane_t lane, unsigned char* block, int* place)
+{
+    union pysimd_lane_value value;
+    uint64_t key = 0;
+    if (lane.kind == PYSIMD_LANE_FLOAT) {
+        value.f = PyFloat_AsDouble(scalar);
+        if (value.f == -1.0 && PyErr_Occurred()) {
+            return -1;
+        }
+    } else {
+        *place = pysimd_filter_int_place(scalar, lane, &key);
+        if (*place == 2) {
+            return -1;
+        }
+        if (*place != 0) {
+            return 0;
+        }
+        // Keys are biased to be unsigned, taking the bias back out gives two's complement bits
+        value.u = lane.kind == PYSIMD_LANE_INT ? key - ((uint64_t)1 << (lane.width * 8 - 1)) : key;
+    }
+    pysimd_lane_broadcast(value, lane, block);
+    return 1;
+}
+
+/* The lane type values are compared as at a width, the element type of the vector when
+ * it has that width, and signed integers of that width otherwise.
+ */
+static struct pysimd_lane_t pysimd_cmp_lane(struct pysimd_lane_t lane, size_t width)
+{
+    struct pysimd_lane_t result;
+    if (lane.kind == PYSIMD_LANE_FLOAT && lane.width == width) {
+        return lane;
+    }
+    result.kind = pysimd_lane_is_unsigned(lane, (Py_ssize_t)width) ? PYSIMD_LANE_UINT : PYSIMD_LANE_INT;
+    result.width = width;
+    return result;
+}
+
+// Position of the kernel for a lane type, in kernels ordered i8, i16, i32, i64, f32, f64
+static size_t pysimd_lane_kernel_index(struct pysimd_lane_t lane)
+{
+    if (lane.kind == PYSIMD_LANE_FLOAT) {
+        return lane.width == 4 ? 4 : 5;
+    }
+    return lane.width == 1 ? 0 : lane.width == 2 ? 1 : lane.width == 4 ? 2 : 3;
+}
+
+/* Compares the lanes of the vector to those of another vector, or to a number, with
+ * one of eq, ne, lt, le, gt or ge. Lanes are compared as the element type of the vector
+ * when it has the given width, and as signed integers otherwise. Returns a vector of
+ * lane masks, all ones where the comparison holds, or with packed set, one bit per lane.
+ */
+static PyObject*
+SimdObject_cmp(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"other", "op", "width", "packed", NULL};
+    PyObject* param_other = NULL;
+    const char* param_op = NULL;
+    Py_ssize_t param_width = 0;
+    int param_packed = 0;
+    const pysimd_vec_cmp_t eq_kernels[] = PYSIMD_DISPATCH_KERNELS(cmpeq);
+    const pysimd_vec_cmp_t gt_kernels[] = PYSIMD_DISPATCH_KERNELS(cmpgt);
+    const pysimd_vec_cmp_t gtu_kernels[] = {pysimd_dispatch.cmpgt_u8, pysimd_dispatch.cmpgt_u16,
+                                            pysimd_dispatch.cmpgt_u32, pysimd_dispatch.cmpgt_u64};
+    const pysimd_vec_pack_mask_t pack_kernels[] = {pysimd_dispatch.pack_mask_i8, pysimd_dispatch.pack_mask_i16,
+                                                   pysimd_dispatch.pack_mask_i32, pysimd_dispatch.pack_mask_i64};
+    unsigned char block_raw[PYSIMD_CMP_BROADCAST_SIZE + PYSIMD_ALLOC_ALIGN];
+    unsigned char* block = (unsigned char*)(((uintptr_t)block_raw + PYSIMD_ALLOC_ALIGN - 1) &
+                                            ~(uintptr_t)(PYSIMD_ALLOC_ALIGN - 1));
+    struct pysimd_vec_t broadcast = {PYSIMD_CMP_BROADCAST_SIZE, block, 0};
+    const struct pysimd_vec_t* v2 = &broadcast;
+    SimdObject* other = NULL;
+    struct pysimd_lane_t lane;
+    struct pysimd_lane_t result_lane;
+    enum pysimd_cmp_op op = PYSIMD_CMP_EQ;
+    pysimd_vec_cmp_t kernel = NULL;
+    pysimd_vec_cmp_t gt_kernel = NULL;
+    SimdObject* result = NULL;
+    size_t width_index = 0;
+    size_t kernel_index = 0;
+    size_t region = self->vec.size;
+    size_t n_lanes = 0;
+    size_t result_bytes = 0;
+    int flags = PYSIMD_CMP_BROADCAST;
+    int status = 1;
+    int place = 0;
+    int truth = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Osn|p", kwlist,
+                                     &param_other, &param_op, &param_width, &param_packed)) {
+        return NULL;
+    }
+    if (!pysimd_cmp_op_parse(param_op, &op)) {
+        PyErr_Format(SimdError, "Unrecognized comparison: '%s', expected one of eq, ne, lt, le, gt or ge", param_op);
+        return NULL;
+    }
+    if (param_width != 1 && param_width != 2 && param_width != 4 && param_width != 8) {
+        PyErr_Format(SimdError, "Unrecognized width: %zu for cmp operation", (size_t)param_width);
+        return NULL;
+    }
+    width_index = param_width == 1 ? 0 : param_width == 2 ? 1 : param_width == 4 ? 2 : 3;
+    lane = pysimd_cmp_lane(self->lane, (size_t)param_width);
+    kernel_index = pysimd_lane_kernel_index(lane);
+    gt_kernel = lane.kind == PYSIMD_LANE_UINT ? gtu_kernels[width_index] : gt_kernels[kernel_index];
+    switch (op) {
+        case PYSIMD_CMP_EQ: kernel = eq_kernels[kernel_index]; break;
+        case PYSIMD_CMP_NE: kernel = eq_kernels[kernel_index]; flags |= PYSIMD_CMP_NEGATE; break;
+        case PYSIMD_CMP_GT: kernel = gt_kernel; break;
+        case PYSIMD_CMP_LT: kernel = gt_kernel; flags |= PYSIMD_CMP_SWAP; break;
+        case PYSIMD_CMP_LE:
+        case PYSIMD_CMP_GE:
+            // Float ge is not the negation of lt, as neither holds for NaN
+            if (lane.kind == PYSIMD_LANE_FLOAT) {
+                kernel = param_width == 4 ? pysimd_dispatch.cmpge_f32 : pysimd_dispatch.cmpge_f64;
+                flags |= op == PYSIMD_CMP_LE ? PYSIMD_CMP_SWAP : 0;
+            } else {
+                kernel = gt_kernel;
+                flags |= op == PYSIMD_CMP_LE ? PYSIMD_CMP_NEGATE : PYSIMD_CMP_SWAP | PYSIMD_CMP_NEGATE;
+            }
+            break;
+    }
+    if (PyObject_TypeCheck(param_other, &SimdObjectType)) {
+        other = (SimdObject*)param_other;
+        v2 = &(other->vec);
+        region = PYSIMD_MIN_VEC_SIZE(&(self->vec), v2);
+        flags &= ~PYSIMD_CMP_BROADCAST;
+    } else {
+        status = pysimd_cmp_broadcast(param_other, lane, block, &place);
+        if (status < 0) {
+            return NULL;
+        }
+    }
+    n_lanes = region / (size_t)param_width;
+    result_bytes = param_packed ? ((n_lanes + 7) / 8 + 15) & ~(size_t)15 : region;
+    result_lane.kind = param_packed ? PYSIMD_LANE_UINT : PYSIMD_LANE_INT;
+    result_lane.width = param_packed ? 1 : (size_t)param_width;
+    result = SimdObject_make(result_bytes, result_lane);
+    if (result == NULL) {
+        return NULL;
+    }
+    if (status == 0) {
+        // A number outside the range of the lanes compares the same way with all of them
+        truth = op == PYSIMD_CMP_NE || ((op == PYSIMD_CMP_LT || op == PYSIMD_CMP_LE) ? place > 0 :
+                                        (op == PYSIMD_CMP_GT || op == PYSIMD_CMP_GE) ? place < 0 : 0);
+        memset(result->vec.data, 0, result_bytes);
+        if (!truth) {
+            return (PyObject*)result;
+        }
+        if (!param_packed) {
+            memset(result->vec.data, 0xff, result_bytes);
+        } else {
+            memset(result->vec.data, 0xff, n_lanes / 8);
+            if (n_lanes % 8) {
+                result->vec.data[n_lanes / 8] = (unsigned char)((1u << (n_lanes % 8)) - 1);
+            }
+        }
+        return (PyObject*)result;
+    }
+    if (param_packed) {
+        memset(result->vec.data, 0, result_bytes);
+    }
+    if (region < PYSIMD_NOGIL_MIN) {
+        pysimd_cmp_run(kernel, param_packed ? pack_kernels[width_index] : NULL, (size_t)param_width, flags,
+                       result->vec.data, &(self->vec), v2, region);
+    } else {
+        self->exports += 1;
+        if (other != NULL) {
+            other->exports += 1;
+        }
+        Py_BEGIN_ALLOW_THREADS
+        pysimd_cmp_run(kernel, param_packed ? pack_kernels[width_index] : NULL, (size_t)param_width, flags,
+                       result->vec.data, &(self->vec), v2, region);
+        Py_END_ALLOW_THREADS
+        self->exports -= 1;
+        if (other != NULL) {
+            other->exports -= 1;
+        }
+    }
+    return (PyObject*)result;
+}
+
+enum pysimd_search_op {
+    PYSIMD_SEARCH_FIND,
+    PYSIMD_SEARCH_RFIND,
+    PYSIMD_SEARCH_COUNT
+};
+
+// Parses the arguments shared by find, rfind and count, then runs the kernel for the width
+static PyObject* SimdObject_search_method(SimdObject *self, PyObject *args, PyObject *kwargs,
+                                          enum pysimd_search_op op, const char* method)
+{
+    static char *kwlist[] = {"value", "width", NULL};
+    PyObject* param_value = NULL;
+    Py_ssize_t param_width = 0;
+    const pysimd_vec_search_t find_kernels[] = PYSIMD_DISPATCH_KERNELS(find);
+    const pysimd_vec_search_t rfind_kernels[] = PYSIMD_DISPATCH_KERNELS(rfind);
+    const pysimd_vec_search_t count_kernels[] = PYSIMD_DISPATCH_KERNELS(count);
+    unsigned char block_raw[PYSIMD_CMP_BROADCAST_SIZE + PYSIMD_ALLOC_ALIGN];
+    unsigned char* block = (unsigned char*)(((uintptr_t)block_raw + PYSIMD_ALLOC_ALIGN - 1) &
+                                            ~(uintptr_t)(PYSIMD_ALLOC_ALIGN - 1));
+    pysimd_vec_search_t kernel = NULL;
+    struct pysimd_lane_t lane;
+    size_t kernel_index = 0;
+    size_t found = 0;
+    int status = 0;
+    int place = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On", kwlist, &param_value, &param_width)) {
+        return NULL;
+    }
+    if (param_width != 1 && param_width != 2 && param_width != 4 && param_width != 8) {
+        PyErr_Format(SimdError, "Unrecognized width: %zu for %s operation", (size_t)param_width, method);
+        return NULL;
+    }
+    lane = pysimd_cmp_lane(self->lane, (size_t)param_width);
+    kernel_index = pysimd_lane_kernel_index(lane);
+    kernel = op == PYSIMD_SEARCH_FIND ? find_kernels[kernel_index] :
+             op == PYSIMD_SEARCH_RFIND ? rfind_kernels[kernel_index] : count_kernels[kernel_index];
+    status = pysimd_cmp_broadcast(param_value, lane, block, &place);
+    if (status < 0) {
+        return NULL;
+    }
+    if (status == 0) {
+        // No lane can hold a number outside the range of the lane type
+        return op == PYSIMD_SEARCH_COUNT ? PyLong_FromLong(0) : PyLong_FromLong(-1);
+    }
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        found = op == PYSIMD_SEARCH_COUNT ? pysimd_search_count_run(kernel, &(self->vec), block) :
+                kernel(&(self->vec), block);
+    } else {
+        self->exports += 1;
+        Py_BEGIN_ALLOW_THREADS
+        found = op == PYSIMD_SEARCH_COUNT ? pysimd_search_count_run(kernel, &(self->vec), block) :
+                kernel(&(self->vec), block);
+        Py_END_ALLOW_THREADS
+        self->exports -= 1;
+    }
+    if (op == PYSIMD_SEARCH_COUNT) {
+        return PyLong_FromSize_t(found);
+    }
+    if (found == self->vec.size / (size_t)param_width) {
+        return PyLong_FromLong(-1);
+    }
+    return PyLong_FromSize_t(found);
+}
+
+/* Returns the index of the first lane of the given width equal to a number, or -1 when
+ * there is none. Lanes are compared as the element type of the vector when it has that
+ * width, and as signed integers otherwise.
+ */
+static PyObject*
+SimdObject_find(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_search_method(self, args, kwargs, PYSIMD_SEARCH_FIND, "find");
+}
+
+// Returns the index of the last lane equal to a number, or -1, like find
+static PyObject*
+SimdObject_rfind(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_search_method(self, args, kwargs, PYSIMD_SEARCH_RFIND, "rfind");
+}
+
+// Returns the number of lanes equal to a number, compared like find
+static PyObject*
+SimdObject_count(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_search_method(self, args, kwargs, PYSIMD_SEARCH_COUNT, "count");
+}
+
+/* Returns the index of the first lane equal to any number of a sequence, or -1 when
+ * there is none. Numbers no lane can hold are left out of the search.
+ */
+static PyObject*
+SimdObject_find_any(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"values", "width", NULL};
+    PyObject* param_values = NULL;
+    Py_ssize_t param_width = 0;
+    const pysimd_vec_find_any_t kernels[] = PYSIMD_DISPATCH_KERNELS(find_any);
+    pysimd_vec_find_any_t kernel = NULL;
+    PyObject* values = NULL;
+    unsigned char* blocks = NULL;
+    size_t blocks_capacity = 0;
+    struct pysimd_lane_t lane;
+    size_t n_values = 0;
+    size_t found = 0;
+    Py_ssize_t i = 0;
+    int status = 0;
+    int place = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On", kwlist, &param_values, &param_width)) {
+        return NULL;
+    }
+    if (param_width != 1 && param_width != 2 && param_width != 4 && param_width != 8) {
+        PyErr_Format(SimdError, "Unrecognized width: %zu for find_any operation", (size_t)param_width);
+        return NULL;
+    }
+    lane = pysimd_cmp_lane(self->lane, (size_t)param_width);
+    kernel = kernels[pysimd_lane_kernel_index(lane)];
+    values = PySequence_Fast(param_values, "Expected a sequence of numbers for 'values'");
+    if (values == NULL) {
+        return NULL;
+    }
+    if (PySequence_Fast_GET_SIZE(values) == 0) {
+        Py_DECREF(values);
+        return PyLong_FromLong(-1);
+    }
+    blocks = pysimd_alloc((size_t)PySequence_Fast_GET_SIZE(values) * PYSIMD_CMP_BROADCAST_SIZE, 0, &blocks_capacity);
+    if (blocks == NULL) {
+        Py_DECREF(values);
+        return PyErr_NoMemory();
+    }
+    for (; i < PySequence_Fast_GET_SIZE(values); ++i) {
+        status = pysimd_cmp_broadcast(PySequence_Fast_GET_ITEM(values, i), lane,
+                                      blocks + n_values * PYSIMD_CMP_BROADCAST_SIZE, &place);
+        if (status < 0) {
+            pysimd_free(blocks, blocks_capacity);
+            Py_DECREF(values);
+            return NULL;
+        }
+        n_values += (size_t)status;
+    }
+    Py_DECREF(values);
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        found = pysimd_find_any_run(kernel, (size_t)param_width, &(self->vec), blocks, n_values);
+    } else {
+        self->exports += 1;
+        Py_BEGIN_ALLOW_THREADS
+        found = pysimd_find_any_run(kernel, (size_t)param_width, &(self->vec), blocks, n_values);
+        Py_END_ALLOW_THREADS
+        self->exports -= 1;
+    }
+    pysimd_free(blocks, blocks_capacity);
+    if (found == self->vec.size / (size_t)param_width) {
+        return PyLong_FromLong(-1);
+    }
+    return PyLong_FromSize_t(found);
+}
+
+/* Packs the lanes of a given width that pass every given bound, gt and lt exclusive,
+ * into a new vector, zero padded to a multiple of 16 bytes. Returns the new vector and
+ * the number of lanes in it. Lanes are compared as the element type of the vector when
+ * it has that width, and as signed integers otherwise.
+ */
+static PyObject*
+SimdObject_filter(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"width", "gt", "lt", "eq", NULL};
+    Py_ssize_t param_width = 0;
+    PyObject* param_gt = Py_None;
+    PyObject* param_lt = Py_None;
+    PyObject* param_eq = Py_None;
+    const pysimd_vec_filter_t kernels[] = PYSIMD_DISPATCH_KERNELS(filter);
+    struct pysimd_lane_t lane = self->lane;
+    struct pysimd_filter_range range;
+    pysimd_vec_filter_t kernel = NULL;
+    SimdObject* survivors = NULL;
+    size_t kept = 0;
+    size_t kept_bytes = 0;
+    size_t padded_bytes = 0;
+    int status = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|OOO", kwlist,
+                                     &param_width, &param_gt, &param_lt, &param_eq)) {
+        return NULL;
+    }
+    if (param_width != 1 && param_width != 2 && param_width != 4 && param_width != 8) {
+        PyErr_Format(SimdError, "Unrecognized width: %zu for filter operation", (size_t)param_width);
+        return NULL;
+    }
+    if (param_gt == Py_None && param_lt == Py_None && param_eq == Py_None) {
+        PyErr_Format(SimdError, "filter needs at least one of 'gt', 'lt' or 'eq'");
+        return NULL;
+    }
+    if (lane.kind == PYSIMD_LANE_FLOAT && lane.width == (size_t)param_width) {
+        status = pysimd_filter_float_range(param_gt, param_lt, param_eq, lane, &range);
+        kernel = param_width == 4 ? kernels[4] : kernels[5];
+    } else {
+        lane.kind = pysimd_lane_is_unsigned(self->lane, param_width) ? PYSIMD_LANE_UINT : PYSIMD_LANE_INT;
+        lane.width = (size_t)param_width;
+        status = pysimd_filter_int_range(param_gt, param_lt, param_eq, lane, &range);
+        kernel = param_width == 1 ? kernels[0] : param_width == 2 ? kernels[1] : param_width == 4 ? kernels[2] : kernels[3];
+    }
+    if (status < 0) {
+        return NULL;
+    }
+    survivors = SimdObject_make(self->vec.size, lane);
+    if (survivors == NULL) {
+        return NULL;
+    }
+    if (status > 0) {
+        if (self->vec.size < PYSIMD_NOGIL_MIN) {
+            kept = kernel(survivors->vec.data, &(self->vec), &range);
+        } else {
+            self->exports += 1;
+            Py_BEGIN_ALLOW_THREADS
+            kept = pysimd_filter_run(kernel, lane.width, survivors->vec.data, &(self->vec), &range);
+            Py_END_ALLOW_THREADS
+            self->exports -= 1;
+        }
+    }
+    kept_bytes = kept * lane.width;
+    padded_bytes = (kept_bytes + 15) & ~(size_t)15;
+    memset(survivors->vec.data + kept_bytes, 0, padded_bytes - kept_bytes);
+    survivors->vec.size = padded_bytes;
+    return Py_BuildValue("(Nn)", (PyObject*)survivors, (Py_ssize_t)kept);
+}
+
+/* Writes the running totals of the lanes of a given width, in place or into out. Lanes
+ * are added as floats when the vector has float lanes of that width, and as integers
+ * that wrap around otherwise. With exclusive=True a lane is left out of its own total.
+ * When flags are given, the total starts again from 0 at each lane whose lane in flags
+ * is not 0, such as the lane masks returned by cmp().
+ */
+static PyObject*
+SimdObject_cumsum(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"width", "exclusive", "flags", "out", NULL};
+    Py_ssize_t param_width = 0;
+    int param_exclusive = 0;
+    PyObject* param_flags = Py_None;
+    PyObject* param_out = Py_None;
+    struct pysimd_lane_t lane = self->lane;
+    pysimd_vec_scan_t kernel = NULL;
+    SimdObject* flags = NULL;
+    SimdObject* dst = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|pOO", kwlist,
+                                     &param_width, &param_exclusive, &param_flags, &param_out)) {
+        return NULL;
+    }
+    if (param_width != 4 && param_width != 8) {
+        PyErr_Format(SimdError, "Unrecognized width: %zu for cumsum operation", (size_t)param_width);
+        return NULL;
+    }
+    if (lane.kind == PYSIMD_LANE_FLOAT && lane.width == (size_t)param_width) {
+        kernel = param_width == 4 ? pysimd_dispatch.cumsum_f32 : pysimd_dispatch.cumsum_f64;
+    } else {
+        lane.kind = PYSIMD_LANE_UINT;
+        lane.width = (size_t)param_width;
+        kernel = param_width == 4 ? pysimd_dispatch.cumsum_i32 : pysimd_dispatch.cumsum_i64;
+    }
+    if (param_flags != Py_None) {
+        if (!PyObject_TypeCheck(param_flags, &SimdObjectType)) {
+            PyErr_Format(SimdError, "Expected vector for 'flags', got type '%s'", param_flags->ob_type->tp_name);
+            return NULL;
+        }
+        flags = (SimdObject*)param_flags;
+        if (flags->vec.size < self->vec.size) {
+            PyErr_Format(SimdError, "'flags' vector of size %zu is smaller than the %zu bytes operated on",
+                         flags->vec.size, self->vec.size);
+            return NULL;
+        }
+    }
+    dst = SimdObject_result_target(self, param_out, self->vec.size);
+    if (dst == NULL) {
+        return NULL;
+    }
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        pysimd_scan_run(kernel, lane, &(dst->vec), &(self->vec), flags != NULL ? &(flags->vec) : NULL, param_exclusive);
+    } else {
+        dst->exports += 1;
+        self->exports += 1;
+        if (flags != NULL) {
+            flags->exports += 1;
+        }
+        Py_BEGIN_ALLOW_THREADS
+        pysimd_scan_run(kernel, lane, &(dst->vec), &(self->vec), flags != NULL ? &(flags->vec) : NULL, param_exclusive);
+        Py_END_ALLOW_THREADS
+        dst->exports -= 1;
+        self->exports -= 1;
+        if (flags != NULL) {
+            flags->exports -= 1;
+        }
+    }
+    if (param_out == Py_None) {
+        Py_RETURN_NONE;
+    }
+    Py_INCREF(param_out);
+    return param_out;
+}
+
+/* Sorts the lanes of the vector in place, as the element type or the given type, which
+ * must be 4 or 8 bytes wide. NaNs sort after every other float. When a values vector is
+ * given, as many of its lanes of value_width bytes as there are keys move along with
+ * their keys, and equal keys keep their order.
+ */
+static PyObject*
+SimdObject_sort(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"type", "width", "values", "value_width", NULL};
+    PyObject* param_type = NULL;
+    Py_ssize_t param_width = 0;
+    PyObject* param_values = Py_None;
+    Py_ssize_t param_value_width = 0;
+    struct pysimd_lane_t lane = self->lane;
+    SimdObject* values = NULL;
+    size_t n_lanes = 0;
+    int status = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OnOn", kwlist,
+                                     &param_type, &param_width, &param_values, &param_value_width)) {
+        return NULL;
+    }
+    if (param_type != NULL && !pysimd_lane_from_args(param_type, param_width, &lane, "sort")) {
+        return NULL;
+    }
+    if (lane.width != 4 && lane.width != 8) {
+        PyErr_Format(SimdError, "The type '%s' is not supported for method 'sort'", pysimd_lane_name(lane));
+        return NULL;
+    }
+    if (!SimdObject_check_writable(self)) {
+        return NULL;
+    }
+    n_lanes = self->vec.size / lane.width;
+    if (param_values != Py_None) {
+        if (!PyObject_TypeCheck(param_values, &SimdObjectType)) {
+            PyErr_Format(SimdError, "Expected vector, got type '%s'", param_values->ob_type->tp_name);
+            return NULL;
+        }
+        values = (SimdObject*)param_values;
+        if (values == self) {
+            PyErr_SetString(SimdError, "sort cannot use the vector as its own values");
+            return NULL;
+        }
+        if (!SimdObject_check_writable(values)) {
+            return NULL;
+        }
+        if (param_value_width == 0) {
+            param_value_width = (Py_ssize_t)values->lane.width;
+        }
+        if (param_value_width != 1 && param_value_width != 2 && param_value_width != 4 && param_value_width != 8) {
+            PyErr_Format(SimdError, "Unrecognized width: %zu for sort operation", (size_t)param_value_width);
+            return NULL;
+        }
+        if (values->vec.size / (size_t)param_value_width < n_lanes) {
+            PyErr_Format(SimdError, "sort needs %zu values, the vector has %zu", n_lanes,
+                         values->vec.size / (size_t)param_value_width);
+            return NULL;
+        }
+    }
+    self->exports += 1;
+    if (values != NULL) {
+        values->exports += 1;
+    }
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        status = values == NULL ? pysimd_sort_run(self->vec.data, n_lanes, lane.kind, lane.width)
+                                : pysimd_sort_values_run(self->vec.data, n_lanes, lane.kind, lane.width,
+                                                         values->vec.data, (size_t)param_value_width);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        status = values == NULL ? pysimd_sort_run(self->vec.data, n_lanes, lane.kind, lane.width)
+                                : pysimd_sort_values_run(self->vec.data, n_lanes, lane.kind, lane.width,
+                                                         values->vec.data, (size_t)param_value_width);
+        Py_END_ALLOW_THREADS
+    }
+    self->exports -= 1;
+    if (values != NULL) {
+        values->exports -= 1;
+    }
+    if (status < 0) {
+        return PyErr_NoMemory();
+    }
+    Py_RETURN_NONE;
+}
+
+/* Returns a new vector of the u32 positions of the lanes in sorted order, equal lanes in
+ * the order they appear, zero padded to a multiple of 16 bytes. Lanes are read as the
+ * element type or the given type, which must be 4 or 8 bytes wide.
+ */
+static PyObject*
+SimdObject_argsort(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"type", "width", NULL};
+    PyObject* param_type = NULL;
+    Py_ssize_t param_width = 0;
+    struct pysimd_lane_t lane = self->lane;
+    struct pysimd_lane_t index_lane = {PYSIMD_LANE_UINT, 4};
+    SimdObject* positions = NULL;
+    int64_t* order = NULL;
+    size_t n_lanes = 0;
+    size_t padded_bytes = 0;
+    size_t i = 0;
+    int status = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|On", kwlist, &param_type, &param_width)) {
+        return NULL;
+    }
+    if (param_type != NULL && !pysimd_lane_from_args(param_type, param_width, &lane, "argsort")) {
+        return NULL;
+    }
+    if (lane.width != 4 && lane.width != 8) {
+        PyErr_Format(SimdError, "The type '%s' is not supported for method 'argsort'", pysimd_lane_name(lane));
+        return NULL;
+    }
+    n_lanes = self->vec.size / lane.width;
+    if (n_lanes > UINT32_MAX) {
+        PyErr_Format(SimdError, "argsort positions only go up to %zu lanes", (size_t)UINT32_MAX);
+        return NULL;
+    }
+    padded_bytes = (n_lanes * 4 + 15) & ~(size_t)15;
+    positions = SimdObject_make(padded_bytes, index_lane);
+    if (positions == NULL) {
+        return NULL;
+    }
+    order = (int64_t*)malloc((n_lanes > 0 ? n_lanes : 1) * sizeof(int64_t));
+    if (order == NULL) {
+        Py_DECREF(positions);
+        return PyErr_NoMemory();
+    }
+    self->exports += 1;
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        status = pysimd_argsort_run(order, self->vec.data, n_lanes, lane.kind, lane.width);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        status = pysimd_argsort_run(order, self->vec.data, n_lanes, lane.kind, lane.width);
+        Py_END_ALLOW_THREADS
+    }
+    self->exports -= 1;
+    if (status < 0) {
+        free(order);
+        Py_DECREF(positions);
+        return PyErr_NoMemory();
+    }
+    for (; i < n_lanes; ++i) {
+        ((uint32_t*)positions->vec.data)[i] = (uint32_t)order[i];
+    }
+    free(order);
+    memset(positions->vec.data + n_lanes * 4, 0, padded_bytes - n_lanes * 4);
+    return (PyObject*)positions;
+}
+
+/* Returns a new vector of every lane converted from one lane type to another, both
+ * given by name, zero padded to a multiple of 16 bytes. Integers saturate to the new
+ * type, floats are truncated toward zero into integers, and NaN becomes 0.
+ */
+static PyObject*
+SimdObject_convert(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"from_type", "to_type", NULL};
+    PyObject* param_from = NULL;
+    PyObject* param_to = NULL;
+    struct pysimd_lane_t from;
+    struct pysimd_lane_t to;
+    SimdObject* converted = NULL;
+    size_t n_lanes = 0;
+    size_t padded_bytes = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "UU", kwlist, &param_from, &param_to)) {
+        return NULL;
+    }
+    if (!pysimd_lane_from_args(param_from, 0, &from, "convert") ||
+        !pysimd_lane_from_args(param_to, 0, &to, "convert")) {
+        return NULL;
+    }
+    n_lanes = self->vec.size / from.width;
+    padded_bytes = (n_lanes * to.width + 15) & ~(size_t)15;
+    converted = SimdObject_make(padded_bytes, to);
+    if (converted == NULL) {
+        return NULL;
+    }
+    self->exports += 1;
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        pysimd_convert_run(from, to, converted->vec.data, &(self->vec));
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        pysimd_convert_run(from, to, converted->vec.data, &(self->vec));
+        Py_END_ALLOW_THREADS
+    }
+    self->exports -= 1;
+    memset(converted->vec.data + n_lanes * to.width, 0, padded_bytes - n_lanes * to.width);
+    return (PyObject*)converted;
+}
+
+// Reads the positions taken by gather and scatter, the first count u32 lanes of index or all of them
+static const uint32_t* _index_positions(PyObject* param_index, Py_ssize_t param_count, size_t* n, const char* method)
+{
+    SimdObject* index = NULL;
+    if (!PyObject_TypeCheck(param_index, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector for 'index', got type '%s'", param_index->ob_type->tp_name);
+        return NULL;
+    }
+    index = (SimdObject*)param_index;
+    *n = index->vec.size / 4;
+    if (param_count >= 0) {
+        if ((size_t)param_count > *n) {
+            PyErr_Format(SimdError, "%s needs %zd positions, the index has %zu", method, param_count, *n);
+            return NULL;
+        }
+        *n = (size_t)param_count;
+    }
+    return (const uint32_t*)index->vec.data;
+}
+
+/* Returns a new vector of the lanes at the u32 positions in index, zero padded to a
+ * multiple of 16 bytes. Lanes are 4 or 8 bytes wide, the width of the element type
+ * unless given. All positions are checked before any lane is read.
+ */
+static PyObject*
+SimdObject_gather(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"index", "width", "count", NULL};
+    PyObject* param_index = NULL;
+    Py_ssize_t param_width = 0;
+    Py_ssize_t param_count = -1;
+    struct pysimd_lane_t lane = self->lane;
+    SimdObject* gathered = NULL;
+    const uint32_t* positions = NULL;
+    uint32_t index_max = 0;
+    size_t n = 0;
+    size_t n_lanes = 0;
+    size_t padded_bytes = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nn", kwlist, &param_index, &param_width, &param_count)) {
+        return NULL;
+    }
+    if (param_width != 0 && (size_t)param_width != lane.width) {
+        lane.kind = PYSIMD_LANE_UINT;
+        lane.width = (size_t)param_width;
+    }
+    if (lane.width != 4 && lane.width != 8) {
+        PyErr_Format(SimdError, "Unrecognized width: %zu for gather operation", lane.width);
+        return NULL;
+    }
+    positions = _index_positions(param_index, param_count, &n, "gather");
+    if (positions == NULL) {
+        return NULL;
+    }
+    n_lanes = self->vec.size / lane.width;
+    padded_bytes = (n * lane.width + 15) & ~(size_t)15;
+    gathered = SimdObject_make(padded_bytes > 0 ? padded_bytes : 16, lane);
+    if (gathered == NULL) {
+        return NULL;
+    }
+    self->exports += 1;
+    ((SimdObject*)param_index)->exports += 1;
+    if (n * lane.width < PYSIMD_NOGIL_MIN) {
+        index_max = pysimd_dispatch.index_max(positions, n);
+        if (n == 0 || index_max < n_lanes)
+            pysimd_gather_run(lane.width, gathered->vec.data, self->vec.data, positions, n, index_max);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        index_max = pysimd_dispatch.index_max(positions, n);
+        if (index_max < n_lanes)
+            pysimd_gather_run(lane.width, gathered->vec.data, self->vec.data, positions, n, index_max);
+        Py_END_ALLOW_THREADS
+    }
+    self->exports -= 1;
+    ((SimdObject*)param_index)->exports -= 1;
+    if (n > 0 && index_max >= n_lanes) {
+        Py_DECREF(gathered);
+        PyErr_Format(SimdError, "The position %lu is out of range for %zu lanes", (unsigned long)index_max, n_lanes);
+        return NULL;
+    }
+    memset(gathered->vec.data + n * lane.width, 0, gathered->vec.size - n * lane.width);
+    return (PyObject*)gathered;
+}
+
+/* Writes the lanes of values to the u32 positions in index, in order, so the last of
+ * several lanes written to one position is kept. Lanes are 4 or 8 bytes wide, the width
+ * of the element type unless given. All positions are checked before any lane is
+ * written, and the vector is left as it was when one is out of range.
+ */
+static PyObject*
+SimdObject_scatter(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"index", "values", "width", "count", NULL};
+    PyObject* param_index = NULL;
+    PyObject* param_values = NULL;
+    Py_ssize_t param_width = 0;
+    Py_ssize_t param_count = -1;
+    size_t width = self->lane.width;
+    SimdObject* values = NULL;
+    const uint32_t* positions = NULL;
+    uint32_t index_max = 0;
+    size_t n = 0;
+    size_t n_lanes = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|nn", kwlist, &param_index, &param_values,
+                                     &param_width, &param_count)) {
+        return NULL;
+    }
+    if (param_width != 0) {
+        width = (size_t)param_width;
+    }
+    if (width != 4 && width != 8) {
+        PyErr_Format(SimdError, "Unrecognized width: %zu for scatter operation", width);
+        return NULL;
+    }
+    positions = _index_positions(param_index, param_count, &n, "scatter");
+    if (positions == NULL) {
+        return NULL;
+    }
+    if (!PyObject_TypeCheck(param_values, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector for 'values', got type '%s'", param_values->ob_type->tp_name);
+        return NULL;
+    }
+    values = (SimdObject*)param_values;
+    if (values == self || param_index == (PyObject*)self) {
+        PyErr_SetString(SimdError, "scatter cannot use the vector as its own index or values");
+        return NULL;
+    }
+    if (values->vec.size / width < n) {
+        PyErr_Format(SimdError, "scatter needs %zu values, the vector has %zu", n, values->vec.size / width);
+        return NULL;
+    }
+    if (!SimdObject_check_writable(self)) {
+        return NULL;
+    }
+    n_lanes = self->vec.size / width;
+    self->exports += 1;
+    values->exports += 1;
+    ((SimdObject*)param_index)->exports += 1;
+    if (n * width < PYSIMD_NOGIL_MIN) {
+        index_max = pysimd_dispatch.index_max(positions, n);
+        if (n == 0 || index_max < n_lanes)
+            pysimd_scatter_run(width, self->vec.data, positions, values->vec.data, n, index_max);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        index_max = pysimd_dispatch.index_max(positions, n);
+        if (index_max < n_lanes)
+            pysimd_scatter_run(width, self->vec.data, positions, values->vec.data, n, index_max);
+        Py_END_ALLOW_THREADS
+    }
+    self->exports -= 1;
+    values->exports -= 1;
+    ((SimdObject*)param_index)->exports -= 1;
+    if (n > 0 && index_max >= n_lanes) {
+        PyErr_Format(SimdError, "The position %lu is out of range for %zu lanes", (unsigned long)index_max, n_lanes);
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+/* Returns a new 'u64' vector of the counts of lanes in nbins equal bins over [lo, hi],
+ * hi counting in the last bin, zero padded to a multiple of 16 bytes. Lanes are read as
+ * the element type or the given type, lanes outside of the range and NaNs are dropped.
+ */
+static PyObject*
+SimdObject_histogram(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"nbins", "lo", "hi", "type", "width", NULL};
+    Py_ssize_t param_nbins = 0;
+    double param_lo = 0.0;
+    double param_hi = 0.0;
+    PyObject* param_type = NULL;
+    Py_ssize_t param_width = 0;
+    struct pysimd_lane_t lane = self->lane;
+    struct pysimd_lane_t count_lane = {PYSIMD_LANE_UINT, 8};
+    struct pysimd_hist_range range;
+    SimdObject* counts = NULL;
+    uint64_t* bins = NULL;
+    size_t padded_bytes = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "ndd|On", kwlist, &param_nbins, &param_lo, &param_hi,
+                                     &param_type, &param_width)) {
+        return NULL;
+    }
+    if (param_type != NULL && !pysimd_lane_from_args(param_type, param_width, &lane, "histogram")) {
+        return NULL;
+    }
+    if (param_nbins <= 0 || (size_t)param_nbins > PYSIMD_HIST_MAX_BINS) {
+        PyErr_Format(SimdError, "histogram takes 1 to %zu bins, got %zd", PYSIMD_HIST_MAX_BINS, param_nbins);
+        return NULL;
+    }
+    if (!(param_lo < param_hi) || !isfinite(param_lo) || !isfinite(param_hi)) {
+        PyErr_SetString(SimdError, "histogram needs finite bounds with lo below hi");
+        return NULL;
+    }
+    range.lo = param_lo;
+    range.hi = param_hi;
+    range.scale = (double)param_nbins / (param_hi - param_lo);
+    range.nbins = (uint32_t)param_nbins;
+    bins = (uint64_t*)malloc(((size_t)param_nbins + 1) * sizeof(uint64_t));
+    if (bins == NULL) {
+        return PyErr_NoMemory();
+    }
+    self->exports += 1;
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        pysimd_hist_run(lane, bins, self->vec.data, self->vec.size / lane.width, &range);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        pysimd_hist_run(lane, bins, self->vec.data, self->vec.size / lane.width, &range);
+        Py_END_ALLOW_THREADS
+    }
+    self->exports -= 1;
+    padded_bytes = ((size_t)param_nbins * 8 + 15) & ~(size_t)15;
+    counts = SimdObject_make(padded_bytes, count_lane);
+    if (counts != NULL) {
+        memset(counts->vec.data, 0, padded_bytes);
+        memcpy(counts->vec.data, bins, (size_t)param_nbins * 8);
+    }
+    free(bins);
+    return (PyObject*)counts;
+}
+
+// Returns a new 'u64' vector of 256 counts, of each byte value in the vector
+static PyObject *
+SimdObject_bincount_u8(SimdObject *self, PyObject *Py_UNUSED(ignored))
+{
+    struct pysimd_lane_t count_lane = {PYSIMD_LANE_UINT, 8};
+    SimdObject* counts = SimdObject_make(256 * 8, count_lane);
+    if (counts == NULL) {
+        return NULL;
+    }
+    self->exports += 1;
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        pysimd_bincount_run((uint64_t*)counts->vec.data, self->vec.data, self->vec.size);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        pysimd_bincount_run((uint64_t*)counts->vec.data, self->vec.data, self->vec.size);
+        Py_END_ALLOW_THREADS
+    }
+    self->exports -= 1;
+    return (PyObject*)counts;
+}
+
+/* Returns a new vector of the 32 or 64 bit hash of each lane, of the same size and an
+ * unsigned type as wide as the lanes. Lanes are 4 or 8 bytes wide, the width of the
+ * element type unless given, and the seed picks one of many unrelated hash functions.
+ */
+static PyObject*
+SimdObject_hash(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"width", "seed", NULL};
+    Py_ssize_t param_width = 0;
+    unsigned long long param_seed = 0;
+    struct pysimd_lane_t lane = {PYSIMD_LANE_UINT, self->lane.width};
+    SimdObject* hashes = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nK", kwlist, &param_width, &param_seed)) {
+        return NULL;
+    }
+    if (param_width != 0) {
+        lane.width = (size_t)param_width;
+    }
+    if (lane.width != 4 && lane.width != 8) {
+        PyErr_Format(SimdError, "Unrecognized width: %zu for hash operation", lane.width);
+        return NULL;
+    }
+    hashes = SimdObject_make(self->vec.size, lane);
+    if (hashes == NULL) {
+        return NULL;
+    }
+    self->exports += 1;
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        pysimd_hash_run(lane.width, hashes->vec.data, self->vec.data, self->vec.size / lane.width, (uint64_t)param_seed);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        pysimd_hash_run(lane.width, hashes->vec.data, self->vec.data, self->vec.size / lane.width, (uint64_t)param_seed);
+        Py_END_ALLOW_THREADS
+    }
+    self->exports -= 1;
+    return (PyObject*)hashes;
+}
+
+/* Returns the CRC32C (Castagnoli) checksum of the bytes of the vector, continuing from
+ * value, the checksum of the bytes before them, when given.
+ */
+static PyObject*
+SimdObject_crc32c(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"value", NULL};
+    unsigned int param_value = 0;
+    uint32_t crc = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|I", kwlist, &param_value)) {
+        return NULL;
+    }
+    self->exports += 1;
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        crc = pysimd_crc32c_run((uint32_t)param_value, self->vec.data, self->vec.size);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        crc = pysimd_crc32c_run((uint32_t)param_value, self->vec.data, self->vec.size);
+        Py_END_ALLOW_THREADS
+    }
+    self->exports -= 1;
+    return PyLong_FromUnsignedLong((unsigned long)crc);
+}
+
+/* Computes vector * mul + add as floating point numbers, rounded once when the cpu has
+ * fused multiply-add instructions, and rounded after each operation otherwise.
+ */
+static PyObject*
+SimdObject_fma(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"mul", "add", "width", "out", NULL};
+    Py_ssize_t param_width = 0;
+    PyObject* param_mul = NULL;
+    PyObject* param_add = NULL;
+    PyObject* param_out = Py_None;
+    pysimd_vec_ternop_t op = NULL;
+    SimdObject* dst = NULL;
+    size_t oper_region = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOn|O", kwlist,
+                                     &param_mul, &param_add, &param_width, &param_out)) {
+        return NULL;
+    }
+    if (!PyObject_TypeCheck(param_mul, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector, got type '%s'", param_mul->ob_type->tp_name);
+        return NULL;
+    }
+    if (!PyObject_TypeCheck(param_add, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector, got type '%s'", param_add->ob_type->tp_name);
+        return NULL;
+    }
+    op = param_width == 4 ? pysimd_dispatch.fma_f32 : param_width == 8 ? pysimd_dispatch.fma_f64 : NULL;
+    if (op == NULL) {
+        PyErr_Format(SimdError, "Unrecognized width: %zu for fma operation", (size_t)param_width);
+        return NULL;
+    }
+    oper_region = PYSIMD_MIN_VEC_SIZE(&(self->vec), &(((SimdObject*)param_mul)->vec));
+    if (((SimdObject*)param_add)->vec.size < oper_region) {
+        oper_region = ((SimdObject*)param_add)->vec.size;
+    }
+    dst = SimdObject_result_target(self, param_out, oper_region);
+    if (dst == NULL) {
+        return NULL;
+    }
+    SimdObject_run_ternop(op, dst, self, (SimdObject*)param_mul, (SimdObject*)param_add);
+    if (param_out == Py_None) {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+    Py_INCREF(param_out);
+    return param_out;
+}
+
+/* Runs a reduction over the whole vector, releasing the GIL for large vectors the same
+ * way SimdObject_run_binop does.
+ */
+static union pysimd_lane_value SimdObject_run_reduce(SimdObject* self, enum pysimd_reduce_op op,
+                                                     struct pysimd_lane_t lane)
+{
+    const size_t index = pysimd_lane_index(lane);
+    union pysimd_lane_value result;
+    pysimd_vec_reduce_t kernel = op == PYSIMD_REDUCE_SUM ? pysimd_dispatch.sum[index] :
+                                 op == PYSIMD_REDUCE_MIN ? pysimd_dispatch.min[index] :
+                                 pysimd_dispatch.max[index];
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        return pysimd_reduce_run(kernel, op, lane, &(self->vec));
+    }
+    self->exports += 1;
+    Py_BEGIN_ALLOW_THREADS
+    result = pysimd_reduce_run(kernel, op, lane, &(self->vec));
+    Py_END_ALLOW_THREADS
+    self->exports -= 1;
+    return result;
+}
+
+static PyObject* pysimd_lane_value_to_object(union pysimd_lane_value value, struct pysimd_lane_t lane)
+{
+    switch (lane.kind) {
+        case PYSIMD_LANE_INT:
+            return PyLong_FromLongLong((long long)value.i);
+        case PYSIMD_LANE_UINT:
+            return PyLong_FromUnsignedLongLong((unsigned long long)value.u);
+        case PYSIMD_LANE_FLOAT:
+        default:
+            return PyFloat_FromDouble(value.f);
+    }
+}
+
+enum pysimd_reduce_result {
+    PYSIMD_RESULT_VALUE,
+    PYSIMD_RESULT_MEAN,
+    PYSIMD_RESULT_INDEX
+};
+
+/* Parses the arguments shared by the reduction methods, the lane type to reduce the
+ * vector as, which defaults to the element type of the vector, then reduces it.
+ */
+static PyObject* SimdObject_reduce_method(SimdObject *self, PyObject *args, PyObject *kwargs,
+                                          enum pysimd_reduce_op op, enum pysimd_reduce_result kind,
+                                          const char* method)
+{
+    static char *kwlist[] = {"type", "width", NULL};
+    PyObject* param_type = NULL;
+    Py_ssize_t param_width = 0;
+    struct pysimd_lane_t lane = self->lane;
+    union pysimd_lane_value result;
+    size_t n_lanes = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|On", kwlist,
+                                     &param_type, &param_width)) {
+        return NULL;
+    }
+    if (param_type != NULL && !pysimd_lane_from_args(param_type, param_width, &lane, method)) {
+        return NULL;
+    }
+    n_lanes = self->vec.size / lane.width;
+    if (n_lanes == 0 && op != PYSIMD_REDUCE_SUM) {
+        PyErr_Format(SimdError, "Cannot compute '%s' of an empty vector", method);
+        return NULL;
+    }
+
+    result = SimdObject_run_reduce(self, op, lane);
+    switch (kind) {
+        case PYSIMD_RESULT_MEAN:
+            if (n_lanes == 0) {
+                PyErr_Format(SimdError, "Cannot compute '%s' of an empty vector", method);
+                return NULL;
+            }
+            if (lane.kind == PYSIMD_LANE_INT)
+                return PyFloat_FromDouble((double)result.i / (double)n_lanes);
+            if (lane.kind == PYSIMD_LANE_UINT)
+                return PyFloat_FromDouble((double)result.u / (double)n_lanes);
+            return PyFloat_FromDouble(result.f / (double)n_lanes);
+        case PYSIMD_RESULT_INDEX:
+        {
+            // A vector of only NaN lanes has no minimum, its first lane is reported
+            const pysimd_vec_search_t kernels[] = PYSIMD_DISPATCH_KERNELS(find);
+            unsigned char block_raw[PYSIMD_CMP_BROADCAST_SIZE + PYSIMD_ALLOC_ALIGN];
+            unsigned char* block = (unsigned char*)(((uintptr_t)block_raw + PYSIMD_ALLOC_ALIGN - 1) &
+                                                    ~(uintptr_t)(PYSIMD_ALLOC_ALIGN - 1));
+            size_t found = 0;
+            pysimd_lane_broadcast(result, lane, block);
+            found = kernels[pysimd_lane_kernel_index(lane)](&(self->vec), block);
+            return PyLong_FromSize_t(found == n_lanes ? 0 : found);
+        }
+        case PYSIMD_RESULT_VALUE:
+        default:
+            return pysimd_lane_value_to_object(result, lane);
+    }
+}
+
+static PyObject*
+SimdObject_sum(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_reduce_method(self, args, kwargs, PYSIMD_REDUCE_SUM, PYSIMD_RESULT_VALUE, "sum");
+}
+
+static PyObject*
+SimdObject_min(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_reduce_method(self, args, kwargs, PYSIMD_REDUCE_MIN, PYSIMD_RESULT_VALUE, "min");
+}
+
+static PyObject*
+SimdObject_max(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_reduce_method(self, args, kwargs, PYSIMD_REDUCE_MAX, PYSIMD_RESULT_VALUE, "max");
+}
+
+static PyObject*
+SimdObject_mean(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_reduce_method(self, args, kwargs, PYSIMD_REDUCE_SUM, PYSIMD_RESULT_MEAN, "mean");
+}
+
+static PyObject*
+SimdObject_argmin(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_reduce_method(self, args, kwargs, PYSIMD_REDUCE_MIN, PYSIMD_RESULT_INDEX, "argmin");
+}
+
+static PyObject*
+SimdObject_argmax(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    return SimdObject_reduce_method(self, args, kwargs, PYSIMD_REDUCE_MAX, PYSIMD_RESULT_INDEX, "argmax");
+}
+
+static PyObject*
+SimdObject_as_bytes(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"start", "end", NULL};
+    Py_ssize_t param_start = 0;
+    Py_ssize_t param_end = 0;
+    size_t actual_start = 0;
+    size_t actual_end = self->vec.size;
+    PyObject* bytes_made = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nn", kwlist,
+                                     &param_start, &param_end)) {
+        return NULL;
+    }
+
+    if (param_start != 0) {
+        if (param_start > self->vec.size || param_start < 0) {
+            PyErr_Format(SimdError, "start: '%ld', is out of bounds for vector of size %zu", param_start, self->vec.size);
+            return NULL;
+        }
+        actual_start = (size_t)param_start;
+    }
+
+    if (param_end != 0) {
+        if (param_end > self->vec.size || param_end < 0) {
+            PyErr_Format(SimdError, "end: '%ld', is out of bounds for vector of size %zu", param_end, self->vec.size);
+            return NULL;
+        }
+        actual_end = (size_t)param_end;
+    }
+
+    bytes_made = PyBytes_FromStringAndSize((const char*)self->vec.data +  actual_start, actual_end - actual_start);
+    RETURN_OR_SYS_ERROR(bytes_made);
+
+}
+
+// Ints for every 8 bit lane value, from -128 to 255, so exporting bytes allocates nothing
+static PyObject* pysimd_byte_ints[384];
+
+static int pysimd_byte_ints_init(void)
+{
+    int i = 0;
+    for (; i < 384; ++i) {
+        pysimd_byte_ints[i] = PyLong_FromLong(i - 128);
+        if (pysimd_byte_ints[i] == NULL) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Writes a new reference for each lane of the vector into items, which must have
+ * room for vec->size / lane.width objects. Returns 0 with an exception set on failure,
+ * leaving the remaining items NULL.
+ */
+static int pysimd_lanes_to_items(const struct pysimd_vec_t* vec, struct pysimd_lane_t lane, PyObject** items)
+{
+    const size_t n_members = vec->size / lane.width;
+    size_t i = 0;
+    #define PYSIMD_LANES_TO_ITEMS(ctype, maker) \
+        { \
+            const ctype* reader = (const ctype*)(vec->data); \
+            for (i = 0; i < n_members; ++i) { \
+                PyObject* to_put = maker(reader[i]); \
+                if (to_put == NULL) \
+                    return 0; \
+                items[i] = to_put; \
+            } \
+        }
+    if (lane.width == 1 && lane.kind != PYSIMD_LANE_FLOAT) {
+        const unsigned char* reader = vec->data;
+        for (i = 0; i < n_members; ++i) {
+            int value = lane.kind == PYSIMD_LANE_INT ? (int)(signed char)reader[i] : (int)reader[i];
+            PyObject* to_put = pysimd_byte_ints[value + 128];
+            Py_INCREF(to_put);
+            items[i] = to_put;
+        }
+        return 1;
+    }
+    switch (lane.kind) {
+        case PYSIMD_LANE_INT:
+            if (lane.width == 2)
+                PYSIMD_LANES_TO_ITEMS(int16_t, PyLong_FromLong)
+            else if (lane.width == 4)
+                PYSIMD_LANES_TO_ITEMS(int32_t, PyLong_FromLong)
+            else
+                PYSIMD_LANES_TO_ITEMS(long long, PyLong_FromLongLong)
+            break;
+        case PYSIMD_LANE_UINT:
+            if (lane.width == 2)
+                PYSIMD_LANES_TO_ITEMS(uint16_t, PyLong_FromUnsignedLong)
+            else if (lane.width == 4)
+                PYSIMD_LANES_TO_ITEMS(uint32_t, PyLong_FromUnsignedLong)
+            else
+                PYSIMD_LANES_TO_ITEMS(unsigned long long, PyLong_FromUnsignedLongLong)
+            break;
+        case PYSIMD_LANE_FLOAT:
+            if (lane.width == 4)
+                PYSIMD_LANES_TO_ITEMS(float, PyFloat_FromDouble)
+            else
+                PYSIMD_LANES_TO_ITEMS(double, PyFloat_FromDouble)
+            break;
+    }
+    #undef PYSIMD_LANES_TO_ITEMS
+    return 1;
+}
+
+static PyObject*
+SimdObject_as_tuple(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"type", "width", NULL};
+    PyObject* tuple_to_give = NULL;
+    PyObject* param_type = NULL;
+    Py_ssize_t param_width = 0;
+    struct pysimd_lane_t lane;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On", kwlist,
+                                     &param_type, &param_width)) {
+        return NULL;
+    }
+    if (!pysimd_lane_from_args(param_type, param_width, &lane, "as_tuple")) {
+        return NULL;
+    }
+
+    tuple_to_give = PyTuple_New(self->vec.size / lane.width);
+    if (tuple_to_give == NULL) {
+        return NULL;
+    }
+    if (!pysimd_lanes_to_items(&(self->vec), lane, PySequence_Fast_ITEMS(tuple_to_give))) {
+        Py_DECREF(tuple_to_give);
+        return NULL;
+    }
+    return tuple_to_give;
+}
+
+static PyObject*
+SimdObject_to_list(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"type", "width", NULL};
+    PyObject* list_to_give = NULL;
+    PyObject* param_type = NULL;
+    Py_ssize_t param_width = 0;
+    struct pysimd_lane_t lane = self->lane;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|On", kwlist,
+                                     &param_type, &param_width)) {
+        return NULL;
+    }
+    if (param_type != NULL && !pysimd_lane_from_args(param_type, param_width, &lane, "to_list")) {
+        return NULL;
+    }
+
+    list_to_give = PyList_New(self->vec.size / lane.width);
+    if (list_to_give == NULL) {
+        return NULL;
+    }
+    if (!pysimd_lanes_to_items(&(self->vec), lane, PySequence_Fast_ITEMS(list_to_give))) {
+        Py_DECREF(list_to_give);
+        return NULL;
+    }
+    return list_to_give;
+}
+
+/* Copies the raw vector bytes into a preallocated writable buffer, like an array.array
+ * or a bytearray, and returns the number of items of that buffer that were filled.
+ */
+static PyObject*
+SimdObject_into(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"target", NULL};
+    PyObject* param_target = NULL;
+    Py_buffer target;
+    size_t to_copy = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", kwlist, &param_target)) {
+        return NULL;
+    }
+    if (PyObject_GetBuffer(param_target, &target, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE) < 0) {
+        return NULL;
+    }
+
+    to_copy = (size_t)target.len < self->vec.size ? (size_t)target.len : self->vec.size;
+    to_copy -= to_copy % (size_t)target.itemsize;
+    if (to_copy >= PYSIMD_NOGIL_MIN) {
+        self->exports += 1;
+        Py_BEGIN_ALLOW_THREADS
+        memmove(target.buf, self->vec.data, to_copy);
+        Py_END_ALLOW_THREADS
+        self->exports -= 1;
+    } else {
+        memmove(target.buf, self->vec.data, to_copy);
+    }
+    PyBuffer_Release(&target);
+    return PyLong_FromSize_t(to_copy / (size_t)target.itemsize);
+}
+
+/* Infers a lane type from the struct module format a buffer reports for its items.
+ * Returns 0 for formats other than a single native number.
+ */
+static int pysimd_lane_from_format(const char* format, Py_ssize_t itemsize, struct pysimd_lane_t* lane)
+{
+    if (format == NULL) {
+        format = "B";
+    }
+    if (format[0] == '@') {
+        ++format;
+    }
+    if (format[0] == '\0' || format[1] != '\0') {
+        return 0;
+    }
+    switch (format[0]) {
+        case 'b': case 'h': case 'i': case 'l': case 'q': case 'n':
+            lane->kind = PYSIMD_LANE_INT;
+            break;
+        case 'B': case 'H': case 'I': case 'L': case 'Q': case 'N':
+            lane->kind = PYSIMD_LANE_UINT;
+            break;
+        case 'f': case 'd':
+            lane->kind = PYSIMD_LANE_FLOAT;
+            break;
+        default:
+            return 0;
+    }
+    if (itemsize != 1 && itemsize != 2 && itemsize != 4 && itemsize != 8) {
+        return 0;
+    }
+    lane->width = (size_t)itemsize;
+    return 1;
+}
+
+/* Creates a vector over the memory of any object supporting the buffer protocol.
+ * Contiguous memory that meets the vector alignment and size rules is borrowed as is,
+ * anything else is copied once into a new vector, zero padded to a multiple of 16 bytes.
+ */
+static PyObject*
+SimdObject_from_buffer(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"source", "copy", "type", NULL};
+    PyObject* param_source = NULL;
+    int param_copy = 0;
+    PyObject* param_type = NULL;
+    SimdObject* made = NULL;
+    Py_buffer source;
+    int readonly = 0;
+    struct pysimd_lane_t lane = {PYSIMD_LANE_UINT, 1};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|pO", kwlist,
+                                     &param_source, &param_copy, &param_type)) {
+        return NULL;
+    }
+    if (param_type != NULL && !pysimd_lane_from_args(param_type, 0, &lane, "from_buffer")) {
+        return NULL;
+    }
+
+    if (PyObject_GetBuffer(param_source, &source, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE | PyBUF_FORMAT) < 0) {
+        PyErr_Clear();
+        readonly = 1;
+        if (PyObject_GetBuffer(param_source, &source, PyBUF_FULL_RO) < 0) {
+            return NULL;
+        }
+    }
+    if (source.len == 0) {
+        PyBuffer_Release(&source);
+        PyErr_SetString(SimdError, "cannot make a vector from an empty buffer");
+        return NULL;
+    }
+
+    made = (SimdObject*)type->tp_alloc(type, 0);
+    if (made == NULL) {
+        PyBuffer_Release(&source);
+        return NULL;
+    }
+    made->source.obj = NULL;
+    if (param_type == NULL && !pysimd_lane_from_format(source.format, source.itemsize, &lane)) {
+        lane.kind = PYSIMD_LANE_UINT;
+        lane.width = 1;
+    }
+    made->lane = lane;
+
+    if (!param_copy && PyBuffer_IsContiguous(&source, 'C') &&
+        ((uintptr_t)source.buf % 16) == 0 && (source.len % 16) == 0) {
+        made->source = source;
+        made->readonly = readonly;
+        made->vec.data = (uint8_t*)source.buf;
+        made->vec.size = (size_t)source.len;
+        made->vec.capacity = 0;
+        return (PyObject*)made;
+    }
+
+    pysimd_vec_init_raw(&(made->vec), ((size_t)source.len + 15) & ~(size_t)15);
+    if (made->vec.data == NULL) {
+        PyBuffer_Release(&source);
+        Py_DECREF(made);
+        return PyErr_NoMemory();
+    }
+    if (PyBuffer_ToContiguous(made->vec.data, &source, source.len, 'C') < 0) {
+        PyBuffer_Release(&source);
+        Py_DECREF(made);
+        return NULL;
+    }
+    memset(made->vec.data + source.len, 0, made->vec.size - (size_t)source.len);
+    PyBuffer_Release(&source);
+    return (PyObject*)made;
+}
+
+// Maps a lane type onto a struct module format character
+static const char* pysimd_lane_format(struct pysimd_lane_t lane)
+{
+    switch (lane.kind) {
+        case PYSIMD_LANE_INT:
+            return lane.width == 1 ? "b" : lane.width == 2 ? "h" : lane.width == 4 ? "i" : "q";
+        case PYSIMD_LANE_UINT:
+            return lane.width == 1 ? "B" : lane.width == 2 ? "H" : lane.width == 4 ? "I" : "Q";
+        case PYSIMD_LANE_FLOAT:
+        default:
+            return lane.width == 4 ? "f" : "d";
+    }
+}
+
+static PyObject*
+SimdObject_view(SimdObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"type", "width", NULL};
+    PyObject* param_type = NULL;
+    Py_ssize_t param_width = 0;
+    PyObject* byte_view = NULL;
+    PyObject* typed_view = NULL;
+    struct pysimd_lane_t lane = self->lane;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|On", kwlist,
+                                     &param_type, &param_width)) {
+        return NULL;
+    }
+    if (param_type != NULL && !pysimd_lane_from_args(param_type, param_width, &lane, "view")) {
+        return NULL;
+    }
+    byte_view = PyMemoryView_FromObject((PyObject*)self);
+    if (byte_view == NULL) {
+        return NULL;
+    }
+    typed_view = PyObject_CallMethod(byte_view, "cast", "s", pysimd_lane_format(lane));
+    Py_DECREF(byte_view);
+    return typed_view;
+}
+
+static int SimdObject_getbuffer(SimdObject *self, Py_buffer *view, int flags)
+{
+    if (PyBuffer_FillInfo(view, (PyObject*)self, self->vec.data, (Py_ssize_t)self->vec.size, self->readonly, flags) < 0) {
+        return -1;
+    }
+    self->exports += 1;
+    return 0;
+}
+
+static void SimdObject_releasebuffer(SimdObject *self, Py_buffer *view)
+{
+    self->exports -= 1;
+}
+
+static PyBufferProcs SimdObject_as_buffer = {
+    (getbufferproc)SimdObject_getbuffer,
+    (releasebufferproc)SimdObject_releasebuffer
+};
+
+static PyObject* ExprObject_create(SimdObject* base)
+{
+    ExprObject* made = (ExprObject*)ExprObjectType.tp_alloc(&ExprObjectType, 0);
+    if (made == NULL) {
+        return NULL;
+    }
+    Py_INCREF(base);
+    made->base = base;
+    made->steps = NULL;
+    made->operands = NULL;
+    made->n_steps = 0;
+    made->capacity = 0;
+    return (PyObject*)made;
+}
+
+static PyObject *
+SimdObject_lazy(SimdObject *self, PyObject *Py_UNUSED(ignored))
+{
+    return ExprObject_create(self);
+}
+
+static PyObject *
+SimdObject_clear(SimdObject *self, PyObject *Py_UNUSED(ignored))
+{
+    if (!SimdObject_check_writable(self)) {
+        return NULL;
+    }
+    if (self->vec.size < PYSIMD_NOGIL_MIN) {
+        pysimd_dispatch.clear_data(&(self->vec));
+    } else {
+        self->exports += 1;
+        Py_BEGIN_ALLOW_THREADS
+        pysimd_dispatch.clear_data(&(self->vec));
+        Py_END_ALLOW_THREADS
+        self->exports -= 1;
+    }
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyMethodDef SimdObject_methods[] = {
+    {"clear", (PyCFunction) SimdObject_clear, METH_NOARGS,
+     "Sets all bytes in the vector to 0"
+    },
+    {"size", (PyCFunction) SimdObject_size, METH_NOARGS,
+     "Returns the current size of the vector"
+    },
+    {"resize", (PyCFunction) SimdObject_resize, METH_VARARGS | METH_KEYWORDS,
+    "Resizes the vector to the desired capacity"
+    },
+    {"add", (PyCFunction) SimdObject_add, METH_VARARGS | METH_KEYWORDS,
+    "Adds a vector into another vector, or writes the sum into the vector given as out, saturate=True clamps instead of wrapping"
+    },
+    {"fadd", (PyCFunction) SimdObject_fadd, METH_VARARGS | METH_KEYWORDS,
+    "Adds a vector into another vector as floating point numbers, or into out"
+    },
+    {"sub", (PyCFunction) SimdObject_sub, METH_VARARGS | METH_KEYWORDS,
+    "Subtracts a vector from another vector, or writes the difference into the vector given as out, saturate=True clamps instead of wrapping"
+    },
+    {"fsub", (PyCFunction) SimdObject_fsub, METH_VARARGS | METH_KEYWORDS,
+    "Subtracts a vector from another vector as floating point numbers, or into out"
+    },
+    {"mul", (PyCFunction) SimdObject_mul, METH_VARARGS | METH_KEYWORDS,
+    "Multiplies a vector into another vector, keeping the low half, or with high=True the high half of each product"
+    },
+    {"fmul", (PyCFunction) SimdObject_fmul, METH_VARARGS | METH_KEYWORDS,
+    "Multiplies a vector into another vector as floating point numbers, or into out"
+    },
+    {"fdiv", (PyCFunction) SimdObject_fdiv, METH_VARARGS | METH_KEYWORDS,
+    "Divides a vector by another vector as floating point numbers, or into out"
+    },
+    {"avg", (PyCFunction) SimdObject_avg, METH_VARARGS | METH_KEYWORDS,
+    "Averages a vector into another vector as unsigned 8 or 16 bit lanes, rounding up, or into out"
+    },
+    {"absdiff", (PyCFunction) SimdObject_absdiff, METH_VARARGS | METH_KEYWORDS,
+    "Writes the absolute differences of 8 or 16 bit lanes with another vector, in place or into out"
+    },
+    {"sad", (PyCFunction) SimdObject_sad, METH_VARARGS | METH_KEYWORDS,
+    "Returns the sum of the absolute differences of the bytes of two vectors"
+    },
+    {"and_", (PyCFunction) SimdObject_and, METH_VARARGS | METH_KEYWORDS,
+    "Bitwise and of two vectors"
+    },
+    {"or_", (PyCFunction) SimdObject_or, METH_VARARGS | METH_KEYWORDS,
+    "Bitwise or of two vectors"
+    },
+    {"xor", (PyCFunction) SimdObject_xor, METH_VARARGS | METH_KEYWORDS,
+    "Bitwise exclusive or of two vectors"
+    },
+    {"andnot", (PyCFunction) SimdObject_andnot, METH_VARARGS | METH_KEYWORDS,
+    "Clears the bits of the vector that are set in another vector"
+    },
+    {"not_", (PyCFunction) SimdObject_not, METH_VARARGS | METH_KEYWORDS,
+    "Inverts every bit of the vector"
+    },
+    {"popcount", (PyCFunction) SimdObject_popcount, METH_NOARGS,
+    "Returns the number of set bits in the vector"
+    },
+    {"and_popcount", (PyCFunction) SimdObject_and_popcount, METH_VARARGS | METH_KEYWORDS,
+    "Returns the number of bits set in both of two vectors"
+    },
+    {"cmp", (PyCFunction) SimdObject_cmp, METH_VARARGS | METH_KEYWORDS,
+    "Compares the lanes to another vector or a number, returns lane masks or with packed=True a bit mask"
+    },
+    {"find", (PyCFunction) SimdObject_find, METH_VARARGS | METH_KEYWORDS,
+    "Returns the index of the first lane equal to a number, or -1"
+    },
+    {"rfind", (PyCFunction) SimdObject_rfind, METH_VARARGS | METH_KEYWORDS,
+    "Returns the index of the last lane equal to a number, or -1"
+    },
+    {"count", (PyCFunction) SimdObject_count, METH_VARARGS | METH_KEYWORDS,
+    "Returns the number of lanes equal to a number"
+    },
+    {"find_any", (PyCFunction) SimdObject_find_any, METH_VARARGS | METH_KEYWORDS,
+    "Returns the index of the first lane equal to any of a sequence of numbers, or -1"
+    },
+    {"filter", (PyCFunction) SimdObject_filter, METH_VARARGS | METH_KEYWORDS,
+    "Packs the lanes within the gt, lt and eq bounds into a new vector, returns it and their count"
+    },
+    {"cumsum", (PyCFunction) SimdObject_cumsum, METH_VARARGS | METH_KEYWORDS,
+    "Writes the running totals of the 4 or 8 byte lanes, restarting at flagged lanes, in place or into out"
+    },
+    {"sort", (PyCFunction) SimdObject_sort, METH_VARARGS | METH_KEYWORDS,
+    "Sorts the 4 or 8 byte lanes in place, moving the lanes of a values vector along stably when given"
+    },
+    {"argsort", (PyCFunction) SimdObject_argsort, METH_VARARGS | METH_KEYWORDS,
+    "Returns a u32 vector of the positions of the 4 or 8 byte lanes in stable sorted order"
+    },
+    {"convert", (PyCFunction) SimdObject_convert, METH_VARARGS | METH_KEYWORDS,
+    "Returns a new vector of the lanes converted from one named lane type to another"
+    },
+    {"gather", (PyCFunction) SimdObject_gather, METH_VARARGS | METH_KEYWORDS,
+    "Returns a new vector of the lanes at the u32 positions of an index vector"
+    },
+    {"scatter", (PyCFunction) SimdObject_scatter, METH_VARARGS | METH_KEYWORDS,
+    "Writes the lanes of a values vector to the u32 positions of an index vector"
+    },
+    {"histogram", (PyCFunction) SimdObject_histogram, METH_VARARGS | METH_KEYWORDS,
+    "Returns a new u64 vector of the counts of lanes in equal bins over a range"
+    },
+    {"bincount_u8", (PyCFunction) SimdObject_bincount_u8, METH_NOARGS,
+    "Returns a new u64 vector of the counts of each of the 256 byte values"
+    },
+    {"hash", (PyCFunction) SimdObject_hash, METH_VARARGS | METH_KEYWORDS,
+    "Returns a new vector of the 32 or 64 bit hash of each lane"
+    },
+    {"crc32c", (PyCFunction) SimdObject_crc32c, METH_VARARGS | METH_KEYWORDS,
+    "Returns the CRC32C checksum of the bytes of the vector"
+    },
+    {"fsqrt", (PyCFunction) SimdObject_fsqrt, METH_VARARGS | METH_KEYWORDS,
+    "Takes the square root of every lane as floating point numbers, in place or into out"
+    },
+    {"fma", (PyCFunction) SimdObject_fma, METH_VARARGS | METH_KEYWORDS,
+    "Computes vector * mul + add as floating point numbers, in place or into out"
+    },
+    {"sum", (PyCFunction) SimdObject_sum, METH_VARARGS | METH_KEYWORDS,
+    "Returns the sum of the lanes of the vector, integers are summed without overflow up to 64 bits"
+    },
+    {"min", (PyCFunction) SimdObject_min, METH_VARARGS | METH_KEYWORDS,
+    "Returns the smallest lane of the vector, NaN lanes are ignored"
+    },
+    {"max", (PyCFunction) SimdObject_max, METH_VARARGS | METH_KEYWORDS,
+    "Returns the largest lane of the vector, NaN lanes are ignored"
+    },
+    {"mean", (PyCFunction) SimdObject_mean, METH_VARARGS | METH_KEYWORDS,
+    "Returns the mean of the lanes of the vector as a float"
+    },
+    {"argmin", (PyCFunction) SimdObject_argmin, METH_VARARGS | METH_KEYWORDS,
+    "Returns the index of the first smallest lane of the vector"
+    },
+    {"argmax", (PyCFunction) SimdObject_argmax, METH_VARARGS | METH_KEYWORDS,
+    "Returns the index of the first largest lane of the vector"
+    },
+    {"as_bytes", (PyCFunction) SimdObject_as_bytes, METH_VARARGS | METH_KEYWORDS,
+    "Returns a bytes object representing the internal bytes of the vector"
+    },
+    {"as_tuple", (PyCFunction) SimdObject_as_tuple, METH_VARARGS | METH_KEYWORDS,
+    "Returns a tuple populated with members of the vector, defaults to 32 bit integers"
+    },
+    {"to_list", (PyCFunction) SimdObject_to_list, METH_VARARGS | METH_KEYWORDS,
+    "Returns a list of the lanes of the vector, for a lane type such as 'u8', 'i32' or 'f64'"
+    },
+    {"into", (PyCFunction) SimdObject_into, METH_VARARGS | METH_KEYWORDS,
+    "Copies the vector bytes into a preallocated writable buffer, such as an array.array"
+    },
+    {"copy", (PyCFunction) SimdObject_copy, METH_VARARGS | METH_KEYWORDS,
+    "Returns a copy of the vector"
+    },
+    {"from_buffer", (PyCFunction) SimdObject_from_buffer, METH_CLASS | METH_VARARGS | METH_KEYWORDS,
+    "Makes a vector over the memory of a buffer object, copying only if it is not aligned"
+    },
+    {"view", (PyCFunction) SimdObject_view, METH_VARARGS | METH_KEYWORDS,
+    "Returns a memoryview over the vector data, typed by lane width, without copying"
+    },
+    {"lazy", (PyCFunction) SimdObject_lazy, METH_NOARGS,
+    "Returns an expression on the vector, whose operations are deferred and run fused"
+    },
+    {NULL}  /* Sentinel */
+};
+
+static PyObject*
+SimdObject_get_type(SimdObject *self, void *closure)
+{
+    return PyUnicode_FromString(pysimd_lane_name(self->lane));
+}
+
+static int
+SimdObject_set_type(SimdObject *self, PyObject *value, void *closure)
+{
+    struct pysimd_lane_t lane;
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete the type of a vector");
+        return -1;
+    }
+    if (!PyUnicode_Check(value)) {
+        PyErr_Format(SimdError, "Expected a lane type name such as 'i32', got type '%s'", value->ob_type->tp_name);
+        return -1;
+    }
+    if (!pysimd_lane_from_args(value, 0, &lane, "type")) {
+        return -1;
+    }
+    self->lane = lane;
+    return 0;
+}
+
+static PyGetSetDef SimdObject_getset[] = {
+    {"type", (getter) SimdObject_get_type, (setter) SimdObject_set_type,
+     "The element type of the vector, such as 'u8', 'i32' or 'f64', used by operators", NULL},
+    {NULL}  /* Sentinel */
+};
+
+// Picks the kernel for a lane type, out of kernels ordered i8, i16, i32, i64, f32, f64
+static pysimd_vec_binop_t pysimd_lane_kernel(struct pysimd_lane_t lane, const pysimd_vec_binop_t* kernels)
+{
+    if (lane.kind == PYSIMD_LANE_FLOAT) {
+        return lane.width == 4 ? kernels[4] : kernels[5];
+    }
+    return lane.width == 1 ? kernels[0] : lane.width == 2 ? kernels[1] : lane.width == 4 ? kernels[2] : kernels[3];
+}
+
+/* Implements the arithmetic operators. Both operands must be vectors of the same size
+ * and lane width, the kernel and the type of the result follow the left operand.
+ */
+static PyObject* SimdObject_number_binop(PyObject* left, PyObject* right,
+                                         const pysimd_vec_binop_t* kernels, int in_place)
+{
+    SimdObject* v1 = (SimdObject*)left;
+    SimdObject* v2 = (SimdObject*)right;
+    SimdObject* dst = NULL;
+    pysimd_vec_binop_t op = NULL;
+    if (!PyObject_TypeCheck(left, &SimdObjectType) || !PyObject_TypeCheck(right, &SimdObjectType)) {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    if (v1->lane.width != v2->lane.width ||
+        (v1->lane.kind == PYSIMD_LANE_FLOAT) != (v2->lane.kind == PYSIMD_LANE_FLOAT)) {
+        PyErr_Format(SimdError, "cannot combine vectors of types '%s' and '%s'",
+                     pysimd_lane_name(v1->lane), pysimd_lane_name(v2->lane));
+        return NULL;
+    }
+    if (v1->vec.size != v2->vec.size) {
+        PyErr_Format(SimdError, "cannot combine vectors of sizes %zu and %zu", v1->vec.size, v2->vec.size);
+        return NULL;
+    }
+    op = pysimd_lane_kernel(v1->lane, kernels);
+    if (op == NULL) {
+        PyErr_Format(SimdError, "the operator is not supported for vectors of type '%s'", pysimd_lane_name(v1->lane));
+        return NULL;
+    }
+    if (in_place) {
+        if (!SimdObject_check_writable(v1)) {
+            return NULL;
+        }
+        dst = v1;
+        Py_INCREF(dst);
+    } else {
+        dst = SimdObject_make(v1->vec.size, v1->lane);
+        if (dst == NULL) {
+            return NULL;
+        }
+    }
+    SimdObject_run_binop(op, dst, v1, v2);
+    return (PyObject*)dst;
+}
+
+static PyObject* SimdObject_nb_add(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(add);
+    return SimdObject_number_binop(left, right, kernels, 0);
+}
+
+static PyObject* SimdObject_nb_inplace_add(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(add);
+    return SimdObject_number_binop(left, right, kernels, 1);
+}
+
+static PyObject* SimdObject_nb_subtract(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(sub);
+    return SimdObject_number_binop(left, right, kernels, 0);
+}
+
+static PyObject* SimdObject_nb_inplace_subtract(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(sub);
+    return SimdObject_number_binop(left, right, kernels, 1);
+}
+
+#define PYSIMD_MUL_KERNELS { \
+    NULL, pysimd_dispatch.mul_i16, pysimd_dispatch.mul_i32, \
+    pysimd_dispatch.mul_i64, pysimd_dispatch.mul_f32, pysimd_dispatch.mul_f64 }
+
+#define PYSIMD_DIV_KERNELS { NULL, NULL, NULL, NULL, pysimd_dispatch.div_f32, pysimd_dispatch.div_f64 }
+
+static PyObject* SimdObject_nb_multiply(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_MUL_KERNELS;
+    return SimdObject_number_binop(left, right, kernels, 0);
+}
+
+static PyObject* SimdObject_nb_inplace_multiply(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_MUL_KERNELS;
+    return SimdObject_number_binop(left, right, kernels, 1);
+}
+
+static PyObject* SimdObject_nb_true_divide(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DIV_KERNELS;
+    return SimdObject_number_binop(left, right, kernels, 0);
+}
+
+static PyObject* SimdObject_nb_inplace_true_divide(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DIV_KERNELS;
+    return SimdObject_number_binop(left, right, kernels, 1);
+}
+
+// The bitwise operators ignore lanes, so every width uses the same kernel
+#define PYSIMD_BIT_KERNELS(op) { \
+    pysimd_dispatch.op, pysimd_dispatch.op, pysimd_dispatch.op, \
+    pysimd_dispatch.op, pysimd_dispatch.op, pysimd_dispatch.op }
+
+static PyObject* SimdObject_nb_and(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_BIT_KERNELS(and_);
+    return SimdObject_number_binop(left, right, kernels, 0);
+}
+
+static PyObject* SimdObject_nb_inplace_and(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_BIT_KERNELS(and_);
+    return SimdObject_number_binop(left, right, kernels, 1);
+}
+
+static PyObject* SimdObject_nb_or(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_BIT_KERNELS(or_);
+    return SimdObject_number_binop(left, right, kernels, 0);
+}
+
+static PyObject* SimdObject_nb_inplace_or(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_BIT_KERNELS(or_);
+    return SimdObject_number_binop(left, right, kernels, 1);
+}
+
+static PyObject* SimdObject_nb_xor(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_BIT_KERNELS(xor_);
+    return SimdObject_number_binop(left, right, kernels, 0);
+}
+
+static PyObject* SimdObject_nb_inplace_xor(PyObject* left, PyObject* right)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_BIT_KERNELS(xor_);
+    return SimdObject_number_binop(left, right, kernels, 1);
+}
+
+static PyObject* SimdObject_nb_invert(PyObject* operand)
+{
+    SimdObject* src = (SimdObject*)operand;
+    SimdObject* dst = SimdObject_make(src->vec.size, src->lane);
+    if (dst == NULL) {
+        return NULL;
+    }
+    SimdObject_run_unop(pysimd_dispatch.not_, dst, src);
+    return (PyObject*)dst;
+}
+
+static PyNumberMethods SimdObject_as_number = {
+    .nb_add = SimdObject_nb_add,
+    .nb_subtract = SimdObject_nb_subtract,
+    .nb_inplace_add = SimdObject_nb_inplace_add,
+    .nb_inplace_subtract = SimdObject_nb_inplace_subtract,
+    .nb_multiply = SimdObject_nb_multiply,
+    .nb_inplace_multiply = SimdObject_nb_inplace_multiply,
+    .nb_true_divide = SimdObject_nb_true_divide,
+    .nb_inplace_true_divide = SimdObject_nb_inplace_true_divide,
+    .nb_and = SimdObject_nb_and,
+    .nb_inplace_and = SimdObject_nb_inplace_and,
+    .nb_or = SimdObject_nb_or,
+    .nb_inplace_or = SimdObject_nb_inplace_or,
+    .nb_xor = SimdObject_nb_xor,
+    .nb_inplace_xor = SimdObject_nb_inplace_xor,
+    .nb_invert = SimdObject_nb_invert,
+};
+
+PyTypeObject SimdObjectType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "simd.Vec",
+    .tp_doc = "A vector containing simd data",
+    .tp_basicsize = sizeof(SimdObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .tp_new = SimdObject_new,
+    .tp_init = (initproc) SimdObject_init,
+    .tp_dealloc = (destructor) SimdObject_dealloc,
+    .tp_repr = (reprfunc) SimdObject_repr,
+    .tp_methods = SimdObject_methods,
+    .tp_getset = SimdObject_getset,
+    .tp_as_number = &SimdObject_as_number,
+    .tp_as_buffer = &SimdObject_as_buffer,
+};
+
+
+static void ExprObject_dealloc(ExprObject* self)
+{
+    Py_ssize_t i = 0;
+    for (; i < self->n_steps; ++i) {
+        Py_DECREF(self->operands[i]);
+    }
+    PyMem_Free(self->steps);
+    PyMem_Free(self->operands);
+    Py_XDECREF(self->base);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+// Parses the arguments shared by the arithmetic methods, and records the operation
+static PyObject* ExprObject_record(ExprObject *self, PyObject *args, PyObject *kwargs,
+                                   const pysimd_vec_binop_t* kernels, int is_float, const char* method)
+{
+    static char *kwlist[] = {"other", "width", NULL};
+    Py_ssize_t param_width = 0;
+    PyObject* param_other = NULL;
+    pysimd_vec_binop_t op = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On", kwlist,
+                                     &param_other, &param_width)) {
+        return NULL;
+    }
+    if (!PyObject_TypeCheck(param_other, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector, got type '%s'", param_other->ob_type->tp_name);
+        return NULL;
+    }
+    op = pysimd_width_kernel(kernels, param_width, is_float, method);
+    if (op == NULL) {
+        return NULL;
+    }
+    if (self->n_steps == self->capacity) {
+        Py_ssize_t new_capacity = self->capacity == 0 ? 8 : self->capacity * 2;
+        struct pysimd_expr_step* new_steps = PyMem_Realloc(self->steps, new_capacity * sizeof(struct pysimd_expr_step));
+        SimdObject** new_operands = NULL;
+        if (new_steps == NULL) {
+            return PyErr_NoMemory();
+        }
+        self->steps = new_steps;
+        new_operands = PyMem_Realloc(self->operands, new_capacity * sizeof(SimdObject*));
+        if (new_operands == NULL) {
+            return PyErr_NoMemory();
+        }
+        self->operands = new_operands;
+        self->capacity = new_capacity;
+    }
+    Py_INCREF(param_other);
+    self->operands[self->n_steps] = (SimdObject*)param_other;
+    self->steps[self->n_steps].op = op;
+    self->steps[self->n_steps].operand = &(((SimdObject*)param_other)->vec);
+    self->n_steps += 1;
+    Py_INCREF(self);
+    return (PyObject*)self;
+}
+
+static PyObject*
+ExprObject_add(ExprObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(add);
+    return ExprObject_record(self, args, kwargs, kernels, 0, "add");
+}
+
+static PyObject*
+ExprObject_fadd(ExprObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(add);
+    return ExprObject_record(self, args, kwargs, kernels, 1, "fadd");
+}
+
+static PyObject*
+ExprObject_sub(ExprObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(sub);
+    return ExprObject_record(self, args, kwargs, kernels, 0, "sub");
+}
+
+static PyObject*
+ExprObject_fsub(ExprObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DISPATCH_KERNELS(sub);
+    return ExprObject_record(self, args, kwargs, kernels, 1, "fsub");
+}
+
+static PyObject*
+ExprObject_mul(ExprObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_MUL_KERNELS;
+    return ExprObject_record(self, args, kwargs, kernels, 0, "mul");
+}
+
+static PyObject*
+ExprObject_fmul(ExprObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_MUL_KERNELS;
+    return ExprObject_record(self, args, kwargs, kernels, 1, "fmul");
+}
+
+static PyObject*
+ExprObject_fdiv(ExprObject *self, PyObject *args, PyObject *kwargs)
+{
+    const pysimd_vec_binop_t kernels[] = PYSIMD_DIV_KERNELS;
+    return ExprObject_record(self, args, kwargs, kernels, 1, "fdiv");
+}
+
+// Marks every vector of the expression as in use, or no longer in use for a delta of -1
+static void ExprObject_mark_exports(ExprObject* self, SimdObject* dst, Py_ssize_t delta)
+{
+    Py_ssize_t i = 0;
+    self->base->exports += delta;
+    dst->exports += delta;
+    for (; i < self->n_steps; ++i) {
+        self->operands[i]->exports += delta;
+    }
+}
+
+/* Runs the recorded operations in one pass. The result covers the bytes that the base
+ * and all operands have in common, and goes to out when it is given, or a new vector
+ * with the element type of the base otherwise.
+ */
+static PyObject*
+ExprObject_eval(ExprObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"out", NULL};
+    PyObject* param_out = Py_None;
+    SimdObject* dst = NULL;
+    struct pysimd_expr_t expr;
+    size_t region = self->base->vec.size;
+    Py_ssize_t i = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist, &param_out)) {
+        return NULL;
+    }
+    for (; i < self->n_steps; ++i) {
+        if (self->operands[i]->vec.size < region)
+            region = self->operands[i]->vec.size;
+    }
+
+    if (param_out != Py_None) {
+        if (!PyObject_TypeCheck(param_out, &SimdObjectType)) {
+            PyErr_Format(SimdError, "Expected vector for 'out', got type '%s'", param_out->ob_type->tp_name);
+            return NULL;
+        }
+        dst = (SimdObject*)param_out;
+        if (dst->vec.size < region) {
+            PyErr_Format(SimdError, "'out' vector of size %zu is smaller than the %zu bytes operated on",
+                         dst->vec.size, region);
+            return NULL;
+        }
+        if (!SimdObject_check_writable(dst)) {
+            return NULL;
+        }
+        Py_INCREF(dst);
+    } else {
+        dst = SimdObject_make(region, self->base->lane);
+        if (dst == NULL) {
+            return NULL;
+        }
+    }
+
+    expr.base = &(self->base->vec);
+    expr.steps = self->steps;
+    expr.n_steps = (size_t)self->n_steps;
+    if (region < PYSIMD_NOGIL_MIN) {
+        pysimd_expr_run(&(dst->vec), &expr, region);
+    } else {
+        ExprObject_mark_exports(self, dst, 1);
+        Py_BEGIN_ALLOW_THREADS
+        pysimd_expr_run(&(dst->vec), &expr, region);
+        Py_END_ALLOW_THREADS
+        ExprObject_mark_exports(self, dst, -1);
+    }
+    return (PyObject*)dst;
+}
+
+static PyObject *
+ExprObject_len(ExprObject *self, PyObject *Py_UNUSED(ignored))
+{
+    return PyLong_FromSsize_t(self->n_steps);
+}
+
+static PyMethodDef ExprObject_methods[] = {
+    {"add", (PyCFunction) ExprObject_add, METH_VARARGS | METH_KEYWORDS,
+    "Records adding a vector, returns the expression"
+    },
+    {"fadd", (PyCFunction) ExprObject_fadd, METH_VARARGS | METH_KEYWORDS,
+    "Records adding a vector as floating point numbers, returns the expression"
+    },
+    {"sub", (PyCFunction) ExprObject_sub, METH_VARARGS | METH_KEYWORDS,
+    "Records subtracting a vector, returns the expression"
+    },
+    {"fsub", (PyCFunction) ExprObject_fsub, METH_VARARGS | METH_KEYWORDS,
+    "Records subtracting a vector as floating point numbers, returns the expression"
+    },
+    {"mul", (PyCFunction) ExprObject_mul, METH_VARARGS | METH_KEYWORDS,
+    "Records multiplying by a vector, keeping the low half of each product, returns the expression"
+    },
+    {"fmul", (PyCFunction) ExprObject_fmul, METH_VARARGS | METH_KEYWORDS,
+    "Records multiplying by a vector as floating point numbers, returns the expression"
+    },
+    {"fdiv", (PyCFunction) ExprObject_fdiv, METH_VARARGS | METH_KEYWORDS,
+    "Records dividing by a vector as floating point numbers, returns the expression"
+    },
+    {"eval", (PyCFunction) ExprObject_eval, METH_VARARGS | METH_KEYWORDS,
+    "Runs the recorded operations in a single pass, into a new vector or out"
+    },
+    {"steps", (PyCFunction) ExprObject_len, METH_NOARGS,
+    "Returns the number of recorded operations"
+    },
+    {NULL}  /* Sentinel */
+};
+
+PyTypeObject ExprObjectType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "simd.Expr",
+    .tp_doc = "A deferred chain of vector operations, evaluated in a single pass",
+    .tp_basicsize = sizeof(ExprObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_dealloc = (destructor) ExprObject_dealloc,
+    .tp_methods = ExprObject_methods,
+};
+
+/* A matrix of f32 or f64 lanes over the memory of a vector. Rows, columns and
+ * transposes are views over the same vector, which is kept alive and cannot be resized
+ * while any view of it exists.
+ */
+typedef struct {
+    PyObject_HEAD
+    SimdObject* base;
+    size_t offset;
+    struct pysimd_lane_t lane;
+    size_t rows;
+    size_t cols;
+    size_t row_stride;
+    size_t col_stride;
+} MatObject;
+
+static struct pysimd_mat_t MatObject_mat(MatObject* self)
+{
+    struct pysimd_mat_t mat;
+    mat.data = self->base->vec.data + self->offset;
+    mat.rows = self->rows;
+    mat.cols = self->cols;
+    mat.row_stride = self->row_stride;
+    mat.col_stride = self->col_stride;
+    return mat;
+}
+
+// Makes a matrix over base, taking a reference to it and pinning its memory
+static MatObject* MatObject_create(SimdObject* base, size_t offset, struct pysimd_lane_t lane,
+                                   size_t rows, size_t cols, size_t row_stride, size_t col_stride)
+{
+    MatObject* made = (MatObject*)MatObjectType.tp_alloc(&MatObjectType, 0);
+    if (made == NULL) {
+        return NULL;
+    }
+    Py_INCREF(base);
+    base->exports += 1;
+    made->base = base;
+    made->offset = offset;
+    made->lane = lane;
+    made->rows = rows;
+    made->cols = cols;
+    made->row_stride = row_stride;
+    made->col_stride = col_stride;
+    return made;
+}
+
+// Makes a zeroed matrix, each row padded to start on a cache line
+static MatObject* MatObject_make(size_t rows, size_t cols, struct pysimd_lane_t lane)
+{
+    const size_t row_stride = (cols * lane.width + PYSIMD_MAT_ROW_ALIGN - 1) & ~(size_t)(PYSIMD_MAT_ROW_ALIGN - 1);
+    MatObject* made = NULL;
+    SimdObject* base = SimdObject_make(rows * row_stride > 0 ? rows * row_stride : PYSIMD_MAT_ROW_ALIGN, lane);
+    if (base == NULL) {
+        return NULL;
+    }
+    memset(base->vec.data, 0, base->vec.size);
+    made = MatObject_create(base, 0, lane, rows, cols, row_stride, lane.width);
+    Py_DECREF(base);
+    return made;
+}
+
+static void MatObject_dealloc(MatObject* self)
+{
+    if (self->base != NULL) {
+        self->base->exports -= 1;
+        Py_DECREF(self->base);
+    }
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject*
+MatObject_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"rows", "cols", "type", "vec", "stride", NULL};
+    Py_ssize_t param_rows = 0;
+    Py_ssize_t param_cols = 0;
+    PyObject* param_type = NULL;
+    PyObject* param_vec = NULL;
+    Py_ssize_t param_stride = 0;
+    struct pysimd_lane_t lane = {PYSIMD_LANE_FLOAT, 4};
+    SimdObject* base = NULL;
+    size_t row_stride = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "nn|OOn", kwlist, &param_rows, &param_cols,
+                                     &param_type, &param_vec, &param_stride)) {
+        return NULL;
+    }
+    if (param_type != NULL && !pysimd_lane_from_args(param_type, 0, &lane, "Mat")) {
+        return NULL;
+    }
+    if (lane.kind != PYSIMD_LANE_FLOAT) {
+        PyErr_Format(SimdError, "The type '%s' is not supported for method 'Mat'", pysimd_lane_name(lane));
+        return NULL;
+    }
+    if (param_rows <= 0 || param_cols <= 0 || param_stride < 0) {
+        PyErr_Format(SimdError, "Mat needs positive rows and cols, got %zd and %zd", param_rows, param_cols);
+        return NULL;
+    }
+    if (param_vec == NULL || param_vec == Py_None) {
+        if (param_stride != 0) {
+            PyErr_SetString(SimdError, "A stride is only taken along with a vector");
+            return NULL;
+        }
+        return (PyObject*)MatObject_make((size_t)param_rows, (size_t)param_cols, lane);
+    }
+    if (!PyObject_TypeCheck(param_vec, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector, got type '%s'", param_vec->ob_type->tp_name);
+        return NULL;
+    }
+    base = (SimdObject*)param_vec;
+    row_stride = param_stride == 0 ? (size_t)param_cols * lane.width : (size_t)param_stride;
+    if (row_stride % lane.width != 0 || row_stride < (size_t)param_cols * lane.width) {
+        PyErr_Format(SimdError, "The stride %zu does not hold %zd lanes of type '%s'", row_stride, param_cols,
+                     pysimd_lane_name(lane));
+        return NULL;
+    }
+    if (((size_t)param_rows - 1) * row_stride + (size_t)param_cols * lane.width > base->vec.size) {
+        PyErr_Format(SimdError, "A vector of %zu bytes is too small for a %zd by %zd matrix", base->vec.size,
+                     param_rows, param_cols);
+        return NULL;
+    }
+    return (PyObject*)MatObject_create(base, 0, lane, (size_t)param_rows, (size_t)param_cols, row_stride, lane.width);
+}
+
+static PyObject* MatObject_get_rows(MatObject *self, void *closure)
+{
+    return PyLong_FromSize_t(self->rows);
+}
+
+static PyObject* MatObject_get_cols(MatObject *self, void *closure)
+{
+    return PyLong_FromSize_t(self->cols);
+}
+
+static PyObject* MatObject_get_shape(MatObject *self, void *closure)
+{
+    return Py_BuildValue("(nn)", (Py_ssize_t)self->rows, (Py_ssize_t)self->cols);
+}
+
+static PyObject* MatObject_get_type(MatObject *self, void *closure)
+{
+    return PyUnicode_FromString(pysimd_lane_name(self->lane));
+}
+
+static PyObject* MatObject_get_strides(MatObject *self, void *closure)
+{
+    return Py_BuildValue("(nn)", (Py_ssize_t)self->row_stride, (Py_ssize_t)self->col_stride);
+}
+
+static PyObject* MatObject_get_vec(MatObject *self, void *closure)
+{
+    Py_INCREF(self->base);
+    return (PyObject*)self->base;
+}
+
+static PyGetSetDef MatObject_getset[] = {
+    {"rows", (getter) MatObject_get_rows, NULL, "The number of rows", NULL},
+    {"cols", (getter) MatObject_get_cols, NULL, "The number of columns", NULL},
+    {"shape", (getter) MatObject_get_shape, NULL, "The rows and columns, as a tuple", NULL},
+    {"type", (getter) MatObject_get_type, NULL, "The element type, 'f32' or 'f64'", NULL},
+    {"strides", (getter) MatObject_get_strides, NULL, "The bytes between rows and between columns, as a tuple", NULL},
+    {"vec", (getter) MatObject_get_vec, NULL, "The vector whose memory the matrix is a view of", NULL},
+    {NULL}  /* Sentinel */
+};
+
+static int MatObject_check_index(MatObject* self, Py_ssize_t i, Py_ssize_t j)
+{
+    if (i < 0 || j < 0 || (size_t)i >= self->rows || (size_t)j >= self->cols) {
+        PyErr_Format(SimdError, "The index (%zd, %zd) is out of range for a %zu by %zu matrix", i, j,
+                     self->rows, self->cols);
+        return 0;
+    }
+    return 1;
+}
+
+static PyObject*
+MatObject_get(MatObject *self, PyObject *args)
+{
+    Py_ssize_t param_i = 0;
+    Py_ssize_t param_j = 0;
+    struct pysimd_mat_t mat = MatObject_mat(self);
+    if (!PyArg_ParseTuple(args, "nn", &param_i, &param_j) || !MatObject_check_index(self, param_i, param_j)) {
+        return NULL;
+    }
+    return PyFloat_FromDouble(simd_mat_get(&mat, self->lane.width, (size_t)param_i, (size_t)param_j));
+}
+
+static PyObject*
+MatObject_set(MatObject *self, PyObject *args)
+{
+    Py_ssize_t param_i = 0;
+    Py_ssize_t param_j = 0;
+    double param_value = 0.0;
+    struct pysimd_mat_t mat = MatObject_mat(self);
+    if (!PyArg_ParseTuple(args, "nnd", &param_i, &param_j, &param_value) ||
+        !MatObject_check_index(self, param_i, param_j) || !SimdObject_check_writable(self->base)) {
+        return NULL;
+    }
+    simd_mat_set(&mat, self->lane.width, (size_t)param_i, (size_t)param_j, param_value);
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+MatObject_row(MatObject *self, PyObject *args)
+{
+    Py_ssize_t param_i = 0;
+    if (!PyArg_ParseTuple(args, "n", &param_i) || !MatObject_check_index(self, param_i, 0)) {
+        return NULL;
+    }
+    return (PyObject*)MatObject_create(self->base, self->offset + (size_t)param_i * self->row_stride, self->lane,
+                                       1, self->cols, self->row_stride, self->col_stride);
+}
+
+static PyObject*
+MatObject_col(MatObject *self, PyObject *args)
+{
+    Py_ssize_t param_j = 0;
+    if (!PyArg_ParseTuple(args, "n", &param_j) || !MatObject_check_index(self, 0, param_j)) {
+        return NULL;
+    }
+    return (PyObject*)MatObject_create(self->base, self->offset + (size_t)param_j * self->col_stride, self->lane,
+                                       self->rows, 1, self->row_stride, self->col_stride);
+}
+
+static PyObject*
+MatObject_transpose(MatObject *self, PyObject *Py_UNUSED(ignored))
+{
+    return (PyObject*)MatObject_create(self->base, self->offset, self->lane,
+                                       self->cols, self->rows, self->col_stride, self->row_stride);
+}
+
+// Returns a new matrix with the same elements, with padded rows of lanes next to each other
+static PyObject*
+MatObject_copy(MatObject *self, PyObject *Py_UNUSED(ignored))
+{
+    struct pysimd_mat_t src = MatObject_mat(self);
+    struct pysimd_mat_t dst;
+    MatObject* made = MatObject_make(self->rows, self->cols, self->lane);
+    if (made == NULL) {
+        return NULL;
+    }
+    dst = MatObject_mat(made);
+    simd_mat_copy(&dst, &src, self->lane.width);
+    return (PyObject*)made;
+}
+
+static PyObject*
+MatObject_to_list(MatObject *self, PyObject *Py_UNUSED(ignored))
+{
+    struct pysimd_mat_t mat = MatObject_mat(self);
+    PyObject* rows = PyList_New((Py_ssize_t)self->rows);
+    size_t i = 0;
+    size_t j = 0;
+    for (; rows != NULL && i < self->rows; ++i) {
+        PyObject* row = PyList_New((Py_ssize_t)self->cols);
+        if (row == NULL) {
+            Py_CLEAR(rows);
+            break;
+        }
+        PyList_SET_ITEM(rows, (Py_ssize_t)i, row);
+        for (j = 0; j < self->cols; ++j) {
+            PyObject* value = PyFloat_FromDouble(simd_mat_get(&mat, self->lane.width, i, j));
+            if (value == NULL) {
+                Py_CLEAR(rows);
+                break;
+            }
+            PyList_SET_ITEM(row, (Py_ssize_t)j, value);
+        }
+    }
+    return rows;
+}
+
+/* Multiplies the matrix by the first cols lanes of x, into a new vector of rows lanes,
+ * zero padded to a multiple of 16 bytes, or into out when it is given.
+ */
+static PyObject*
+MatObject_gemv(MatObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"x", "out", NULL};
+    PyObject* param_x = NULL;
+    PyObject* param_out = Py_None;
+    SimdObject* x = NULL;
+    SimdObject* dst = NULL;
+    struct pysimd_mat_t mat = MatObject_mat(self);
+    const size_t width = self->lane.width;
+    size_t padded_bytes = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, &param_x, &param_out)) {
+        return NULL;
+    }
+    if (!PyObject_TypeCheck(param_x, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector, got type '%s'", param_x->ob_type->tp_name);
+        return NULL;
+    }
+    x = (SimdObject*)param_x;
+    if (x->vec.size < self->cols * width) {
+        PyErr_Format(SimdError, "The vector has fewer than %zu lanes", self->cols);
+        return NULL;
+    }
+    padded_bytes = (self->rows * width + 15) & ~(size_t)15;
+    if (param_out != Py_None) {
+        if (!PyObject_TypeCheck(param_out, &SimdObjectType)) {
+            PyErr_Format(SimdError, "Expected vector for 'out', got type '%s'", param_out->ob_type->tp_name);
+            return NULL;
+        }
+        dst = (SimdObject*)param_out;
+        if (dst == x || dst == self->base) {
+            PyErr_SetString(SimdError, "The 'out' vector cannot be an operand of gemv");
+            return NULL;
+        }
+        if (dst->vec.size < self->rows * width) {
+            PyErr_Format(SimdError, "The 'out' vector has fewer than %zu lanes", self->rows);
+            return NULL;
+        }
+        if (!SimdObject_check_writable(dst)) {
+            return NULL;
+        }
+        Py_INCREF(dst);
+    } else {
+        dst = SimdObject_make(padded_bytes, self->lane);
+        if (dst == NULL) {
+            return NULL;
+        }
+        memset(dst->vec.data + self->rows * width, 0, padded_bytes - self->rows * width);
+    }
+    if (self->rows * self->cols * width < PYSIMD_NOGIL_MIN) {
+        pysimd_gemv_run(width, &mat, x->vec.data, dst->vec.data);
+    } else {
+        x->exports += 1;
+        dst->exports += 1;
+        Py_BEGIN_ALLOW_THREADS
+        pysimd_gemv_run(width, &mat, x->vec.data, dst->vec.data);
+        Py_END_ALLOW_THREADS
+        x->exports -= 1;
+        dst->exports -= 1;
+    }
+    return (PyObject*)dst;
+}
+
+/* Multiplies the matrix by b, into a new matrix, or into out when it is given, which
+ * must have lanes next to each other in each row and be apart from both operands.
+ */
+static PyObject*
+MatObject_matmul(MatObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *kwlist[] = {"b", "out", NULL};
+    PyObject* param_b = NULL;
+    PyObject* param_out = Py_None;
+    MatObject* b = NULL;
+    MatObject* dst = NULL;
+    struct pysimd_mat_t a_mat = MatObject_mat(self);
+    struct pysimd_mat_t b_mat;
+    struct pysimd_mat_t c_mat;
+    int failed = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, &param_b, &param_out)) {
+        return NULL;
+    }
+    if (!PyObject_TypeCheck(param_b, &MatObjectType)) {
+        PyErr_Format(SimdError, "Expected matrix, got type '%s'", param_b->ob_type->tp_name);
+        return NULL;
+    }
+    b = (MatObject*)param_b;
+    if (b->lane.width != self->lane.width) {
+        PyErr_Format(SimdError, "cannot multiply matrices of types '%s' and '%s'",
+                     pysimd_lane_name(self->lane), pysimd_lane_name(b->lane));
+        return NULL;
+    }
+    if (b->rows != self->cols) {
+        PyErr_Format(SimdError, "cannot multiply a %zu by %zu matrix by a %zu by %zu matrix",
+                     self->rows, self->cols, b->rows, b->cols);
+        return NULL;
+    }
+    b_mat = MatObject_mat(b);
+    if (param_out != Py_None) {
+        if (!PyObject_TypeCheck(param_out, &MatObjectType)) {
+            PyErr_Format(SimdError, "Expected matrix for 'out', got type '%s'", param_out->ob_type->tp_name);
+            return NULL;
+        }
+        dst = (MatObject*)param_out;
+        if (dst->lane.width != self->lane.width || dst->rows != self->rows || dst->cols != b->cols ||
+            dst->col_stride != self->lane.width) {
+            PyErr_Format(SimdError, "The 'out' matrix must be a %zu by %zu matrix of type '%s' with lanes next to each other",
+                         self->rows, b->cols, pysimd_lane_name(self->lane));
+            return NULL;
+        }
+        if (dst->base == self->base || dst->base == b->base) {
+            PyErr_SetString(SimdError, "The 'out' matrix cannot share a vector with an operand of matmul");
+            return NULL;
+        }
+        if (!SimdObject_check_writable(dst->base)) {
+            return NULL;
+        }
+        Py_INCREF(dst);
+    } else {
+        dst = MatObject_make(self->rows, b->cols, self->lane);
+        if (dst == NULL) {
+            return NULL;
+        }
+    }
+    c_mat = MatObject_mat(dst);
+    if (self->rows * self->cols * b->cols < PYSIMD_NOGIL_MIN) {
+        failed = pysimd_gemm_run(self->lane.width, &c_mat, &a_mat, &b_mat);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        failed = pysimd_gemm_run(self->lane.width, &c_mat, &a_mat, &b_mat);
+        Py_END_ALLOW_THREADS
+    }
+    if (failed) {
+        Py_DECREF(dst);
+        return PyErr_NoMemory();
+    }
+    return (PyObject*)dst;
+}
+
+static PyObject*
+MatObject_repr(MatObject *self)
+{
+    return PyUnicode_FromFormat("simd.Mat(%zu, %zu, '%s')", self->rows, self->cols, pysimd_lane_name(self->lane));
+}
+
+static PyMethodDef MatObject_methods[] = {
+    {"get", (PyCFunction) MatObject_get, METH_VARARGS,
+    "Returns the element at a row and column"
     },
-    {"as_bytes", (PyCFunction) SimdObject_as_bytes, METH_VARARGS | METH_KEYWORDS,
-    "Returns a bytes object representing the internal bytes of the vector"
+    {"set", (PyCFunction) MatObject_set, METH_VARARGS,
+    "Sets the element at a row and column"
     },
-    {"as_tuple", (PyCFunction) SimdObject_as_tuple, METH_VARARGS | METH_KEYWORDS,
-    "Returns a tuple populated with members of the vector, defaults to 32 bit integers"
+    {"row", (PyCFunction) MatObject_row, METH_VARARGS,
+    "Returns a 1 by cols view of a row"
     },
-    {"copy", (PyCFunction) SimdObject_copy, METH_VARARGS | METH_KEYWORDS,
-    "Returns a copy of the vector"
+    {"col", (PyCFunction) MatObject_col, METH_VARARGS,
+    "Returns a rows by 1 view of a column"
+    },
+    {"transpose", (PyCFunction) MatObject_transpose, METH_NOARGS,
+    "Returns a transposed view of the matrix, without copying"
+    },
+    {"copy", (PyCFunction) MatObject_copy, METH_NOARGS,
+    "Returns a new matrix with the same elements and padded rows"
+    },
+    {"to_list", (PyCFunction) MatObject_to_list, METH_NOARGS,
+    "Returns the elements as a list of rows"
+    },
+    {"gemv", (PyCFunction) MatObject_gemv, METH_VARARGS | METH_KEYWORDS,
+    "Multiplies the matrix by a vector, into a new vector or out"
+    },
+    {"matmul", (PyCFunction) MatObject_matmul, METH_VARARGS | METH_KEYWORDS,
+    "Multiplies the matrix by another, into a new matrix or out"
     },
     {NULL}  /* Sentinel */
 };
 
-PyTypeObject SimdObjectType = {
+PyTypeObject MatObjectType = {
     PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "simd.Vec",
-    .tp_doc = "A vector containing simd data",
-    .tp_basicsize = sizeof(SimdObject),
+    .tp_name = "simd.Mat",
+    .tp_doc = "A strided matrix of f32 or f64 lanes over the memory of a vector",
+    .tp_basicsize = sizeof(MatObject),
     .tp_itemsize = 0,
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_new = SimdObject_new,
-    .tp_init = (initproc) SimdObject_init,
-    .tp_dealloc = (destructor) SimdObject_dealloc,
-    .tp_repr = (reprfunc) SimdObject_repr,
-    .tp_methods = SimdObject_methods,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = MatObject_new,
+    .tp_dealloc = (destructor) MatObject_dealloc,
+    .tp_repr = (reprfunc) MatObject_repr,
+    .tp_methods = MatObject_methods,
+    .tp_getset = MatObject_getset,
 };
 
+static PyObject* _expr(PyObject* self, PyObject* args)
+{
+    PyObject* base = NULL;
+    if (!PyArg_ParseTuple(args, "O", &base)) {
+        return NULL;
+    }
+    if (!PyObject_TypeCheck(base, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector, got type '%s'", base->ob_type->tp_name);
+        return NULL;
+    }
+    return ExprObject_create((SimdObject*)base);
+}
+
+/* Takes the bits of a where the mask is set, and those of b elsewhere, such as the lanes
+ * of a where a lane mask from cmp holds. The result goes into out when it is given, and
+ * into a new vector of the type of a otherwise.
+ */
+static PyObject* _select(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    static char *kwlist[] = {"mask", "a", "b", "out", NULL};
+    PyObject* operands[3] = {NULL, NULL, NULL};
+    PyObject* param_out = Py_None;
+    SimdObject* mask = NULL;
+    SimdObject* a = NULL;
+    SimdObject* b = NULL;
+    SimdObject* dst = NULL;
+    size_t oper_region = 0;
+    size_t i = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|O", kwlist,
+                                     &operands[0], &operands[1], &operands[2], &param_out)) {
+        return NULL;
+    }
+    for (; i < 3; ++i) {
+        if (!PyObject_TypeCheck(operands[i], &SimdObjectType)) {
+            PyErr_Format(SimdError, "Expected vector, got type '%s'", operands[i]->ob_type->tp_name);
+            return NULL;
+        }
+    }
+    mask = (SimdObject*)operands[0];
+    a = (SimdObject*)operands[1];
+    b = (SimdObject*)operands[2];
+    oper_region = PYSIMD_MIN_VEC_SIZE(&(mask->vec), &(a->vec));
+    if (b->vec.size < oper_region) {
+        oper_region = b->vec.size;
+    }
+    if (param_out == Py_None) {
+        dst = SimdObject_make(oper_region, a->lane);
+        if (dst == NULL) {
+            return NULL;
+        }
+    } else {
+        dst = SimdObject_result_target(a, param_out, oper_region);
+        if (dst == NULL) {
+            return NULL;
+        }
+        Py_INCREF(dst);
+    }
+    SimdObject_run_ternop(pysimd_dispatch.select, dst, mask, a, b);
+    return (PyObject*)dst;
+}
+
+/* Reads the lane type of a distance, given by name, or else that of the first vector.
+ * Distances are between f32 or i8 lanes.
+ */
+static int _dist_lane(PyObject* param_type, SimdObject* a, struct pysimd_lane_t* lane, const char* method)
+{
+    *lane = a->lane;
+    if (param_type != NULL && !pysimd_lane_from_args(param_type, 0, lane, method)) {
+        return 0;
+    }
+    if (!(lane->kind == PYSIMD_LANE_FLOAT && lane->width == 4) && !(lane->kind == PYSIMD_LANE_INT && lane->width == 1)) {
+        PyErr_Format(SimdError, "The type '%s' is not supported for method '%s'", pysimd_lane_name(*lane), method);
+        return 0;
+    }
+    return 1;
+}
+
+/* Sums the lanes two vectors both have for a distance, returning the lane type in lane,
+ * or 0 with an error set.
+ */
+static int _dist_sums(PyObject* args, PyObject* kwargs, enum pysimd_dist_metric metric, const char* method,
+                      struct pysimd_lane_t* lane, union pysimd_lane_value* sums)
+{
+    static char *kwlist[] = {"a", "b", "type", NULL};
+    PyObject* operands[2] = {NULL, NULL};
+    PyObject* param_type = NULL;
+    SimdObject* a = NULL;
+    SimdObject* b = NULL;
+    pysimd_vec_dist_t kernel = NULL;
+    size_t oper_region = 0;
+    size_t i = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|O", kwlist, &operands[0], &operands[1], &param_type)) {
+        return 0;
+    }
+    for (; i < 2; ++i) {
+        if (!PyObject_TypeCheck(operands[i], &SimdObjectType)) {
+            PyErr_Format(SimdError, "Expected vector, got type '%s'", operands[i]->ob_type->tp_name);
+            return 0;
+        }
+    }
+    a = (SimdObject*)operands[0];
+    b = (SimdObject*)operands[1];
+    if (!_dist_lane(param_type, a, lane, method)) {
+        return 0;
+    }
+    kernel = lane->kind == PYSIMD_LANE_FLOAT ? pysimd_dispatch.dist_f32[metric] : pysimd_dispatch.dist_i8[metric];
+    oper_region = PYSIMD_MIN_VEC_SIZE(&(a->vec), &(b->vec));
+    a->exports += 1;
+    b->exports += 1;
+    if (oper_region < PYSIMD_NOGIL_MIN) {
+        pysimd_dist_run(kernel, lane->kind == PYSIMD_LANE_FLOAT, &(a->vec), &(b->vec), oper_region, sums);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        pysimd_dist_run(kernel, lane->kind == PYSIMD_LANE_FLOAT, &(a->vec), &(b->vec), oper_region, sums);
+        Py_END_ALLOW_THREADS
+    }
+    a->exports -= 1;
+    b->exports -= 1;
+    return 1;
+}
+
+// One of the totals of a distance as a double, from .i for i8 lanes
+static double _dist_total(struct pysimd_lane_t lane, const union pysimd_lane_value* sums, size_t k)
+{
+    return lane.kind == PYSIMD_LANE_FLOAT ? sums[k].f : (double)sums[k].i;
+}
+
+/* Returns the sum of the products of the lanes of a and b, an int for i8 lanes, and a
+ * float summed in double precision per block for f32 lanes.
+ */
+static PyObject* _dot(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    struct pysimd_lane_t lane;
+    union pysimd_lane_value sums[3];
+    if (!_dist_sums(args, kwargs, PYSIMD_DIST_DOT, "dot", &lane, sums)) {
+        return NULL;
+    }
+    if (lane.kind == PYSIMD_LANE_FLOAT) {
+        return PyFloat_FromDouble(sums[0].f);
+    }
+    return PyLong_FromLongLong((long long)sums[0].i);
+}
+
+// Returns the euclidean distance between a and b
+static PyObject* _l2(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    struct pysimd_lane_t lane;
+    union pysimd_lane_value sums[3];
+    if (!_dist_sums(args, kwargs, PYSIMD_DIST_L2, "l2", &lane, sums)) {
+        return NULL;
+    }
+    return PyFloat_FromDouble(sqrt(_dist_total(lane, sums, 0)));
+}
+
+// Returns the cosine of the angle between a and b, NaN when either is all zeros
+static PyObject* _cosine(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    struct pysimd_lane_t lane;
+    union pysimd_lane_value sums[3];
+    if (!_dist_sums(args, kwargs, PYSIMD_DIST_COSINE, "cosine", &lane, sums)) {
+        return NULL;
+    }
+    return PyFloat_FromDouble(pysimd_dist_cosine(_dist_total(lane, sums, 0), _dist_total(lane, sums, 1),
+                                                 _dist_total(lane, sums, 2)));
+}
+
+/* Returns a list of the positions of the k rows of matrix nearest to query, nearest
+ * first. The matrix holds rows of dim lanes one after the other, the first rows of them
+ * when given, else every whole row, padding included. The metric is 'l2', 'dot' or
+ * 'cosine', the greatest dot product or cosine being nearest.
+ */
+static PyObject* _knn(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    static char *kwlist[] = {"query", "matrix", "dim", "k", "metric", "type", "rows", NULL};
+    PyObject* param_query = NULL;
+    PyObject* param_matrix = NULL;
+    Py_ssize_t param_dim = 0;
+    Py_ssize_t param_k = 0;
+    const char* param_metric = "l2";
+    PyObject* param_type = NULL;
+    Py_ssize_t param_rows = -1;
+    SimdObject* query = NULL;
+    SimdObject* matrix = NULL;
+    struct pysimd_lane_t lane;
+    enum pysimd_dist_metric metric = PYSIMD_DIST_L2;
+    struct pysimd_vec_t query_row;
+    size_t* found = NULL;
+    size_t row_bytes = 0;
+    size_t n_rows = 0;
+    ptrdiff_t n_found = 0;
+    ptrdiff_t i = 0;
+    PyObject* rows = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOnn|sOn", kwlist, &param_query, &param_matrix,
+                                     &param_dim, &param_k, &param_metric, &param_type, &param_rows)) {
+        return NULL;
+    }
+    if (!PyObject_TypeCheck(param_query, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector for 'query', got type '%s'", param_query->ob_type->tp_name);
+        return NULL;
+    }
+    if (!PyObject_TypeCheck(param_matrix, &SimdObjectType)) {
+        PyErr_Format(SimdError, "Expected vector for 'matrix', got type '%s'", param_matrix->ob_type->tp_name);
+        return NULL;
+    }
+    query = (SimdObject*)param_query;
+    matrix = (SimdObject*)param_matrix;
+    if (strcmp(param_metric, "dot") == 0) {
+        metric = PYSIMD_DIST_DOT;
+    } else if (strcmp(param_metric, "cosine") == 0) {
+        metric = PYSIMD_DIST_COSINE;
+    } else if (strcmp(param_metric, "l2") != 0) {
+        PyErr_Format(SimdError, "Unrecognized metric: '%s' for knn operation", param_metric);
+        return NULL;
+    }
+    if (!_dist_lane(param_type, query, &lane, "knn")) {
+        return NULL;
+    }
+    if (param_dim <= 0 || param_k <= 0) {
+        PyErr_Format(SimdError, "knn needs a positive dim and k, got %zd and %zd", param_dim, param_k);
+        return NULL;
+    }
+    row_bytes = (size_t)param_dim * lane.width;
+    if (query->vec.size < row_bytes) {
+        PyErr_Format(SimdError, "The query has fewer than %zd lanes", param_dim);
+        return NULL;
+    }
+    n_rows = matrix->vec.size / row_bytes;
+    if (param_rows >= 0) {
+        if ((size_t)param_rows > n_rows) {
+            PyErr_Format(SimdError, "knn needs %zd rows, the matrix has %zu", param_rows, n_rows);
+            return NULL;
+        }
+        n_rows = (size_t)param_rows;
+    }
+    found = (size_t*)malloc(((size_t)param_k < n_rows ? (size_t)param_k : n_rows + 1) * sizeof(size_t));
+    if (found == NULL) {
+        return PyErr_NoMemory();
+    }
+    query_row.size = row_bytes;
+    query_row.data = query->vec.data;
+    query_row.capacity = 0;
+    query->exports += 1;
+    matrix->exports += 1;
+    if (matrix->vec.size < PYSIMD_NOGIL_MIN) {
+        n_found = pysimd_knn_run(lane.kind == PYSIMD_LANE_FLOAT ? pysimd_dispatch.dist_f32[metric] : pysimd_dispatch.dist_i8[metric],
+                                 metric, lane.kind == PYSIMD_LANE_FLOAT, &query_row, matrix->vec.data, row_bytes, n_rows,
+                                 (size_t)param_k, found);
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        n_found = pysimd_knn_run(lane.kind == PYSIMD_LANE_FLOAT ? pysimd_dispatch.dist_f32[metric] : pysimd_dispatch.dist_i8[metric],
+                                 metric, lane.kind == PYSIMD_LANE_FLOAT, &query_row, matrix->vec.data, row_bytes, n_rows,
+                                 (size_t)param_k, found);
+        Py_END_ALLOW_THREADS
+    }
+    query->exports -= 1;
+    matrix->exports -= 1;
+    if (n_found < 0) {
+        free(found);
+        return PyErr_NoMemory();
+    }
+    rows = PyList_New(n_found);
+    for (; rows != NULL && i < n_found; ++i) {
+        PyObject* row = PyLong_FromSize_t(found[i]);
+        if (row == NULL) {
+            Py_CLEAR(rows);
+            break;
+        }
+        PyList_SET_ITEM(rows, i, row);
+    }
+    free(found);
+    return rows;
+}
 
 static PyObject* _system_info(PyObject* self, PyObject *Py_UNUSED(ignored))
 {
     PyObject* info_dict = NULL;
     PyObject* arch_str = NULL;
     PyObject* cc_str = NULL;
+    PyObject* dispatch_str = NULL;
+    PyObject* cache_size = NULL;
+    PyObject* stream_min = NULL;
     PyObject* features_dict = NULL;
     struct pysimd_sys_info sinfo;
     pysimd_sys_info_init(&sinfo);
@@ -527,6 +3939,33 @@ static PyObject* _system_info(PyObject* self, PyObject *Py_UNUSED(ignored))
     }
     Py_DECREF(cc_str);
 
+    dispatch_str = PyUnicode_FromString(pysimd_dispatch_tier_stringify(pysimd_dispatch.tier));
+    if (dispatch_str == NULL) {
+        goto DICT_ERRCLEAN;
+    }
+    if (0 != PyDict_SetItemString(info_dict, "dispatch", dispatch_str)) {
+        goto DICT_ERRCLEAN;
+    }
+    Py_CLEAR(dispatch_str);
+
+    cache_size = PyLong_FromSize_t(sinfo.cache_size);
+    if (cache_size == NULL) {
+        goto DICT_ERRCLEAN;
+    }
+    if (0 != PyDict_SetItemString(info_dict, "cache_size", cache_size)) {
+        goto DICT_ERRCLEAN;
+    }
+    Py_CLEAR(cache_size);
+
+    stream_min = PyLong_FromSize_t(pysimd_vec_stream_min);
+    if (stream_min == NULL) {
+        goto DICT_ERRCLEAN;
+    }
+    if (0 != PyDict_SetItemString(info_dict, "stream_min", stream_min)) {
+        goto DICT_ERRCLEAN;
+    }
+    Py_CLEAR(stream_min);
+
     features_dict = PyDict_New();
     if (features_dict == NULL) {
         goto DICT_ERRCLEAN;
@@ -572,10 +4011,35 @@ DICT_ERRCLEAN:
     Py_XDECREF(info_dict);
     Py_XDECREF(arch_str);
     Py_XDECREF(cc_str);
+    Py_XDECREF(dispatch_str);
+    Py_XDECREF(cache_size);
+    Py_XDECREF(stream_min);
     Py_XDECREF(features_dict);
     return NULL;
 }
 
+static PyObject* _set_num_threads(PyObject* self, PyObject* args)
+{
+    Py_ssize_t n_threads = 0;
+    if (!PyArg_ParseTuple(args, "n", &n_threads)) {
+        return NULL;
+    }
+    if (n_threads < 0) {
+        PyErr_Format(SimdError, "The number of threads cannot be negative, got %zd", n_threads);
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    pysimd_pool_set_threads((size_t)n_threads);
+    Py_END_ALLOW_THREADS
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* _get_num_threads(PyObject* self, PyObject *Py_UNUSED(ignored))
+{
+    return PyLong_FromSize_t(pysimd_pool_get_threads());
+}
+
 static PyObject* _simd_verion(PyObject* self, PyObject *Py_UNUSED(ignored))
 {
     return Py_BuildValue("III", 0, 0, 1);
@@ -586,6 +4050,30 @@ static PyMethodDef myMethods[] = {
     { "system_info", (PyCFunction)_system_info, METH_NOARGS, 
       "Returns a dictionary containing information on the system architecture and features." 
     },
+    { "expr", (PyCFunction)_expr, METH_VARARGS,
+      "Starts a deferred expression on a vector, same as Vec.lazy()."
+    },
+    { "select", (PyCFunction)_select, METH_VARARGS | METH_KEYWORDS,
+      "Takes the bits of a where the mask is set, and those of b elsewhere."
+    },
+    { "dot", (PyCFunction)_dot, METH_VARARGS | METH_KEYWORDS,
+      "Returns the dot product of two f32 or i8 vectors."
+    },
+    { "l2", (PyCFunction)_l2, METH_VARARGS | METH_KEYWORDS,
+      "Returns the euclidean distance between two f32 or i8 vectors."
+    },
+    { "cosine", (PyCFunction)_cosine, METH_VARARGS | METH_KEYWORDS,
+      "Returns the cosine of the angle between two f32 or i8 vectors."
+    },
+    { "knn", (PyCFunction)_knn, METH_VARARGS | METH_KEYWORDS,
+      "Returns the positions of the k rows of a matrix vector nearest to a query vector, of its first rows if given."
+    },
+    { "set_num_threads", (PyCFunction)_set_num_threads, METH_VARARGS,
+      "Sets the number of threads large operations are split across, 0 uses every cpu."
+    },
+    { "get_num_threads", (PyCFunction)_get_num_threads, METH_NOARGS,
+      "Returns the number of threads large operations are split across."
+    },
     { "version", (PyCFunction)_simd_verion, METH_NOARGS, 
       "Returns the version of pysimd." 
     },
@@ -605,8 +4093,21 @@ static struct PyModuleDef simdModule = {
 PyMODINIT_FUNC PyInit_simd(void)
 {
     PyObject *m;
+    struct pysimd_sys_info sinfo;
+    pysimd_sys_info_init(&sinfo);
+    pysimd_dispatch_init(&sinfo);
+    pysimd_pool_init();
+    if (!pysimd_byte_ints_init())
+        return NULL;
+    // Failing to register only means cached vector memory is left to the OS at exit
+    (void)Py_AtExit(pysimd_alloc_trim);
+
     if (PyType_Ready(&SimdObjectType) < 0)
         return NULL;
+    if (PyType_Ready(&ExprObjectType) < 0)
+        return NULL;
+    if (PyType_Ready(&MatObjectType) < 0)
+        return NULL;
 
     m = PyModule_Create(&simdModule);
     if (m == NULL)
@@ -619,6 +4120,23 @@ PyMODINIT_FUNC PyInit_simd(void)
         return NULL;
     }
 
+    Py_INCREF(&ExprObjectType);
+    if (PyModule_AddObject(m, "Expr", (PyObject *) &ExprObjectType) < 0) {
+        Py_DECREF(&ExprObjectType);
+        Py_DECREF(&SimdObjectType);
+        Py_DECREF(m);
+        return NULL;
+    }
+
+    Py_INCREF(&MatObjectType);
+    if (PyModule_AddObject(m, "Mat", (PyObject *) &MatObjectType) < 0) {
+        Py_DECREF(&MatObjectType);
+        Py_DECREF(&ExprObjectType);
+        Py_DECREF(&SimdObjectType);
+        Py_DECREF(m);
+        return NULL;
+    }
+
     SimdError = PyErr_NewException("simd.SimdError", NULL, NULL);
     Py_XINCREF(SimdError);
     if (PyModule_AddObject(m, "error", SimdError) < 0) {
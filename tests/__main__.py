@@ -33,10 +33,11 @@ else:
 		raise Exception("Found no extensions in " + extend_dir)
 
 # Try to import extension
+sys.path.insert(0, BUILT_TEST_DIR)
 try:
 	import simd
 except Exception as exc:
-	raise("Could not import extension, reason: " + str(exc))
+	raise Exception("Could not import extension, reason: " + str(exc))
 
 compiler_includes_and_libs = sysconfig.get_config_vars('INCLUDEPY', 'LIBPL', 'LIBRARY')
 if len(compiler_includes_and_libs) != 3:
@@ -48,8 +49,15 @@ if cc_libs.startswith("lib"):
 if cc_libs.endswith(".a"):
 	cc_libs = cc_libs[:-2]
 
+# A static libpython needs its own dependencies linked in, and must export its symbols
+# for the extension module to resolve them when it is imported
+cc_link_args = " ".join([flag for flag in sysconfig.get_config_vars('LIBS', 'SYSLIBS', 'LINKFORSHARED') if flag]).split()
+
 py3_embed_cc = distutils.ccompiler.new_compiler()
 
+# Sources are compiled by name from their own directory, an absolute source path would
+# be repeated under the output directory for its object file
+os.chdir(CURRENT_DIR)
 current_dir_cfiles = [os.path.join(CURRENT_DIR, path) for path in os.listdir(CURRENT_DIR) if path.endswith(".c")]
 built_tests = []
 
@@ -57,9 +65,10 @@ for cfile in current_dir_cfiles:
 	cfile_dir = os.path.dirname(cfile)
 	built_name = os.path.join(cfile_dir, 'bin', os.path.basename(cfile)[:-2])
 	print("Building: " + cfile)
-	obj_file = py3_embed_cc.compile([cfile], include_dirs=[cc_includes], macros=[('TESTING_BIN_PATH', "\"" + cfile_dir + "\"")])
+	obj_file = py3_embed_cc.compile([os.path.basename(cfile)], include_dirs=[cc_includes], macros=[('TESTING_BIN_PATH', "\"" + BUILT_TEST_DIR + "\"")],
+	                              output_dir=BUILT_TEST_DIR)
 	py3_embed_cc.link_executable(obj_file, library_dirs=[cc_lib_dirs], libraries=[cc_libs], 
-		                         output_progname=built_name)
+		                         output_progname=built_name, extra_postargs=cc_link_args)
 	built_tests.append(built_name)
 
 # Run the tests
@@ -84,3 +93,6 @@ for cmdtest in built_tests:
 print("------------------------------------------------------")
 print("{} tests failed out of {} total tests".format(len(tests_failed), len(built_tests)))
 print("------------------------------------------------------")
+
+if len(tests_failed) > 0:
+	sys.exit(1)
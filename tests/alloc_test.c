@@ -0,0 +1,80 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+/* Checks the vector allocator through the addresses of vector data: reuse of freed
+ * blocks per size class up to the class cache limit, resizing within and past the
+ * capacity of a block, and blocks too large to be pooled.
+ */
+static const char* ALLOC_CHECKS =
+"import simd, ctypes, mmap\n"
+"def addr(v):\n"
+"    c = ctypes.c_char.from_buffer(v)\n"
+"    found = ctypes.addressof(c)\n"
+"    del c\n"
+"    return found\n"
+"# Pooled blocks of 1 MB, of which the class caches 4 MB\n"
+"pooled = [simd.Vec(size=1 << 20, zero=False) for _ in range(8)]\n"
+"freed = [addr(v) for v in pooled]\n"
+"while pooled:\n"
+"    del pooled[0]\n"
+"pooled = [simd.Vec(size=1 << 20) for _ in range(4)]\n"
+"assert [addr(v) for v in pooled] == freed[3::-1]\n"
+"assert all(v.as_bytes() == bytes(1 << 20) for v in pooled)\n"
+"del pooled[:]\n"
+"# Freed blocks come back for any size of the same class, zeroed unless zero=False\n"
+"for size, other in ((16, 64), (48, 32), (208, 256), (4096, 2064), (5008, 8192)):\n"
+"    v = simd.Vec(size=size, repeat_value=0xEE, repeat_size=1)\n"
+"    at = addr(v)\n"
+"    assert at % 64 == 0, size\n"
+"    for _ in range(1000):\n"
+"        del v\n"
+"        v = simd.Vec(size=other)\n"
+"        assert addr(v) == at and v.as_bytes() == bytes(v.size()), size\n"
+"    del v\n"
+"    v = simd.Vec(size=size, zero=False)\n"
+"    assert addr(v) == at and v.size() == size, size\n"
+"# Resizing within the capacity keeps the block and zeroes the grown tail\n"
+"v = simd.Vec(size=256, repeat_value=7, repeat_size=1)\n"
+"at = addr(v)\n"
+"assert v.resize(144) == 144 and addr(v) == at and v.as_bytes() == b'\\x07' * 144\n"
+"assert v.resize(256) == 256 and addr(v) == at\n"
+"assert v.as_bytes() == b'\\x07' * 144 + bytes(112)\n"
+"# Past the capacity, or below half of it, the data moves to a block of another class\n"
+"v = simd.Vec(size=256, repeat_value=9, repeat_size=1)\n"
+"assert v.resize(1024) == 1024 and v.as_bytes() == b'\\x09' * 256 + bytes(768)\n"
+"v = simd.Vec(size=256, repeat_value=9, repeat_size=1)\n"
+"at = addr(v)\n"
+"assert v.resize(64) == 64 and addr(v) != at and v.as_bytes() == b'\\x09' * 64\n"
+"assert v.resize(128) == 128 and v.as_bytes() == b'\\x09' * 64 + bytes(64)\n"
+"# Over 1 MB blocks are mapped from the OS, a page at a time\n"
+"size = (1 << 20) + 16\n"
+"v = simd.Vec(size=size, repeat_value=3, repeat_size=1)\n"
+"at = addr(v)\n"
+"assert at % mmap.PAGESIZE == 0 and v.as_bytes() == b'\\x03' * size\n"
+"assert v.resize(size - 32) == size - 32 and addr(v) == at\n"
+"assert v.resize(size) == size and addr(v) == at and v.as_bytes() == b'\\x03' * (size - 32) + bytes(32)\n"
+"assert v.resize(4 << 20) == 4 << 20 and v.as_bytes() == b'\\x03' * (size - 32) + bytes((4 << 20) - size + 32)\n"
+"assert v.resize(4096) == 4096 and addr(v) % 64 == 0 and v.as_bytes() == b'\\x03' * 4096\n"
+"del v\n"
+"v = simd.Vec(size=3 << 20, zero=False)\n"
+"assert v.size() == 3 << 20 and addr(v) % mmap.PAGESIZE == 0\n"
+"print('Alloc checks passed')\n";
+
+int
+main(int argc, char *argv[])
+{
+    int result = 0;
+    Py_Initialize();
+    PyObject * sys_path = PySys_GetObject("path");
+    PyList_Append(sys_path, PyUnicode_FromString(TESTING_BIN_PATH));
+
+    if (PyRun_SimpleString(ALLOC_CHECKS) != 0) {
+        fprintf(stderr, "Alloc checks failed\n");
+        result = 1;
+    }
+
+    if (Py_FinalizeEx() < 0) {
+        exit(120);
+    }
+    return result;
+}
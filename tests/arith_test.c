@@ -0,0 +1,326 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+/* Checks add and sub at each lane width over sizes that exercise the unrolled
+ * body, the single register loop and the 16 byte remainder of the wide kernels,
+ * then the operators, out= forms and fused expressions, and once on a vector
+ * large enough to be split across the thread pool.
+ */
+static const char* ARITH_CHECKS =
+"import simd\n"
+"for size in (16, 48, 64, 112, 272, 1040):\n"
+"    for width in (1, 2, 4, 8):\n"
+"        a = simd.Vec(size=size, repeat_value=7, repeat_size=width)\n"
+"        b = simd.Vec(size=size, repeat_value=9, repeat_size=width)\n"
+"        a.add(b, width=width)\n"
+"        assert a.as_tuple(type=int, width=width) == (16,) * (size // width), (size, width)\n"
+"        a.sub(b, width=width)\n"
+"        a.sub(b, width=width)\n"
+"        assert a.as_tuple(type=int, width=width) == (-2,) * (size // width), (size, width)\n"
+"    for width in (4, 8):\n"
+"        a = simd.Vec(size=size, repeat_value=1.5, repeat_size=width)\n"
+"        b = simd.Vec(size=size, repeat_value=0.25, repeat_size=width)\n"
+"        a.fadd(b, width=width)\n"
+"        assert a.as_tuple(type=float, width=width) == (1.75,) * (size // width), (size, width)\n"
+"        a.fsub(b, width=width)\n"
+"        a.fsub(b, width=width)\n"
+"        assert a.as_tuple(type=float, width=width) == (1.25,) * (size // width), (size, width)\n"
+"a = simd.Vec(size=160, repeat_value=1, repeat_size=4)\n"
+"b = simd.Vec(size=80, repeat_value=1, repeat_size=4)\n"
+"a.add(b, width=4)\n"
+"assert a.as_tuple(type=int, width=4) == (2,) * 20 + (1,) * 20\n"
+"a = simd.Vec(size=64, repeat_value=3, repeat_size=4)\n"
+"b = simd.Vec(size=64, repeat_value=5, repeat_size=4)\n"
+"c = a + b\n"
+"assert c.type == 'i32' and c.to_list() == [8] * 16 and a.to_list() == [3] * 16\n"
+"assert (c - a - a).to_list() == [2] * 16\n"
+"out = simd.Vec(size=64, type='i32')\n"
+"assert a.sub(b, width=4, out=out) is out and out.to_list() == [-2] * 16\n"
+"a += b\n"
+"assert a.to_list() == [8] * 16\n"
+"f = simd.Vec(size=32, repeat_value=1.5, repeat_size=8)\n"
+"assert (f + f).to_list() == [3.0] * 4\n"
+"for size in (48, 4096 + 16, 3 * 4096 + 48):\n"
+"    a = simd.Vec(size=size, repeat_value=10, repeat_size=4)\n"
+"    b = simd.Vec(size=size, repeat_value=3, repeat_size=4)\n"
+"    r = a.lazy().add(b, width=4).sub(b, width=4).sub(b, width=4).eval()\n"
+"    assert r.to_list() == [7] * (size // 4) and a.to_list() == [10] * (size // 4), size\n"
+"    assert simd.expr(a).add(b, width=4).sub(a, width=4).eval(out=a) is a\n"
+"    assert a.to_list() == [3] * (size // 4), size\n"
+"simd.set_num_threads(4)\n"
+"size = 8 << 20\n"
+"a = simd.Vec(size=size, repeat_value=3, repeat_size=4)\n"
+"b = simd.Vec(size=size, repeat_value=5, repeat_size=4)\n"
+"a.add(b, width=4)\n"
+"v = a.view(type=int, width=4)\n"
+"assert v[0] == 8 and v[size // 8] == 8 and v[-1] == 8\n"
+"del v\n"
+"assert a.sum() == 8 * (size // 4) and a.max('u8') == 8 and a.min('u8') == 0\n"
+"simd.set_num_threads(0)\n"
+"import array\n"
+"import math\n"
+"import operator\n"
+"for n in (4, 36, 1000):\n"
+"    items = [(i * 7919) % 2003 - 1000 for i in range(n)]\n"
+"    for code, name in (('b', 'i8'), ('h', 'i16'), ('i', 'i32'), ('q', 'i64'), ('d', 'f64')):\n"
+"        lanes = [x % 128 - 64 for x in items] if code == 'b' else items\n"
+"        x = simd.Vec.from_buffer(array.array(code, lanes), copy=True)\n"
+"        assert x.type == name, (x.type, name)\n"
+"        pad = x.size() // x.view().itemsize - len(lanes)\n"
+"        lanes = lanes + [0] * pad\n"
+"        assert x.sum() == sum(lanes) and x.min() == min(lanes) and x.max() == max(lanes), (n, name)\n"
+"        assert x.argmin() == lanes.index(min(lanes)) and x.argmax() == lanes.index(max(lanes)), (n, name)\n"
+"        assert abs(x.mean() - sum(lanes) / len(lanes)) < 1e-9, (n, name)\n"
+"for size in (16, 48, 4096 + 80):\n"
+"    a = simd.Vec.from_buffer(array.array('i', [-3, 70000, 5, -40000] * (size // 16)))\n"
+"    b = simd.Vec.from_buffer(array.array('i', [7, 70000, -9, 40000] * (size // 16)))\n"
+"    out = simd.Vec(size=size, type='i32')\n"
+"    assert a.mul(b, width=4, out=out).to_list() == [-21, 605032704, -45, -1600000000] * (size // 16), size\n"
+"    assert a.mul(b, width=4, out=out, high=True).to_list() == [-1, 1, -1, -1] * (size // 16), size\n"
+"    f = simd.Vec.from_buffer(array.array('d', [2.0, 9.0] * (size // 16)))\n"
+"    g = simd.Vec.from_buffer(array.array('d', [4.0, 0.5] * (size // 16)))\n"
+"    assert f.fmul(g, width=8, out=simd.Vec(size=size, type='f64')).to_list() == [8.0, 4.5] * (size // 16)\n"
+"    assert (f / g).to_list() == [0.5, 18.0] * (size // 16)\n"
+"    assert f.fma(g, f, width=8, out=simd.Vec(size=size, type='f64')).to_list() == [10.0, 13.5] * (size // 16)\n"
+"    f.fsqrt(width=8)\n"
+"    assert f.to_list()[:2] == [2.0 ** 0.5, 3.0]\n"
+"for size in (16, 48, 4096 + 80):\n"
+"    px = simd.Vec.from_buffer(array.array('B', [250, 10, 128, 0] * (size // 4)))\n"
+"    py = simd.Vec.from_buffer(array.array('B', [10, 20, 200, 0] * (size // 4)))\n"
+"    out = simd.Vec(size=size, type='u8')\n"
+"    assert px.add(py, width=1, out=out, saturate=True).to_list() == [255, 30, 255, 0] * (size // 4), size\n"
+"    assert px.sub(py, width=1, out=out, saturate=True).to_list() == [240, 0, 0, 0] * (size // 4), size\n"
+"    assert px.avg(py, width=1, out=out).to_list() == [130, 15, 164, 0] * (size // 4), size\n"
+"    assert px.absdiff(py, width=1, out=out).to_list() == [240, 10, 72, 0] * (size // 4), size\n"
+"    assert px.sad(py) == 322 * (size // 4), size\n"
+"    s16 = simd.Vec.from_buffer(array.array('h', [30000, -30000, 5, -5] * (size // 8)))\n"
+"    out = simd.Vec(size=size, type='i16')\n"
+"    assert s16.add(s16, width=2, out=out, saturate=True).to_list() == [32767, -32768, 10, -10] * (size // 8)\n"
+"    assert s16.absdiff(out, width=2, out=out).to_list() == [2767, 2768, 5, 5] * (size // 8)\n"
+"for size in (16, 48, 4096 + 80):\n"
+"    bx = simd.Vec.from_buffer(bytearray([0xf0, 0x0f, 0xff, 0x01] * (size // 4)))\n"
+"    by = simd.Vec.from_buffer(bytearray([0x3c, 0x3c, 0x00, 0x03] * (size // 4)))\n"
+"    out = simd.Vec(size=size, type='u8')\n"
+"    assert bx.and_(by, out=out).to_list() == [0x30, 0x0c, 0x00, 0x01] * (size // 4), size\n"
+"    assert bx.or_(by, out=out).to_list() == [0xfc, 0x3f, 0xff, 0x03] * (size // 4), size\n"
+"    assert bx.xor(by, out=out).to_list() == [0xcc, 0x33, 0xff, 0x02] * (size // 4), size\n"
+"    assert bx.andnot(by, out=out).to_list() == [0xc0, 0x03, 0xff, 0x00] * (size // 4), size\n"
+"    assert (~bx).to_list() == [0x0f, 0xf0, 0x00, 0xfe] * (size // 4), size\n"
+"    assert (bx ^ by).to_list() == [0xcc, 0x33, 0xff, 0x02] * (size // 4), size\n"
+"    assert bx.popcount() == 17 * (size // 4) and bx.and_popcount(by) == 5 * (size // 4), size\n"
+"    bx.not_()\n"
+"    assert bx.popcount() == 15 * (size // 4), size\n"
+"for size in (16, 48, 112, 4096 + 80):\n"
+"    for fmt in ('b', 'H', 'i', 'Q', 'f', 'd'):\n"
+"        width = array.array(fmt).itemsize\n"
+"        lanes = [(i * 37) % 101 for i in range(size // width)]\n"
+"        fv = simd.Vec.from_buffer(array.array(fmt, lanes))\n"
+"        kept, count = fv.filter(width, gt=20, lt=70)\n"
+"        expected = [x for x in lanes if 20 < x < 70]\n"
+"        assert count == len(expected) and kept.to_list()[:count] == expected, (fmt, size)\n"
+"        assert kept.size() == (count * width + 15) // 16 * 16, (fmt, size)\n"
+"        assert fv.filter(width, eq=37)[1] == lanes.count(37), (fmt, size)\n"
+"fv = simd.Vec.from_buffer(array.array('i', [-5, 3, -2**31, 2**31 - 1]))\n"
+"assert fv.filter(4, gt=-3)[0].to_list()[:2] == [3, 2**31 - 1] and fv.filter(4, lt=-2**40)[1] == 0\n"
+"assert simd.Vec.from_buffer(array.array('I', [5, 2**32 - 1, 0, 7])).filter(4, gt=6)[1] == 2\n"
+"for size in (16, 48, 4096 + 80):\n"
+"    for fmt in ('b', 'B', 'h', 'I', 'q', 'f', 'd'):\n"
+"        width = array.array(fmt).itemsize\n"
+"        xs = [(i * 37) % 11 for i in range(size // width)]\n"
+"        ys = [(i * 13) % 7 for i in range(size // width)]\n"
+"        cx = simd.Vec.from_buffer(array.array(fmt, xs))\n"
+"        cy = simd.Vec.from_buffer(array.array(fmt, ys))\n"
+"        for op, fn in (('eq', operator.eq), ('ne', operator.ne), ('lt', operator.lt),\n"
+"                       ('le', operator.le), ('gt', operator.gt), ('ge', operator.ge)):\n"
+"            expected = [fn(a, b) for a, b in zip(xs, ys)]\n"
+"            mask = cx.cmp(cy, op, width).to_list()\n"
+"            assert [m != 0 for m in mask] == expected and set(mask) <= {0, -1}, (fmt, op, size)\n"
+"            bits = cx.cmp(5, op, width, packed=True).to_list()\n"
+"            assert [bool(bits[i // 8] >> (i % 8) & 1) for i in range(len(xs))] == [fn(a, 5) for a in xs], (fmt, op)\n"
+"        picked = simd.select(cx.cmp(cy, 'gt', width), cx, cy).to_list()\n"
+"        assert picked[:len(xs)] == [max(a, b) for a, b in zip(xs, ys)], (fmt, size)\n"
+"cx = simd.Vec.from_buffer(array.array('b', [-1, 0, 127, -128] * 4))\n"
+"assert cx.cmp(200, 'lt', 1, packed=True).to_list()[:2] == [255, 255] and cx.cmp(-200, 'le', 1).to_list() == [0] * 16\n"
+"assert simd.Vec.from_buffer(array.array('d', [float('nan'), 1.0])).cmp(1.0, 'ge', 8).to_list()[:2] == [0, -1]\n"
+"for size in (16, 48, 112, 4096 + 80):\n"
+"    for fmt in ('b', 'H', 'i', 'Q', 'f', 'd'):\n"
+"        width = array.array(fmt).itemsize\n"
+"        lanes = [(i * 37) % 101 for i in range(size // width)]\n"
+"        sv = simd.Vec.from_buffer(array.array(fmt, lanes))\n"
+"        for wanted in (0, 37, 100, 101):\n"
+"            first = lanes.index(wanted) if wanted in lanes else -1\n"
+"            last = len(lanes) - 1 - lanes[::-1].index(wanted) if wanted in lanes else -1\n"
+"            assert sv.find(wanted, width) == first and sv.rfind(wanted, width) == last, (fmt, size, wanted)\n"
+"            assert sv.count(wanted, width) == lanes.count(wanted), (fmt, size, wanted)\n"
+"        hits = [i for i, x in enumerate(lanes) if x in (55, 74, 99)]\n"
+"        assert sv.find_any([55, 74, 99], width) == (hits[0] if hits else -1), (fmt, size)\n"
+"        assert sv.find_any(list(range(200, 220)) + [lanes[-1]], width) == lanes.index(lanes[-1]), (fmt, size)\n"
+"sv = simd.Vec.from_buffer(array.array('B', [255] * 16))\n"
+"assert sv.find(-1, 1) == -1 and sv.find(255, 1) == 0 and sv.count(256, 1) == 0 and sv.find(-1, 2) == 0\n"
+"assert simd.Vec.from_buffer(array.array('d', [float('nan'), -0.0])).find(0.0, 8) == 1\n"
+"for size in (16, 64, 1024, 40000):\n"
+"    for fmt in ('i', 'I', 'f', 'q', 'Q', 'd'):\n"
+"        lanes = [(i * 7919) % 1009 - (0 if fmt in 'IQ' else 500) for i in range(size // array.array(fmt).itemsize)]\n"
+"        sv = simd.Vec.from_buffer(array.array(fmt, lanes))\n"
+"        order = sorted(range(len(lanes)), key=lambda i: lanes[i])\n"
+"        assert sv.argsort().to_list()[:len(lanes)] == order, (fmt, size)\n"
+"        tags = simd.Vec.from_buffer(array.array('I', range(max(len(lanes), 4))))\n"
+"        sv.sort(values=tags)\n"
+"        assert sv.to_list() == sorted(lanes) and tags.to_list()[:len(lanes)] == order, (fmt, size)\n"
+"sv = simd.Vec.from_buffer(array.array('d', [float('nan'), 2.0, -0.0, float('-inf'), 0.0, -3.5]))\n"
+"sv.sort()\n"
+"assert str(sv.to_list()) == '[-inf, -3.5, -0.0, 0.0, 2.0, nan]'\n"
+"for size in (16, 48, 4096 + 80):\n"
+"    for fmt in ('I', 'q', 'f', 'd'):\n"
+"        width = array.array(fmt).itemsize\n"
+"        lanes = [(i * 37) % 11 for i in range(size // width)]\n"
+"        marks = [int(i % 7 == 3) for i in range(len(lanes))]\n"
+"        inclusive, exclusive, segmented, total = [], [], [], 0\n"
+"        for x, m in zip(lanes, marks):\n"
+"            exclusive.append(sum(inclusive[-1:]))\n"
+"            inclusive.append(exclusive[-1] + x)\n"
+"            total = x if m else total + x\n"
+"            segmented.append(total)\n"
+"        sv = simd.Vec.from_buffer(array.array(fmt, lanes))\n"
+"        out = simd.Vec(size=sv.size())\n"
+"        assert sv.cumsum(width, out=out).to_list(type=sv.type) == inclusive, (fmt, size)\n"
+"        assert sv.cumsum(width, exclusive=True, out=out).to_list(type=sv.type) == exclusive, (fmt, size)\n"
+"        flags = simd.Vec.from_buffer(array.array('I' if width == 4 else 'Q', marks))\n"
+"        sv.cumsum(width, flags=flags)\n"
+"        assert sv.to_list() == segmented, (fmt, size)\n"
+"sv = simd.Vec.from_buffer(array.array('i', [-1, 2 ** 31 - 1, 1, 5]))\n"
+"sv.cumsum(4)\n"
+"assert sv.to_list() == [-1, 2 ** 31 - 2, 2 ** 31 - 1, -2 ** 31 + 4]\n"
+"formats = {'i8': 'b', 'u8': 'B', 'i16': 'h', 'u16': 'H', 'i32': 'i', 'u32': 'I', 'i64': 'q', 'u64': 'Q', 'f32': 'f', 'f64': 'd'}\n"
+"for size in (16, 64 + 48, 4096 + 16):\n"
+"    for source in formats:\n"
+"        width = array.array(formats[source]).itemsize\n"
+"        span = min(1 << (8 * width), 70001)\n"
+"        lanes = array.array(formats[source], [(i * 7919) % span - (0 if source[0] == 'u' else span // 2) for i in range(size // width)])\n"
+"        sv = simd.Vec.from_buffer(lanes)\n"
+"        for target in formats:\n"
+"            kind, bits = target[0], int(target[1:])\n"
+"            low, high = (0, (1 << bits) - 1) if kind == 'u' else (-(1 << (bits - 1)), (1 << (bits - 1)) - 1)\n"
+"            wanted = [float(x) if kind == 'f' else max(low, min(high, int(x))) for x in lanes]\n"
+"            got = sv.convert(source, target)\n"
+"            assert got.type == target and got.size() == (len(lanes) * bits // 8 + 15) // 16 * 16, (source, target)\n"
+"            assert got.to_list()[:len(lanes)] == wanted, (source, target, size)\n"
+"sv = simd.Vec.from_buffer(array.array('d', [float('nan'), -1.9, 2.0 ** 63, -1e300, 3e9, 1.5]))\n"
+"assert sv.convert('f64', 'i32').to_list() == [0, -1, 2 ** 31 - 1, -2 ** 31, 2 ** 31 - 1, 1, 0, 0]\n"
+"assert sv.convert('f64', 'i64').to_list() == [0, -1, 2 ** 63 - 1, -2 ** 63, 3000000000, 1]\n"
+"assert sv.convert('f64', 'u8').to_list()[:6] == [0, 0, 255, 0, 255, 1]\n"
+"for size in (16, 96, 16384 * 4 + 48):\n"
+"    xs = [float((i * 37) % 9 - 4) for i in range(size // 4)]\n"
+"    ys = [float((i * 11) % 7 - 3) for i in range(size // 4)]\n"
+"    a, b = simd.Vec.from_buffer(array.array('f', xs)), simd.Vec.from_buffer(array.array('f', ys))\n"
+"    dot, xx, yy = sum(x * y for x, y in zip(xs, ys)), sum(x * x for x in xs), sum(y * y for y in ys)\n"
+"    assert simd.dot(a, b) == dot and simd.l2(a, b) == math.sqrt(xx - 2 * dot + yy), size\n"
+"    assert abs(simd.cosine(a, b) - dot / math.sqrt(xx * yy)) < 1e-12, size\n"
+"    bytes_a, bytes_b = array.array('b', [int(x) * 31 for x in xs] * 4), array.array('b', [-128] * len(xs) * 4)\n"
+"    a, b = simd.Vec.from_buffer(bytes_a), simd.Vec.from_buffer(bytes_b)\n"
+"    assert simd.dot(a, b, type='i8') == sum(x * -128 for x in bytes_a), size\n"
+"    assert simd.l2(a, b, type='i8') == math.sqrt(sum((x + 128) ** 2 for x in bytes_a)), size\n"
+"rows = [[float((r * 7 + c * 3) % 11) for c in range(5)] for r in range(30)]\n"
+"matrix = simd.Vec.from_buffer(array.array('f', sum(rows, []) + [0.0] * 2))\n"
+"query = simd.Vec.from_buffer(array.array('f', rows[17][:4] + [rows[17][4] + 0.5, 0.0, 0.0, 0.0]))\n"
+"near = sorted(range(30), key=lambda r: (sum((x - y) ** 2 for x, y in zip(rows[r], query.to_list())), r))\n"
+"assert simd.knn(query, matrix, 5, 4) == near[:4] and simd.knn(query, matrix, 5, 99) == near\n"
+"far = sorted(range(30), key=lambda r: (-sum(x * y for x, y in zip(rows[r], query.to_list())), r))\n"
+"assert simd.knn(query, matrix, 5, 3, metric='dot') == far[:3] and simd.knn(query, matrix, 5, 3, metric='cosine') == [6, 17, 28]\n"
+"matrix = simd.Vec.from_buffer(array.array('f', sum(rows[:7], [])[:21]))\n"
+"assert matrix.size() == 96 and simd.knn(query, matrix, 3, 99) == [4, 2, 5, 6, 1, 3, 0, 7]\n"
+"assert simd.knn(query, matrix, 3, 99, rows=7) == [4, 2, 5, 6, 1, 3, 0] and simd.knn(query, matrix, 3, 2, rows=0) == []\n"
+"small = simd.Vec.from_buffer(array.array('b', [r * 8 + c for r in range(10) for c in range(4)]))\n"
+"assert simd.knn(simd.Vec.from_buffer(array.array('b', [99] * 16)), small, 4, 3, type='i8', rows=10) == [9, 8, 7]\n"
+"try:\n"
+"    simd.knn(query, matrix, 3, 2, rows=9)\n"
+"    assert False, 'knn read past the matrix'\n"
+"except simd.error:\n"
+"    pass\n"
+"for kind in ('f32', 'f64'):\n"
+"    for rows, inner, cols in ((1, 1, 1), (5, 17, 33), (70, 300, 40), (9, 20, 600)):\n"
+"        a, b = simd.Mat(rows, inner, kind), simd.Mat(cols, inner, kind).transpose()\n"
+"        for i in range(inner):\n"
+"            for r in range(max(rows, cols)):\n"
+"                if r < rows: a.set(r, i, float((r * 5 + i * 3) % 7 - 3))\n"
+"                if r < cols: b.set(i, r, float((r * 2 + i) % 5 - 2))\n"
+"        la, lb = a.to_list(), b.to_list()\n"
+"        wanted = [[sum(la[r][i] * lb[i][c] for i in range(inner)) for c in range(cols)] for r in range(rows)]\n"
+"        assert a.matmul(b).to_list() == a.matmul(b.copy()).to_list() == wanted, (kind, rows, inner, cols)\n"
+"        assert a.transpose().shape == (inner, rows) and a.transpose().transpose().to_list() == la\n"
+"        assert a.col(inner - 1).to_list() == [[row[-1]] for row in la] and a.row(rows - 1).to_list() == [la[-1]]\n"
+"        x = b.col(0).copy().transpose().copy()\n"
+"        for y in (a.gemv(x.vec), a.transpose().copy().transpose().gemv(x.vec)):\n"
+"            assert simd.Mat(1, rows, kind, vec=y).to_list() == [[row[0] for row in wanted]], (kind, rows, inner)\n"
+"assert simd.Mat(3, 5).strides == (64, 4) and simd.Mat(3, 5, 'f64').vec.size() == 192\n"
+"for code in ('I', 'q', 'f', 'd'):\n"
+"    for size in (8, 36, 40000):\n"
+"        lanes = array.array(code, [(i * 7919) % 1000 - 300 if code != 'I' else (i * 7919) % 1000 for i in range(size)])\n"
+"        sv = simd.Vec.from_buffer(lanes)\n"
+"        order = sv.argsort()\n"
+"        got = array.array(code, sv.gather(order, count=size).as_bytes()[:size * lanes.itemsize])\n"
+"        assert got.tolist() == sorted(lanes), (code, size)\n"
+"        back = simd.Vec(size=sv.size())\n"
+"        back.scatter(order, sv.gather(order), width=lanes.itemsize, count=size)\n"
+"        assert back.as_bytes()[:size * lanes.itemsize] == lanes.tobytes(), (code, size)\n"
+"sv = simd.Vec.from_buffer(array.array('I', [10, 20, 30, 40]))\n"
+"assert sv.gather(simd.Vec.from_buffer(array.array('I', [3, 3, 0, 2]))).to_list() == [40, 40, 10, 30]\n"
+"try:\n"
+"    sv.scatter(simd.Vec.from_buffer(array.array('I', [0, 1, 4, 2])), simd.Vec.from_buffer(array.array('I', [7] * 4)))\n"
+"    assert False\n"
+"except simd.error:\n"
+"    assert sv.to_list() == [10, 20, 30, 40]\n"
+"sv.scatter(simd.Vec.from_buffer(array.array('I', [1, 1, 1, 1])), simd.Vec.from_buffer(array.array('I', [5, 6, 7, 8])))\n"
+"assert sv.to_list() == [10, 8, 30, 40]\n"
+"lanes = array.array('d', [(i * 37) % 23 * 0.5 - 1.0 for i in range(40000)] + [float('nan'), 10.0, 10.5, -1.5])\n"
+"sv = simd.Vec.from_buffer(lanes)\n"
+"for code, kind in (('d', 'f64'), ('f', 'f32'), ('i', 'i32')):\n"
+"    typed = simd.Vec.from_buffer(array.array(code, [int(x) if code == 'i' else x for x in lanes if code != 'i' or x == x]))\n"
+"    values = [x for x in array.array(code, typed.as_bytes()).tolist()]\n"
+"    for nbins in (1, 6, 44):\n"
+"        wanted = [0] * nbins\n"
+"        for x in values:\n"
+"            if -1.0 <= x <= 10.0:\n"
+"                wanted[min(int((x + 1.0) * (nbins / 11.0)), nbins - 1)] += 1\n"
+"        assert typed.histogram(nbins, -1.0, 10.0, type=kind).to_list()[:nbins] == wanted, (kind, nbins)\n"
+"bv = simd.Vec.from_buffer(bytearray(bytes(range(256)) * 3 + b'\\x07' * 1008))\n"
+"assert bv.bincount_u8().to_list() == [3] * 7 + [1011] + [3] * 248\n"
+"def crc32c(data, crc=0):\n"
+"    crc ^= 0xffffffff\n"
+"    for byte in data:\n"
+"        crc ^= byte\n"
+"        for _ in range(8):\n"
+"            crc = (crc >> 1) ^ 0x82f63b78 if crc & 1 else crc >> 1\n"
+"    return crc ^ 0xffffffff\n"
+"assert crc32c(b'123456789') == 0xe3069283\n"
+"for size in (16, 6160, 12336):\n"
+"    bv = simd.Vec.from_buffer(bytearray((i * 131 + 7) % 256 for i in range(size)))\n"
+"    assert bv.crc32c() == crc32c(bv.as_bytes()) and bv.crc32c(value=99) == crc32c(bv.as_bytes(), 99), size\n"
+"    for width in (4, 8):\n"
+"        hashes = bv.hash(width=width, seed=3)\n"
+"        assert hashes.size() == bv.size() and hashes.type == ('u32' if width == 4 else 'u64')\n"
+"        assert len(set(hashes.to_list())) == len(set(bv.hash(width=width).to_list()))\n"
+"        assert hashes.as_bytes() != bv.hash(width=width, seed=4).as_bytes()\n"
+"assert simd.Vec(size=16).hash(width=8).to_list() == [0x6393d51c06c618dc] * 2\n"
+"x = simd.Vec(size=64, repeat_value=255, repeat_size=1)\n"
+"assert x.sum('u8') == 255 * 64 and x.sum('i8') == -64 and x.sum('u64') == (1 << 64) - 8\n"
+"print('Arithmetic checks passed on tier: ' + simd.system_info()['dispatch'])\n";
+
+int
+main(int argc, char *argv[])
+{
+    int result = 0;
+    Py_Initialize();
+    PyObject * sys_path = PySys_GetObject("path");
+    PyList_Append(sys_path, PyUnicode_FromString(TESTING_BIN_PATH));
+
+    if (PyRun_SimpleString(ARITH_CHECKS) != 0) {
+        fprintf(stderr, "Arithmetic checks failed\n");
+        result = 1;
+    }
+
+    if (Py_FinalizeEx() < 0) {
+        exit(120);
+    }
+    return result;
+}
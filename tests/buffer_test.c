@@ -0,0 +1,57 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+/* Checks the buffer protocol export of Vec, typed views, and that the vector
+ * cannot be resized while its memory is exported.
+ */
+static const char* BUFFER_CHECKS =
+"import simd\n"
+"a = simd.Vec(size=32, repeat_value=5, repeat_size=4)\n"
+"m = memoryview(a)\n"
+"assert m.format == 'B' and m.nbytes == 32 and bytes(m) == a.as_bytes()\n"
+"v = a.view(type=int, width=4)\n"
+"assert v.format == 'i' and v.tolist() == [5] * 8\n"
+"v[0] = -3\n"
+"assert a.as_tuple(type=int, width=4)[0] == -3\n"
+"try:\n"
+"    a.resize(64)\n"
+"    raise AssertionError('resize succeeded while exported')\n"
+"except BufferError:\n"
+"    pass\n"
+"del m, v\n"
+"assert a.resize(64) == 64\n"
+"f = simd.Vec(size=16, repeat_value=2.5, repeat_size=8).view(type=float, width=8)\n"
+"assert f.format == 'd' and f.tolist() == [2.5, 2.5]\n"
+"import threading\n"
+"big = simd.Vec(size=1 << 26, repeat_value=1, repeat_size=1)\n"
+"sink = bytearray(1 << 26)\n"
+"copier = threading.Thread(target=lambda: [big.into(sink) for _ in range(8)])\n"
+"refused = 0\n"
+"copier.start()\n"
+"while copier.is_alive():\n"
+"    try:\n"
+"        big.resize(1 << 26)\n"
+"    except BufferError:\n"
+"        refused += 1\n"
+"copier.join()\n"
+"assert refused > 0 and big.size() == 1 << 26\n"
+"print('Buffer checks passed')\n";
+
+int
+main(int argc, char *argv[])
+{
+    int result = 0;
+    Py_Initialize();
+    PyObject * sys_path = PySys_GetObject("path");
+    PyList_Append(sys_path, PyUnicode_FromString(TESTING_BIN_PATH));
+
+    if (PyRun_SimpleString(BUFFER_CHECKS) != 0) {
+        fprintf(stderr, "Buffer checks failed\n");
+        result = 1;
+    }
+
+    if (Py_FinalizeEx() < 0) {
+        exit(120);
+    }
+    return result;
+}
@@ -0,0 +1,64 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+/* Checks filling, clearing and copying with the non-temporal stores, which only vectors
+ * past the last level cache reach by default. The cutover is lowered to 16 bytes before
+ * import, so every size streams, including borrowed memory not aligned past 16 bytes.
+ */
+static const char* STREAM_CHECKS =
+"import simd, struct, ctypes\n"
+"assert simd.system_info()['stream_min'] == 16\n"
+"sizes = (16, 32, 48, 64, 80, 112, 4096, 4144, 65536 + 208)\n"
+"for n in sizes:\n"
+"    for value, width, fmt in ((0xA5, 1, 'B'), (0xBEEF, 2, 'H'), (0xDEADBEEF, 4, 'I'), (0x0123456789ABCDEF, 8, 'Q')):\n"
+"        v = simd.Vec(size=n, repeat_value=value, repeat_size=width)\n"
+"        assert v.as_bytes() == struct.pack(fmt, value) * (n // width), (n, width)\n"
+"        v.clear()\n"
+"        assert v.as_bytes() == bytes(n), (n, width)\n"
+"    for value, width, fmt in ((-1.5, 4, 'f'), (2.25, 8, 'd')):\n"
+"        v = simd.Vec(size=n, repeat_value=value, repeat_size=width)\n"
+"        assert v.as_bytes() == struct.pack(fmt, value) * (n // width), (n, width)\n"
+"    data = bytes((i * 7 + n) % 251 for i in range(n))\n"
+"    owned = simd.Vec.from_buffer(data, copy=True)\n"
+"    assert owned.copy().as_bytes() == data, n\n"
+"    if n > 32:\n"
+"        assert owned.copy(16, n - 16).as_bytes() == data[16:n - 16], n\n"
+"store = bytearray(65536 + 512)\n"
+"base = ctypes.addressof((ctypes.c_char * len(store)).from_buffer(store))\n"
+"for misalign in (16, 32, 48):\n"
+"    offset = (misalign - base) % 64\n"
+"    for n in sizes:\n"
+"        data = bytes((i * 13 + misalign) % 253 for i in range(n))\n"
+"        store[:] = b'\\xff' * len(store)\n"
+"        store[offset:offset + n] = data\n"
+"        view = memoryview(store)[offset:offset + n]\n"
+"        borrowed = simd.Vec.from_buffer(view)\n"
+"        assert borrowed.copy().as_bytes() == data, (misalign, n)\n"
+"        if n > 32:\n"
+"            assert borrowed.copy(16, n - 16).as_bytes() == data[16:n - 16], (misalign, n)\n"
+"        borrowed.clear()\n"
+"        assert store[offset:offset + n] == bytes(n), (misalign, n)\n"
+"        assert store[:offset] == b'\\xff' * offset and store[offset + n:] == b'\\xff' * (len(store) - offset - n), (misalign, n)\n"
+"        del borrowed\n"
+"        view.release()\n"
+"print('Stream checks passed')\n";
+
+int
+main(int argc, char *argv[])
+{
+    int result = 0;
+    setenv("PYSIMD_STREAM_MIN", "16", 1);
+    Py_Initialize();
+    PyObject * sys_path = PySys_GetObject("path");
+    PyList_Append(sys_path, PyUnicode_FromString(TESTING_BIN_PATH));
+
+    if (PyRun_SimpleString(STREAM_CHECKS) != 0) {
+        fprintf(stderr, "Stream checks failed\n");
+        result = 1;
+    }
+
+    if (Py_FinalizeEx() < 0) {
+        exit(120);
+    }
+    return result;
+}